@@ -36,6 +36,13 @@
 #include <arm_neon.h>
 #endif
 
+// the fixed-point operations are not offered by the Accelerate framework
+#if __SSE2__
+#include <emmintrin.h>
+#elif _ARM_ARCH_7
+#include <arm_neon.h>
+#endif
+
 /**
  * This class offers static inline functions for computing basic arithmetic with float arrays.
  * It offers a central place for optimised implementations of common compute-intensive operations.
@@ -57,9 +64,9 @@ class ArrayArithmetic {
         inVec0 = _mm_loadu_ps(input0 + i);
         inVec1 = _mm_loadu_ps(input1 + i);
         res = _mm_add_ps(inVec0, inVec1);
-        _mm_store_ps(output + i, res);
+        _mm_storeu_ps(output + i, res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input0[i] + input1[i];
       }
       #elif _ARM_ARCH_7
@@ -71,7 +78,7 @@ class ArrayArithmetic {
         res = vaddq_f32(inVec0, inVec1);
         vst1q_f32((float32_t *) (output + i), res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input0[i] + input1[i];
       }
       #else
@@ -91,9 +98,9 @@ class ArrayArithmetic {
       for (int i = startIndex, j = 0; j < numFours; i+=4, j++) {
         inVec = _mm_loadu_ps(input + i);
         res = _mm_add_ps(inVec, constVec);
-        _mm_store_ps(output + i, res);
+        _mm_storeu_ps(output + i, res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input[i] + constant;
       }
       #elif _ARM_ARCH_7
@@ -104,7 +111,7 @@ class ArrayArithmetic {
         float32x4_t res = vaddq_f32(inVec, constVec);
         vst1q_f32((float32_t *) (output + i), res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input[i] + constant;
       }
       #else
@@ -124,9 +131,9 @@ class ArrayArithmetic {
         inVec0 = _mm_loadu_ps(input0 + i);
         inVec1 = _mm_loadu_ps(input1 + i);
         res = _mm_sub_ps(inVec0, inVec1);
-        _mm_store_ps(output + i, res);
+        _mm_storeu_ps(output + i, res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input0[i] - input1[i];
       }
       #elif _ARM_ARCH_7
@@ -140,7 +147,7 @@ class ArrayArithmetic {
         vst1q_f32((float32_t *) (output + i), res); // store
       }
       // compute the remainder of the block (if any)
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input0[i] - input1[i];
       }
       #else
@@ -161,9 +168,9 @@ class ArrayArithmetic {
       for (int i = startIndex, j = 0; j < numFours; i+=4, j++) {
         inVec = _mm_loadu_ps(input + i);
         res = _mm_sub_ps(inVec, constVec);
-        _mm_store_ps(output + i, res);
+        _mm_storeu_ps(output + i, res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input[i] - constant;
       }
       #elif _ARM_ARCH_7
@@ -174,7 +181,7 @@ class ArrayArithmetic {
         float32x4_t res = vsubq_f32(inVec, constVec);
         vst1q_f32((float32_t *) (output + i), res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input[i] - constant;
       }
       #else
@@ -194,9 +201,9 @@ class ArrayArithmetic {
         inVec0 = _mm_loadu_ps(input0 + i);
         inVec1 = _mm_loadu_ps(input1 + i);
         res = _mm_mul_ps(inVec0, inVec1);
-        _mm_store_ps(output + i, res);
+        _mm_storeu_ps(output + i, res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input0[i] * input1[i];
       }
       #elif _ARM_ARCH_7
@@ -210,7 +217,7 @@ class ArrayArithmetic {
         vst1q_f32((float32_t *) (output + i), res); // store
       }
       // compute the remainder of the block (if any)
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input0[i] * input1[i];
       }
       #else
@@ -230,9 +237,9 @@ class ArrayArithmetic {
       for (int i = startIndex, j = 0; j < numFours; i+=4, j++) {
         inVec = _mm_loadu_ps(input + i);
         res = _mm_mul_ps(inVec, constVec);
-        _mm_store_ps(output + i, res);
+        _mm_storeu_ps(output + i, res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input[i] * constant;
       }
       #elif _ARM_ARCH_7
@@ -242,7 +249,7 @@ class ArrayArithmetic {
         float32x4_t res = vmulq_n_f32(inVec, constant);
         vst1q_f32((float32_t *) (output + i), res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input[i] * constant;
       }
       #else
@@ -263,9 +270,9 @@ class ArrayArithmetic {
         inVec0 = _mm_loadu_ps(input0 + i);
         inVec1 = _mm_loadu_ps(input1 + i);
         res = _mm_div_ps(inVec0, inVec1);
-        _mm_store_ps(output + i, res);
+        _mm_storeu_ps(output + i, res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input0[i] / input1[i];
       }
       #else
@@ -285,9 +292,9 @@ class ArrayArithmetic {
       for (int i = startIndex, j = 0; j < numFours; i+=4, j++) {
         inVec = _mm_loadu_ps(input + i);
         res = _mm_div_ps(inVec, constVec);
-        _mm_store_ps(output + i, res);
+        _mm_storeu_ps(output + i, res);
       }
-      for (int i = startIndex + numFours<<2; i < endIndex; i++) {
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
         output[i] = input[i] / constant;
       }
       #else
@@ -297,6 +304,177 @@ class ArrayArithmetic {
       #endif
     }
     
+    static inline void fill(float *output, float value, int startIndex, int endIndex) {
+      #if TARGET_OS_MAC || TARGET_OS_IPHONE
+      vDSP_vfill(&value, output+startIndex, 1, endIndex-startIndex);
+      #elif __SSE__
+      const __m128 valueVec = _mm_set1_ps(value);
+      const int numFours = (endIndex - startIndex) >> 2;
+      for (int i = startIndex, j = 0; j < numFours; i+=4, j++) {
+        _mm_storeu_ps(output + i, valueVec);
+      }
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
+        output[i] = value;
+      }
+      #elif _ARM_ARCH_7
+      const float32x4_t valueVec = vdupq_n_f32(value);
+      const int numFours = (endIndex - startIndex) >> 2;
+      for (int i = startIndex, j = 0; j < numFours; i+=4, j++) {
+        vst1q_f32((float32_t *) (output + i), valueVec);
+      }
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
+        output[i] = value;
+      }
+      #else
+      for (int i = startIndex; i < endIndex; i++) {
+        output[i] = value;
+      }
+      #endif
+    }
+  
+    /**
+     * Writes <code>start + n * slope</code> to <code>output[startIndex + n]</code>. Every element is
+     * computed from its index, such that rounding errors do not accumulate along the ramp.
+     */
+    static inline void ramp(float *output, float start, float slope, int startIndex, int endIndex) {
+      #if TARGET_OS_MAC || TARGET_OS_IPHONE
+      vDSP_vramp(&start, &slope, output+startIndex, 1, endIndex-startIndex);
+      #elif __SSE__
+      const __m128 startVec = _mm_set1_ps(start);
+      const __m128 slopeVec = _mm_set1_ps(slope);
+      const __m128 four = _mm_set1_ps(4.0f);
+      __m128 indexVec = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+      const int numFours = (endIndex - startIndex) >> 2;
+      for (int i = startIndex, j = 0; j < numFours; i+=4, j++) {
+        _mm_storeu_ps(output + i, _mm_add_ps(startVec, _mm_mul_ps(indexVec, slopeVec)));
+        indexVec = _mm_add_ps(indexVec, four); // integers are exact
+      }
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
+        output[i] = start + ((float) (i - startIndex)) * slope;
+      }
+      #elif _ARM_ARCH_7
+      const float32x4_t startVec = vdupq_n_f32(start);
+      const float32x4_t four = vdupq_n_f32(4.0f);
+      const float indices[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+      float32x4_t indexVec = vld1q_f32((const float32_t *) indices);
+      const int numFours = (endIndex - startIndex) >> 2;
+      for (int i = startIndex, j = 0; j < numFours; i+=4, j++) {
+        vst1q_f32((float32_t *) (output + i), vmlaq_n_f32(startVec, indexVec, slope));
+        indexVec = vaddq_f32(indexVec, four);
+      }
+      for (int i = startIndex + (numFours<<2); i < endIndex; i++) {
+        output[i] = start + ((float) (i - startIndex)) * slope;
+      }
+      #else
+      for (int i = startIndex; i < endIndex; i++) {
+        output[i] = start + ((float) (i - startIndex)) * slope;
+      }
+      #endif
+    }
+  
+    /**
+     * Returns the index of the first element in [startIndex, endIndex) which is at least
+     * <code>threshold</code>, or <code>endIndex</code> if there is none. Four elements are compared
+     * at once, and only a group containing a match is searched element by element.
+     */
+    static inline int findGreaterThanOrEqual(float *input, float threshold, int startIndex, int endIndex) {
+      int i = startIndex;
+      #if __SSE__
+      const __m128 thresholdVec = _mm_set1_ps(threshold);
+      for (; i <= endIndex - 4; i+=4) {
+        if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(input + i), thresholdVec)) != 0) {
+          break;
+        }
+      }
+      #elif _ARM_ARCH_7
+      for (; i <= endIndex - 4; i+=4) {
+        uint32x4_t maskVec = vcgeq_f32(vld1q_f32((const float32_t *) (input + i)), vdupq_n_f32(threshold));
+        uint32x2_t maskPair = vorr_u32(vget_low_u32(maskVec), vget_high_u32(maskVec));
+        if ((vget_lane_u32(maskPair, 0) | vget_lane_u32(maskPair, 1)) != 0) {
+          break;
+        }
+      }
+      #endif
+      for (; i < endIndex; i++) {
+        if (input[i] >= threshold) {
+          return i;
+        }
+      }
+      return endIndex;
+    }
+  
+    /**
+     * Returns the index of the first element in [startIndex, endIndex) which is less than
+     * <code>threshold</code>, or <code>endIndex</code> if there is none.
+     */
+    static inline int findLessThan(float *input, float threshold, int startIndex, int endIndex) {
+      int i = startIndex;
+      #if __SSE__
+      const __m128 thresholdVec = _mm_set1_ps(threshold);
+      for (; i <= endIndex - 4; i+=4) {
+        if (_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(input + i), thresholdVec)) != 0) {
+          break;
+        }
+      }
+      #elif _ARM_ARCH_7
+      for (; i <= endIndex - 4; i+=4) {
+        uint32x4_t maskVec = vcltq_f32(vld1q_f32((const float32_t *) (input + i)), vdupq_n_f32(threshold));
+        uint32x2_t maskPair = vorr_u32(vget_low_u32(maskVec), vget_high_u32(maskVec));
+        if ((vget_lane_u32(maskPair, 0) | vget_lane_u32(maskPair, 1)) != 0) {
+          break;
+        }
+      }
+      #endif
+      for (; i < endIndex; i++) {
+        if (input[i] < threshold) {
+          return i;
+        }
+      }
+      return endIndex;
+    }
+  
+    /** Returns the sum of the products of the elements of two arrays of the given length. */
+    static inline float dotProduct(float *input0, float *input1, int length) {
+      #if TARGET_OS_MAC || TARGET_OS_IPHONE
+      float result = 0.0f;
+      vDSP_dotpr(input0, 1, input1, 1, &result, length);
+      return result;
+      #elif __SSE__
+      // four partial sums are accumulated, one per lane
+      __m128 sumVec = _mm_setzero_ps();
+      const int numFours = length >> 2;
+      for (int i = 0, j = 0; j < numFours; i+=4, j++) {
+        sumVec = _mm_add_ps(sumVec, _mm_mul_ps(_mm_loadu_ps(input0 + i), _mm_loadu_ps(input1 + i)));
+      }
+      float sums[4];
+      _mm_storeu_ps(sums, sumVec);
+      float result = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+      for (int i = numFours<<2; i < length; i++) {
+        result += input0[i] * input1[i];
+      }
+      return result;
+      #elif _ARM_ARCH_7
+      float32x4_t sumVec = vdupq_n_f32(0.0f);
+      const int numFours = length >> 2;
+      for (int i = 0, j = 0; j < numFours; i+=4, j++) {
+        sumVec = vmlaq_f32(sumVec, vld1q_f32((const float32_t *) (input0 + i)),
+            vld1q_f32((const float32_t *) (input1 + i)));
+      }
+      float32x2_t sumPair = vadd_f32(vget_low_f32(sumVec), vget_high_f32(sumVec));
+      float result = vget_lane_f32(vpadd_f32(sumPair, sumPair), 0);
+      for (int i = numFours<<2; i < length; i++) {
+        result += input0[i] * input1[i];
+      }
+      return result;
+      #else
+      float result = 0.0f;
+      for (int i = 0; i < length; i++) {
+        result += input0[i] * input1[i];
+      }
+      return result;
+      #endif
+    }
+    
   private:
     ArrayArithmetic(); // no instances of this object are allowed
     ~ArrayArithmetic();
@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "BlockAdapter.h"
+#include "PdGraph.h"
+
+static int greatestCommonDivisor(int a, int b) {
+  while (b != 0) {
+    int c = a % b;
+    a = b;
+    b = c;
+  }
+  return a;
+}
+
+BlockAdapter::BlockAdapter(PdGraph *graph) {
+  this->graph = graph;
+  blockSize = graph->getBlockSize();
+  numInputChannels = graph->getNumInputChannels();
+  numOutputChannels = graph->getNumOutputChannels();
+  numInputFrames = 0;
+  outputRing = NULL;
+  capacity = 0;
+  readIndex = 0;
+  numOutputFrames = 0;
+  latency = 0;
+  hasStarted = false;
+}
+
+BlockAdapter::~BlockAdapter() {
+  free(outputRing);
+}
+
+int BlockAdapter::getLatency() {
+  return latency;
+}
+
+void BlockAdapter::ensureCapacity(int numFrames) {
+  if (numFrames <= capacity) {
+    return;
+  }
+  // the ring is unrolled into the new buffers, such that the next frame to be read is at index 0
+  float *newRing = (float *) calloc(numOutputChannels * numFrames, sizeof(float));
+  for (int k = 0; k < numOutputChannels; k++) {
+    float *channel = outputRing + (k * capacity);
+    float *newChannel = newRing + (k * numFrames);
+    for (int i = 0; i < numOutputFrames; i++) {
+      newChannel[i] = channel[(readIndex + i) % capacity];
+    }
+  }
+  free(outputRing);
+  outputRing = newRing;
+  capacity = numFrames;
+  readIndex = 0;
+}
+
+void BlockAdapter::pushOutputBlock() {
+  float *outputBuffers = graph->getGlobalDspBufferAtOutlet(0);
+  int writeIndex = (readIndex + numOutputFrames) % capacity;
+  int numHeadFrames = (capacity - writeIndex < blockSize) ? capacity - writeIndex : blockSize;
+  for (int k = 0; k < numOutputChannels; k++) {
+    float *channel = outputRing + (k * capacity);
+    memcpy(channel + writeIndex, outputBuffers + (k * blockSize), numHeadFrames * sizeof(float));
+    memcpy(channel, outputBuffers + (k * blockSize) + numHeadFrames,
+        (blockSize - numHeadFrames) * sizeof(float));
+  }
+  numOutputFrames += blockSize;
+}
+
+void BlockAdapter::process(float *inputBuffers, float *outputBuffers, int numFrames) {
+  if (!hasStarted) {
+    latency = blockSize - greatestCommonDivisor(numFrames, blockSize);
+    ensureCapacity(latency + numFrames + blockSize);
+    numOutputFrames = latency; // the ring is initially silent
+    hasStarted = true;
+  }
+  
+  // all blocks which are completed by the input of this call are processed before any output is
+  // taken, so the ring must be able to hold all of their output in addition to what it already has
+  int numNewBlocks = (numInputFrames + numFrames) / blockSize;
+  ensureCapacity(numOutputFrames + (numNewBlocks * blockSize));
+  
+  float *graphInputBuffers = graph->getGlobalDspBufferAtInlet(0);
+  for (int i = 0; i < numFrames;) {
+    int n = (blockSize - numInputFrames < numFrames - i) ? blockSize - numInputFrames : numFrames - i;
+    for (int k = 0; k < numInputChannels; k++) {
+      memcpy(graphInputBuffers + (k * blockSize) + numInputFrames, inputBuffers + (k * numFrames) + i,
+          n * sizeof(float));
+    }
+    numInputFrames += n;
+    i += n;
+    if (numInputFrames == blockSize) {
+      graph->process(NULL, NULL);
+      pushOutputBlock();
+      numInputFrames = 0;
+    }
+  }
+  
+  if (numOutputFrames < numFrames) {
+    // the host buffer size has changed such that there is not enough output. Silence is inserted
+    // in front of the remaining output, and the latency grows accordingly.
+    int numMissingFrames = numFrames - numOutputFrames;
+    ensureCapacity(numFrames);
+    readIndex = (readIndex - numMissingFrames + capacity) % capacity;
+    for (int k = 0; k < numOutputChannels; k++) {
+      float *channel = outputRing + (k * capacity);
+      for (int i = 0, j = readIndex; i < numMissingFrames; i++, j = (j + 1) % capacity) {
+        channel[j] = 0.0f;
+      }
+    }
+    numOutputFrames = numFrames;
+    latency += numMissingFrames;
+  }
+  
+  int numTailFrames = (capacity - readIndex < numFrames) ? capacity - readIndex : numFrames;
+  for (int k = 0; k < numOutputChannels; k++) {
+    float *channel = outputRing + (k * capacity);
+    memcpy(outputBuffers + (k * numFrames), channel + readIndex, numTailFrames * sizeof(float));
+    memcpy(outputBuffers + (k * numFrames) + numTailFrames, channel, (numFrames - numTailFrames) * sizeof(float));
+  }
+  readIndex = (readIndex + numFrames) % capacity;
+  numOutputFrames -= numFrames;
+}
@@ -0,0 +1,80 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _BLOCK_ADAPTER_H_
+#define _BLOCK_ADAPTER_H_
+
+class PdGraph;
+
+/**
+ * <code>BlockAdapter</code> lets a host process a graph with any number of frames per call,
+ * independently of the block size of the graph. Input frames are written straight into the input
+ * buffers of the graph, which are processed whenever they are full. Output blocks are collected in
+ * a ring buffer per channel, from which the host's frames are taken.
+ * <br>
+ * Output is delayed by a fixed number of frames. With a constant host buffer size of N frames and a
+ * block size of B, the smallest delay which never runs out of output is B - gcd(N, B), which is
+ * the delay chosen at the first call. E.g., it is zero if N is a multiple of B, and 63 for 441
+ * frames with B = 64. If a later call would run out of output, because the host buffer size has
+ * changed, the delay is increased by inserting silence.
+ */
+class BlockAdapter {
+  
+  public:
+    BlockAdapter(PdGraph *graph);
+    ~BlockAdapter();
+  
+    /**
+     * Processes the given number of frames. The buffers hold <code>numFrames</code> non-interleaved
+     * samples for each channel of the graph.
+     */
+    void process(float *inputBuffers, float *outputBuffers, int numFrames);
+  
+    /** Returns the number of frames by which the output is delayed, or 0 before the first call. */
+    int getLatency();
+  
+  private:
+    /** Ensures that the ring buffers can hold the given number of frames. */
+    void ensureCapacity(int numFrames);
+  
+    /** Moves one processed block from the output buffers of the graph into the ring buffers. */
+    void pushOutputBlock();
+  
+    PdGraph *graph;
+    int blockSize;
+    int numInputChannels;
+    int numOutputChannels;
+  
+    /** The number of frames of the next block which have been written into the graph's input buffers. */
+    int numInputFrames;
+  
+    /** One ring buffer of <code>capacity</code> frames per output channel, stored consecutively. */
+    float *outputRing;
+    int capacity;
+    int readIndex;
+    int numOutputFrames;
+  
+    int latency;
+    bool hasStarted;
+};
+
+#endif // _BLOCK_ADAPTER_H_
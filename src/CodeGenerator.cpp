@@ -0,0 +1,402 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "CodeGenerator.h"
+#include "CompiledDsp.h"
+#include "DspDelayWrite.h"
+#include "DspObject.h"
+#include "PdGraph.h"
+
+typedef struct {
+  DspObject *dspObject;
+  int index;
+  char *expression;
+} BufferMapEntry;
+
+CodeGenerator::CodeGenerator(PdGraph *graph, ZGSampleType sampleType) {
+  this->graph = graph;
+  this->sampleType = sampleType;
+  outputBufferMap = new List();
+  inputBufferMap = new List();
+  delaylineMap = new List();
+  tableNameList = new List();
+  stateList = new List();
+  numBuffers = 0;
+  numStates = 0;
+  memset(&declarations, 0, sizeof(CodeBuffer));
+  memset(&stateMembers, 0, sizeof(CodeBuffer));
+  memset(&tableCode, 0, sizeof(CodeBuffer));
+  memset(&initCode, 0, sizeof(CodeBuffer));
+  memset(&processCode, 0, sizeof(CodeBuffer));
+}
+
+CodeGenerator::~CodeGenerator() {
+  List *bufferMaps[3] = {outputBufferMap, inputBufferMap, delaylineMap};
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < bufferMaps[i]->size(); j++) {
+      BufferMapEntry *entry = (BufferMapEntry *) bufferMaps[i]->get(j);
+      free(entry->expression);
+      free(entry);
+    }
+    delete bufferMaps[i];
+  }
+  for (int i = 0; i < tableNameList->size(); i++) {
+    free(tableNameList->get(i));
+  }
+  delete tableNameList;
+  for (int i = 0; i < stateList->size(); i++) {
+    free(stateList->get(i));
+  }
+  delete stateList;
+  free(declarations.text);
+  free(stateMembers.text);
+  free(tableCode.text);
+  free(initCode.text);
+  free(processCode.text);
+}
+
+bool CodeGenerator::generate() {
+  return graph->generateCode(this);
+}
+
+bool CodeGenerator::generateObject(DspObject *dspObject) {
+  const char *label = dspObject->getObjectLabel();
+  bool isGraph = (strcmp(label, "pd") == 0);
+  if (!isGraph) {
+    // the compiled code only knows the parameters with which the objects were created
+    for (int i = 0; i < dspObject->getNumMessageInlets(); i++) {
+      if (dspObject->getIncomingMessageConnections(i)->size() > 0) {
+        graph->printErr("[%s] cannot be compiled because it receives messages.", label);
+        return false;
+      }
+    }
+  }
+  addCode("// [%s]", label);
+  if (!dspObject->generateCode(this)) {
+    if (!isGraph) {
+      graph->printErr((sampleType == ZG_SAMPLE_FLOAT) ? "[%s] cannot be compiled." :
+          "[%s] cannot be compiled with fixed-point samples.", label);
+    }
+    return false;
+  }
+  return true;
+}
+
+char *CodeGenerator::getInputBuffer(DspObject *dspObject, int inletIndex) {
+  char *expression = findBuffer(inputBufferMap, dspObject, inletIndex);
+  if (expression != NULL) {
+    return expression;
+  }
+  
+  List *connectionList = dspObject->getIncomingDspConnections(inletIndex);
+  switch (connectionList->size()) {
+    case 0: {
+      return putBuffer(inputBufferMap, dspObject, inletIndex, "zero");
+    }
+    case 1: {
+      ObjectLetPair *objectLetPair = (ObjectLetPair *) connectionList->get(0);
+      return putBuffer(inputBufferMap, dspObject, inletIndex,
+          getOutputBuffer((DspObject *) objectLetPair->object, objectLetPair->index));
+    }
+    default: {
+      // sum all incoming signals in the order in which DspObject::processDsp() does
+      CodeBuffer sum;
+      memset(&sum, 0, sizeof(CodeBuffer));
+      for (int i = 1; i < connectionList->size(); i++) {
+        append(&sum, "add(");
+      }
+      for (int i = 0; i < connectionList->size(); i++) {
+        ObjectLetPair *objectLetPair = (ObjectLetPair *) connectionList->get(i);
+        append(&sum, (i > 0) ? ", %s[i])" : "%s[i]",
+            getOutputBuffer((DspObject *) objectLetPair->object, objectLetPair->index));
+      }
+      expression = putBuffer(inputBufferMap, dspObject, inletIndex, newBuffer());
+      addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = %s;", expression, sum.text);
+      free(sum.text);
+      return expression;
+    }
+  }
+}
+
+char *CodeGenerator::getOutputBuffer(DspObject *dspObject, int outletIndex) {
+  char *expression = findBuffer(outputBufferMap, dspObject, outletIndex);
+  if (expression == NULL) {
+    expression = putBuffer(outputBufferMap, dspObject, outletIndex, newBuffer());
+  }
+  return expression;
+}
+
+void CodeGenerator::setOutputBuffer(DspObject *dspObject, int outletIndex, const char *expression) {
+  putBuffer(outputBufferMap, dspObject, outletIndex, expression);
+}
+
+char *CodeGenerator::findBuffer(List *bufferMap, DspObject *dspObject, int index) {
+  for (int i = 0; i < bufferMap->size(); i++) {
+    BufferMapEntry *entry = (BufferMapEntry *) bufferMap->get(i);
+    if (entry->dspObject == dspObject && entry->index == index) {
+      return entry->expression;
+    }
+  }
+  return NULL;
+}
+
+char *CodeGenerator::putBuffer(List *bufferMap, DspObject *dspObject, int index, const char *expression) {
+  BufferMapEntry *entry = (BufferMapEntry *) malloc(sizeof(BufferMapEntry));
+  entry->dspObject = dspObject;
+  entry->index = index;
+  entry->expression = StaticUtils::copyString((char *) expression);
+  bufferMap->add(entry);
+  return entry->expression;
+}
+
+char *CodeGenerator::newBuffer() {
+  static char expression[32];
+  append(&stateMembers, "  sample_t b%i[BLOCK_SIZE];\n", numBuffers);
+  snprintf(expression, sizeof(expression), "s->b%i", numBuffers++);
+  return expression;
+}
+
+char *CodeGenerator::newState(float initialValue) {
+  char expression[32];
+  append(&stateMembers, "  float f%i;\n", numStates);
+  snprintf(expression, sizeof(expression), "s->f%i", numStates++);
+  append(&initCode, "    %s = " CODE_FLOAT ";\n", expression, initialValue);
+  char *stateExpression = StaticUtils::copyString(expression);
+  stateList->add(stateExpression);
+  return stateExpression;
+}
+
+char *CodeGenerator::newSampleState(float initialValue) {
+  char expression[32];
+  append(&stateMembers, "  sample_t f%i;\n", numStates);
+  snprintf(expression, sizeof(expression), "s->f%i", numStates++);
+  append(&initCode, "    %s = " CODE_SAMPLE ";\n", expression, initialValue);
+  char *stateExpression = StaticUtils::copyString(expression);
+  stateList->add(stateExpression);
+  return stateExpression;
+}
+
+char *CodeGenerator::newPhaseState(float initialPhase) {
+  char expression[32];
+  append(&stateMembers, "  unsigned int f%i;\n", numStates);
+  snprintf(expression, sizeof(expression), "s->f%i", numStates++);
+  append(&initCode, "    %s = %uu;\n", expression, toPhase(initialPhase));
+  char *stateExpression = StaticUtils::copyString(expression);
+  stateList->add(stateExpression);
+  return stateExpression;
+}
+
+unsigned int CodeGenerator::toPhase(double numCycles) {
+  double phase = (numCycles - floor(numCycles)) * 4294967296.0;
+  return (phase < 4294967296.0) ? (unsigned int) phase : 0; // a tiny negative number rounds up
+}
+
+void CodeGenerator::getDelayline(DspDelayWrite *delayline, char **bufferExpression,
+    char **headExpression) {
+  *bufferExpression = findBuffer(delaylineMap, delayline, 0);
+  if (*bufferExpression == NULL) {
+    int headIndex = 0;
+    int bufferLength = 0;
+    delayline->getBuffer(&headIndex, &bufferLength);
+    char expression[32];
+    append(&stateMembers, "  sample_t f%i[%i];\n", numStates, bufferLength);
+    snprintf(expression, sizeof(expression), "s->f%i", numStates++);
+    *bufferExpression = putBuffer(delaylineMap, delayline, 0, expression);
+    append(&stateMembers, "  int f%i;\n", numStates);
+    snprintf(expression, sizeof(expression), "s->f%i", numStates++);
+    append(&initCode, "    %s = %i;\n", expression, headIndex);
+    putBuffer(delaylineMap, delayline, 1, expression);
+  }
+  *headExpression = findBuffer(delaylineMap, delayline, 1);
+}
+
+bool CodeGenerator::newTable(const char *name, int length, const char *initFormat, ...) {
+  for (int i = 0; i < tableNameList->size(); i++) {
+    if (strcmp((char *) tableNameList->get(i), name) == 0) {
+      return false;
+    }
+  }
+  tableNameList->add(StaticUtils::copyString((char *) name));
+  append(&declarations, "static sample_t %s[%i];\n", name, length);
+  append(&tableCode, "    ");
+  va_list ap;
+  va_start(ap, initFormat);
+  appendWithList(&tableCode, initFormat, ap);
+  va_end(ap);
+  append(&tableCode, "\n");
+  return true;
+}
+
+void CodeGenerator::addCode(const char *format, ...) {
+  append(&processCode, "    ");
+  va_list ap;
+  va_start(ap, format);
+  appendWithList(&processCode, format, ap);
+  va_end(ap);
+  append(&processCode, "\n");
+}
+
+int CodeGenerator::getBlockSize() {
+  return graph->getBlockSize();
+}
+
+float CodeGenerator::getSampleRate() {
+  return graph->getSampleRate();
+}
+
+ZGSampleType CodeGenerator::getSampleType() {
+  return sampleType;
+}
+
+void CodeGenerator::assembleSampleFunctions(CodeBuffer *codeBuffer) {
+  if (sampleType == ZG_SAMPLE_FLOAT) {
+    append(codeBuffer, "typedef float sample_t;\n\n");
+    append(codeBuffer, "static inline sample_t toSample(float f) { return f; }\n");
+    append(codeBuffer, "static inline sample_t add(sample_t a, sample_t b) { return a + b; }\n");
+    append(codeBuffer, "static inline sample_t subtract(sample_t a, sample_t b) { return a - b; }\n");
+    append(codeBuffer, "static inline sample_t multiply(sample_t a, sample_t b) { return a * b; }\n");
+    append(codeBuffer, "static inline sample_t divide(sample_t a, sample_t b) { return a / b; }\n");
+    append(codeBuffer, "static inline sample_t wrap(sample_t a) { return a - floorf(a); }\n\n");
+    return;
+  }
+  
+  // Q15 or Q31. All operations saturate at the limits of the format instead of wrapping around,
+  // such that an overflow is heard as clipping. Multiplication rounds to the nearest value, and
+  // division truncates towards zero. Division by zero saturates according to the sign of the
+  // dividend, and is zero for zero.
+  int numFractionalBits = (sampleType == ZG_SAMPLE_Q15) ? 15 : 31;
+  append(codeBuffer, "typedef %s sample_t;\n", (sampleType == ZG_SAMPLE_Q15) ? "short" : "int");
+  append(codeBuffer, "typedef long long wide_t;\n\n");
+  append(codeBuffer, "#define SAMPLE_BITS %i\n", numFractionalBits);
+  append(codeBuffer, "#define SAMPLE_MAX ((sample_t) ((1LL << SAMPLE_BITS) - 1))\n");
+  append(codeBuffer, "#define SAMPLE_MIN ((sample_t) (-SAMPLE_MAX - 1))\n");
+  append(codeBuffer, "#define SAMPLE_ONE %.1ff\n\n", (double) (1LL << numFractionalBits));
+  append(codeBuffer, "static inline sample_t saturate(wide_t a) {\n"
+      "  return (a > SAMPLE_MAX) ? SAMPLE_MAX : (a < SAMPLE_MIN) ? SAMPLE_MIN : (sample_t) a;\n}\n");
+  append(codeBuffer, "static inline sample_t toSample(float f) {\n"
+      "  float scaled = f * SAMPLE_ONE;\n"
+      "  if (scaled >= (float) SAMPLE_MAX) return SAMPLE_MAX;\n"
+      "  else if (scaled <= -SAMPLE_ONE) return SAMPLE_MIN;\n"
+      "  else if (scaled != scaled) return 0;\n"
+      "  else return (sample_t) lrintf(scaled);\n}\n");
+  append(codeBuffer, "static inline float toFloat(sample_t a) { return ((float) a) * (1.0f / SAMPLE_ONE); }\n");
+  append(codeBuffer, "static inline sample_t add(sample_t a, sample_t b) { return saturate((wide_t) a + b); }\n");
+  append(codeBuffer, "static inline sample_t subtract(sample_t a, sample_t b) { return saturate((wide_t) a - b); }\n");
+  append(codeBuffer, "static inline sample_t multiply(sample_t a, sample_t b) {\n"
+      "  return saturate(((wide_t) a * b + (1LL << (SAMPLE_BITS-1))) >> SAMPLE_BITS);\n}\n");
+  append(codeBuffer, "static inline sample_t divide(sample_t a, sample_t b) {\n"
+      "  if (b == 0) return (a > 0) ? SAMPLE_MAX : (a < 0) ? SAMPLE_MIN : 0;\n"
+      "  return saturate(((wide_t) a * (1LL << SAMPLE_BITS)) / b);\n}\n");
+  append(codeBuffer, "static inline sample_t wrap(sample_t a) { return a & SAMPLE_MAX; }\n\n");
+}
+
+void CodeGenerator::assemble(CodeBuffer *codeBuffer) {
+  bool isFixedPoint = (sampleType != ZG_SAMPLE_FLOAT);
+  int numInputSamples = graph->getNumInputChannels() * graph->getBlockSize();
+  int numOutputSamples = graph->getNumOutputChannels() * graph->getBlockSize();
+  append(codeBuffer, "/* Generated by zgcompile. Do not edit. */\n\n");
+  append(codeBuffer, "#include <math.h>\n#include <stdlib.h>\n\n");
+  append(codeBuffer, "#define BLOCK_SIZE %i\n\n", graph->getBlockSize());
+  assembleSampleFunctions(codeBuffer);
+  append(codeBuffer, "static sample_t zero[BLOCK_SIZE];\n%s\n", (declarations.text != NULL) ? declarations.text : "");
+  append(codeBuffer, "typedef struct {\n");
+  if (isFixedPoint) {
+    // the converted input and output of the graph
+    append(codeBuffer, "  sample_t input[%i];\n  sample_t output[%i];\n",
+        (numInputSamples > 0) ? numInputSamples : 1, (numOutputSamples > 0) ? numOutputSamples : 1);
+  }
+  append(codeBuffer, "%s} State;\n\n", (stateMembers.text != NULL) ? stateMembers.text : "");
+  append(codeBuffer, "static void initTables() {\n");
+  append(codeBuffer, "  static bool isInitialised = false;\n");
+  append(codeBuffer, "  if (!isInitialised) {\n%s", (tableCode.text != NULL) ? tableCode.text : "");
+  append(codeBuffer, "    isInitialised = true;\n  }\n}\n\n");
+  append(codeBuffer, "extern \"C\" {\n");
+  append(codeBuffer, "  void *%s() {\n", COMPILED_DSP_NEW);
+  append(codeBuffer, "    initTables();\n");
+  append(codeBuffer, "    State *s = (State *) calloc(1, sizeof(State));\n%s", (initCode.text != NULL) ? initCode.text : "");
+  append(codeBuffer, "    return s;\n  }\n\n");
+  append(codeBuffer, "  void %s(void *state) {\n    free(state);\n  }\n\n", COMPILED_DSP_DELETE);
+  append(codeBuffer, "  int %s() {\n    return %i;\n  }\n\n", COMPILED_DSP_GET_SAMPLE_TYPE, sampleType);
+  if (isFixedPoint) {
+    append(codeBuffer, "  void %s(void *state, float *inputBuffers, float *outputBuffers) {\n", COMPILED_DSP_PROCESS);
+    append(codeBuffer, "    State *s = (State *) state;\n");
+    append(codeBuffer, "    sample_t *input = s->input;\n");
+    append(codeBuffer, "    sample_t *output = s->output;\n");
+    append(codeBuffer, "    for (int i = 0; i < %i; i++) input[i] = toSample(inputBuffers[i]);\n", numInputSamples);
+    append(codeBuffer, "    for (int i = 0; i < %i; i++) output[i] = 0;\n", numOutputSamples);
+    append(codeBuffer, "%s", (processCode.text != NULL) ? processCode.text : "");
+    append(codeBuffer, "    for (int i = 0; i < %i; i++) outputBuffers[i] += toFloat(output[i]);\n  }\n", numOutputSamples);
+  } else {
+    append(codeBuffer, "  void %s(void *state, float *input, float *output) {\n", COMPILED_DSP_PROCESS);
+    append(codeBuffer, "    State *s = (State *) state;\n%s  }\n", (processCode.text != NULL) ? processCode.text : "");
+  }
+}
+
+unsigned int CodeGenerator::getSignature() {
+  CodeBuffer codeBuffer;
+  memset(&codeBuffer, 0, sizeof(CodeBuffer));
+  assemble(&codeBuffer);
+  // 32-bit FNV-1a
+  unsigned int hash = 2166136261u;
+  for (int i = 0; i < codeBuffer.length; i++) {
+    hash = (hash ^ (unsigned char) codeBuffer.text[i]) * 16777619u;
+  }
+  free(codeBuffer.text);
+  return hash;
+}
+
+bool CodeGenerator::writeToFile(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    graph->printErr("Could not open \"%s\" for writing.", path);
+    return false;
+  }
+  CodeBuffer codeBuffer;
+  memset(&codeBuffer, 0, sizeof(CodeBuffer));
+  assemble(&codeBuffer);
+  fputs(codeBuffer.text, file);
+  fprintf(file, "\n  unsigned int %s() {\n    return %uu;\n  }\n}\n", COMPILED_DSP_GET_SIGNATURE, getSignature());
+  free(codeBuffer.text);
+  return (fclose(file) == 0);
+}
+
+void CodeGenerator::append(CodeBuffer *codeBuffer, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  appendWithList(codeBuffer, format, ap);
+  va_end(ap);
+}
+
+void CodeGenerator::appendWithList(CodeBuffer *codeBuffer, const char *format, va_list ap) {
+  va_list apCopy;
+  va_copy(apCopy, ap);
+  int length = vsnprintf(NULL, 0, format, apCopy);
+  va_end(apCopy);
+  if (codeBuffer->length + length + 1 > codeBuffer->capacity) {
+    codeBuffer->capacity = 2 * (codeBuffer->length + length + 1);
+    codeBuffer->text = (char *) realloc(codeBuffer->text, codeBuffer->capacity);
+  }
+  vsnprintf(codeBuffer->text + codeBuffer->length, length + 1, format, ap);
+  codeBuffer->length += length;
+}
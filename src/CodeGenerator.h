@@ -0,0 +1,193 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _CODE_GENERATOR_H_
+#define _CODE_GENERATOR_H_
+
+#include <stdarg.h>
+#include "List.h"
+#include "ZGSampleType.h"
+
+class DspDelayWrite;
+class DspObject;
+class PdGraph;
+
+/** The format with which <code>DspObject</code>s write constants into the generated code. */
+#define CODE_FLOAT "((float) %.9g)"
+
+/** The format with which <code>DspObject</code>s write constant samples into the generated code. */
+#define CODE_SAMPLE "toSample(%.9g)"
+
+/** A growable string into which code is written. */
+typedef struct {
+  char *text;
+  int length;
+  int capacity;
+} CodeBuffer;
+
+/**
+ * The <code>CodeGenerator</code> translates the DSP part of a loaded graph into a single C++
+ * translation unit. The code of all objects is inlined in the order in which the graph would
+ * process them, and all of their parameters are written as constants, such that the compiler can
+ * fold them. The message part of the graph is not translated. A graph loaded with the resulting
+ * library (see <code>CompiledDsp</code>) still processes messages itself, but calls the compiled
+ * code instead of its <code>DspObject</code>s. Graphs are therefore only compiled if no messages
+ * arrive at any of their <code>DspObject</code>s.
+ *
+ * Each <code>DspObject</code> writes its own code in <code>generateCode()</code>, using the
+ * functions of this class to refer to its buffers and to declare its state.
+ * <br>
+ * All signals are of type <code>sample_t</code>, which is <code>float</code> or, for targets
+ * without a floating-point unit, a Q15 or Q31 fixed-point integer. The generated code computes
+ * with the functions <code>add()</code>, <code>subtract()</code>, <code>multiply()</code>,
+ * <code>divide()</code> and <code>wrap()</code> of this type, which saturate for fixed-point
+ * samples, and converts constants with <code>toSample()</code> (see <code>CODE_SAMPLE</code>). The
+ * code is self-contained, such that it can be built for any target. Objects which cannot be
+ * computed with fixed-point samples check <code>getSampleType()</code>.
+ */
+class CodeGenerator {
+  
+  public:
+    CodeGenerator(PdGraph *graph, ZGSampleType sampleType);
+    ~CodeGenerator();
+  
+    /**
+     * Generates the code of the graph. Returns <code>false</code>, having printed the reason to the
+     * graph's error output, if it contains any object which cannot be compiled.
+     */
+    bool generate();
+  
+    /** Writes the generated translation unit to the given path. Returns <code>false</code> on failure. */
+    bool writeToFile(const char *path);
+  
+    /**
+     * Returns a hash of the generated code. A compiled library is only loaded by a graph which
+     * generates exactly the same code, i.e., the same patch with the same parameters.
+     */
+    unsigned int getSignature();
+  
+    /** Generates the code of the given object, which must be part of the graph's process order. */
+    bool generateObject(DspObject *dspObject);
+  
+    /**
+     * Returns the expression of the buffer holding the signal at the given inlet of an object.
+     * Several incoming signals are summed into a new buffer. An inlet without any incoming signal
+     * refers to a buffer of zeros.
+     */
+    char *getInputBuffer(DspObject *dspObject, int inletIndex);
+  
+    /** Returns the expression of the buffer holding the signal at the given outlet of an object. */
+    char *getOutputBuffer(DspObject *dspObject, int outletIndex);
+  
+    /**
+     * Makes the given outlet of an object refer to an existing buffer, such as the global input
+     * buffers for [adc~], instead of a buffer of its own.
+     */
+    void setOutputBuffer(DspObject *dspObject, int outletIndex, const char *expression);
+  
+    /** Declares a new <code>float</code> state variable with the given initial value. Returns its expression. */
+    char *newState(float initialValue);
+  
+    /** Declares a new <code>sample_t</code> state variable with the given initial value. Returns its expression. */
+    char *newSampleState(float initialValue);
+  
+    /**
+     * Declares a new phase state variable, an <code>unsigned int</code> which holds the fraction
+     * of a cycle in [0, 1) in 32 bits, such that it wraps around by itself. Returns its expression.
+     */
+    char *newPhaseState(float initialPhase);
+  
+    /** Returns the fractional part of the given number of cycles as a phase (see <code>newPhaseState()</code>). */
+    static unsigned int toPhase(double numCycles);
+  
+    /**
+     * Returns the expressions of the <code>sample_t</code> buffer of the given delay line and of
+     * the <code>int</code> index at which its next block is written. They are declared when first
+     * requested, by the [delwrite~] or by any object reading from it, as the process order does not
+     * determine which comes first.
+     */
+    void getDelayline(DspDelayWrite *delayline, char **bufferExpression, char **headExpression);
+  
+    /**
+     * Declares a static <code>sample_t</code> lookup table of the given length which is shared by
+     * all objects. The given code fills it when the library is first used. Returns
+     * <code>false</code> if a table with the given name already exists, in which case nothing is
+     * done.
+     */
+    bool newTable(const char *name, int length, const char *initFormat, ...);
+  
+    /** Writes a line of code into the process function. */
+    void addCode(const char *format, ...);
+  
+    int getBlockSize();
+    float getSampleRate();
+    ZGSampleType getSampleType();
+  
+  private:
+    /** Returns the expression of the given object and outlet (or inlet) in the buffer map, or <code>NULL</code>. */
+    char *findBuffer(List *bufferMap, DspObject *dspObject, int index);
+  
+    /** Adds a copy of the given expression to the buffer map. Returns the copy. */
+    char *putBuffer(List *bufferMap, DspObject *dspObject, int index, const char *expression);
+  
+    /** Declares a new signal buffer of one block. Returns its expression. */
+    char *newBuffer();
+  
+    /** Writes the translation unit up to (but excluding) the signature into the given buffer. */
+    void assemble(CodeBuffer *codeBuffer);
+  
+    /** Writes the definition of <code>sample_t</code> and of its functions into the given buffer. */
+    void assembleSampleFunctions(CodeBuffer *codeBuffer);
+  
+    static void append(CodeBuffer *codeBuffer, const char *format, ...);
+    static void appendWithList(CodeBuffer *codeBuffer, const char *format, va_list ap);
+  
+    PdGraph *graph;
+  
+    ZGSampleType sampleType;
+  
+    /** Maps outlets of objects to the expressions of their buffers. */
+    List *outputBufferMap;
+  
+    /** Maps inlets of objects to the expressions of their (summed) buffers. */
+    List *inputBufferMap;
+  
+    /** Maps delay lines to the expressions of their buffers (index 0) and write indices (index 1). */
+    List *delaylineMap;
+  
+    /** The names of all declared tables. */
+    List *tableNameList;
+  
+    /** The expressions of all declared state variables. */
+    List *stateList;
+  
+    int numBuffers;
+    int numStates;
+  
+    CodeBuffer declarations; // tables
+    CodeBuffer stateMembers; // members of the state structure
+    CodeBuffer tableCode; // fills the tables
+    CodeBuffer initCode; // initialises the state
+    CodeBuffer processCode; // the body of the process function
+};
+
+#endif // _CODE_GENERATOR_H_
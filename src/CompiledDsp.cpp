@@ -0,0 +1,74 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <dlfcn.h>
+#include "CodeGenerator.h"
+#include "CompiledDsp.h"
+#include "PdGraph.h"
+
+CompiledDsp *CompiledDsp::newInstance(const char *libraryPath, PdGraph *graph) {
+  void *library = dlopen(libraryPath, RTLD_NOW | RTLD_LOCAL);
+  if (library == NULL) {
+    graph->printErr("Could not load the compiled graph \"%s\": %s", libraryPath, dlerror());
+    return NULL;
+  }
+  
+  void *(*newFunction)() = (void *(*)()) dlsym(library, COMPILED_DSP_NEW);
+  void (*deleteFunction)(void *) = (void (*)(void *)) dlsym(library, COMPILED_DSP_DELETE);
+  void (*processFunction)(void *, float *, float *) =
+      (void (*)(void *, float *, float *)) dlsym(library, COMPILED_DSP_PROCESS);
+  unsigned int (*getSignatureFunction)() = (unsigned int (*)()) dlsym(library, COMPILED_DSP_GET_SIGNATURE);
+  int (*getSampleTypeFunction)() = (int (*)()) dlsym(library, COMPILED_DSP_GET_SAMPLE_TYPE);
+  if (newFunction == NULL || deleteFunction == NULL || processFunction == NULL ||
+      getSignatureFunction == NULL || getSampleTypeFunction == NULL) {
+    graph->printErr("\"%s\" is not a compiled graph.", libraryPath);
+    dlclose(library);
+    return NULL;
+  }
+  
+  // the library must have been generated from exactly this graph, with the same parameters
+  CodeGenerator *codeGenerator = new CodeGenerator(graph, (ZGSampleType) getSampleTypeFunction());
+  bool isCompiledFromGraph = codeGenerator->generate() &&
+      (codeGenerator->getSignature() == getSignatureFunction());
+  delete codeGenerator;
+  if (!isCompiledFromGraph) {
+    graph->printErr("\"%s\" has not been compiled from this graph with the same block size, "
+        "sample rate and number of channels.", libraryPath);
+    dlclose(library);
+    return NULL;
+  }
+  
+  return new CompiledDsp(library, newFunction, deleteFunction, processFunction);
+}
+
+CompiledDsp::CompiledDsp(void *library, void *(*newFunction)(), void (*deleteFunction)(void *),
+    void (*processFunction)(void *, float *, float *)) {
+  this->library = library;
+  this->deleteFunction = deleteFunction;
+  this->processFunction = processFunction;
+  state = newFunction();
+}
+
+CompiledDsp::~CompiledDsp() {
+  deleteFunction(state);
+  dlclose(library);
+}
@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _COMPILED_DSP_H_
+#define _COMPILED_DSP_H_
+
+class PdGraph;
+
+/* The functions exported by a library generated by <code>CodeGenerator</code>. */
+#define COMPILED_DSP_NEW "zg_compiled_new"
+#define COMPILED_DSP_DELETE "zg_compiled_delete"
+#define COMPILED_DSP_PROCESS "zg_compiled_process"
+#define COMPILED_DSP_GET_SIGNATURE "zg_compiled_get_signature"
+#define COMPILED_DSP_GET_SAMPLE_TYPE "zg_compiled_get_sample_type"
+
+/**
+ * A <code>CompiledDsp</code> is the compiled code of the DSP part of a graph, loaded from a shared
+ * library which has been built from the output of <code>CodeGenerator</code>. It replaces the
+ * processing of all of the graph's <code>DspObject</code>s.
+ */
+class CompiledDsp {
+  
+  public:
+    /**
+     * Loads the library at the given path. Returns <code>NULL</code>, having printed the reason to
+     * the graph's error output, if it cannot be loaded or was not compiled from the given graph.
+     */
+    static CompiledDsp *newInstance(const char *libraryPath, PdGraph *graph);
+    ~CompiledDsp();
+  
+    /** Computes one block. The buffers hold one block of non-interleaved samples per channel. */
+    inline void process(float *inputBuffers, float *outputBuffers) {
+      processFunction(state, inputBuffers, outputBuffers);
+    }
+  
+  private:
+    CompiledDsp(void *library, void *(*newFunction)(), void (*deleteFunction)(void *),
+        void (*processFunction)(void *, float *, float *));
+  
+    /** The handle of the shared library. */
+    void *library;
+  
+    /** The state of this instance of the compiled code, i.e., all buffers and filter taps. */
+    void *state;
+  
+    void (*deleteFunction)(void *);
+    void (*processFunction)(void *, float *, float *);
+};
+
+#endif // _COMPILED_DSP_H_
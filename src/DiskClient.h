@@ -0,0 +1,53 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DISK_CLIENT_H_
+#define _DISK_CLIENT_H_
+
+/**
+ * A <code>DiskClient</code> is anything which performs its file operations on the disk thread of
+ * the <code>DiskStreamer</code>, such as a <code>SoundfileStream</code> or the
+ * <code>SampleLoader</code>.
+ */
+class DiskClient {
+  
+  public:
+    virtual ~DiskClient() {}
+  
+    /**
+     * Performs pending file operations. Returns <code>true</code> if any work was done. Each call
+     * should do a bounded amount of work, as all clients share the disk thread.
+     * May only be called by the disk thread.
+     */
+    virtual bool service() = 0;
+  
+    /** Completes or abandons all pending operations. Called when the client is retired. */
+    virtual void finish() = 0;
+  
+    /**
+     * If set, the client waits for the disk instead of dropping audio or returning late results.
+     * This is only appropriate when the graph is not run in real time.
+     */
+    virtual void setWaitsForDisk(bool waitsForDisk) = 0;
+};
+
+#endif // _DISK_CLIENT_H_
@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <unistd.h>
+#include "DiskClient.h"
+#include "DiskStreamer.h"
+#include "List.h"
+
+/** How long the disk thread sleeps when no client has any work, in microseconds. */
+#define DISK_STREAMER_IDLE_INTERVAL 2000
+
+DiskStreamer::DiskStreamer() {
+  clientList = new List();
+  pthread_mutex_init(&clientListMutex, NULL);
+  isRunning = true;
+  waitsForDisk = false;
+  pthread_create(&diskThread, NULL, &DiskStreamer::serviceLoop, this);
+}
+
+DiskStreamer::~DiskStreamer() {
+  isRunning = false;
+  pthread_join(diskThread, NULL);
+  pthread_mutex_destroy(&clientListMutex);
+  delete clientList;
+}
+
+void DiskStreamer::addClient(DiskClient *client) {
+  pthread_mutex_lock(&clientListMutex);
+  client->setWaitsForDisk(waitsForDisk);
+  clientList->add(client);
+  pthread_mutex_unlock(&clientListMutex);
+}
+
+void DiskStreamer::removeClient(DiskClient *client) {
+  pthread_mutex_lock(&clientListMutex);
+  int index = clientList->indexOf(client);
+  if (index >= 0) {
+    clientList->remove(index);
+  }
+  pthread_mutex_unlock(&clientListMutex);
+  client->finish();
+}
+
+void DiskStreamer::setWaitsForDisk(bool waitsForDisk) {
+  pthread_mutex_lock(&clientListMutex);
+  this->waitsForDisk = waitsForDisk;
+  for (int i = 0; i < clientList->size(); i++) {
+    ((DiskClient *) clientList->get(i))->setWaitsForDisk(waitsForDisk);
+  }
+  pthread_mutex_unlock(&clientListMutex);
+}
+
+void *DiskStreamer::serviceLoop(void *diskStreamer) {
+  DiskStreamer *streamer = (DiskStreamer *) diskStreamer;
+  while (streamer->isRunning) {
+    bool didWork = false;
+    pthread_mutex_lock(&streamer->clientListMutex);
+    for (int i = 0; i < streamer->clientList->size(); i++) {
+      DiskClient *client = (DiskClient *) streamer->clientList->get(i);
+      didWork |= client->service();
+    }
+    pthread_mutex_unlock(&streamer->clientListMutex);
+    if (!didWork) {
+      usleep(DISK_STREAMER_IDLE_INTERVAL);
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,68 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DISK_STREAMER_H_
+#define _DISK_STREAMER_H_
+
+#include <pthread.h>
+
+class DiskClient;
+class List;
+
+/**
+ * The <code>DiskStreamer</code> owns the disk thread which serves all <code>DiskClient</code>s
+ * of a graph. The thread repeatedly performs the pending file operations of every client, and
+ * sleeps briefly whenever there is nothing to do. It never waits on the audio thread, and the audio
+ * thread never waits on it.
+ */
+class DiskStreamer {
+  
+  public:
+    DiskStreamer();
+    ~DiskStreamer();
+  
+    /** Starts serving the given client. */
+    void addClient(DiskClient *client);
+  
+    /**
+     * Stops serving the given client. All of its pending operations are finished before this
+     * function returns. The client is not deleted.
+     */
+    void removeClient(DiskClient *client);
+  
+    /**
+     * Makes all clients wait for the disk instead of dropping audio. This is used when the graph
+     * is rendered offline, faster than real time.
+     */
+    void setWaitsForDisk(bool waitsForDisk);
+  
+  private:
+    static void *serviceLoop(void *diskStreamer);
+  
+    List *clientList;
+    pthread_mutex_t clientListMutex;
+    pthread_t diskThread;
+    volatile bool isRunning;
+    bool waitsForDisk;
+};
+
+#endif // _DISK_STREAMER_H_
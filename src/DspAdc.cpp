@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspAdc.h"
 #include "PdGraph.h"
 
@@ -51,3 +52,12 @@ const char *DspAdc::getObjectLabel() {
 void DspAdc::processDsp() {
   // nothing to do as output buffers point directly at global input buffers
 }
+
+bool DspAdc::generateCode(CodeGenerator *codeGenerator) {
+  for (int i = 0; i < numDspOutlets; i++) {
+    char expression[32];
+    snprintf(expression, sizeof(expression), "(input + %i)", i * blockSizeInt);
+    codeGenerator->setOutputBuffer(this, i, expression);
+  }
+  return true;
+}
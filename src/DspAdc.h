@@ -32,6 +32,8 @@ class DspAdc : public DspObject {
     ~DspAdc();
   
     const char *getObjectLabel();
+
+    bool generateCode(CodeGenerator *codeGenerator);
   
     // overrides <code>DspObject::processDsp()</code> and does nothing
     void processDsp();
@@ -21,11 +21,15 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "CodeGenerator.h"
 #include "DspAdd.h"
+#include "DspFusedChain.h"
 #include "PdGraph.h"
 
 DspAdd::DspAdd(PdMessage *initMessage, PdGraph *graph) : DspObject(2, 2, 0, 1, graph) {
   constant = initMessage->isFloat(0) ? initMessage->getFloat(0) : 0.0f;
+  
+  onInletConnectionUpdate();
 }
 
 DspAdd::~DspAdd() {
@@ -39,22 +43,42 @@ const char *DspAdd::getObjectLabel() {
 void DspAdd::processMessage(int inletIndex, PdMessage *message) {
   if (inletIndex == 1) {
     if (message->isFloat(0)) {
-      processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
       constant = message->getFloat(0);
     }
   }
 }
 
-void DspAdd::processDspToIndex(float blockIndex) {
+void DspAdd::onInletConnectionUpdate() {
   switch (signalPrecedence) {
     case DSP_DSP: {
-      ArrayArithmetic::add(localDspBufferAtInlet[0], localDspBufferAtInlet[1],
-          localDspBufferAtOutlet[0], 0, blockSizeInt);
+      processFunction = &processSignal<DSP_DSP>;
       break;
     }
     case DSP_MESSAGE: {
-      ArrayArithmetic::add(localDspBufferAtInlet[0], constant, localDspBufferAtOutlet[0],
-          getStartSampleIndex(), getEndSampleIndex(blockIndex));
+      processFunction = &processSignal<DSP_MESSAGE>;
+      break;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      processFunction = &processSignal<MESSAGE_MESSAGE>;
+      break;
+    }
+  }
+}
+
+template <DspMessagePresedence precedence>
+void DspAdd::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
+  DspAdd *dspAdd = (DspAdd *) dspObject;
+  switch (precedence) {
+    case DSP_DSP: {
+      ArrayArithmetic::add(dspAdd->localDspBufferAtInlet[0], dspAdd->localDspBufferAtInlet[1],
+          dspAdd->localDspBufferAtOutlet[0], fromIndex, toIndex);
+      break;
+    }
+    case DSP_MESSAGE: {
+      ArrayArithmetic::add(dspAdd->localDspBufferAtInlet[0], dspAdd->constant,
+          dspAdd->localDspBufferAtOutlet[0], fromIndex, toIndex);
       break;
     }
     case MESSAGE_DSP:
@@ -63,5 +87,50 @@ void DspAdd::processDspToIndex(float blockIndex) {
       break; // nothing to do
     }
   }
-  blockIndexOfLastMessage = blockIndex; // update the block index of the last message
+}
+
+bool DspAdd::generateCode(CodeGenerator *codeGenerator) {
+  switch (signalPrecedence) {
+    case DSP_DSP: {
+      codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = add(%s[i], %s[i]);",
+          codeGenerator->getOutputBuffer(this, 0), codeGenerator->getInputBuffer(this, 0),
+          codeGenerator->getInputBuffer(this, 1));
+      break;
+    }
+    case DSP_MESSAGE: {
+      codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = add(%s[i], " CODE_SAMPLE ");",
+          codeGenerator->getOutputBuffer(this, 0), codeGenerator->getInputBuffer(this, 0), constant);
+      break;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      break; // nothing to do
+    }
+  }
+  return true;
+}
+
+bool DspAdd::getElementwiseOperation(ElementwiseOperation *operation) {
+  operation->type = ELEMENTWISE_ADD;
+  operation->constant = constant;
+  switch (signalPrecedence) {
+    case DSP_DSP: {
+      operation->operandBuffer = getSingleInputBuffer(1);
+      return (operation->operandBuffer != NULL);
+    }
+    case DSP_MESSAGE: {
+      operation->operandBuffer = NULL;
+      return true;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      return false;
+    }
+  }
+}
+
+bool DspAdd::isElementwise() {
+  return true;
 }
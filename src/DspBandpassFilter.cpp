@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspBandpassFilter.h"
 #include "PdGraph.h"
 
@@ -79,14 +80,12 @@ void DspBandpassFilter::processMessage(int inletIndex, PdMessage *message) {
     }
     case 1: {
       if (message->isFloat(0)) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
         calculateFilterCoefficients(message->getFloat(0), q);
       }
       break;
     }
     case 2: {
       if (message->isFloat(0)) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
         calculateFilterCoefficients(centerFrequency, message->getFloat(0));
       }
       break;
@@ -97,15 +96,37 @@ void DspBandpassFilter::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspBandpassFilter::processDspToIndex(float newBlockIndex) {
+void DspBandpassFilter::processDspWithIndex(int fromIndex, int toIndex) {
   float *inputBuffer = localDspBufferAtInlet[0]; 
   float *outputBuffer = localDspBufferAtOutlet[0];
-  int endSampleIndex = getEndSampleIndex(newBlockIndex);
-  for (int i = getStartSampleIndex(); i < endSampleIndex; i++) {
+  for (int i = fromIndex; i < toIndex; i++) {
     outputBuffer[i] =  inputBuffer[i] + (coef1 * tap_0) + (coef2 * tap_1);
     tap_1 = tap_0;
     tap_0 = outputBuffer[i];
     outputBuffer[i] *= gain;
   }
-  blockIndexOfLastMessage = newBlockIndex;
+}
+
+bool DspBandpassFilter::generateCode(CodeGenerator *codeGenerator) {
+  if (codeGenerator->getSampleType() != ZG_SAMPLE_FLOAT) {
+    return false; // the feedback coefficient may be as large as two
+  }
+  char *tap0State = codeGenerator->newState(tap_0);
+  char *tap1State = codeGenerator->newState(tap_1);
+  char *inputBuffer = codeGenerator->getInputBuffer(this, 0);
+  char *outputBuffer = codeGenerator->getOutputBuffer(this, 0);
+  codeGenerator->addCode("{");
+  codeGenerator->addCode("  float tap0 = %s;", tap0State);
+  codeGenerator->addCode("  float tap1 = %s;", tap1State);
+  codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++) {");
+  codeGenerator->addCode("    float f = %s[i] + (" CODE_FLOAT " * tap0) + (" CODE_FLOAT " * tap1);",
+      inputBuffer, coef1, coef2);
+  codeGenerator->addCode("    tap1 = tap0;");
+  codeGenerator->addCode("    tap0 = f;");
+  codeGenerator->addCode("    %s[i] = f * " CODE_FLOAT ";", outputBuffer, gain);
+  codeGenerator->addCode("  }");
+  codeGenerator->addCode("  %s = tap0;", tap0State);
+  codeGenerator->addCode("  %s = tap1;", tap1State);
+  codeGenerator->addCode("}");
+  return true;
 }
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DSP_BANG_H_
+#define _DSP_BANG_H_
+
+#include "DspObject.h"
+
+/**
+ * [bang~]
+ * <br>
+ * Outputs a bang after every block which its graph computes. The bang is timestamped at the end
+ * of the block, i.e. at the start of the next one. It follows any messages which have already been
+ * scheduled for that time.
+ */
+class DspBang : public DspObject {
+  
+  public:
+    DspBang(PdGraph *graph);
+    ~DspBang();
+  
+    const char *getObjectLabel();
+  
+    ConnectionType getConnectionType(int outletIndex);
+  
+    void processDsp();
+};
+
+#endif // _DSP_BANG_H_
@@ -70,6 +70,11 @@ void DspCatch::processDsp() {
   int numConnections = throwList->size();
   switch (numConnections) {
     case 0: {
+      if (localDspBufferAtOutlet[0] != originalOutputBuffer) {
+        // the last throw~ has been removed, and its buffer may no longer exist
+        localDspBufferAtOutlet[0] = originalOutputBuffer;
+        memset(originalOutputBuffer, 0, numBytesInBlock);
+      }
       break;
     }
     case 1: {
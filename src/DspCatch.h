@@ -40,6 +40,9 @@ class DspCatch : public DspObject {
     void addThrow(DspThrow *dspThrow);
     void removeThrow(DspThrow *dspThrow);
   
+    /** Returns the address of the list of associated throw~ objects, which an edit of the running graph replaces. */
+    inline List **getThrowListSlot() { return &throwList; }
+  
     char *getName();
     const char *getObjectLabel();
     void processDsp();
@@ -20,7 +20,9 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspClip.h"
+#include "DspFusedChain.h"
 #include "PdGraph.h"
 
 DspClip::DspClip(PdMessage *initMessage, PdGraph *graph) : DspObject(3, 1, 0, 1, graph) {
@@ -40,14 +42,12 @@ void DspClip::processMessage(int inletIndex, PdMessage *message) {
   switch (inletIndex) {
     case 1: {
       if (message->isFloat(0)) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
         lowerBound = message->getFloat(0); // set the lower bound
       }
       break;
     }
     case 2: {
       if (message->isFloat(0)) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
         upperBound = message->getFloat(0); // set the upper bound
       }
       break;
@@ -58,11 +58,10 @@ void DspClip::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspClip::processDspToIndex(float newBlockIndex) {
+void DspClip::processDspWithIndex(int fromIndex, int toIndex) {
   float *inputBuffer = localDspBufferAtInlet[0];
   float *outputBuffer = localDspBufferAtOutlet[0];
-  int endSampleIndex = getEndSampleIndex(newBlockIndex);
-  for (int i = getStartSampleIndex(); i < endSampleIndex; i++) {
+  for (int i = fromIndex; i < toIndex; i++) {
     if (inputBuffer[i] <= lowerBound) {
       outputBuffer[i] = lowerBound;
     } else if (inputBuffer[i] >= upperBound) {
@@ -71,5 +70,29 @@ void DspClip::processDspToIndex(float newBlockIndex) {
       outputBuffer[i] = inputBuffer[i];
     }
   }
-  blockIndexOfLastMessage = newBlockIndex;
+}
+
+bool DspClip::generateCode(CodeGenerator *codeGenerator) {
+  char *inputBuffer = codeGenerator->getInputBuffer(this, 0);
+  char *outputBuffer = codeGenerator->getOutputBuffer(this, 0);
+  codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) {");
+  codeGenerator->addCode("  if (%s[i] <= " CODE_SAMPLE ") %s[i] = " CODE_SAMPLE ";",
+      inputBuffer, lowerBound, outputBuffer, lowerBound);
+  codeGenerator->addCode("  else if (%s[i] >= " CODE_SAMPLE ") %s[i] = " CODE_SAMPLE ";",
+      inputBuffer, upperBound, outputBuffer, upperBound);
+  codeGenerator->addCode("  else %s[i] = %s[i];", outputBuffer, inputBuffer);
+  codeGenerator->addCode("}");
+  return true;
+}
+
+bool DspClip::getElementwiseOperation(ElementwiseOperation *operation) {
+  operation->type = ELEMENTWISE_CLIP;
+  operation->operandBuffer = NULL;
+  operation->constant = lowerBound;
+  operation->upperBound = upperBound;
+  return true;
+}
+
+bool DspClip::isElementwise() {
+  return true;
 }
@@ -33,10 +33,14 @@ class DspClip : public DspObject {
     ~DspClip();
   
     const char *getObjectLabel();
+
+    bool generateCode(CodeGenerator *codeGenerator);
+    bool getElementwiseOperation(ElementwiseOperation *operation);
+    bool isElementwise();
     
   private:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float newBlockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
   
     float lowerBound;
     float upperBound;
@@ -0,0 +1,290 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArrayArithmetic.h"
+#include "DspClone.h"
+#include "PdGraph.h"
+
+/**
+ * The number of inlets and outlets of an instance, which are as many as those of any graph.
+ * Messages from the outlets of instance i arrive at inlets (i+1) * CLONE_MAX_LETS and above.
+ */
+#define CLONE_MAX_LETS PdGraph::MAX_NUM_LETS
+
+/** An instance is considered to be silent while the magnitude of its output is below this level (-100dB). */
+#define CLONE_SILENCE_THRESHOLD 0.00001f
+
+/** The default time in milliseconds after which silent instances are put to sleep. */
+#define DEFAULT_CLONE_SLEEP_TIME 100.0f
+
+DspClone::DspClone(PdMessage *initMessage, PdGraph *graph) :
+    DspObject(CLONE_MAX_LETS, CLONE_MAX_LETS, CLONE_MAX_LETS, CLONE_MAX_LETS, graph) {
+  instances = NULL;
+  numInstances = 0;
+  startNumber = 0;
+  currentInstance = 0;
+  numSilentSamples = NULL;
+  sleepSamples = (int) StaticUtils::millisecondsToSamples(DEFAULT_CLONE_SLEEP_TIME, graph->getSampleRate());
+  
+  int argIndex = 0;
+  if (initMessage->isSymbol(0) && strcmp(initMessage->getSymbol(0), "-s") == 0 &&
+      initMessage->isFloat(1)) {
+    startNumber = (int) initMessage->getFloat(1);
+    argIndex = 2;
+  }
+  if (!initMessage->isSymbol(argIndex) || !initMessage->isFloat(argIndex+1) ||
+      initMessage->getFloat(argIndex+1) < 1.0f) {
+    graph->printErr("clone must be initialised in the format [clone abstraction numInstances].\n");
+    return;
+  }
+  
+  // the abstraction is parsed once, and all instances are created from the parsed file. As with
+  // other abstractions, first look in the local directory and then in the declared directories.
+  char *filename = StaticUtils::joinPaths(initMessage->getSymbol(argIndex), ".pd");
+  char *directory = StaticUtils::copyString(graph->getDirectory());
+  List *declareList = graph->getDeclareList();
+  for (int i = -1; i < declareList->size(); i++) {
+    if (i >= 0) {
+      free(directory);
+      directory = StaticUtils::joinPaths(graph->getDirectory(), (char *) declareList->get(i));
+    }
+    char *filePath = StaticUtils::joinPaths(directory, filename);
+    PdFileParser *fileParser = new PdFileParser(filePath);
+    free(filePath);
+    bool didCreateInstances = createInstances(fileParser, directory, initMessage, argIndex);
+    delete fileParser;
+    if (didCreateInstances) {
+      break;
+    }
+  }
+  if (numInstances == 0) {
+    graph->printErr("clone: abstraction \"%s\" could not be found.\n", filename);
+  }
+  free(directory);
+  free(filename);
+}
+
+DspClone::~DspClone() {
+  for (int i = 0; i < numInstances; i++) {
+    delete instances[i];
+  }
+  free(instances);
+  free(numSilentSamples);
+}
+
+bool DspClone::createInstances(PdFileParser *fileParser, char *directory, PdMessage *initMessage,
+    int argIndex) {
+  int numRequestedInstances = (int) initMessage->getFloat(argIndex+1);
+  PdMessage *arguments = new PdMessage();
+  arguments->addElement(new MessageElement(0.0f)); // $1 is the instance number
+  for (int i = argIndex + 2; i < initMessage->getNumElements(); i++) {
+    arguments->addElement(initMessage->getElement(i)->copy());
+  }
+  
+  for (int i = 0; i < numRequestedInstances; i++) {
+    arguments->setFloat(0, (float) (startNumber + i));
+    PdGraph *instance = PdGraph::newInstance(fileParser, directory, graph->getBlockSize(),
+        graph->getNumInputChannels(), graph->getNumOutputChannels(), graph->getSampleRate(), graph,
+        arguments);
+    if (instance == NULL) {
+      break; // the file does not exist or is not a patch
+    }
+    if (instance->getNumInlets() > CLONE_MAX_LETS || instance->getNumOutlets() > CLONE_MAX_LETS) {
+      graph->printErr("clone: an abstraction may have at most %i inlets and %i outlets.\n",
+          CLONE_MAX_LETS, CLONE_MAX_LETS);
+      delete instance;
+      break;
+    }
+    if (numInstances == 0) {
+      instances = (PdGraph **) malloc(numRequestedInstances * sizeof(PdGraph *));
+    }
+    instances[numInstances++] = instance;
+    
+    // messages from the outlets of the instance are received by this object
+    for (int j = 0; j < instance->getNumOutlets(); j++) {
+      if (instance->getConnectionType(j) == MESSAGE) {
+        instance->addConnectionToObjectFromOutlet(this, (i + 1) * CLONE_MAX_LETS + j, j);
+      }
+    }
+  }
+  delete arguments;
+  
+  if (numInstances > 0) {
+    numSilentSamples = (int *) calloc(numInstances, sizeof(int));
+  }
+  return (numInstances > 0);
+}
+
+const char *DspClone::getObjectLabel() {
+  return "clone";
+}
+
+ConnectionType DspClone::getConnectionType(int outletIndex) {
+  return (outletIndex < getNumOutlets()) ? instances[0]->getConnectionType(outletIndex) : MESSAGE;
+}
+
+int DspClone::getNumInlets() {
+  return (numInstances > 0) ? instances[0]->getNumInlets() : 0;
+}
+
+int DspClone::getNumOutlets() {
+  return (numInstances > 0) ? instances[0]->getNumOutlets() : 0;
+}
+
+bool DspClone::doesProcessAudio() {
+  return (numInstances > 0) && instances[0]->doesProcessAudio();
+}
+
+void DspClone::receiveMessage(int inletIndex, PdMessage *message) {
+  if (inletIndex < CLONE_MAX_LETS) {
+    processMessage(inletIndex, message);
+  } else {
+    sendFromInstance(inletIndex / CLONE_MAX_LETS - 1, inletIndex % CLONE_MAX_LETS, message);
+  }
+}
+
+void DspClone::processMessage(int inletIndex, PdMessage *message) {
+  if (numInstances == 0) {
+    return;
+  }
+  if (message->isFloat(0)) {
+    int instanceIndex = (int) message->getFloat(0) - startNumber;
+    if (instanceIndex >= 0 && instanceIndex < numInstances) {
+      currentInstance = instanceIndex;
+      sendToInstance(instanceIndex, inletIndex, message, 1);
+    }
+  } else if (message->isSymbol(0)) {
+    char *selector = message->getSymbol(0);
+    if (strcmp(selector, "all") == 0) {
+      for (int i = 0; i < numInstances; i++) {
+        sendToInstance(i, inletIndex, message, 1);
+      }
+    } else if (strcmp(selector, "next") == 0) {
+      currentInstance = (currentInstance + 1) % numInstances;
+      sendToInstance(currentInstance, inletIndex, message, 1);
+    } else if (strcmp(selector, "this") == 0) {
+      sendToInstance(currentInstance, inletIndex, message, 1);
+    } else if (strcmp(selector, "set") == 0 && message->isFloat(1)) {
+      int instanceIndex = (int) message->getFloat(1) - startNumber;
+      if (instanceIndex >= 0 && instanceIndex < numInstances) {
+        currentInstance = instanceIndex;
+      }
+    } else if (strcmp(selector, "sleep") == 0 && message->isFloat(1) && inletIndex == 0) {
+      float sleepTime = message->getFloat(1);
+      sleepSamples = (sleepTime > 0.0f)
+          ? (int) StaticUtils::millisecondsToSamples(sleepTime, graph->getSampleRate()) : 0;
+      if (sleepSamples == 0) {
+        for (int i = 0; i < numInstances; i++) {
+          wakeInstance(i);
+        }
+      }
+    } else {
+      graph->printErr("clone: unknown message \"%s\".\n", selector);
+    }
+  }
+}
+
+void DspClone::sendToInstance(int instanceIndex, int inletIndex, PdMessage *message, int startIndex) {
+  PdGraph *instance = instances[instanceIndex];
+  if (inletIndex < instance->getNumInlets()) {
+    wakeInstance(instanceIndex);
+    PdMessage *routedMessage = getNextOutgoingMessage(inletIndex);
+    routedMessage->clearAndCopyFrom(message, startIndex);
+    if (routedMessage->getNumElements() == 0) {
+      routedMessage->addElement(new MessageElement());
+      routedMessage->getElement(0)->setBang();
+    }
+    // the message is reserved so that it is not reused while the instance processes it
+    routedMessage->reserve(this);
+    instance->receiveMessage(inletIndex, routedMessage);
+    routedMessage->unreserve(this);
+  }
+}
+
+void DspClone::sendFromInstance(int instanceIndex, int outletIndex, PdMessage *message) {
+  PdMessage *outgoingMessage = getNextOutgoingMessage(outletIndex);
+  outgoingMessage->clear();
+  outgoingMessage->addElement(new MessageElement((float) (startNumber + instanceIndex)));
+  for (int i = 0; i < message->getNumElements(); i++) {
+    outgoingMessage->addElement(message->getElement(i)->copy());
+  }
+  outgoingMessage->setTimestamp(message->getTimestamp());
+  sendMessage(outletIndex, outgoingMessage);
+}
+
+void DspClone::wakeInstance(int instanceIndex) {
+  instances[instanceIndex]->setSleeping(false);
+  numSilentSamples[instanceIndex] = 0;
+}
+
+void DspClone::processDspToIndex(float blockIndex) {
+  int numOutlets = getNumOutlets();
+  for (int j = 0; j < numOutlets; j++) {
+    if (getConnectionType(j) == DSP) {
+      memset(localDspBufferAtOutlet[j], 0, numBytesInBlock);
+    }
+  }
+  
+  int numInlets = getNumInlets();
+  for (int i = 0; i < numInstances; i++) {
+    PdGraph *instance = instances[i];
+    if (instance->isSleeping()) {
+      continue; // sleeping instances are skipped entirely
+    } else if (sleepSamples > 0 && numSilentSamples[i] >= sleepSamples) {
+      numSilentSamples[i] = 0; // the instance has been woken by a message to one of its objects
+    }
+    for (int k = 0; k < numInlets; k++) {
+      instance->setDspBufferAtInlet(k, localDspBufferAtInlet[k]);
+    }
+    instance->processDsp();
+    
+    // sum the signal outlets, and find the peak magnitude of the instance's output
+    bool hasDspOutlet = false;
+    float peak = 0.0f;
+    for (int j = 0; j < numOutlets; j++) {
+      if (getConnectionType(j) == DSP) {
+        hasDspOutlet = true;
+        float *instanceBuffer = instance->getDspBufferAtOutlet(j);
+        ArrayArithmetic::add(localDspBufferAtOutlet[j], instanceBuffer, localDspBufferAtOutlet[j],
+            0, blockSizeInt);
+        for (int n = 0; n < blockSizeInt; n++) {
+          float magnitude = fabsf(instanceBuffer[n]);
+          if (magnitude > peak) {
+            peak = magnitude;
+          }
+        }
+      }
+    }
+    
+    // instances without signal outlets cannot be known to be silent, and never sleep
+    if (hasDspOutlet && sleepSamples > 0) {
+      if (peak < CLONE_SILENCE_THRESHOLD) {
+        numSilentSamples[i] += blockSizeInt;
+        if (numSilentSamples[i] >= sleepSamples) {
+          instance->setSleeping(true);
+        }
+      } else {
+        numSilentSamples[i] = 0;
+      }
+    }
+  }
+}
@@ -0,0 +1,107 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DSP_CLONE_H_
+#define _DSP_CLONE_H_
+
+#include "DspObject.h"
+#include "PdFileParser.h"
+
+/**
+ * [clone abstraction numInstances args...], [clone -s startNumber abstraction numInstances args...]
+ * Creates a number of instances of an abstraction from a single parse of its file. Each instance
+ * receives its number as $1 (counting from <code>startNumber</code>, which is 0 by default), followed
+ * by the remaining arguments.
+ *
+ * A message at any inlet is routed to the instances by its first element: a number selects that
+ * instance, "all" selects all instances, "next" the instance after the most recently selected one,
+ * and "this" the most recently selected one, which may also be changed with "set number". The
+ * remainder of the message is sent to the corresponding inlet of the selected instances. Thus
+ * [poly] may feed [clone] via [pack]. Signal inlets are shared by all instances and signal outlets
+ * are summed. Messages sent from an outlet of an instance are prefixed with its number.
+ *
+ * An instance whose signal outlets have been silent for some time is put to sleep, and its audio is
+ * not computed at all. Its objects still receive messages. An instance wakes as soon as a message is
+ * routed to it, or arrives at one of its audio objects in any other way, e.g. via [receive]. The
+ * time after which instances sleep is set in milliseconds with "sleep time" at the left inlet.
+ * "sleep 0" disables sleeping.
+ */
+class DspClone : public DspObject {
+  
+  public:
+    DspClone(PdMessage *initMessage, PdGraph *graph);
+    ~DspClone();
+  
+    const char *getObjectLabel();
+  
+    ConnectionType getConnectionType(int outletIndex);
+  
+    /** Returns the number of inlets and outlets of the abstraction. */
+    int getNumInlets();
+    int getNumOutlets();
+  
+    bool doesProcessAudio();
+  
+    /**
+     * Messages are routed immediately, as with <code>PdGraph</code>s. Messages from the outlets of
+     * the instances also arrive here, at inlet indices which encode the instance and outlet.
+     */
+    void receiveMessage(int inletIndex, PdMessage *message);
+  
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+  
+    /* The instances are processed as a whole block, as are graphs. */
+    void processDspToIndex(float blockIndex);
+  
+    /** Creates all instances from the given parsed abstraction. Returns <code>false</code> on failure. */
+    bool createInstances(PdFileParser *fileParser, char *directory, PdMessage *initMessage, int argIndex);
+  
+    /**
+     * Sends the elements of the message from <code>startIndex</code> to the given inlet of an
+     * instance, waking it if necessary.
+     */
+    void sendToInstance(int instanceIndex, int inletIndex, PdMessage *message, int startIndex);
+  
+    /** Sends a message from an outlet of an instance, prefixed with the number of the instance. */
+    void sendFromInstance(int instanceIndex, int outletIndex, PdMessage *message);
+  
+    /** Resumes the audio processing of the given instance. */
+    void wakeInstance(int instanceIndex);
+  
+    PdGraph **instances;
+    int numInstances;
+  
+    /** The number of the first instance, by which it is addressed and which is its $1. */
+    int startNumber;
+  
+    /** The most recently selected instance, used by "next" and "this". */
+    int currentInstance;
+  
+    /** The number of samples for which the signal outlets of each instance have been silent. */
+    int *numSilentSamples;
+  
+    /** The number of silent samples after which an instance is put to sleep. 0 disables sleeping. */
+    int sleepSamples;
+};
+
+#endif // _DSP_CLONE_H_
@@ -21,6 +21,7 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "CodeGenerator.h"
 #include "DspCosine.h"
 #include "PdGraph.h"
 
@@ -52,20 +53,44 @@ const char *DspCosine::getObjectLabel() {
   return "cos~";
 }
 
-void DspCosine::processDspToIndex(float blockIndex) {
+void DspCosine::processDspWithIndex(int fromIndex, int toIndex) {
   float *inputBuffer = localDspBufferAtInlet[0];
   float *outputBuffer = localDspBufferAtOutlet[0];
   #if TARGET_OS_MAC || TARGET_OS_IPHONE
-  vDSP_vabs(inputBuffer, 1, inputBuffer, 1, blockSizeInt); // abs(x)
-  vDSP_vfrac(inputBuffer, 1, inputBuffer, 1, blockSizeInt); // get the fractional part of x
-  vDSP_vsmul(inputBuffer, 1, &sampleRate, inputBuffer, 1, blockSizeInt); // * sampleRate
-  vDSP_vindex(cos_table, inputBuffer, 1, outputBuffer, 1, blockSizeInt); // perform a table lookup
+  int duration = toIndex - fromIndex;
+  vDSP_vabs(inputBuffer+fromIndex, 1, outputBuffer+fromIndex, 1, duration); // abs(x)
+  vDSP_vfrac(outputBuffer+fromIndex, 1, outputBuffer+fromIndex, 1, duration); // get the fractional part of x
+  vDSP_vsmul(outputBuffer+fromIndex, 1, &sampleRate, outputBuffer+fromIndex, 1, duration); // * sampleRate
+  vDSP_vindex(cos_table, outputBuffer+fromIndex, 1, outputBuffer+fromIndex, 1, duration); // perform a table lookup
   #else
-  for (int i = 0; i < blockSizeInt; i++) {
+  for (int i = fromIndex; i < toIndex; i++) {
     float f = fabsf(inputBuffer[i]);
     f -= floorf(f);
     outputBuffer[i] = cos_table[(int) (f * sampleRate)];
   }
   #endif
-  blockIndexOfLastMessage = blockIndex;
+}
+
+bool DspCosine::generateCode(CodeGenerator *codeGenerator) {
+  // as processDspWithIndex() without the Accelerate framework
+  int sampleRateInt = (int) sampleRate;
+  codeGenerator->newTable("cos_table", sampleRateInt + 1,
+      "for (int i = 0; i < %i; i++) cos_table[i] = toSample(cosf(2.0f * M_PI * ((float) i) / " CODE_FLOAT ")); "
+      "cos_table[%i] = cos_table[0];", sampleRateInt, sampleRate, sampleRateInt);
+  char *inputBuffer = codeGenerator->getInputBuffer(this, 0);
+  char *outputBuffer = codeGenerator->getOutputBuffer(this, 0);
+  if (codeGenerator->getSampleType() != ZG_SAMPLE_FLOAT) {
+    // the cosine is even, so the wrapped phase gives the same result as its absolute value
+    codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) {");
+    codeGenerator->addCode("  %s[i] = cos_table[((wide_t) wrap(%s[i]) * %i) >> SAMPLE_BITS];",
+        outputBuffer, inputBuffer, sampleRateInt);
+    codeGenerator->addCode("}");
+    return true;
+  }
+  codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) {");
+  codeGenerator->addCode("  float f = fabsf(%s[i]);", inputBuffer);
+  codeGenerator->addCode("  f -= floorf(f);");
+  codeGenerator->addCode("  %s[i] = cos_table[(int) (f * " CODE_FLOAT ")];", outputBuffer, sampleRate);
+  codeGenerator->addCode("}");
+  return true;
 }
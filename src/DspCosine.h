@@ -34,8 +34,10 @@ class DspCosine : public DspObject {
 
     const char *getObjectLabel();
 
+    bool generateCode(CodeGenerator *codeGenerator);
+
   protected:
-    void processDspToIndex(float blockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
 
   private:
     float sampleRate;
@@ -21,6 +21,7 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "CodeGenerator.h"
 #include "DspDac.h"
 #include "PdGraph.h"
 
@@ -28,6 +29,7 @@ DspDac::DspDac(PdGraph *graph) : DspObject(0, graph->getNumOutputChannels(), 0,
   for (int i = 0; i < numDspInlets; i++) {
     // reuse/repurpose localDspBufferAtInlet to store pointers to the global output buffers
     free(localDspBufferAtInlet[i]);
+    localDspBufferAtInletReserved[i] = NULL;
     localDspBufferAtInlet[i] = graph->getGlobalDspBufferAtOutlet(i);
   }
 }
@@ -56,3 +58,16 @@ void DspDac::processDsp() {
     }
   }
 }
+
+bool DspDac::generateCode(CodeGenerator *codeGenerator) {
+  for (int i = 0; i < numDspInlets; i++) {
+    List *incomingDspConnectionsList = incomingDspConnectionsListAtInlet[i];
+    for (int j = 0; j < incomingDspConnectionsList->size(); j++) {
+      ObjectLetPair *objectLetPair = (ObjectLetPair *) incomingDspConnectionsList->get(j);
+      codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) output[%i + i] = add(output[%i + i], %s[i]);",
+          i * blockSizeInt, i * blockSizeInt,
+          codeGenerator->getOutputBuffer((DspObject *) objectLetPair->object, objectLetPair->index));
+    }
+  }
+  return true;
+}
@@ -32,6 +32,8 @@ class DspDac : public DspObject {
     ~DspDac();
   
     const char *getObjectLabel();
+
+    bool generateCode(CodeGenerator *codeGenerator);
   
     // override DspObject::processDsp in order to optimise performance
     void processDsp();
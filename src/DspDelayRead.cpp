@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspDelayRead.h"
 #include "DspDelayWrite.h"
 #include "PdGraph.h"
@@ -61,50 +62,67 @@ const char *DspDelayRead::getObjectLabel() {
 void DspDelayRead::processMessage(int inletIndex, PdMessage *message) {
   if (message->getElement(0)->getType() == FLOAT) {
     // update the delay time
-    processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
     delayInSamples = StaticUtils::millisecondsToSamples(message->getElement(0)->getFloat(), graph->getSampleRate());
     delayInSamplesInt = (int) delayInSamples;
   }
 }
 
-void DspDelayRead::processDspToIndex(float newBlockIndex) {
+void DspDelayRead::processDspWithIndex(int fromIndex, int toIndex) {
+  if (delayline == NULL) {
+    // there is no delwrite~ with the given name (anymore). Output silence.
+    localDspBufferAtOutlet[0] = originalOutputBuffer;
+    memset(originalOutputBuffer + fromIndex, 0, (toIndex - fromIndex) * sizeof(float));
+    return;
+  }
   int headIndex;
   int bufferLength;
   float *buffer = delayline->getBuffer(&headIndex, &bufferLength);
-  if (blockIndexOfLastMessage == 0.0f && newBlockIndex == blockSizeFloat) {
+  int delayIndex = headIndex - blockSizeInt - delayInSamplesInt + fromIndex;
+  if (delayIndex < 0) {
+    delayIndex += bufferLength;
+  }
+  if (fromIndex == 0 && toIndex == blockSizeInt && delayIndex <= bufferLength - blockSizeInt) {
     // this handles the most common case. Messages are rarely sent to delread~.
-    int delayIndex = headIndex - blockSizeInt - delayInSamplesInt;
-    if (delayIndex < 0) {
-      delayIndex += bufferLength;
-    }
-    if (delayIndex > bufferLength - blockSizeInt) {
-      int samplesInBuffer = bufferLength - delayIndex; // samples remaining in the buffer that belong in this block
-      memcpy(originalOutputBuffer, buffer + delayIndex, samplesInBuffer * sizeof(float));
-      memcpy(originalOutputBuffer + samplesInBuffer, buffer, (blockSizeInt - samplesInBuffer) * sizeof(float));
-      localDspBufferAtOutlet[0] = originalOutputBuffer;
-    } else {
-      localDspBufferAtOutlet[0] = buffer + delayIndex;
-    }
+    localDspBufferAtOutlet[0] = buffer + delayIndex;
   } else {
-    //float delayIndex = (float) headIndex - delayInSamples - ((float) graph->getBlockSize() - blockIndexOfLastMessage);
-    int delayIndex = (headIndex-blockSizeInt) - (int) (delayInSamples+blockIndexOfLastMessage);
-    if (delayIndex < 0) {
-      delayIndex += bufferLength;
-    }
-    /*
-     * TODO(mhroth): finish this logic
-    if (delayIndex > bufferLength - blockSizeInt) {
-      int samplesInBuffer = bufferLength - delayIndex;
-      memcpy(originalOutputBuffer, buffer + delayIndex, samplesInBuffer * sizeof(float));
-      memcpy(originalOutputBuffer + samplesInBuffer, buffer, (blockSizeInt - samplesInBuffer) * sizeof(float));
-      localDspBufferAtOutlet[0] = originalOutputBuffer;
+    // the block is composed of fragments of delwrite~'s buffer, possibly wrapping around its end
+    localDspBufferAtOutlet[0] = originalOutputBuffer;
+    int numSamples = toIndex - fromIndex;
+    int samplesInBuffer = bufferLength - delayIndex; // samples remaining before the buffer wraps
+    if (samplesInBuffer >= numSamples) {
+      memcpy(originalOutputBuffer + fromIndex, buffer + delayIndex, numSamples * sizeof(float));
     } else {
-      memcpy(originalOutputBuffer + getStartSampleIndex(), 
-             buffer + delayIndex, 
-             (int) (newBlockIndex - blockIndexOfLastMessage) * sizeof(float));
+      memcpy(originalOutputBuffer + fromIndex, buffer + delayIndex, samplesInBuffer * sizeof(float));
+      memcpy(originalOutputBuffer + fromIndex + samplesInBuffer, buffer,
+          (numSamples - samplesInBuffer) * sizeof(float));
     }
-    */
-    localDspBufferAtOutlet[0] = originalOutputBuffer;
   }
-  blockIndexOfLastMessage = newBlockIndex;
+}
+
+bool DspDelayRead::generateCode(CodeGenerator *codeGenerator) {
+  char *outputBuffer = codeGenerator->getOutputBuffer(this, 0);
+  if (delayline == NULL) {
+    codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = 0;", outputBuffer);
+    return true;
+  }
+  // as processDspWithIndex() for a whole block, reading the delay line's head as it is when this
+  // object is processed
+  int headIndex = 0;
+  int bufferLength = 0;
+  delayline->getBuffer(&headIndex, &bufferLength);
+  if (delayInSamplesInt < 0 || delayInSamplesInt > bufferLength - blockSizeInt) {
+    return false; // the block would be read from outside of the delay line
+  }
+  char *bufferExpression = NULL;
+  char *headExpression = NULL;
+  codeGenerator->getDelayline(delayline, &bufferExpression, &headExpression);
+  codeGenerator->addCode("{");
+  codeGenerator->addCode("  int index = %s - BLOCK_SIZE - %i;", headExpression, delayInSamplesInt);
+  codeGenerator->addCode("  if (index < 0) index += %i;", bufferLength);
+  codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++, index++) {");
+  codeGenerator->addCode("    if (index == %i) index = 0;", bufferLength);
+  codeGenerator->addCode("    %s[i] = %s[index];", outputBuffer, bufferExpression);
+  codeGenerator->addCode("  }");
+  codeGenerator->addCode("}");
+  return true;
 }
@@ -39,9 +39,11 @@ class DspDelayRead : public DelayReceiver {
   
     const char *getObjectLabel();
   
+    bool generateCode(CodeGenerator *codeGenerator);
+  
   private:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float newBlockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
   
     float delayInSamples;
     int delayInSamplesInt;
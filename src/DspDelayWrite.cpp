@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspDelayWrite.h"
 #include "PdGraph.h"
 
@@ -77,3 +78,21 @@ void DspDelayWrite::processDspToIndex(float newBlockIndex) {
     headIndex = 0;
   }
 }
+
+bool DspDelayWrite::generateCode(CodeGenerator *codeGenerator) {
+  if (buffer == NULL) {
+    return false;
+  }
+  // as processDspToIndex(). buffer[bufferLength] is only read by vd~, which is not compiled.
+  char *bufferExpression = NULL;
+  char *headExpression = NULL;
+  codeGenerator->getDelayline(this, &bufferExpression, &headExpression);
+  codeGenerator->addCode("{");
+  codeGenerator->addCode("  int head = %s;", headExpression);
+  codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++) %s[head+i] = %s[i];",
+      bufferExpression, codeGenerator->getInputBuffer(this, 0));
+  codeGenerator->addCode("  head += BLOCK_SIZE;");
+  codeGenerator->addCode("  %s = (head >= %i) ? 0 : head;", headExpression, bufferLength);
+  codeGenerator->addCode("}");
+  return true;
+}
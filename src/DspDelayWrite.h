@@ -37,6 +37,8 @@ class DspDelayWrite : public DspObject {
   
     float *getBuffer(int *headIndex, int *bufferLength);
   
+    bool generateCode(CodeGenerator *codeGenerator);
+  
   private:
     void processDspToIndex(float newBlockIndex);
   
@@ -25,45 +25,25 @@
 #include "PdGraph.h"
 
 DspEnvelope::DspEnvelope(PdMessage *initMessage, PdGraph *graph) : DspObject(0, 1, 1, 0, graph) {
-  if (initMessage->getNumElements() == 1 && initMessage->getElement(0)->getType() == FLOAT) {
-    // if one parameter is provided, set the window size
-    windowSize = (int) initMessage->getElement(0)->getFloat();
-    setWindowInterval(windowSize/2);
-  } else if (initMessage->getNumElements() == 2 && 
-             initMessage->getElement(0)->getType() == FLOAT &&
-             initMessage->getElement(1)->getType() == FLOAT) {
-    // if two parameters are provided, set the window size and window interval
-    windowSize = initMessage->getElement(0)->getFloat();
-    windowInterval = initMessage->getElement(1)->getFloat();
-  } else {
-    // otherwise, use default values for the window size and interval
+  windowSize = initMessage->isFloat(0) ? (int) initMessage->getFloat(0) : DEFAULT_WINDOW_SIZE;
+  if (windowSize < 1) {
+    graph->printErr("env~ window size must be positive. %i reset to %i.\n",
+                    windowSize, DEFAULT_WINDOW_SIZE);
     windowSize = DEFAULT_WINDOW_SIZE;
-    windowInterval = windowSize / 2;
   }
-  
-  // NOTE(mhroth): I haven't thought very much if this fix could be better done. The issue is that
-  // if the blocksize is large (e.g., larger than the windowInterval), then env~ will never send
-  // a message. With more logic, a block size larger than the window size could be accomodated. But
-  // I am too lazy to consider this option at the moment. Thus, currently the window size and interval
-  // must be at least as large as the block size.
-  if (windowSize < graph->getBlockSize()) {
-    graph->printErr("env~ window size must be at least as large as the block size. %i reset to %i.\n",
-                    windowSize, graph->getBlockSize());
-    windowSize = graph->getBlockSize();
-  }
-  if (windowInterval < graph->getBlockSize()) {
-    graph->printErr("env~ window interval must be at least as large as the block size. %i reset to %i.\n",
-                    windowInterval, graph->getBlockSize());
-    windowInterval = graph->getBlockSize();
+  windowInterval = initMessage->isFloat(1) ? (int) initMessage->getFloat(1) : windowSize/2;
+  if (windowInterval < 1) {
+    windowInterval = (windowSize > 1) ? windowSize/2 : 1;
   }
   
   initBuffers();
 }
 
 DspEnvelope::~DspEnvelope() {
-  free(signalBuffer);
+  free(windowSums);
+  free(windowPositions);
   free(hanningCoefficients);
-  free(rmsBuffer);
+  free(squareBuffer);
 }
 
 const char *DspEnvelope::getObjectLabel() {
@@ -74,34 +54,30 @@ ConnectionType DspEnvelope::getConnectionType(int outletIndex) {
   return MESSAGE;
 }
 
-void DspEnvelope::setWindowInterval(int newInterval) {
-  int i = newInterval % graph->getBlockSize();
-  if (i == 0) {
-    // windowInterval is a multiple of blockSize. Awesome :)
-    this->windowInterval = newInterval;
-  } else if (i <= graph->getBlockSize()/2) {
-    // windowInterval is closer to the smaller multiple of blockSize
-    this->windowInterval = (newInterval/graph->getBlockSize())*graph->getBlockSize();
-  } else {
-    // windowInterval is closer to the larger multiple of blockSize
-    this->windowInterval = ((newInterval/graph->getBlockSize())+1)*graph->getBlockSize();
-  }
-}
-
 void DspEnvelope::initBuffers() {
-  // ensure that the buffer is big enough to take the number of whole blocks needed to fill it
-  numSamplesReceived = 0;
-  numSamplesReceivedSinceLastInterval = 0;
-  int numBlocksPerWindow = (windowSize % graph->getBlockSize() == 0) ? (windowSize/graph->getBlockSize()) : (windowSize/graph->getBlockSize()) + 1;
-  int bufferSize = numBlocksPerWindow * graph->getBlockSize();
-  signalBuffer = (float *) malloc(bufferSize * sizeof(float));
-  hanningCoefficients = (float *) malloc(bufferSize * sizeof(float));
-  rmsBuffer = (float *) malloc(bufferSize * sizeof(float));
+  // at most this many windows overlap the boundary between two blocks
+  maxWindows = (windowSize / windowInterval) + 1;
+  windowSums = (float *) calloc(maxWindows, sizeof(float));
+  windowPositions = (int *) calloc(maxWindows, sizeof(int));
+  squareBuffer = (float *) malloc(blockSizeInt * sizeof(float));
+  
+  // the windows which would have started before the object was created are already open, such
+  // that the first envelope is sent after windowInterval samples (or fewer)
+  numWindows = 0;
+  oldestWindowIndex = 0;
+  for (int position = ((windowSize-1) / windowInterval) * windowInterval; position > 0;
+       position -= windowInterval) {
+    windowPositions[numWindows++] = position;
+  }
+  numSamplesToNextWindow = 0;
+  
+  hanningCoefficients = (float *) malloc(windowSize * sizeof(float));
   float N_1 = (float) (windowSize - 1); // (N == windowSize) - 1
   float hanningSum = 0.0f;
   for (int i = 0; i < windowSize; i++) {
-    // calcualte the hanning window coefficients
-    hanningCoefficients[i] = 0.5f * (1.0f - cosf((2.0f * M_PI * (float) i) / N_1));
+    // calcualte the hanning window coefficients. A window of one sample is not weighted.
+    hanningCoefficients[i] = (windowSize == 1) ? 1.0f :
+        0.5f * (1.0f - cosf((2.0f * M_PI * (float) i) / N_1));
     hanningSum += hanningCoefficients[i];
   }
   for (int i = 0; i < windowSize; i++) {
@@ -110,37 +86,52 @@ void DspEnvelope::initBuffers() {
   }
 }
 
-// windowSize and windowInterval are constrained to be multiples of the block size
-void DspEnvelope::processDspToIndex(float newBlockIndex) {
-  // copy the input into the signal buffer
-  memcpy(signalBuffer + numSamplesReceived, localDspBufferAtInlet[0], numBytesInBlock);
-  numSamplesReceived += blockSizeInt;
-  numSamplesReceivedSinceLastInterval += blockSizeInt;
-  if (numSamplesReceived >= windowSize) {
-    numSamplesReceived = 0;
+void DspEnvelope::processDspWithIndex(int fromIndex, int toIndex) {
+  ArrayArithmetic::multiply(localDspBufferAtInlet[0], localDspBufferAtInlet[0], squareBuffer,
+      fromIndex, toIndex);
+  
+  // continue the open windows, oldest first, and send those which are complete
+  int numSamples = toIndex - fromIndex;
+  for (int i = 0; i < numWindows; i++) {
+    int j = (oldestWindowIndex + i) % maxWindows;
+    int position = windowPositions[j];
+    int length = (numSamples < windowSize - position) ? numSamples : windowSize - position;
+    windowSums[j] += ArrayArithmetic::dotProduct(squareBuffer + fromIndex,
+        hanningCoefficients + position, length);
+    windowPositions[j] = position + length;
+  }
+  while (numWindows > 0 && windowPositions[oldestWindowIndex] == windowSize) {
+    sendEnvelope(windowSums[oldestWindowIndex]);
+    oldestWindowIndex = (oldestWindowIndex + 1) % maxWindows;
+    numWindows--;
   }
-  if (numSamplesReceivedSinceLastInterval == windowInterval) {
-    numSamplesReceivedSinceLastInterval -= windowInterval;
-    // apply hanning window to signal and calculate Root Mean Square
-    float rms = 0.0f;
-    #if TARGET_OS_MAC || TARGET_OS_IPHONE
-    vDSP_vsq(signalBuffer, 1, rmsBuffer, 1, windowSize); // signalBuffer^2 
-    vDSP_vmul(rmsBuffer, 1, hanningCoefficients, 1, rmsBuffer, 1, windowSize); // * hanning window
-    vDSP_sve(rmsBuffer, 1, &rms, windowSize); // sum the result
-    #else
-    for (int i = 0; i < windowSize; i++) {
-      rms += signalBuffer[i] * signalBuffer[i] * hanningCoefficients[i];
+  
+  // open the windows which start in this block. Those shorter than the rest of it are complete.
+  int startIndex = fromIndex + numSamplesToNextWindow;
+  for (; startIndex < toIndex; startIndex += windowInterval) {
+    int length = (toIndex - startIndex < windowSize) ? toIndex - startIndex : windowSize;
+    float sum = ArrayArithmetic::dotProduct(squareBuffer + startIndex, hanningCoefficients, length);
+    if (length == windowSize) {
+      sendEnvelope(sum);
+    } else {
+      int j = (oldestWindowIndex + numWindows) % maxWindows;
+      windowSums[j] = sum;
+      windowPositions[j] = length;
+      numWindows++;
     }
-    #endif
-    // finish RMS calculation. sqrt is removed as it can be combined with the log operation.
-    // result is normalised such that 1 RMS == 100 dB
-    rms = 10.0f * log10f(rms) + 100.0f;
-
-    PdMessage *outgoingMessage = getNextOutgoingMessage(0);
-    // graph will schedule this at the beginning of the next block because the timestamp will be
-    // behind the block start timestamp
-    outgoingMessage->setTimestamp(0.0);
-    outgoingMessage->setFloat(0, (rms < 0.0f) ? 0.0f : rms);
-    graph->scheduleMessage(this, 0, outgoingMessage);
   }
+  numSamplesToNextWindow = startIndex - toIndex;
+}
+
+void DspEnvelope::sendEnvelope(float power) {
+  // sqrt is removed as it can be combined with the log operation.
+  // result is normalised such that 1 RMS == 100 dB
+  float rms = 10.0f * log10f(power) + 100.0f;
+  
+  PdMessage *outgoingMessage = getNextOutgoingMessage(0);
+  // graph will schedule this at the beginning of the next block because the timestamp will be
+  // behind the block start timestamp
+  outgoingMessage->setTimestamp(0);
+  outgoingMessage->setFloat(0, (rms < 0.0f) ? 0.0f : rms);
+  graph->scheduleMessage(this, 0, outgoingMessage);
 }
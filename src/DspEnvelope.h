@@ -25,15 +25,22 @@
 
 #include "DspObject.h"
 
-/** [env~], [env~ float], [env~ float float] */
+/**
+ * [env~], [env~ float], [env~ float float]
+ * <br>
+ * Every <code>windowInterval</code> samples, outputs the Hann-weighted power of the last
+ * <code>windowSize</code> samples in dB, where an RMS of 1 is 100 dB. Both may be of any size
+ * relative to the block. Every window which overlaps the current block accumulates its weighted
+ * sum of squares as the block arrives, such that no signal history is kept and each sample is
+ * visited once per overlapping window. Signal before the object was created counts as silence.
+ */
 class DspEnvelope : public DspObject {
   
   public:
     /*
      * @param windowSize  The window size in samples of the analysis. Defaults to 1024.
      * @param windowInterval  The window interval in samples of the analysis.
-     * The interval must be a multiple of the block size. If not, then it is reset to
-     * the nearest multiple. Defaults to windowSize/2, according to the mentioned constraints.
+     * Defaults to windowSize/2.
      */
     DspEnvelope(PdMessage *initMessage, PdGraph *graph);
     ~DspEnvelope();
@@ -43,11 +50,13 @@ class DspEnvelope : public DspObject {
     ConnectionType getConnectionType(int outletIndex);
     
   private:
-    void processDspToIndex(float newBlockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
   
     /** Initialise the analysis buffers. */
     void initBuffers();
-    void setWindowInterval(int newInterval);
+  
+    /** Sends the envelope of a window with the given weighted sum of squares. */
+    void sendEnvelope(float power);
   
     /** By default, the analysis window size is 1024 samples. */
     const static int DEFAULT_WINDOW_SIZE = 1024;
@@ -55,12 +64,18 @@ class DspEnvelope : public DspObject {
     int windowSize;
     int windowInterval;
   
-    int numSamplesReceived;
-    int numSamplesReceivedSinceLastInterval;
+    /** The number of samples from the end of the last block to the start of the next window. */
+    int numSamplesToNextWindow;
+  
+    /** The open windows form a ring, in order of age. */
+    int maxWindows;
+    int numWindows;
+    int oldestWindowIndex;
+    float *windowSums;
+    int *windowPositions; // the number of samples accumulated by each window
   
-    float *signalBuffer;
     float *hanningCoefficients;
-    float *rmsBuffer; // a working buffer for computing the RMS
+    float *squareBuffer; // the squared input of the current block
 };
 
 #endif // _DSP_ENVELOPE_H_
@@ -0,0 +1,236 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <math.h>
+#include "DspFusedChain.h"
+#include "PdGraph.h"
+
+DspFusedChain::DspFusedChain(List *objectList, PdGraph *graph) : DspObject(0, 0, 0, 0, graph) {
+  numObjects = objectList->size();
+  objects = (DspObject **) malloc(numObjects * sizeof(DspObject *));
+  for (int i = 0; i < numObjects; i++) {
+    objects[i] = (DspObject *) objectList->get(i);
+  }
+  operations = (ElementwiseOperation *) malloc(numObjects * sizeof(ElementwiseOperation));
+}
+
+DspFusedChain::~DspFusedChain() {
+  free(objects);
+  free(operations);
+}
+
+const char *DspFusedChain::getObjectLabel() {
+  return "fused~";
+}
+
+bool DspFusedChain::canFuse(DspObject *fromObject, DspObject *toObject, PdGraph *graph) {
+  if (!hasElementwiseInlets(fromObject, graph) || !hasElementwiseInlets(toObject, graph) ||
+      graph->getPlannedList(fromObject->getIncomingConnectionsSlot(DSP, 0))->size() != 1 ||
+      graph->getPlannedList(toObject->getIncomingConnectionsSlot(DSP, 0))->size() != 1) {
+    return false;
+  }
+  List *outgoingDspConnectionsList = graph->getPlannedList(fromObject->getOutgoingConnectionsSlot(DSP, 0));
+  if (outgoingDspConnectionsList->size() != 1) {
+    return false; // the output of fromObject is needed elsewhere
+  }
+  ObjectLetPair *objectLetPair = (ObjectLetPair *) outgoingDspConnectionsList->get(0);
+  return (objectLetPair->object == toObject && objectLetPair->index == 0);
+}
+
+bool DspFusedChain::hasElementwiseInlets(DspObject *dspObject, PdGraph *graph) {
+  if (!dspObject->isElementwise() || dspObject->getNumDspInlets() == 0) {
+    return false;
+  }
+  // a signal operand must be a single buffer, which is not summed
+  for (int i = 1; i < dspObject->getNumDspInlets(); i++) {
+    if (graph->getPlannedList(dspObject->getIncomingConnectionsSlot(DSP, i))->size() > 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DspFusedChain::contains(DspObject *dspObject) {
+  for (int i = 0; i < numObjects; i++) {
+    if (objects[i] == dspObject) {
+      return true;
+    }
+  }
+  return false;
+}
+
+DspObject *DspFusedChain::getLastObject() {
+  return objects[numObjects-1];
+}
+
+int DspFusedChain::getNumObjects() {
+  return numObjects;
+}
+
+DspObject *DspFusedChain::getObject(int index) {
+  return objects[index];
+}
+
+bool DspFusedChain::isChainOf(List *objectList) {
+  if (objectList->size() != numObjects) {
+    return false;
+  }
+  for (int i = 0; i < numObjects; i++) {
+    if (objectList->get(i) != objects[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DspFusedChain::processObjects() {
+  for (int i = 0; i < numObjects; i++) {
+    objects[i]->processDsp();
+  }
+}
+
+void DspFusedChain::processDsp() {
+  for (int i = 0; i < numObjects; i++) {
+    if (objects[i]->hasPendingMessages()) {
+      // a message splits the block. Process the objects on their own.
+      processObjects();
+      return;
+    }
+    // the parameters may have changed with the messages of previous blocks
+    if (!objects[i]->getElementwiseOperation(operations + i)) {
+      processObjects();
+      return;
+    }
+  }
+  
+  float *inputBuffer = objects[0]->getSingleInputBuffer(0);
+  float *outputBuffer = objects[numObjects-1]->getDspBufferAtOutlet(0);
+  int i = 0;
+  #if __SSE__
+  // each chunk of samples stays in registers while all operations are applied to it
+  const int numChunks = blockSizeInt / CHUNK_SIZE;
+  for (int j = 0; j < numChunks; i+=CHUNK_SIZE, j++) {
+    __m128 vecs[CHUNK_SIZE/4];
+    for (int k = 0; k < CHUNK_SIZE/4; k++) {
+      vecs[k] = _mm_loadu_ps(inputBuffer + i + 4*k);
+    }
+    for (int k = 0; k < numObjects; k++) {
+      applyOperation(operations + k, vecs, i);
+    }
+    for (int k = 0; k < CHUNK_SIZE/4; k++) {
+      _mm_storeu_ps(outputBuffer + i + 4*k, vecs[k]);
+    }
+  }
+  #endif
+  for (; i < blockSizeInt; i++) {
+    float f = inputBuffer[i];
+    for (int k = 0; k < numObjects; k++) {
+      f = applyOperation(operations + k, f, i);
+    }
+    outputBuffer[i] = f;
+  }
+}
+
+float DspFusedChain::applyOperation(ElementwiseOperation *operation, float f, int index) {
+  float operand = (operation->operandBuffer != NULL)
+      ? operation->operandBuffer[index] : operation->constant;
+  switch (operation->type) {
+    case ELEMENTWISE_ADD: return f + operand;
+    case ELEMENTWISE_SUBTRACT: return f - operand;
+    case ELEMENTWISE_MULTIPLY: return f * operand;
+    case ELEMENTWISE_DIVIDE: return f / operand;
+    case ELEMENTWISE_CLIP: {
+      if (f <= operation->constant) {
+        return operation->constant;
+      } else if (f >= operation->upperBound) {
+        return operation->upperBound;
+      } else {
+        return f;
+      }
+    }
+    case ELEMENTWISE_WRAP: return f - floorf(f);
+    default: return f;
+  }
+}
+
+#if __SSE__
+void DspFusedChain::applyOperation(ElementwiseOperation *operation, __m128 *vecs, int index) {
+  const int numVecs = CHUNK_SIZE/4;
+  float *operandBuffer = operation->operandBuffer;
+  __m128 constVec = _mm_set1_ps(operation->constant);
+  switch (operation->type) {
+    case ELEMENTWISE_ADD: {
+      for (int i = 0; i < numVecs; i++) {
+        vecs[i] = _mm_add_ps(vecs[i],
+            (operandBuffer != NULL) ? _mm_loadu_ps(operandBuffer + index + 4*i) : constVec);
+      }
+      break;
+    }
+    case ELEMENTWISE_SUBTRACT: {
+      for (int i = 0; i < numVecs; i++) {
+        vecs[i] = _mm_sub_ps(vecs[i],
+            (operandBuffer != NULL) ? _mm_loadu_ps(operandBuffer + index + 4*i) : constVec);
+      }
+      break;
+    }
+    case ELEMENTWISE_MULTIPLY: {
+      for (int i = 0; i < numVecs; i++) {
+        vecs[i] = _mm_mul_ps(vecs[i],
+            (operandBuffer != NULL) ? _mm_loadu_ps(operandBuffer + index + 4*i) : constVec);
+      }
+      break;
+    }
+    case ELEMENTWISE_DIVIDE: {
+      for (int i = 0; i < numVecs; i++) {
+        vecs[i] = _mm_div_ps(vecs[i],
+            (operandBuffer != NULL) ? _mm_loadu_ps(operandBuffer + index + 4*i) : constVec);
+      }
+      break;
+    }
+    case ELEMENTWISE_CLIP: {
+      // select as DspClip does, such that NaNs and inverted bounds give the same results
+      __m128 upperVec = _mm_set1_ps(operation->upperBound);
+      for (int i = 0; i < numVecs; i++) {
+        __m128 upperMask = _mm_cmpge_ps(vecs[i], upperVec);
+        __m128 lowerMask = _mm_cmple_ps(vecs[i], constVec);
+        __m128 res = _mm_or_ps(_mm_andnot_ps(upperMask, vecs[i]), _mm_and_ps(upperMask, upperVec));
+        vecs[i] = _mm_or_ps(_mm_andnot_ps(lowerMask, res), _mm_and_ps(lowerMask, constVec));
+      }
+      break;
+    }
+    case ELEMENTWISE_WRAP: {
+      // SSE has no floor instruction
+      float samples[CHUNK_SIZE];
+      for (int i = 0; i < numVecs; i++) {
+        _mm_storeu_ps(samples + 4*i, vecs[i]);
+      }
+      for (int i = 0; i < CHUNK_SIZE; i++) {
+        samples[i] -= floorf(samples[i]);
+      }
+      for (int i = 0; i < numVecs; i++) {
+        vecs[i] = _mm_loadu_ps(samples + 4*i);
+      }
+      break;
+    }
+  }
+}
+#endif
@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DSP_FUSED_CHAIN_H_
+#define _DSP_FUSED_CHAIN_H_
+
+#if __SSE__
+#include <xmmintrin.h>
+#endif
+#include "DspObject.h"
+
+/** The operations which may be fused into a <code>DspFusedChain</code>. */
+typedef enum ElementwiseOperationType {
+  ELEMENTWISE_ADD,
+  ELEMENTWISE_SUBTRACT,
+  ELEMENTWISE_MULTIPLY,
+  ELEMENTWISE_DIVIDE,
+  ELEMENTWISE_CLIP,
+  ELEMENTWISE_WRAP
+} ElementwiseOperationType;
+
+/** The operation which an object applies to each sample of the signal at its left inlet. */
+typedef struct ElementwiseOperation {
+  ElementwiseOperationType type;
+  
+  /** The right operand of the arithmetic operations, or <code>NULL</code> if it is a constant. */
+  float *operandBuffer;
+  
+  /** The constant right operand of the arithmetic operations, or the lower bound of a clip. */
+  float constant;
+  
+  /** The upper bound of a clip. */
+  float upperBound;
+} ElementwiseOperation;
+
+/**
+ * A <code>DspFusedChain</code> computes a chain of elementwise objects, such as
+ * <code>[*~ 0.5] -> [+~ 1] -> [clip~ -1 1] -> [wrap~]</code>, in one pass over the block. Each
+ * chunk of samples is loaded once, all operations are applied to it in registers, and only the
+ * output of the last object of the chain is written. The buffers of the other objects are not used.
+ * Whenever one of the objects has received a message in the current block, the objects are
+ * processed individually instead, such that the message takes effect at the right sample.
+ * <code>PdGraph</code> replaces the objects of the chain by a <code>DspFusedChain</code> in its
+ * process order.
+ */
+class DspFusedChain : public DspObject {
+  
+  public:
+    /**
+     * Returns a new chain of the given objects, which must be in order and each connected only
+     * to the next one.
+     */
+    DspFusedChain(List *objectList, PdGraph *graph);
+    ~DspFusedChain();
+  
+    /**
+     * Returns <code>true</code> if the output of the given object may be computed by the next one
+     * in a chain, i.e., if both are elementwise, and the former only connects to the left inlet
+     * of the latter and nothing else arrives there. The connections are those which the given graph
+     * will have once all queued edits have been applied.
+     */
+    static bool canFuse(DspObject *fromObject, DspObject *toObject, PdGraph *graph);
+  
+    void processDsp();
+  
+    const char *getObjectLabel();
+  
+    /** Returns <code>true</code> if the given object is part of this chain. */
+    bool contains(DspObject *dspObject);
+  
+    /** Returns the last object of this chain. */
+    DspObject *getLastObject();
+  
+    /** Returns the number of objects in this chain. */
+    int getNumObjects();
+  
+    /** Returns the object at the given index of this chain, in process order. */
+    DspObject *getObject(int index);
+  
+    /**
+     * Returns <code>true</code> if this chain consists of exactly the given objects, in order. Such
+     * a chain can be kept when the process order is recomputed.
+     */
+    bool isChainOf(List *objectList);
+  
+  private:
+    /**
+     * Returns <code>true</code> if the given object is elementwise, and at most one signal arrives at
+     * each of its inlets, given the connections which the graph will have.
+     */
+    static bool hasElementwiseInlets(DspObject *dspObject, PdGraph *graph);
+  
+    /** Processes the objects of this chain on their own, in order. */
+    void processObjects();
+  
+    /** The number of samples which are computed at once, held in registers. */
+    static const int CHUNK_SIZE = 16;
+  
+    /** Returns the result of the given operation on the sample at the given index of the block. */
+    static inline float applyOperation(ElementwiseOperation *operation, float f, int index);
+  
+    #if __SSE__
+    /** Applies the given operation to the chunk of samples beginning at the given index of the block. */
+    static inline void applyOperation(ElementwiseOperation *operation, __m128 *vecs, int index);
+    #endif
+  
+    /** The objects of this chain, in process order. */
+    DspObject **objects;
+    int numObjects;
+  
+    /** The operations of the objects, updated in every block. */
+    ElementwiseOperation *operations;
+};
+
+#endif // _DSP_FUSED_CHAIN_H_
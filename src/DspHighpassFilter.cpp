@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspHighpassFilter.h"
 #include "PdGraph.h"
 
@@ -56,7 +57,6 @@ void DspHighpassFilter::processMessage(int inletIndex, PdMessage *message) {
       MessageElement *messageElement = message->getElement(0);
       if (messageElement->getType() == SYMBOL) {
         if (strcmp(messageElement->getSymbol(), "clear") == 0) {
-          processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), sampleRate));
           tap_0 = 0.0f;
         }
       }
@@ -65,7 +65,6 @@ void DspHighpassFilter::processMessage(int inletIndex, PdMessage *message) {
     case 1: {
       MessageElement *messageElement = message->getElement(0);
       if (messageElement->getType() == FLOAT) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), sampleRate));
         calculateFilterCoefficients(messageElement->getFloat());
       }
       break;
@@ -76,15 +75,44 @@ void DspHighpassFilter::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspHighpassFilter::processDspToIndex(float newBlockIndex) {
+void DspHighpassFilter::processDspWithIndex(int fromIndex, int toIndex) {
   float *inputBuffer = localDspBufferAtInlet[0]; 
   float *outputBuffer = localDspBufferAtOutlet[0];
   
-  int endSampleIndex = getEndSampleIndex(newBlockIndex);
-  for (int i = getStartSampleIndex(); i < endSampleIndex; i++) {
+  for (int i = fromIndex; i < toIndex; i++) {
     float f = inputBuffer[i] + alpha * tap_0;
     outputBuffer[i] = f - tap_0;
     tap_0 = f;
   }
-  blockIndexOfLastMessage = newBlockIndex;
+}
+
+bool DspHighpassFilter::generateCode(CodeGenerator *codeGenerator) {
+  char *inputBuffer = codeGenerator->getInputBuffer(this, 0);
+  char *outputBuffer = codeGenerator->getOutputBuffer(this, 0);
+  if (codeGenerator->getSampleType() != ZG_SAMPLE_FLOAT) {
+    // The tap below grows to 1/(1-alpha) times the input, which does not fit into [-1, 1). The
+    // output is instead computed as the input minus its lowpass, whose tap is (1-alpha) times smaller.
+    char *tapState = codeGenerator->newSampleState((1.0f - alpha) * tap_0);
+    codeGenerator->addCode("{");
+    codeGenerator->addCode("  sample_t tap = %s;", tapState);
+    codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++) {");
+    codeGenerator->addCode("    %s[i] = subtract(%s[i], tap);", outputBuffer, inputBuffer);
+    codeGenerator->addCode("    tap = add(multiply(" CODE_SAMPLE ", %s[i]), multiply(" CODE_SAMPLE ", tap));",
+        1.0f - alpha, inputBuffer, alpha);
+    codeGenerator->addCode("  }");
+    codeGenerator->addCode("  %s = tap;", tapState);
+    codeGenerator->addCode("}");
+    return true;
+  }
+  char *tapState = codeGenerator->newState(tap_0);
+  codeGenerator->addCode("{");
+  codeGenerator->addCode("  float tap = %s;", tapState);
+  codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++) {");
+  codeGenerator->addCode("    float f = %s[i] + " CODE_FLOAT " * tap;", inputBuffer, alpha);
+  codeGenerator->addCode("    %s[i] = f - tap;", outputBuffer);
+  codeGenerator->addCode("    tap = f;");
+  codeGenerator->addCode("  }");
+  codeGenerator->addCode("  %s = tap;", tapState);
+  codeGenerator->addCode("}");
+  return true;
 }
@@ -36,10 +36,12 @@ class DspHighpassFilter : public DspObject {
     ~DspHighpassFilter();
   
     const char *getObjectLabel();
+
+    bool generateCode(CodeGenerator *codeGenerator);
   
   private:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float newBlockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
     void calculateFilterCoefficients(float cutoffFrequency);
     
     float sampleRate;
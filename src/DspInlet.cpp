@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspInlet.h"
 
 DspInlet::DspInlet(PdGraph *graph) : DspObject(0, 0, 0, 1, graph) {
@@ -44,3 +45,8 @@ void DspInlet::processDsp() {
   // update the outlet buffer with the graph's (possibly new) inlet buffer
   localDspBufferAtOutlet[0] = *graphInletBuffer;
 }
+
+bool DspInlet::generateCode(CodeGenerator *codeGenerator) {
+  // the graph refers the outlet to the buffer at its inlet, see PdGraph::generateCode()
+  return true;
+}
@@ -39,6 +39,8 @@ class DspInlet : public DspObject {
     ~DspInlet();
   
     const char *getObjectLabel();
+
+    bool generateCode(CodeGenerator *codeGenerator);
   
     /**
      * Set the parent-graph's inlet buffer. A double pointer is used because the graph's inlet buffer
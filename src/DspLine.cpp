@@ -21,6 +21,7 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "CodeGenerator.h"
 #include "DspLine.h"
 #include "PdGraph.h"
 
@@ -48,7 +49,6 @@ void DspLine::processMessage(int inletIndex, PdMessage *message) {
       case 1: {
         // jump to value
         if (message->isFloat(0)) {
-          processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
           target = message->getFloat(0);
           slope = 0.0f;
           numSamplesToTarget = 0.0f;
@@ -58,7 +58,6 @@ void DspLine::processMessage(int inletIndex, PdMessage *message) {
       default: { // at least two inputs
         // new ramp
         if (message->isFloat(0) && message->isFloat(1)) {
-          processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
           target = message->getFloat(0);
           float timeToTargetMs = message->getFloat(1); // no negative time to targets!
           numSamplesToTarget = StaticUtils::millisecondsToSamples(
@@ -71,59 +70,42 @@ void DspLine::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspLine::processDspToIndex(float blockIndex) {
+void DspLine::processDspWithIndex(int fromIndex, int toIndex) {
   float *outputBuffer = localDspBufferAtOutlet[0];
   if (numSamplesToTarget <= 0.0f) { // if we have already reached the target
-    #if TARGET_OS_MAC || TARGET_OS_IPHONE
-    vDSP_vfill(&target, outputBuffer+getStartSampleIndex(), 1, getEndSampleIndex(blockIndex)-getStartSampleIndex());
-    #else
-    // TODO(mhroth): can this be replaced with memset() or something similar?
-    // can this be made faster?
-    int blockIndexInt = getEndSampleIndex(blockIndex);
-    for (int i = getStartSampleIndex(); i < blockIndexInt; i++) {
-      outputBuffer[i] = target; // stay at the target
-    }
-    #endif
+    ArrayArithmetic::fill(outputBuffer, target, fromIndex, toIndex);
     lastOutputSample = target;
   } else {
     // the number of samples to be processed this iteration
-    float processLength = blockIndex - blockIndexOfLastMessage;
-    if (processLength > 0.0f) {
-      // if there is anything to process at all (several messages may be received at once)
-      if (numSamplesToTarget < processLength) {
-        int targetIndexInt = getEndSampleIndex(blockIndexOfLastMessage + numSamplesToTarget);
-        #if TARGET_OS_MAC || TARGET_OS_IPHONE
-        vDSP_vramp(&lastOutputSample, &slope, outputBuffer+getStartSampleIndex(), 1, targetIndexInt-getStartSampleIndex());
-        vDSP_vfill(&target, outputBuffer+targetIndexInt, 1, getEndSampleIndex(blockIndex)-targetIndexInt);
-        #else
-        // if we will process more samples than we have remaining to the target
-        // i.e., if we will arrive at the target while processing
-        outputBuffer[getStartSampleIndex()] = lastOutputSample + slope;
-        for (int i = getStartSampleIndex()+1; i < targetIndexInt; i++) {
-          outputBuffer[i] = outputBuffer[i-1] + slope;
-        }
-        int blockIndexInt = getEndSampleIndex(blockIndex);
-        for (int i = targetIndexInt; i < blockIndexInt; i++) {
-          outputBuffer[i] = target;
-        }
-        #endif
-        lastOutputSample = target;
-        numSamplesToTarget = 0;
-      } else {
-        // if the target is far off
-        int blockIndexInt = getEndSampleIndex(blockIndex);
-        #if TARGET_OS_MAC || TARGET_OS_IPHONE
-        vDSP_vramp(&lastOutputSample, &slope, outputBuffer+getStartSampleIndex(), 1, blockIndexInt-getStartSampleIndex());
-        #else
-        outputBuffer[getStartSampleIndex()] = lastOutputSample + slope;
-        for (int i = getStartSampleIndex()+1; i < blockIndexInt; i++) {
-          outputBuffer[i] = outputBuffer[i-1] + slope;
-        }
-        #endif
-        lastOutputSample = outputBuffer[blockIndexInt-1];  
-        numSamplesToTarget -= processLength;
+    float processLength = (float) (toIndex - fromIndex);
+    if (numSamplesToTarget < processLength) {
+      // if we will process more samples than we have remaining to the target
+      // i.e., if we will arrive at the target while processing
+      int targetIndexInt = fromIndex + (int) ceilf(numSamplesToTarget);
+      if (targetIndexInt > toIndex) {
+        targetIndexInt = toIndex;
       }
+      ArrayArithmetic::ramp(outputBuffer, lastOutputSample + slope, slope, fromIndex, targetIndexInt);
+      ArrayArithmetic::fill(outputBuffer, target, targetIndexInt, toIndex);
+      lastOutputSample = target;
+      numSamplesToTarget = 0;
+    } else {
+      // if the target is far off. The ramp is computed back from the target, such that rounding
+      // errors do not accumulate from one block to the next.
+      numSamplesToTarget -= processLength;
+      ArrayArithmetic::ramp(outputBuffer, target - slope * (numSamplesToTarget + processLength - 1.0f),
+          slope, fromIndex, toIndex);
+      lastOutputSample = target - slope * numSamplesToTarget;
     }
   }
-  blockIndexOfLastMessage = blockIndex;
+}
+
+bool DspLine::generateCode(CodeGenerator *codeGenerator) {
+  if (numSamplesToTarget > 0.0f) {
+    return false; // a ramp is in progress
+  }
+  // without any messages, the output remains at the target
+  codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = " CODE_SAMPLE ";",
+      codeGenerator->getOutputBuffer(this, 0), target);
+  return true;
 }
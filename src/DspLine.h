@@ -33,10 +33,12 @@ class DspLine : public DspObject {
     ~DspLine();
   
     const char *getObjectLabel();
+  
+    bool generateCode(CodeGenerator *codeGenerator);
     
   private:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float newBlockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
   
     float target;
     float slope;
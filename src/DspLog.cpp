@@ -27,6 +27,8 @@
 DspLog::DspLog(PdMessage *initMessage, PdGraph *graph) : DspObject(2, 2, 0, 1, graph) {
   // by default assume ln
   log2_base = initMessage->isFloat(0) ? log2f(initMessage->getFloat(0)) : M_LOG2E;
+  
+  onInletConnectionUpdate();
 }
 
 DspLog::~DspLog() {
@@ -40,7 +42,6 @@ const char *DspLog::getObjectLabel() {
 void DspLog::processMessage(int inletIndex, PdMessage *message) {
   if (inletIndex == 1) {
     if (message->isFloat(0)) {
-      processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
       if (message->getFloat(0) <= 0.0f) {
         graph->printErr("log~ base cannot be set to a non-positive number: %d\n", message->getFloat(0));
       } else {
@@ -50,31 +51,51 @@ void DspLog::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspLog::processDspToIndex(float blockIndex) {
+void DspLog::onInletConnectionUpdate() {
   switch (signalPrecedence) {
     case DSP_DSP: {
-      int blockIndexInt = getEndSampleIndex(blockIndex);
-      float *inputBuffer0 = localDspBufferAtInlet[0];
-      float *inputBuffer1 = localDspBufferAtInlet[1];
-      float *outputBuffer = localDspBufferAtOutlet[0];
-      for (int i = getStartSampleIndex(); i < blockIndexInt; i++) {
+      processFunction = &processSignal<DSP_DSP>;
+      break;
+    }
+    case DSP_MESSAGE: {
+      processFunction = &processSignal<DSP_MESSAGE>;
+      break;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      processFunction = &processSignal<MESSAGE_MESSAGE>;
+      break;
+    }
+  }
+}
+
+template <DspMessagePresedence precedence>
+void DspLog::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
+  DspLog *dspLog = (DspLog *) dspObject;
+  switch (precedence) {
+    case DSP_DSP: {
+      float *inputBuffer0 = dspLog->localDspBufferAtInlet[0];
+      float *inputBuffer1 = dspLog->localDspBufferAtInlet[1];
+      float *outputBuffer = dspLog->localDspBufferAtOutlet[0];
+      for (int i = fromIndex; i < toIndex; i++) {
         if (inputBuffer0[i] <= 0.0f || inputBuffer1[i] <= 0.0f) {
           outputBuffer[i] = -1000.0f; // Pd's "error" float value
         } else {
-          outputBuffer[i] = log2Approx(inputBuffer0[i]) / log2Approx(inputBuffer1[i]);
+          outputBuffer[i] = dspLog->log2Approx(inputBuffer0[i]) /
+              dspLog->log2Approx(inputBuffer1[i]);
         }
       }
       break;
     }
     case DSP_MESSAGE: {
-      int blockIndexInt = getEndSampleIndex(blockIndex);
-      float *inputBuffer = localDspBufferAtInlet[0];
-      float *outputBuffer = localDspBufferAtOutlet[0];
-      for (int i = getStartSampleIndex(); i < blockIndexInt; i++) {
+      float *inputBuffer = dspLog->localDspBufferAtInlet[0];
+      float *outputBuffer = dspLog->localDspBufferAtOutlet[0];
+      for (int i = fromIndex; i < toIndex; i++) {
         if (inputBuffer[i] <= 0.0f) {
           outputBuffer[i] = -1000.0f;
         } else {
-          outputBuffer[i] = log2Approx(inputBuffer[i]) / log2_base;
+          outputBuffer[i] = dspLog->log2Approx(inputBuffer[i]) / dspLog->log2_base;
         }
       }
       break;
@@ -85,7 +106,6 @@ void DspLog::processDspToIndex(float blockIndex) {
       break; // nothing to do
     }
   }
-  blockIndexOfLastMessage = blockIndex;
 }
 
 // this implementation is reproduced from http://www.musicdsp.org/showone.php?id=91
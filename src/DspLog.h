@@ -36,7 +36,11 @@ class DspLog : public DspObject {
   
   private:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float blockIndex);
+    void onInletConnectionUpdate();
+  
+    /** Computes the output for the given signal precedence, which is resolved at compile time. */
+    template <DspMessagePresedence precedence>
+    static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
   
     inline float log2Approx(float x);
   
@@ -21,6 +21,7 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "CodeGenerator.h"
 #include "DspLowpassFilter.h"
 #include "PdGraph.h"
 
@@ -58,14 +59,12 @@ void DspLowpassFilter::processMessage(int inletIndex, PdMessage *message) {
   switch (inletIndex) {
     case 0: {
       if (message->isSymbol(0) && strcmp(message->getSymbol(0), "clear") == 0) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
         tap_0 = 0.0f;
       }
       break;
     }
     case 1: {
       if (message->isFloat(0)) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
         calculateFilterCoefficients(message->getFloat(0));
       }
       break;
@@ -76,28 +75,41 @@ void DspLowpassFilter::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspLowpassFilter::processDspToIndex(float blockIndex) {
+void DspLowpassFilter::processDspWithIndex(int fromIndex, int toIndex) {
   float *inputBuffer = localDspBufferAtInlet[0]; 
   float *outputBuffer = localDspBufferAtOutlet[0];
-  const int startSampleIndex = getStartSampleIndex();
-  const int endSampleIndex = getEndSampleIndex(blockIndex);
-  const int duration = endSampleIndex - startSampleIndex;
+  const int duration = toIndex - fromIndex;
   const int durationBytes = duration * sizeof(float);
   #if TARGET_OS_MAC || TARGET_OS_IPHONE
-  memcpy(filterInputBuffer+2, inputBuffer+startSampleIndex, durationBytes);
+  memcpy(filterInputBuffer+2, inputBuffer+fromIndex, durationBytes);
   vDSP_deq22(filterInputBuffer, 1, coefficients, filterOutputBuffer, 1, duration);
-  memcpy(outputBuffer+startSampleIndex, filterOutputBuffer+2, durationBytes);
+  memcpy(outputBuffer+fromIndex, filterOutputBuffer+2, durationBytes);
   // copy last two inputs and outputs to start of filter buffer arrays
   memcpy(filterInputBuffer, filterInputBuffer+duration, 2 * sizeof(float));
   memcpy(filterOutputBuffer, filterOutputBuffer+duration, 2 * sizeof(float));
   #else
-  ArrayArithmetic::multiply(inputBuffer, alpha, outputBuffer, startSampleIndex, endSampleIndex);
-  outputBuffer[startSampleIndex] += beta * tap_0;
-  for (int i = startSampleIndex+1; i < endSampleIndex; i++) {
+  ArrayArithmetic::multiply(inputBuffer, alpha, outputBuffer, fromIndex, toIndex);
+  outputBuffer[fromIndex] += beta * tap_0;
+  for (int i = fromIndex+1; i < toIndex; i++) {
     outputBuffer[i] += beta * outputBuffer[i-1];
   }
-  tap_0 = outputBuffer[endSampleIndex-1];
+  tap_0 = outputBuffer[toIndex-1];
   #endif
-  
-  blockIndexOfLastMessage = blockIndex;
+}
+
+bool DspLowpassFilter::generateCode(CodeGenerator *codeGenerator) {
+  // as processDspWithIndex() without the Accelerate framework
+  char *tapState = codeGenerator->newSampleState(tap_0);
+  char *inputBuffer = codeGenerator->getInputBuffer(this, 0);
+  char *outputBuffer = codeGenerator->getOutputBuffer(this, 0);
+  codeGenerator->addCode("{");
+  codeGenerator->addCode("  sample_t tap = %s;", tapState);
+  codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++) {");
+  codeGenerator->addCode("    sample_t f = multiply(%s[i], " CODE_SAMPLE ");", inputBuffer, alpha);
+  codeGenerator->addCode("    f = add(f, multiply(" CODE_SAMPLE ", tap));", beta);
+  codeGenerator->addCode("    %s[i] = tap = f;", outputBuffer);
+  codeGenerator->addCode("  }");
+  codeGenerator->addCode("  %s = tap;", tapState);
+  codeGenerator->addCode("}");
+  return true;
 }
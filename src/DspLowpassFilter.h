@@ -36,10 +36,12 @@ class DspLowpassFilter : public DspObject {
     ~DspLowpassFilter();
   
     const char *getObjectLabel();
+
+    bool generateCode(CodeGenerator *codeGenerator);
     
   private:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float blockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
     void calculateFilterCoefficients(float cutoffFrequency);
   
     float sampleRate;
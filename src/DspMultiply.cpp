@@ -21,11 +21,15 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "CodeGenerator.h"
+#include "DspFusedChain.h"
 #include "DspMultiply.h"
 #include "PdGraph.h"
 
 DspMultiply::DspMultiply(PdMessage *initMessage, PdGraph *graph) : DspObject(2, 2, 0, 1, graph) {
   constant = initMessage->isFloat(0) ? initMessage->getFloat(0) : 0.0f;
+  
+  onInletConnectionUpdate();
 }
 
 DspMultiply::~DspMultiply() {
@@ -40,7 +44,6 @@ void DspMultiply::processMessage(int inletIndex, PdMessage *message) {
   switch (inletIndex) {
     case 1: {
       if (message->isFloat(0)) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
         constant = message->getFloat(0);
       }
       break;
@@ -51,16 +54,37 @@ void DspMultiply::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspMultiply::processDspToIndex(float blockIndex) {
+void DspMultiply::onInletConnectionUpdate() {
   switch (signalPrecedence) {
     case DSP_DSP: {
-      ArrayArithmetic::multiply(localDspBufferAtInlet[0], localDspBufferAtInlet[1], 
-          localDspBufferAtOutlet[0], 0, blockSizeInt);
+      processFunction = &processSignal<DSP_DSP>;
       break;
     }
     case DSP_MESSAGE: {
-      ArrayArithmetic::multiply(localDspBufferAtInlet[0], constant, localDspBufferAtOutlet[0],
-          getStartSampleIndex(), getEndSampleIndex(blockIndex));
+      processFunction = &processSignal<DSP_MESSAGE>;
+      break;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      processFunction = &processSignal<MESSAGE_MESSAGE>;
+      break;
+    }
+  }
+}
+
+template <DspMessagePresedence precedence>
+void DspMultiply::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
+  DspMultiply *dspMultiply = (DspMultiply *) dspObject;
+  switch (precedence) {
+    case DSP_DSP: {
+      ArrayArithmetic::multiply(dspMultiply->localDspBufferAtInlet[0], dspMultiply->localDspBufferAtInlet[1],
+          dspMultiply->localDspBufferAtOutlet[0], fromIndex, toIndex);
+      break;
+    }
+    case DSP_MESSAGE: {
+      ArrayArithmetic::multiply(dspMultiply->localDspBufferAtInlet[0], dspMultiply->constant,
+          dspMultiply->localDspBufferAtOutlet[0], fromIndex, toIndex);
       break;
     }
     case MESSAGE_DSP:
@@ -69,5 +93,50 @@ void DspMultiply::processDspToIndex(float blockIndex) {
       break; // nothing to do
     }
   }
-  blockIndexOfLastMessage = blockIndex; // update the block index of the last message
+}
+
+bool DspMultiply::generateCode(CodeGenerator *codeGenerator) {
+  switch (signalPrecedence) {
+    case DSP_DSP: {
+      codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = multiply(%s[i], %s[i]);",
+          codeGenerator->getOutputBuffer(this, 0), codeGenerator->getInputBuffer(this, 0),
+          codeGenerator->getInputBuffer(this, 1));
+      break;
+    }
+    case DSP_MESSAGE: {
+      codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = multiply(%s[i], " CODE_SAMPLE ");",
+          codeGenerator->getOutputBuffer(this, 0), codeGenerator->getInputBuffer(this, 0), constant);
+      break;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      break; // nothing to do
+    }
+  }
+  return true;
+}
+
+bool DspMultiply::getElementwiseOperation(ElementwiseOperation *operation) {
+  operation->type = ELEMENTWISE_MULTIPLY;
+  operation->constant = constant;
+  switch (signalPrecedence) {
+    case DSP_DSP: {
+      operation->operandBuffer = getSingleInputBuffer(1);
+      return (operation->operandBuffer != NULL);
+    }
+    case DSP_MESSAGE: {
+      operation->operandBuffer = NULL;
+      return true;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      return false;
+    }
+  }
+}
+
+bool DspMultiply::isElementwise() {
+  return true;
 }
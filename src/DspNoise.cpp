@@ -23,23 +23,28 @@
 #include "DspNoise.h"
 #include "PdGraph.h"
 
-DspNoise::DspNoise(PdGraph *graph) : DspObject(1, 0, 0, 1, graph->getBlockSize(), graph) {
-  twister = new MTRand(); // use new seed
+DspNoise::DspNoise(PdMessage *initMessage, PdGraph *graph) :
+    DspObject(1, 0, 0, 1, graph->getBlockSize(), graph) {
+  generator = graph->newRandomGenerator();
+  if (initMessage->isFloat(0)) {
+    generator->seed((unsigned int) initMessage->getFloat(0));
+  }
 }
 
 DspNoise::~DspNoise() {
-  delete twister;
+  delete generator;
 }
 
 const char *DspNoise::getObjectLabel() {
   return "noise~";
 }
 
-void DspNoise::processDspToIndex(float blockIndex) {
-  int blockIndexInt = getEndSampleIndex(blockIndex);
-  float *outputBuffer = localDspBufferAtOutlet[0];
-  for (int i = getStartSampleIndex(); i < blockIndexInt; i++) {
-    outputBuffer[i] = ((float) twister->rand(2.0)) - 1.0f;
+void DspNoise::processMessage(int inletIndex, PdMessage *message) {
+  if (message->isSymbol(0) && strcmp(message->getSymbol(0), "seed") == 0 && message->isFloat(1)) {
+    generator->seed((unsigned int) message->getFloat(1));
   }
-  blockIndexOfLastMessage = blockIndex;
+}
+
+void DspNoise::processDspWithIndex(int fromIndex, int toIndex) {
+  generator->fillBipolar(localDspBufferAtOutlet[0] + fromIndex, toIndex - fromIndex);
 }
@@ -24,24 +24,25 @@
 #define _DSP_NOISE_H_
 
 #include "DspObject.h"
-#include "MersenneTwister.h"
+#include "RandomGenerator.h"
 
 class PdGraph;
 
-/** [noise~] */
+/** [noise~], [noise~ seed] */
 class DspNoise : public DspObject {
     
   public:
-    DspNoise(PdGraph *graph);
+    DspNoise(PdMessage *initMessage, PdGraph *graph);
     ~DspNoise();
   
     const char *getObjectLabel();
     
   protected:
-    void processDspToIndex(float newBlockIndex);
+    void processMessage(int inletIndex, PdMessage *message);
+    void processDspWithIndex(int fromIndex, int toIndex);
   
   private:
-    MTRand *twister;
+    RandomGenerator *generator;
 };
 
 #endif // _DSP_NOISE_H_
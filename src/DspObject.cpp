@@ -41,8 +41,10 @@ void DspObject::init(int numDspInlets, int numDspOutlets, int blockSize) {
   blockSizeFloat = (float) blockSizeInt;
   blockIndexOfLastMessage = 0.0f;
   signalPrecedence = MESSAGE_MESSAGE; // default
+  processFunction = &processFunctionDefault;
   numBytesInBlock = blockSizeInt * sizeof(float);
   messageQueue = new MessageQueue();
+  Profiler::resetCounter(&profileCounter);
   
   // initialise the incoming dsp connections list
   incomingDspConnectionsListAtInlet = (List **) malloc(numDspInlets * sizeof(List *));
@@ -125,9 +127,7 @@ void DspObject::addConnectionFromObjectToInlet(MessageObject *messageObject, int
     objectLetPair->object = messageObject;
     objectLetPair->index = outletIndex;
     incomingDspConnectionsList->add(objectLetPair);
-    
-    // set signal precedence
-    signalPrecedence = (DspMessagePresedence) (signalPrecedence | (0x1 << inletIndex));
+    updateInletConnections(inletIndex);
   }
 }
 
@@ -144,6 +144,73 @@ void DspObject::addConnectionToObjectFromOutlet(MessageObject *messageObject, in
   }
 }
 
+void DspObject::removeConnectionFromObjectToInlet(MessageObject *messageObject, int outletIndex, int inletIndex) {
+  MessageObject::removeConnectionFromObjectToInlet(messageObject, outletIndex, inletIndex);
+  
+  if (messageObject->getConnectionType(outletIndex) == DSP &&
+      removeConnectionFromList(incomingDspConnectionsListAtInlet[inletIndex], messageObject, outletIndex) &&
+      incomingDspConnectionsListAtInlet[inletIndex]->size() == 0) {
+    updateInletConnections(inletIndex);
+  }
+}
+
+void DspObject::updateInletConnections(int inletIndex) {
+  if (incomingDspConnectionsListAtInlet[inletIndex]->size() > 0) {
+    signalPrecedence = (DspMessagePresedence) (signalPrecedence | (0x1 << inletIndex));
+  } else {
+    // the inlet no longer receives any signal. Stop pointing at the remote object's buffer and
+    // return to message input at this inlet. Objects such as dac~ which replace the local inlet
+    // buffer with their own do not have a reserved buffer.
+    if (localDspBufferAtInletReserved[inletIndex] != NULL) {
+      localDspBufferAtInlet[inletIndex] = localDspBufferAtInletReserved[inletIndex];
+      memset(localDspBufferAtInletReserved[inletIndex], 0, numBytesInBlock);
+    }
+    signalPrecedence = (DspMessagePresedence) (signalPrecedence & ~(0x1 << inletIndex));
+  }
+  onInletConnectionUpdate();
+}
+
+void DspObject::removeConnectionToObjectFromOutlet(MessageObject *messageObject, int inletIndex, int outletIndex) {
+  MessageObject::removeConnectionToObjectFromOutlet(messageObject, inletIndex, outletIndex);
+  
+  if (getConnectionType(outletIndex) == DSP) {
+    removeConnectionFromList(outgoingDspConnectionsListAtOutlet[outletIndex], messageObject, inletIndex);
+  }
+}
+
+void DspObject::removeAllConnections() {
+  MessageObject::removeAllConnections();
+  
+  for (int i = 0; i < numDspInlets; i++) {
+    List *list = incomingDspConnectionsListAtInlet[i];
+    while (list->size() > 0) {
+      ObjectLetPair *objectLetPair = (ObjectLetPair *) list->get(0);
+      MessageObject *remoteObject = objectLetPair->object;
+      int outletIndex = objectLetPair->index;
+      remoteObject->removeConnectionToObjectFromOutlet(this, i, outletIndex);
+      removeConnectionFromObjectToInlet(remoteObject, outletIndex, i);
+    }
+  }
+  for (int i = 0; i < numDspOutlets; i++) {
+    List *list = outgoingDspConnectionsListAtOutlet[i];
+    while (list->size() > 0) {
+      ObjectLetPair *objectLetPair = (ObjectLetPair *) list->get(0);
+      MessageObject *remoteObject = objectLetPair->object;
+      int inletIndex = objectLetPair->index;
+      remoteObject->removeConnectionFromObjectToInlet(this, i, inletIndex);
+      removeConnectionToObjectFromOutlet(remoteObject, inletIndex, i);
+    }
+  }
+}
+
+int DspObject::getNumInlets() {
+  return (numMessageInlets > numDspInlets) ? numMessageInlets : numDspInlets;
+}
+
+int DspObject::getNumOutlets() {
+  return (numMessageOutlets > numDspOutlets) ? numMessageOutlets : numDspOutlets;
+}
+
 bool DspObject::shouldDistributeMessageToInlets() {
   return false;
 }
@@ -152,6 +219,9 @@ void DspObject::receiveMessage(int inletIndex, PdMessage *message) {
   // Queue the message to be processed during the DSP round only if the graph is switched on.
   // Otherwise messages would begin to pile up because the graph is not processed.
   if (graph->isSwitchedOn()) {
+    // a sleeping graph (e.g., an instance of [clone]) must process its audio to act on the message
+    graph->wake();
+    
     // reserve the message so that it won't be reused by the issuing object.
     // The message is released once it is consumed in processDsp().
     message->reserve(this);
@@ -180,9 +250,10 @@ void DspObject::processDsp() {
     }
   }
   
-  // process all pending messages in this block
+  // process all pending messages in this block, computing the audio up to each one beforehand
   MessageLetPair *messageLetPair = NULL;
   while ((messageLetPair = (MessageLetPair *) messageQueue->remove(0)) != NULL) {
+    processDspToIndex(messageLetPair->message->getBlockIndex(graph->getBlockStartTimestamp()));
     processMessage(messageLetPair->index, messageLetPair->message);
     messageLetPair->message->unreserve(this); // unreserve the message so that it can be reused by the issuing object
   }
@@ -228,20 +299,45 @@ void DspObject::resolveInputBuffersAtInlet(int inletIndex) {
 }
 
 void DspObject::processDspToIndex(float blockIndex) {
+  int fromIndex = getStartSampleIndex();
+  int toIndex = getEndSampleIndex(blockIndex);
+  if (fromIndex < toIndex) {
+    processFunction(this, fromIndex, toIndex);
+    blockIndexOfLastMessage = blockIndex;
+  }
+}
+
+void DspObject::processDspWithIndex(int fromIndex, int toIndex) {
   // by default, this function does nothing
 }
 
-bool DspObject::isRootNode() {
-  if (!MessageObject::isRootNode()) {
-    return false;
-  } else {
-    for (int i = 0; i < numDspInlets; i++) {
-      if (incomingDspConnectionsListAtInlet[i]->size() > 0) {
-        return false;
-      }
-    }
-    return true;
+void DspObject::onInletConnectionUpdate() {
+  // by default, the kernel does not depend on the connections
+}
+
+void DspObject::processFunctionDefault(DspObject *dspObject, int fromIndex, int toIndex) {
+  dspObject->processDspWithIndex(fromIndex, toIndex);
+}
+
+bool DspObject::generateCode(CodeGenerator *codeGenerator) {
+  return false;
+}
+
+bool DspObject::getElementwiseOperation(ElementwiseOperation *operation) {
+  return false;
+}
+
+bool DspObject::isElementwise() {
+  return false;
+}
+
+float *DspObject::getSingleInputBuffer(int inletIndex) {
+  List *incomingDspConnectionsList = incomingDspConnectionsListAtInlet[inletIndex];
+  if (incomingDspConnectionsList->size() != 1) {
+    return NULL;
   }
+  ObjectLetPair *objectLetPair = (ObjectLetPair *) incomingDspConnectionsList->get(0);
+  return ((DspObject *) objectLetPair->object)->getDspBufferAtOutlet(objectLetPair->index);
 }
 
 bool DspObject::isLeafNode() {
@@ -257,30 +353,20 @@ bool DspObject::isLeafNode() {
   }
 }
 
-List *DspObject::getProcessOrder() {
-  if (isOrdered) {
-    // if this object has already been ordered, then move on
-    return new List();
+List **DspObject::getIncomingConnectionsSlot(ConnectionType type, int inletIndex) {
+  if (type == DSP) {
+    return (inletIndex >= 0 && inletIndex < numDspInlets)
+        ? &incomingDspConnectionsListAtInlet[inletIndex] : NULL;
   } else {
-    isOrdered = true;
-    List *processList = new List();
-    for (int i = 0; i < numMessageInlets; i++) {
-      for (int j = 0; j < incomingMessageConnectionsListAtInlet[i]->size(); j++) {
-        ObjectLetPair *objectLetPair = (ObjectLetPair *) incomingMessageConnectionsListAtInlet[i]->get(j);
-        List *parentProcessList = objectLetPair->object->getProcessOrder();
-        processList->add(parentProcessList);
-        delete parentProcessList;
-      }
-    }
-    for (int i = 0; i < numDspInlets; i++) {
-      for (int j = 0; j < incomingDspConnectionsListAtInlet[i]->size(); j++) {
-        ObjectLetPair *objectLetPair = (ObjectLetPair *) incomingDspConnectionsListAtInlet[i]->get(j);
-        List *parentProcessList = objectLetPair->object->getProcessOrder();
-        processList->add(parentProcessList);
-        delete parentProcessList;
-      }
-    }
-    processList->add(this);
-    return processList;
+    return MessageObject::getIncomingConnectionsSlot(type, inletIndex);
+  }
+}
+
+List **DspObject::getOutgoingConnectionsSlot(ConnectionType type, int outletIndex) {
+  if (type == DSP) {
+    return (outletIndex >= 0 && outletIndex < numDspOutlets)
+        ? &outgoingDspConnectionsListAtOutlet[outletIndex] : NULL;
+  } else {
+    return MessageObject::getOutgoingConnectionsSlot(type, outletIndex);
   }
 }
@@ -28,6 +28,10 @@
 #include "MessageLetPair.h"
 #include "MessageObject.h"
 #include "MessageQueue.h"
+#include "Profiler.h"
+
+class CodeGenerator;
+struct ElementwiseOperation;
 
 /**
  * A <code>DspObject</code> is the abstract superclass of any object which processes audio.
@@ -69,23 +73,120 @@ class DspObject : public MessageObject {
       
     void addConnectionToObjectFromOutlet(MessageObject *messageObject, int inletIndex, int outletIndex);
   
+    void removeConnectionFromObjectToInlet(MessageObject *messageObject, int outletIndex, int inletIndex);
+  
+    void removeConnectionToObjectFromOutlet(MessageObject *messageObject, int inletIndex, int outletIndex);
+  
+    void removeAllConnections();
+  
+    int getNumInlets();
+    int getNumOutlets();
+  
+    /** Returns the number of signal inlets of this object. */
+    inline int getNumDspInlets() { return numDspInlets; }
+  
+    /** Returns the list of objects (and their outlets) from which signals arrive at the given inlet. */
+    inline List *getIncomingDspConnections(int inletIndex) {
+      return incomingDspConnectionsListAtInlet[inletIndex];
+    }
+  
+    /** Returns the list of objects (and their inlets) to which signals are sent from the given outlet. */
+    inline List *getOutgoingDspConnections(int outletIndex) {
+      return outgoingDspConnectionsListAtOutlet[outletIndex];
+    }
+  
+    /**
+     * Returns the output buffer of the only object connected to the given inlet, or <code>NULL</code>
+     * if there is no such connection or several, whose signals must first be summed.
+     */
+    float *getSingleInputBuffer(int inletIndex);
+  
+    /** Returns <code>true</code> if messages are waiting to be processed in the current block. */
+    inline bool hasPendingMessages() { return messageQueue->size() > 0; }
+  
     virtual bool doesProcessAudio();
   
-    bool isRootNode();
     bool isLeafNode();
-    List *getProcessOrder();
+  
+    List **getIncomingConnectionsSlot(ConnectionType type, int inletIndex);
+    List **getOutgoingConnectionsSlot(ConnectionType type, int outletIndex);
+  
+    /**
+     * Brings the signal precedence and the input buffer of the given inlet up to date with its
+     * connections, after the list of connections has been replaced by an edit of the running graph.
+     */
+    void updateInletConnections(int inletIndex);
+  
+    /**
+     * Writes the code which computes one block of this object into the given <code>CodeGenerator</code>,
+     * with all parameters as constants. Returns <code>false</code> if this object cannot be compiled,
+     * which is the default.
+     */
+    virtual bool generateCode(CodeGenerator *codeGenerator);
+  
+    /**
+     * Describes how this object computes each output sample from the corresponding input samples
+     * alone, such that it can be part of a <code>DspFusedChain</code>. Returns <code>false</code> if
+     * this object is not elementwise, which is the default, or currently cannot be fused.
+     */
+    virtual bool getElementwiseOperation(ElementwiseOperation *operation);
+  
+    /**
+     * Returns <code>true</code> if this object may be elementwise, depending only on its connections.
+     * A graph decides which chains to fuse with this function, such that the decision can be made
+     * before an edit changes the connections.
+     */
+    virtual bool isElementwise();
+  
+    /** Returns the timing statistics of this object. They are only updated while profiling. */
+    inline ProfileCounter *getProfileCounter() { return &profileCounter; }
     
   protected:  
+    /**
+     * Computes the output buffers from the last message up to the given block index. The default
+     * implementation calls <code>processFunction</code> with the corresponding sample indices.
+     * Objects which always process whole blocks (graphs, <code>delwrite~</code>, <code>env~</code>,
+     * <code>outlet~</code>) override this function directly.
+     */
     virtual void processDspToIndex(float blockIndex);
   
+    /**
+     * Computes the output buffers in the sample range [fromIndex, toIndex). <code>processDsp()</code>
+     * splits the block at every queued message, such that all messages take effect at exactly the
+     * sample at which they are timestamped. The range is never empty.
+     */
+    virtual void processDspWithIndex(int fromIndex, int toIndex);
+  
+    /**
+     * Called whenever a signal connection to an inlet is added or removed, i.e., whenever
+     * <code>signalPrecedence</code> may have changed. Objects whose computation depends on it
+     * select the matching kernel as <code>processFunction</code> here.
+     */
+    virtual void onInletConnectionUpdate();
+  
+    /**
+     * The kernel which computes the output buffers in the sample range [fromIndex, toIndex). It is
+     * called by <code>processDspToIndex()</code>, such that no branching on the connections is
+     * necessary while processing. The default kernel calls <code>processDspWithIndex()</code>.
+     */
+    void (*processFunction)(DspObject *dspObject, int fromIndex, int toIndex);
+  
+    /** The default <code>processFunction</code>. */
+    static void processFunctionDefault(DspObject *dspObject, int fromIndex, int toIndex);
+  
     /** Returns the start sample index as an integer when computing output buffers in <code>processDspToIndex()</code>. */
     inline int getStartSampleIndex() {
       return (int) ceilf(blockIndexOfLastMessage);
     }
   
-    /** Returns the end sample index as an integer when computing output buffers in <code>processDspToIndex()</code>. */
+    /**
+     * Returns the end sample index as an integer when computing output buffers in <code>processDspToIndex()</code>.
+     * Message timestamps at the very end of a block may round to an index slightly beyond it, so
+     * the result is limited to the block size.
+     */
     inline int getEndSampleIndex(float blockIndex) {
-      return (int) ceilf(blockIndex);
+      int endIndex = (int) ceilf(blockIndex);
+      return (endIndex > blockSizeInt) ? blockSizeInt : endIndex;
     }
     
     /** The number of dsp inlets of this object. */
@@ -120,6 +221,9 @@ class DspObject : public MessageObject {
     /** List of all dsp objects to which this object connects at each outlet. */
     List **outgoingDspConnectionsListAtOutlet;
   
+    /** Timing statistics of calls to <code>processDsp()</code>, updated by the graph while profiling. */
+    ProfileCounter profileCounter;
+  
   private:
     /** This function encapsulates the common code between the two constructors. */
     void init(int numDspInlets, int numDspOutlets, int blockSize);
@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspOsc.h"
 #include "PdGraph.h"
 
@@ -47,6 +48,8 @@ DspOsc::DspOsc(PdMessage *initMessage, PdGraph *graph) : DspObject(2, 2, 0, 1, g
     }
     cos_table[sampleRateInt] = cos_table[0];
   }
+  
+  onInletConnectionUpdate();
 }
 
 DspOsc::~DspOsc() {
@@ -65,13 +68,16 @@ void DspOsc::processMessage(int inletIndex, PdMessage *message) {
     case 0: { // update the frequency
       MessageElement *messageElement = message->getElement(0);
       if (messageElement->getType() == FLOAT) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), sampleRate));
         frequency = fabsf(messageElement->getFloat());
       }
       break;
     }
     case 1: { // update the phase
-      // TODO(mhroth)
+      if (message->isFloat(0)) {
+        // the phase is set exactly at the sample at which the message arrives
+        float newPhase = message->getFloat(0);
+        index = (newPhase - floorf(newPhase)) * sampleRate;
+      }
       break;
     }
     default: {
@@ -80,34 +86,47 @@ void DspOsc::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspOsc::processDspToIndex(float blockIndex) {
+void DspOsc::onInletConnectionUpdate() {
   switch (signalPrecedence) {
-    case DSP_DSP: {
-      // TODO(mhroth)
+    case DSP_DSP:
+    case DSP_MESSAGE: {
+      processFunction = &processSignal<DSP_MESSAGE>;
       break;
     }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      processFunction = &processSignal<MESSAGE_MESSAGE>;
+      break;
+    }
+  }
+}
+
+template <DspMessagePresedence precedence>
+void DspOsc::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
+  DspOsc *dspOsc = (DspOsc *) dspObject;
+  float index = dspOsc->index;
+  float sampleRate = dspOsc->sampleRate;
+  float frequency = dspOsc->frequency;
+  switch (precedence) {
+    case DSP_DSP: // a signal at the phase inlet is ignored
     case DSP_MESSAGE: {
-      int endSampleIndex = getEndSampleIndex(blockIndex);
-      float *inputBuffer = localDspBufferAtInlet[0];
-      float *outputBuffer = localDspBufferAtOutlet[0];
-      for (int i = getStartSampleIndex(); i < endSampleIndex; index += inputBuffer[i++]) {
+      float *inputBuffer = dspOsc->localDspBufferAtInlet[0];
+      float *outputBuffer = dspOsc->localDspBufferAtOutlet[0];
+      for (int i = fromIndex; i < toIndex; index += inputBuffer[i++]) {
         if (index < 0.0f) {
           index += sampleRate;
         } else if (index >= sampleRate) {
           index -= sampleRate;
         }
-        outputBuffer[i] = cos_table[(int) index];
+        outputBuffer[i] = dspOsc->cos_table[(int) index];
       }
       break;
     }
-    case MESSAGE_DSP: {
-      // TODO(mhroth)
-      break;
-    }
+    case MESSAGE_DSP:
     case MESSAGE_MESSAGE: {
-      int endSampleIndex = getEndSampleIndex(blockIndex);
-      float *outputBuffer = localDspBufferAtOutlet[0];
-      for (int i = getStartSampleIndex(); i < endSampleIndex; i++, index += frequency) {
+      float *outputBuffer = dspOsc->localDspBufferAtOutlet[0];
+      for (int i = fromIndex; i < toIndex; i++, index += frequency) {
         if (index < 0.0f) {
           // allow negative frequencies (read the wavetable backwards)
           index += sampleRate;
@@ -116,10 +135,52 @@ void DspOsc::processDspToIndex(float blockIndex) {
           // outside of the cos_table
           index -= sampleRate;
         }
-        outputBuffer[i] = cos_table[(int) index];
+        outputBuffer[i] = dspOsc->cos_table[(int) index];
       }
       break;
     }
   }
-  blockIndexOfLastMessage = blockIndex; // update the block index of the last message
+  dspOsc->index = index;
+}
+
+bool DspOsc::generateCode(CodeGenerator *codeGenerator) {
+  codeGenerator->newTable("osc_table", sampleRate + 1,
+      "for (int i = 0; i < %i; i++) osc_table[i] = toSample(cosf(2.0f * M_PI * ((float) i) / %i)); "
+      "osc_table[%i] = osc_table[0];", sampleRate, sampleRate, sampleRate);
+  char *outputBuffer = codeGenerator->getOutputBuffer(this, 0);
+  if (codeGenerator->getSampleType() != ZG_SAMPLE_FLOAT) {
+    if (signalPrecedence == DSP_DSP || signalPrecedence == DSP_MESSAGE) {
+      return false; // a frequency signal does not fit into [-1, 1)
+    }
+    // the phase wraps around by itself, and is scaled to the length of the table
+    char *phaseState = codeGenerator->newPhaseState(index / sampleRate);
+    codeGenerator->addCode("{");
+    codeGenerator->addCode("  unsigned int phase = %s;", phaseState);
+    codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++, phase += %uu) {",
+        CodeGenerator::toPhase((double) frequency / sampleRate));
+    codeGenerator->addCode("    %s[i] = osc_table[((unsigned long long) phase * %i) >> 32];",
+        outputBuffer, sampleRate);
+    codeGenerator->addCode("  }");
+    codeGenerator->addCode("  %s = phase;", phaseState);
+    codeGenerator->addCode("}");
+    return true;
+  }
+  char *indexState = codeGenerator->newState(index);
+  codeGenerator->addCode("{");
+  codeGenerator->addCode("  float index = %s;", indexState);
+  if (signalPrecedence == DSP_DSP || signalPrecedence == DSP_MESSAGE) {
+    codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; index += %s[i++]) {",
+        codeGenerator->getInputBuffer(this, 0));
+    codeGenerator->addCode("    if (index < 0.0f) index += %i;", sampleRate);
+    codeGenerator->addCode("    else if (index >= %i) index -= %i;", sampleRate, sampleRate);
+  } else {
+    codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++, index += " CODE_FLOAT ") {", frequency);
+    codeGenerator->addCode("    if (index < 0.0f) index += %i;", sampleRate);
+    codeGenerator->addCode("    if (index >= %i) index -= %i;", sampleRate, sampleRate);
+  }
+  codeGenerator->addCode("    %s[i] = osc_table[(int) index];", outputBuffer);
+  codeGenerator->addCode("  }");
+  codeGenerator->addCode("  %s = index;", indexState);
+  codeGenerator->addCode("}");
+  return true;
 }
@@ -33,10 +33,16 @@ class DspOsc : public DspObject {
     ~DspOsc();
   
     const char *getObjectLabel();
+
+    bool generateCode(CodeGenerator *codeGenerator);
     
   protected:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float blockIndex);
+    void onInletConnectionUpdate();
+  
+    /** Computes the output for the given signal precedence, which is resolved at compile time. */
+    template <DspMessagePresedence precedence>
+    static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
     
   private:    
     int sampleRate;
@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspOutlet.h"
 #include "PdGraph.h"
 
@@ -44,3 +45,8 @@ void DspOutlet::processDspToIndex(float blockIndex) {
   // to the graph's output buffer
   memcpy(graph->getDspBufferAtOutlet(outletIndex), localDspBufferAtInlet[0], numBytesInBlock);
 }
+
+bool DspOutlet::generateCode(CodeGenerator *codeGenerator) {
+  codeGenerator->setOutputBuffer(graph, outletIndex, codeGenerator->getInputBuffer(this, 0));
+  return true;
+}
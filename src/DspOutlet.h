@@ -42,6 +42,8 @@ class DspOutlet : public DspObject {
     ~DspOutlet();
   
     const char *getObjectLabel();
+
+    bool generateCode(CodeGenerator *codeGenerator);
   
     /**
      * Set the outlet index of this object in the parent-graph.
@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspPhasor.h"
 #include "PdGraph.h"
 
@@ -48,6 +49,8 @@ DspPhasor::DspPhasor(PdMessage *initMessage, PdGraph *graph) : DspObject(2, 2, 0
     }
     phasor_table[sampleRateInt] = phasor_table[0];
   }
+  
+  onInletConnectionUpdate();
 }
 
 DspPhasor::~DspPhasor() {
@@ -66,13 +69,16 @@ void DspPhasor::processMessage(int inletIndex, PdMessage *message) {
     case 0: { // update the frequency
       MessageElement *messageElement = message->getElement(0);
       if (messageElement->getType() == FLOAT) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
         frequency = messageElement->getFloat();
       }
       break;
     }
     case 1: { // update the phase
-      // TODO(mhroth)
+      if (message->isFloat(0)) {
+        // the phase is set exactly at the sample at which the message arrives
+        float newPhase = message->getFloat(0);
+        index = (newPhase - floorf(newPhase)) * sampleRate;
+      }
       break;
     }
     default: {
@@ -81,43 +87,98 @@ void DspPhasor::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspPhasor::processDspToIndex(float blockIndex) {
+void DspPhasor::onInletConnectionUpdate() {
   switch (signalPrecedence) {
-    case DSP_DSP: {
-      // TODO(mhroth)
+    case DSP_DSP:
+    case DSP_MESSAGE: {
+      processFunction = &processSignal<DSP_MESSAGE>;
+      break;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      processFunction = &processSignal<MESSAGE_MESSAGE>;
       break;
     }
+  }
+}
+
+template <DspMessagePresedence precedence>
+void DspPhasor::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
+  DspPhasor *dspPhasor = (DspPhasor *) dspObject;
+  float index = dspPhasor->index;
+  float sampleRate = dspPhasor->sampleRate;
+  float frequency = dspPhasor->frequency;
+  switch (precedence) {
+    case DSP_DSP: // a signal at the phase inlet is ignored
     case DSP_MESSAGE: {
-      int endSampleIndex = getEndSampleIndex(blockIndex);
-      float *inputBuffer = localDspBufferAtInlet[0];
-      float *outputBuffer = localDspBufferAtOutlet[0];
-      for (int i = getStartSampleIndex(); i < endSampleIndex; index += inputBuffer[i++]) {
+      float *inputBuffer = dspPhasor->localDspBufferAtInlet[0];
+      float *outputBuffer = dspPhasor->localDspBufferAtOutlet[0];
+      for (int i = fromIndex; i < toIndex; index += inputBuffer[i++]) {
         if (index < 0.0f) {
           index += sampleRate; // account for negative frequencies
         } else if (index >= sampleRate) {
           index -= sampleRate;
         }
-        outputBuffer[i] = phasor_table[(int) index];
+        outputBuffer[i] = dspPhasor->phasor_table[(int) index];
       }
       break;
     }
-    case MESSAGE_DSP: {
-      // TODO(mhroth)
-      break;
-    }
+    case MESSAGE_DSP:
     case MESSAGE_MESSAGE: {
-      int endSampleIndex = getEndSampleIndex(blockIndex);
-      float *outputBuffer = localDspBufferAtOutlet[0];
-      for (int i = getStartSampleIndex(); i < endSampleIndex; i++, index += frequency) {
+      float *outputBuffer = dspPhasor->localDspBufferAtOutlet[0];
+      for (int i = fromIndex; i < toIndex; i++, index += frequency) {
         if (index < 0.0f) {
           index += sampleRate; // account for negative frequencies
         } else if (index >= sampleRate) {
           index -= sampleRate;
         }
-        outputBuffer[i] = phasor_table[(int) index];
+        outputBuffer[i] = dspPhasor->phasor_table[(int) index];
       }
       break;
     }
   }
-  blockIndexOfLastMessage = blockIndex; // update the block index of the last message
+  dspPhasor->index = index;
+}
+
+bool DspPhasor::generateCode(CodeGenerator *codeGenerator) {
+  int sampleRateInt = (int) sampleRate;
+  codeGenerator->newTable("phasor_table", sampleRateInt + 1,
+      "float f = 0.0f; "
+      "for (int i = 0; i < %i; i++, f += 1.0f / " CODE_FLOAT ") phasor_table[i] = toSample(f); "
+      "phasor_table[%i] = phasor_table[0];", sampleRateInt, sampleRate, sampleRateInt);
+  char *outputBuffer = codeGenerator->getOutputBuffer(this, 0);
+  if (codeGenerator->getSampleType() != ZG_SAMPLE_FLOAT) {
+    if (signalPrecedence == DSP_DSP || signalPrecedence == DSP_MESSAGE) {
+      return false; // a frequency signal does not fit into [-1, 1)
+    }
+    // the phase wraps around by itself, and is scaled to the length of the table
+    char *phaseState = codeGenerator->newPhaseState(index / sampleRate);
+    codeGenerator->addCode("{");
+    codeGenerator->addCode("  unsigned int phase = %s;", phaseState);
+    codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++, phase += %uu) {",
+        CodeGenerator::toPhase((double) frequency / sampleRate));
+    codeGenerator->addCode("    %s[i] = phasor_table[((unsigned long long) phase * %i) >> 32];",
+        outputBuffer, sampleRateInt);
+    codeGenerator->addCode("  }");
+    codeGenerator->addCode("  %s = phase;", phaseState);
+    codeGenerator->addCode("}");
+    return true;
+  }
+  char *indexState = codeGenerator->newState(index);
+  codeGenerator->addCode("{");
+  codeGenerator->addCode("  float index = %s;", indexState);
+  if (signalPrecedence == DSP_DSP || signalPrecedence == DSP_MESSAGE) {
+    codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; index += %s[i++]) {",
+        codeGenerator->getInputBuffer(this, 0));
+  } else {
+    codeGenerator->addCode("  for (int i = 0; i < BLOCK_SIZE; i++, index += " CODE_FLOAT ") {", frequency);
+  }
+  codeGenerator->addCode("    if (index < 0.0f) index += " CODE_FLOAT ";", sampleRate);
+  codeGenerator->addCode("    else if (index >= " CODE_FLOAT ") index -= " CODE_FLOAT ";", sampleRate, sampleRate);
+  codeGenerator->addCode("    %s[i] = phasor_table[(int) index];", outputBuffer);
+  codeGenerator->addCode("  }");
+  codeGenerator->addCode("  %s = index;", indexState);
+  codeGenerator->addCode("}");
+  return true;
 }
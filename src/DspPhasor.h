@@ -34,9 +34,15 @@ class DspPhasor : public DspObject {
 
     const char *getObjectLabel();
 
+    bool generateCode(CodeGenerator *codeGenerator);
+
   protected:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float blockIndex);
+    void onInletConnectionUpdate();
+  
+    /** Computes the output for the given signal precedence, which is resolved at compile time. */
+    template <DspMessagePresedence precedence>
+    static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
 
   private:
     float sampleRate;
@@ -0,0 +1,138 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DiskStreamer.h"
+#include "DspReadSoundfile.h"
+#include "PdGraph.h"
+#include "SoundfileStream.h"
+
+/** The default read-ahead in bytes per channel, as in Pd. */
+#define DEFAULT_READSF_BUFFER_SIZE 262144
+
+DspReadSoundfile::DspReadSoundfile(PdMessage *initMessage, PdGraph *graph) :
+    // one signal outlet per channel, followed by a message outlet which bangs at the end of the file
+    DspObject(1, 0,
+              (initMessage->isFloat(0) && initMessage->getFloat(0) > 1.0f) ? (int) initMessage->getFloat(0) + 1 : 2,
+              (initMessage->isFloat(0) && initMessage->getFloat(0) > 1.0f) ? (int) initMessage->getFloat(0) : 1,
+              graph) {
+  numChannels = numDspOutlets;
+  int bufferSize = initMessage->isFloat(1) ? (int) initMessage->getFloat(1) : DEFAULT_READSF_BUFFER_SIZE;
+  if (bufferSize <= 0) {
+    bufferSize = DEFAULT_READSF_BUFFER_SIZE;
+  }
+  
+  stream = new SoundfileStream(SOUNDFILE_STREAM_READ, numChannels, bufferSize / sizeof(float));
+  graph->getDiskStreamer()->addClient(stream);
+  isOpen = false;
+  isPlaying = false;
+}
+
+DspReadSoundfile::~DspReadSoundfile() {
+  graph->getDiskStreamer()->removeClient(stream);
+  delete stream;
+}
+
+const char *DspReadSoundfile::getObjectLabel() {
+  return "readsf~";
+}
+
+ConnectionType DspReadSoundfile::getConnectionType(int outletIndex) {
+  return (outletIndex < numChannels) ? DSP : MESSAGE;
+}
+
+void DspReadSoundfile::processMessage(int inletIndex, PdMessage *message) {
+  switch (message->getType(0)) {
+    case FLOAT: {
+      // [1( is equivalent to [start( and [0( to [stop(
+      if (message->getFloat(0) != 0.0f) {
+        isPlaying = isOpen;
+      } else if (isOpen) {
+        isPlaying = false;
+        isOpen = false;
+        stream->requestClose();
+      }
+      break;
+    }
+    case SYMBOL: {
+      char *command = message->getSymbol(0);
+      if (strcmp(command, "open") == 0) {
+        open(message);
+      } else if (strcmp(command, "start") == 0) {
+        isPlaying = isOpen;
+      } else if (strcmp(command, "stop") == 0) {
+        if (isOpen) {
+          isPlaying = false;
+          isOpen = false;
+          stream->requestClose();
+        }
+      } else if (strcmp(command, "print") == 0) {
+        graph->printStd("readsf~: %i channels, %s, %i dropouts.\n", numChannels,
+            isPlaying ? "playing" : (isOpen ? "open" : "closed"), stream->getNumDropouts());
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+void DspReadSoundfile::open(PdMessage *message) {
+  // skip any flags. Only the file name and onset are supported.
+  int index = 1;
+  while (message->isSymbol(index) && message->getSymbol(index)[0] == '-') {
+    index += message->isFloat(index+1) ? 2 : 1;
+  }
+  if (!message->isSymbol(index)) {
+    graph->printErr("readsf~: open requires a file name.\n");
+    return;
+  }
+  int onsetFrames = message->isFloat(index+1) ? (int) message->getFloat(index+1) : 0;
+  isPlaying = false;
+  isOpen = stream->requestOpen(graph->getDirectory(), message->getSymbol(index), onsetFrames, 0, 0);
+  if (!isOpen) {
+    graph->printErr("readsf~: too many requests. \"%s\" will not be opened.\n", message->getSymbol(index));
+  }
+}
+
+void DspReadSoundfile::processDspWithIndex(int fromIndex, int toIndex) {
+  if (fromIndex < toIndex) {
+    if (isPlaying) {
+      if (stream->read(localDspBufferAtOutlet, fromIndex, toIndex)) {
+        isPlaying = false;
+        isOpen = false;
+        if (stream->didOpenFail()) {
+          graph->printErr("readsf~: the file could not be opened.\n");
+        }
+        // the end of the file is announced at the beginning of the next block
+        PdMessage *outgoingMessage = getNextOutgoingMessage(numChannels);
+        outgoingMessage->setTimestamp(0);
+        outgoingMessage->getElement(0)->setBang();
+        graph->scheduleMessage(this, numChannels, outgoingMessage);
+      }
+    } else {
+      for (int i = 0; i < numChannels; i++) {
+        memset(localDspBufferAtOutlet[i] + fromIndex, 0, (toIndex - fromIndex) * sizeof(float));
+      }
+    }
+  }
+}
@@ -54,5 +54,6 @@ void DspReceive::setBuffer(float **buffer) {
 
 void DspReceive::processDsp() {
   // replace the local outlet buffer with a pointer to the input buffer of the associated send~
-  localDspBufferAtOutlet[0] = *sendBuffer;
+  // if there is no associated send~ (anymore), the original (silent) buffer is used
+  localDspBufferAtOutlet[0] = (sendBuffer != NULL) ? *sendBuffer : originalLocalOutletBuffer;
 }
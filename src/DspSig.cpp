@@ -20,6 +20,7 @@
  *
  */
 
+#include "CodeGenerator.h"
 #include "DspSig.h"
 #include "PdGraph.h"
 
@@ -37,16 +38,19 @@ const char *DspSignal::getObjectLabel() {
 
 void DspSignal::processMessage(int inletIndex, PdMessage *message) {
   if (message->isFloat(0)) {
-    processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
     constant = message->getFloat(0);
   }
 }
 
-void DspSignal::processDspToIndex(float blockIndex) {
+void DspSignal::processDspWithIndex(int fromIndex, int toIndex) {
   float *outputBuffer = localDspBufferAtOutlet[0];
-  int endSampleIndex = getEndSampleIndex(blockIndex);
-  for (int i = getStartSampleIndex(); i < endSampleIndex; i++) {
+  for (int i = fromIndex; i < toIndex; i++) {
     outputBuffer[i] = constant;
   }
-  blockIndexOfLastMessage = blockIndex;
+}
+
+bool DspSignal::generateCode(CodeGenerator *codeGenerator) {
+  codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = " CODE_SAMPLE ";",
+      codeGenerator->getOutputBuffer(this, 0), constant);
+  return true;
 }
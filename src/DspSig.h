@@ -33,10 +33,12 @@ public:
   ~DspSignal();
   
   const char *getObjectLabel();
+
+  bool generateCode(CodeGenerator *codeGenerator);
   
   private:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float blockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
   
     float constant;
 };
@@ -21,11 +21,15 @@
  */
 
 #include "ArrayArithmetic.h"
+#include "CodeGenerator.h"
+#include "DspFusedChain.h"
 #include "DspSubtract.h"
 #include "PdGraph.h"
 
 DspSubtract::DspSubtract(PdMessage *initMessage, PdGraph *graph) : DspObject(2, 2, 0, 1, graph) {
   constant = initMessage->isFloat(0) ? initMessage->getFloat(0) : 0.0f;
+  
+  onInletConnectionUpdate();
 }
 
 DspSubtract::~DspSubtract() {
@@ -40,7 +44,6 @@ void DspSubtract::processMessage(int inletIndex, PdMessage *message) {
   switch (inletIndex) {
     case 1: {
       if (message->isFloat(0)) {
-        processDspToIndex(message->getBlockIndex(graph->getBlockStartTimestamp(), graph->getSampleRate()));
         constant = message->getFloat(0);
       }
       break;
@@ -51,16 +54,37 @@ void DspSubtract::processMessage(int inletIndex, PdMessage *message) {
   }
 }
 
-void DspSubtract::processDspToIndex(float blockIndex) {
+void DspSubtract::onInletConnectionUpdate() {
   switch (signalPrecedence) {
     case DSP_DSP: {
-      ArrayArithmetic::subtract(localDspBufferAtInlet[0], localDspBufferAtInlet[1],
-          localDspBufferAtOutlet[0], getStartSampleIndex(), getEndSampleIndex(blockIndex));
+      processFunction = &processSignal<DSP_DSP>;
       break;
     }
     case DSP_MESSAGE: {
-      ArrayArithmetic::subtract(localDspBufferAtInlet[0], constant, localDspBufferAtOutlet[0],
-          getStartSampleIndex(), getEndSampleIndex(blockIndex));
+      processFunction = &processSignal<DSP_MESSAGE>;
+      break;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      processFunction = &processSignal<MESSAGE_MESSAGE>;
+      break;
+    }
+  }
+}
+
+template <DspMessagePresedence precedence>
+void DspSubtract::processSignal(DspObject *dspObject, int fromIndex, int toIndex) {
+  DspSubtract *dspSubtract = (DspSubtract *) dspObject;
+  switch (precedence) {
+    case DSP_DSP: {
+      ArrayArithmetic::subtract(dspSubtract->localDspBufferAtInlet[0], dspSubtract->localDspBufferAtInlet[1],
+          dspSubtract->localDspBufferAtOutlet[0], fromIndex, toIndex);
+      break;
+    }
+    case DSP_MESSAGE: {
+      ArrayArithmetic::subtract(dspSubtract->localDspBufferAtInlet[0], dspSubtract->constant,
+          dspSubtract->localDspBufferAtOutlet[0], fromIndex, toIndex);
       break;
     }
     case MESSAGE_DSP:
@@ -69,5 +93,50 @@ void DspSubtract::processDspToIndex(float blockIndex) {
       break; // nothing to do
     }
   }
-  blockIndexOfLastMessage = blockIndex; // update the block index of the last message
+}
+
+bool DspSubtract::generateCode(CodeGenerator *codeGenerator) {
+  switch (signalPrecedence) {
+    case DSP_DSP: {
+      codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = subtract(%s[i], %s[i]);",
+          codeGenerator->getOutputBuffer(this, 0), codeGenerator->getInputBuffer(this, 0),
+          codeGenerator->getInputBuffer(this, 1));
+      break;
+    }
+    case DSP_MESSAGE: {
+      codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = subtract(%s[i], " CODE_SAMPLE ");",
+          codeGenerator->getOutputBuffer(this, 0), codeGenerator->getInputBuffer(this, 0), constant);
+      break;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      break; // nothing to do
+    }
+  }
+  return true;
+}
+
+bool DspSubtract::getElementwiseOperation(ElementwiseOperation *operation) {
+  operation->type = ELEMENTWISE_SUBTRACT;
+  operation->constant = constant;
+  switch (signalPrecedence) {
+    case DSP_DSP: {
+      operation->operandBuffer = getSingleInputBuffer(1);
+      return (operation->operandBuffer != NULL);
+    }
+    case DSP_MESSAGE: {
+      operation->operandBuffer = NULL;
+      return true;
+    }
+    case MESSAGE_DSP:
+    case MESSAGE_MESSAGE:
+    default: {
+      return false;
+    }
+  }
+}
+
+bool DspSubtract::isElementwise() {
+  return true;
 }
@@ -33,9 +33,17 @@ class DspSubtract : public DspObject {
 
     const char *getObjectLabel();
 
+    bool generateCode(CodeGenerator *codeGenerator);
+    bool getElementwiseOperation(ElementwiseOperation *operation);
+    bool isElementwise();
+
   private:
     void processMessage(int inletIndex, PdMessage *message);
-    void processDspToIndex(float blockIndex);
+    void onInletConnectionUpdate();
+  
+    /** Computes the output for the given signal precedence, which is resolved at compile time. */
+    template <DspMessagePresedence precedence>
+    static void processSignal(DspObject *dspObject, int fromIndex, int toIndex);
 
     float constant;
 };
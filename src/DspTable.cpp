@@ -1,5 +1,5 @@
 /*
- *  Copyright 2009 Reality Jockey, Ltd.
+ *  Copyright 2009,2010 Reality Jockey, Ltd.
  *                 info@rjdj.me
  *                 http://rjdj.me/
  * 
@@ -21,21 +21,106 @@
  */
 
 #include "DspTable.h"
+#include "PdGraph.h"
+#include "SampleCache.h"
 
-DspTable::DspTable(char *tag, int blockSize, char *initString) : 
-    RemoteBufferObject(tag, blockSize, initString) {
-  // nothing to do
-}
+/** The length of a table if none is given, as in Pd. */
+#define DEFAULT_TABLE_LENGTH 100
+
+/** Table storage is aligned to cache lines. */
+#define DSP_TABLE_ALIGNMENT 64
 
-DspTable::DspTable(int bufferLengthInSamples, char *tag, int blockSize, char *initString) : 
-    RemoteBufferObject(bufferLengthInSamples, tag, blockSize, initString) {
-  // nothing to do
+DspTable::DspTable(PdMessage *initMessage, PdGraph *graph) : MessageObject(0, 0, graph) {
+  if (initMessage->isSymbol(0)) {
+    name = StaticUtils::copyString(initMessage->getSymbol(0));
+  } else {
+    name = StaticUtils::copyString((char *) "");
+    graph->printErr("table must be initialised in the format [table name size].\n");
+  }
+  storage = NULL;
+  sharedSample = NULL;
+  buffer = NULL;
+  bufferLength = 0;
+  int length = initMessage->isFloat(1) ? (int) initMessage->getFloat(1) : DEFAULT_TABLE_LENGTH;
+  resize((length > 0) ? length : 1);
 }
 
 DspTable::~DspTable() {
-  // nothing to do
+  if (sharedSample != NULL) {
+    SampleCache::release(sharedSample);
+  }
+  free(storage);
+  free(name);
+}
+
+const char *DspTable::getObjectLabel() {
+  return "table";
+}
+
+float *DspTable::getWritableBuffer(int *length) {
+  if (sharedSample != NULL) {
+    resize(bufferLength); // makes a copy of the sample
+  }
+  *length = bufferLength;
+  return buffer;
+}
+
+void DspTable::share(CachedSample *sample, int channelIndex, int offset, int length) {
+  // retain the new sample before releasing the old one, which may be the same
+  SampleCache::retain(sample);
+  if (sharedSample != NULL) {
+    SampleCache::release(sharedSample);
+  }
+  free(storage);
+  storage = NULL;
+  sharedSample = sample;
+  buffer = sample->channels[channelIndex] + offset;
+  bufferLength = length;
+}
+
+float *DspTable::newStorage(int length) {
+  // the guard length keeps the buffer aligned, as DSP_TABLE_GUARD_LENGTH floats are 64 bytes
+  float *storage = NULL;
+  if (posix_memalign((void **) &storage, DSP_TABLE_ALIGNMENT,
+      (length + 2 * DSP_TABLE_GUARD_LENGTH) * sizeof(float)) != 0) {
+    return NULL;
+  }
+  memset(storage, 0, (length + 2 * DSP_TABLE_GUARD_LENGTH) * sizeof(float));
+  return storage;
+}
+
+void DspTable::adopt(float *newStorage, int length) {
+  if (sharedSample != NULL) {
+    SampleCache::release(sharedSample);
+    sharedSample = NULL;
+  }
+  free(storage);
+  storage = newStorage;
+  buffer = newStorage + DSP_TABLE_GUARD_LENGTH;
+  bufferLength = length;
+}
+
+float *DspTable::resize(int length) {
+  if (length == bufferLength && sharedSample == NULL) {
+    return buffer;
+  }
+  float *resizedStorage = newStorage(length);
+  if (resizedStorage == NULL) {
+    graph->printErr("table %s: could not allocate %i samples.\n", name, length);
+    return buffer;
+  }
+  if (buffer != NULL) {
+    memcpy(resizedStorage + DSP_TABLE_GUARD_LENGTH, buffer,
+        ((length < bufferLength) ? length : bufferLength) * sizeof(float));
+  }
+  adopt(resizedStorage, length);
+  return buffer;
 }
 
-void DspTable::processDspToIndex(int newBlockIndex) {
-  // nothing to do
+void DspTable::setValues(int startIndex, PdMessage *values, int firstElementIndex) {
+  for (int i = firstElementIndex, j = startIndex; i < values->getNumElements() && j < bufferLength; i++, j++) {
+    if (j >= 0 && values->isFloat(i)) {
+      buffer[j] = values->getFloat(i);
+    }
+  }
 }
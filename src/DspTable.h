@@ -1,5 +1,5 @@
 /*
- *  Copyright 2009 Reality Jockey, Ltd.
+ *  Copyright 2009,2010 Reality Jockey, Ltd.
  *                 info@rjdj.me
  *                 http://rjdj.me/
  * 
@@ -23,19 +23,124 @@
 #ifndef _DSP_TABLE_H_
 #define _DSP_TABLE_H_
 
-#include "RemoteBufferObject.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#include "MessageObject.h"
+
+struct CachedSample;
 
 /**
- * table
+ * The number of zeroed samples kept before and after the contents of every table. Readers may
+ * thus touch a few samples beyond either end of a table without checking its bounds.
  */
-class DspTable : public RemoteBufferObject {
+#define DSP_TABLE_GUARD_LENGTH 16
+
+/**
+ * [table name size], or an array defined with <code>#X array name size float flags</code>.
+ * Tables are registered by name with the root graph, and are found by <code>tabread~</code>,
+ * <code>tabplay~</code>, <code>soundfiler</code>, etc. via <code>PdGraph::getTable()</code>.
+ * Table storage is 64-byte aligned.
+ */
+class DspTable : public MessageObject {
   
   public:
-    DspTable(char *tag, int blockSize, char *initString);
-    DspTable(int bufferLengthInSamples, char *tag, int blockSize, char *initString);
+    DspTable(PdMessage *initMessage, PdGraph *graph);
     ~DspTable();
   
-    void processDspToIndex(int newBlockIndex);
+    const char *getObjectLabel();
+  
+    inline char *getName() { return name; }
+  
+    /** Returns the table buffer and its length in samples. */
+    inline float *getBuffer(int *length) {
+      *length = bufferLength;
+      return buffer;
+    }
+  
+    /**
+     * Returns the table buffer for writing. If the table shares a cached sample, the sample is
+     * first copied, as it may not be modified.
+     */
+    float *getWritableBuffer(int *length);
+  
+    /**
+     * Sets the length of the table, keeping its current contents. New samples are zero.
+     * Returns the new buffer. Previously returned buffers become invalid.
+     */
+    float *resize(int length);
+  
+    /**
+     * Sets the table to <code>length</code> samples of a channel of a cached sample, starting at
+     * the sample <code>offset</code>. The channel is used directly and is not copied.
+     */
+    void share(struct CachedSample *sample, int channelIndex, int offset, int length);
+  
+    /**
+     * Replaces the contents of the table with storage returned by <code>newStorage()</code>, which
+     * becomes owned by the table.
+     */
+    void adopt(float *storage, int length);
+  
+    /**
+     * Returns zeroed, aligned and guarded storage for the given number of samples, or
+     * <code>NULL</code> if it cannot be allocated. The samples begin at
+     * <code>DSP_TABLE_GUARD_LENGTH</code>. This function may be called by any thread.
+     */
+    static float *newStorage(int length);
+  
+    /**
+     * Sets the contents of the table starting at the given index. Values beyond the end of the
+     * table are ignored. This is used to set the contents of arrays saved with a patch.
+     */
+    void setValues(int startIndex, PdMessage *values, int firstElementIndex);
+  
+    /**
+     * Pd's 4-point interpolation of <code>table</code> at <code>index + fraction</code>. The
+     * samples at <code>index-1</code> through <code>index+2</code> are read. The guard samples
+     * of a table allow <code>index</code> to be anything in <code>[0, length-1]</code>.
+     */
+    static inline float interpolate4(float *table, int index, float fraction) {
+      float a = table[index-1];
+      float b = table[index];
+      float c = table[index+1];
+      float d = table[index+2];
+      float cminusb = c - b;
+      return b + fraction * (cminusb - 0.1666667f * (1.0f - fraction) *
+          ((d - a - 3.0f * cminusb) * fraction + (d + 2.0f * a - 3.0f * b)));
+    }
+  
+    #if __SSE2__
+    /** Computes <code>interpolate4()</code> for four indices at once. */
+    static inline __m128 interpolate4(float *table, __m128i index, __m128 fraction) {
+      int indices[4] __attribute__((aligned(16)));
+      _mm_store_si128((__m128i *) indices, index);
+      // gather four consecutive samples around each index and transpose them into a, b, c, d
+      __m128 a = _mm_loadu_ps(table + indices[0] - 1);
+      __m128 b = _mm_loadu_ps(table + indices[1] - 1);
+      __m128 c = _mm_loadu_ps(table + indices[2] - 1);
+      __m128 d = _mm_loadu_ps(table + indices[3] - 1);
+      _MM_TRANSPOSE4_PS(a, b, c, d);
+      __m128 cminusb = _mm_sub_ps(c, b);
+      __m128 three = _mm_set1_ps(3.0f);
+      __m128 x = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(d, a), _mm_mul_ps(three, cminusb)), fraction);
+      __m128 y = _mm_sub_ps(_mm_add_ps(d, _mm_add_ps(a, a)), _mm_mul_ps(three, b));
+      __m128 z = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.1666667f), _mm_sub_ps(_mm_set1_ps(1.0f), fraction)),
+          _mm_add_ps(x, y));
+      return _mm_add_ps(b, _mm_mul_ps(fraction, _mm_sub_ps(cminusb, z)));
+    }
+    #endif // __SSE2__
+  
+  private:
+    char *name;
+  
+    /** The start of the allocated memory, including the leading guard samples. */
+    float *storage;
+  
+    /** The cached sample which the table uses instead of its own storage, if any. */
+    struct CachedSample *sharedSample;
+    float *buffer;
+    int bufferLength;
 };
 
 #endif // _DSP_TABLE_H_
@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DspTable.h"
+#include "DspTableOsc4.h"
+#include "PdGraph.h"
+
+DspTableOsc4::DspTableOsc4(PdMessage *initMessage, PdGraph *graph) : DspObject(2, 1, 0, 1, graph) {
+  name = initMessage->isSymbol(0) ? StaticUtils::copyString(initMessage->getSymbol(0)) : NULL;
+  frequency = 0.0f;
+  phase = 0.0;
+}
+
+DspTableOsc4::~DspTableOsc4() {
+  free(name);
+}
+
+const char *DspTableOsc4::getObjectLabel() {
+  return "tabosc4~";
+}
+
+void DspTableOsc4::processMessage(int inletIndex, PdMessage *message) {
+  switch (inletIndex) {
+    case 0: {
+      if (message->isFloat(0)) {
+        frequency = message->getFloat(0);
+      } else if (message->isSymbol(0) && strcmp(message->getSymbol(0), "set") == 0 &&
+          message->isSymbol(1)) {
+        free(name);
+        name = StaticUtils::copyString(message->getSymbol(1));
+      }
+      break;
+    }
+    case 1: {
+      if (message->isFloat(0)) {
+        phase = message->getFloat(0);
+        phase -= floor(phase);
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+void DspTableOsc4::processDspWithIndex(int fromIndex, int toIndex) {
+  float *outputBuffer = localDspBufferAtOutlet[0];
+  DspTable *table = (name != NULL) ? graph->getTable(name) : NULL;
+  int length = 0;
+  float *buffer = (table != NULL) ? table->getBuffer(&length) : NULL;
+  if (length < 4) {
+    memset(outputBuffer + fromIndex, 0, (toIndex - fromIndex) * sizeof(float));
+    return;
+  }
+  
+  double period = (double) (length - 3);
+  double sampleDuration = 1.0 / (double) graph->getSampleRate();
+  float *inputBuffer = (signalPrecedence & 0x1) ? localDspBufferAtInlet[0] : NULL;
+  int i = fromIndex;
+  #if __SSE2__
+  // the phase is advanced in double precision, and four samples are interpolated at once
+  int indices[4] __attribute__((aligned(16)));
+  float fractions[4] __attribute__((aligned(16)));
+  for (; i <= toIndex - 4; i += 4) {
+    for (int j = 0; j < 4; j++) {
+      double position = phase * period;
+      int index = (int) position;
+      indices[j] = index + 1;
+      fractions[j] = (float) (position - (double) index);
+      phase += ((inputBuffer != NULL) ? inputBuffer[i+j] : frequency) * sampleDuration;
+      phase -= floor(phase);
+    }
+    _mm_storeu_ps(outputBuffer + i, DspTable::interpolate4(buffer,
+        _mm_load_si128((__m128i *) indices), _mm_load_ps(fractions)));
+  }
+  #endif // __SSE2__
+  for (; i < toIndex; i++) {
+    double position = phase * period;
+    int index = (int) position;
+    outputBuffer[i] = DspTable::interpolate4(buffer, index + 1, (float) (position - (double) index));
+    phase += ((inputBuffer != NULL) ? inputBuffer[i] : frequency) * sampleDuration;
+    phase -= floor(phase);
+  }
+}
@@ -0,0 +1,54 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DSP_TABLE_OSC4_H_
+#define _DSP_TABLE_OSC4_H_
+
+#include "DspObject.h"
+
+/**
+ * [tabosc4~ name]
+ * A wavetable oscillator with 4-point interpolation. As in Pd, one period of the waveform is
+ * <code>length-3</code> samples, starting at the second sample of the table. The frequency is
+ * set by the left inlet (signal or message), and the phase by the right inlet.
+ */
+class DspTableOsc4 : public DspObject {
+  
+  public:
+    DspTableOsc4(PdMessage *initMessage, PdGraph *graph);
+    ~DspTableOsc4();
+  
+    const char *getObjectLabel();
+  
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+    void processDspWithIndex(int fromIndex, int toIndex);
+  
+    /** The name of the table. It is looked up every block, so the table may come and go. */
+    char *name;
+    float frequency;
+  
+    /** The phase in <code>[0,1)</code>. It is kept in double precision such that it does not drift. */
+    double phase;
+};
+
+#endif // _DSP_TABLE_OSC4_H_
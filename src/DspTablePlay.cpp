@@ -1,5 +1,5 @@
 /*
- *  Copyright 2009 Reality Jockey, Ltd.
+ *  Copyright 2009,2010 Reality Jockey, Ltd.
  *                 info@rjdj.me
  *                 http://rjdj.me/
  * 
@@ -22,105 +22,87 @@
 
 #include "DspTable.h"
 #include "DspTablePlay.h"
+#include "PdGraph.h"
 
-DspTablePlay::DspTablePlay(int blockSize, PdGraph *pdGraph, char *initString) : 
-    RemoteBufferReceiverObject(NULL, blockSize, initString) {
-  this->pdGraph = pdGraph;
-  startIndex = 0;
-  currentIndex = 0;
-  endIndex = -1; // run all the way to the end
-}
-
-DspTablePlay::DspTablePlay(char *tag, int blockSize, PdGraph *pdGraph, char *initString) : 
-    RemoteBufferReceiverObject(tag, blockSize, initString) {
-  this->pdGraph = pdGraph;
-  startIndex = 0;
+DspTablePlay::DspTablePlay(PdMessage *initMessage, PdGraph *graph) : DspObject(1, 0, 2, 1, graph) {
+  name = initMessage->isSymbol(0) ? StaticUtils::copyString(initMessage->getSymbol(0)) : NULL;
+  isPlaying = false;
   currentIndex = 0;
   endIndex = -1;
 }
 
 DspTablePlay::~DspTablePlay() {
-  // nothing to do
+  free(name);
 }
 
-inline void DspTablePlay::processMessage(int inletIndex, PdMessage *message) {
-  if (inletIndex == 0) {
-    MessageElement *messageElement0 = message->getElement(0);
-    switch (messageElement0->getType()) {
-      case FLOAT: {
-        MessageElement *messageElement1 = message->getElement(1);
-        if (messageElement1 != NULL && messageElement1->getType() == FLOAT) {
-          startIndex = messageElement0->getFloat();
-          endIndex = startIndex + messageElement1->getFloat();
-        } else {
-          startIndex = messageElement0->getFloat();
-          endIndex = -1;
-        }
-        break;
-      }
-      case SYMBOL: {
-        if (strcmp(messageElement0->getSymbol(), "set") == 0) {
-          MessageElement *messageElement1 = message->getElement(1);
-          if (messageElement1 != NULL && messageElement1->getType() == SYMBOL) {
-            DspTable *newTable = pdGraph->getTable(messageElement1->getSymbol());
-            if (newTable != NULL) {
-              processDspToIndex(message->getBlockIndex());
-              blockIndexOfLastMessage = message->getBlockIndex();
-              setRemoteBuffer(newTable);
-            }
-          }
-        }
-        break;
-      }
-      case BANG: {
-        // reset the playback
-        processDspToIndex(message->getBlockIndex());
-        startIndex = 0;
-        currentIndex = 0;
-        endIndex = -1; // run all the way to the end
-        break;
-      }
-      default: {
-        break;
-      }
+const char *DspTablePlay::getObjectLabel() {
+  return "tabplay~";
+}
+
+ConnectionType DspTablePlay::getConnectionType(int outletIndex) {
+  return (outletIndex == 0) ? DSP : MESSAGE;
+}
+
+void DspTablePlay::processMessage(int inletIndex, PdMessage *message) {
+  switch (message->getType(0)) {
+    case BANG: {
+      play(0, -1);
+      break;
+    }
+    case FLOAT: {
+      play((int) message->getFloat(0), message->isFloat(1) ? (int) message->getFloat(1) : -1);
+      break;
     }
-    
-    
-    if (message->getNumElements() > 1) {
-      MessageElement *messageElement0 = message->getElement(0);
-      if (messageElement0 != NULL && messageElement0->getType() == SYMBOL &&
-          strcmp(messageElement0->getSymbol(), "set") == 0) {
-        MessageElement *messageElement1 = message->getElement(1);
-        if (messageElement1 != NULL && messageElement1->getType() == SYMBOL) {
-          DspTable *newTable = pdGraph->getTable(messageElement1->getSymbol());
-          if (newTable != NULL) {
-            processDspToIndex(message->getBlockIndex());
-            blockIndexOfLastMessage = message->getBlockIndex();
-            setRemoteBuffer(newTable);
-          }
-        }
+    case SYMBOL: {
+      if (strcmp(message->getSymbol(0), "set") == 0 && message->isSymbol(1)) {
+        free(name);
+        name = StaticUtils::copyString(message->getSymbol(1));
+        isPlaying = false;
+      } else if (strcmp(message->getSymbol(0), "stop") == 0) {
+        isPlaying = false;
       }
+      break;
+    }
+    default: {
+      break;
     }
   }
 }
 
-inline void DspTablePlay::processDspToIndex(int newBlockIndex) {
-  /*
-  int processLength = newBlockIndex - blockIndexOfLastMessage;
-  if (remoteBuffer != NULL && processLength > 0) {
-    int headIndex;
-    int bufferLength;
-    float *buffer = remoteBuffer->getBuffer(&headIndex, &bufferLength);
-    float *outputBuffer = localDspBufferAtOutlet[0];
-    int readIndex = headIndex - delayInSamples - (blockSize - blockIndexOfLastMessage);
-    if (readIndex < 0) {
-      readIndex += bufferLength;
-      // WARNING: this code does not account for the requested buffer length exceeding
-      // the buffer's limits
+void DspTablePlay::play(int startIndex, int length) {
+  currentIndex = (startIndex > 0) ? startIndex : 0;
+  endIndex = (length >= 0) ? currentIndex + length : -1;
+  isPlaying = true;
+}
+
+void DspTablePlay::processDspWithIndex(int fromIndex, int toIndex) {
+  float *outputBuffer = localDspBufferAtOutlet[0];
+  if (isPlaying && fromIndex < toIndex) {
+    DspTable *table = (name != NULL) ? graph->getTable(name) : NULL;
+    int length = 0;
+    float *buffer = (table != NULL) ? table->getBuffer(&length) : NULL;
+    if (endIndex >= 0 && endIndex < length) {
+      length = endIndex; // stop before the end of the table
+    }
+    int numSamples = length - currentIndex;
+    if (numSamples > toIndex - fromIndex) {
+      numSamples = toIndex - fromIndex;
+    }
+    if (numSamples > 0) {
+      memcpy(outputBuffer + fromIndex, buffer + currentIndex, numSamples * sizeof(float));
+      currentIndex += numSamples;
+      fromIndex += numSamples;
+    }
+    if (currentIndex >= length) {
+      isPlaying = false;
+      // the end of playback is announced at the beginning of the next block
+      PdMessage *outgoingMessage = getNextOutgoingMessage(1);
+      outgoingMessage->setTimestamp(0);
+      outgoingMessage->getElement(0)->setBang();
+      graph->scheduleMessage(this, 1, outgoingMessage);
     }
-    memcpy(localDspBufferAtOutlet[0] + blockIndexOfLastMessage, 
-        buffer + readIndex, processLength * sizeof(float));
-    blockIndexOfLastMessage = newBlockIndex;
   }
-   */
-}
\ No newline at end of file
+  if (fromIndex < toIndex) {
+    memset(outputBuffer + fromIndex, 0, (toIndex - fromIndex) * sizeof(float));
+  }
+}
@@ -1,5 +1,5 @@
 /*
- *  Copyright 2009 Reality Jockey, Ltd.
+ *  Copyright 2009,2010 Reality Jockey, Ltd.
  *                 info@rjdj.me
  *                 http://rjdj.me/
  * 
@@ -23,29 +23,37 @@
 #ifndef _DSP_TABLE_PLAY_H_
 #define _DSP_TABLE_PLAY_H_
 
-#include "PdGraph.h"
-#include "RemoteBufferReceiverObject.h"
+#include "DspObject.h"
 
 /**
- * tabplay~
- * This object technically has a right outlet. But I'm not sure what it does
- * and no one seems to use it.
+ * [tabplay~ name]
+ * Plays a table once. A bang plays the whole table, a float plays from the given sample, and a
+ * list of two floats plays the given number of samples from the given sample. The right outlet
+ * bangs when playback finishes.
  */
-class DspTablePlay : public RemoteBufferReceiverObject {
+class DspTablePlay : public DspObject {
   
   public:
-    DspTablePlay(int blockSize, PdGraph *pdGraph, char *initString);
-    DspTablePlay(char *tag, int blockSize, PdGraph *pdGraph, char *initString);
+    DspTablePlay(PdMessage *initMessage, PdGraph *graph);
     ~DspTablePlay();
-    
-  protected:
-    inline void processMessage(int inletIndex, PdMessage *message);
-    inline void processDspToIndex(int newBlockIndex);
+  
+    const char *getObjectLabel();
+  
+    ConnectionType getConnectionType(int outletIndex);
     
   private:
-    PdGraph *pdGraph;
-    int startIndex;
+    void processMessage(int inletIndex, PdMessage *message);
+    void processDspWithIndex(int fromIndex, int toIndex);
+  
+    /** Starts playback at the given index. A negative length plays to the end of the table. */
+    void play(int startIndex, int length);
+  
+    /** The name of the table. It is looked up every block, so the table may come and go. */
+    char *name;
+    bool isPlaying;
     int currentIndex;
+  
+    /** The index at which playback stops. A negative value stops at the end of the table. */
     int endIndex;
 };
 
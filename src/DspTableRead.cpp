@@ -1,5 +1,5 @@
 /*
- *  Copyright 2009 Reality Jockey, Ltd.
+ *  Copyright 2009,2010 Reality Jockey, Ltd.
  *                 info@rjdj.me
  *                 http://rjdj.me/
  * 
@@ -20,63 +20,43 @@
  *
  */
 
-#include <math.h>
 #include "DspTable.h"
 #include "DspTableRead.h"
+#include "PdGraph.h"
 
-DspTableRead::DspTableRead(char *tag, int blockSize, PdGraph *pdGraph, char *initString) : 
-    RemoteBufferReceiverObject(tag, blockSize, initString) {
-  this->pdGraph = pdGraph;
+DspTableRead::DspTableRead(PdMessage *initMessage, PdGraph *graph) : DspObject(1, 1, 0, 1, graph) {
+  name = initMessage->isSymbol(0) ? StaticUtils::copyString(initMessage->getSymbol(0)) : NULL;
 }
 
 DspTableRead::~DspTableRead() {
-  // nothing to do
+  free(name);
 }
 
-inline void DspTableRead::processMessage(int inletIndex, PdMessage *message) {
-  if (inletIndex == 0) {
-    if (message->getNumElements() > 1) {
-      MessageElement *messageElement0 = message->getElement(0);
-      if (messageElement0 != NULL && messageElement0->getType() == SYMBOL &&
-          strcmp(messageElement0->getSymbol(), "set") == 0) {
-        MessageElement *messageElement1 = message->getElement(1);
-        if (messageElement1 != NULL && messageElement1->getType() == SYMBOL) {
-          DspTable *newTable = pdGraph->getTable(messageElement1->getSymbol());
-          if (newTable != NULL) {
-            processDspToIndex(message->getBlockIndex());
-            blockIndexOfLastMessage = message->getBlockIndex();
-            setRemoteBuffer(newTable);
-          }
-        }
-      }
-    }
+const char *DspTableRead::getObjectLabel() {
+  return "tabread~";
+}
+
+void DspTableRead::processMessage(int inletIndex, PdMessage *message) {
+  if (message->isSymbol(0) && strcmp(message->getSymbol(0), "set") == 0 && message->isSymbol(1)) {
+    free(name);
+    name = StaticUtils::copyString(message->getSymbol(1));
   }
 }
 
-inline void DspTableRead::processDspToIndex(int newBlockIndex) {
-  int headIndex;
-  int bufferLength;
-  float *buffer = remoteBuffer->getBuffer(&headIndex, &bufferLength);
-  float bufferLengthFloat = (float) bufferLength;
-  float *inputBuffer = localDspBufferAtInlet[0];
+void DspTableRead::processDspWithIndex(int fromIndex, int toIndex) {
   float *outputBuffer = localDspBufferAtOutlet[0];
-  for (int i = blockIndexOfLastMessage; i < newBlockIndex; i++) {
-    if (inputBuffer[i] < 0.0f) {
-      outputBuffer[i] = 0.0f;
-    } else if (inputBuffer[i] > (bufferLengthFloat-1.0f)) {
-      outputBuffer[i] = 0.0f;
-    } else {
-      float floorX = floorf(inputBuffer[i]);
-      float ceilX = ceilf(inputBuffer[i]);
-      if (floorX == ceilX) {
-        outputBuffer[i] = buffer[(int) floorX];
-      } else {
-        // 2-point linear interpolation
-        float y0 = buffer[(int) floorX];
-        float y1 = (ceilX >= bufferLengthFloat) ? 0.0f : buffer[(int) ceilX];
-        float slope = (y1 - y0) / (ceilX - floorX);
-        outputBuffer[i] = (slope * (inputBuffer[i] - floorX)) + y0;
-      }
+  DspTable *table = (name != NULL) ? graph->getTable(name) : NULL;
+  if (table == NULL) {
+    memset(outputBuffer + fromIndex, 0, (toIndex - fromIndex) * sizeof(float));
+  } else {
+    int length;
+    float *buffer = table->getBuffer(&length);
+    float *inputBuffer = localDspBufferAtInlet[0];
+    float maxIndex = (float) (length - 1);
+    for (int i = fromIndex; i < toIndex; i++) {
+      // written such that NaN indices read the first sample
+      float index = (inputBuffer[i] > 0.0f) ? inputBuffer[i] : 0.0f;
+      outputBuffer[i] = buffer[(int) ((index < maxIndex) ? index : maxIndex)];
     }
   }
 }
@@ -1,5 +1,5 @@
 /*
- *  Copyright 2009 Reality Jockey, Ltd.
+ *  Copyright 2009,2010 Reality Jockey, Ltd.
  *                 info@rjdj.me
  *                 http://rjdj.me/
  * 
@@ -23,24 +23,26 @@
 #ifndef _DSP_TABLE_READ_H_
 #define _DSP_TABLE_READ_H_
 
-#include "PdGraph.h"
-#include "RemoteBufferReceiverObject.h"
+#include "DspObject.h"
 
 /**
- * tabread4~
+ * [tabread~ name]
+ * Reads a table without interpolation. The index is truncated and limited to the table.
  */
-class DspTableRead : public RemoteBufferReceiverObject {
+class DspTableRead : public DspObject {
   
   public:
-    DspTableRead(char *tag, int blockSize, PdGraph *pdGraph, char *initString);
+    DspTableRead(PdMessage *initMessage, PdGraph *graph);
     ~DspTableRead();
   
-  protected:
-    inline void processMessage(int inletIndex, PdMessage *message);
-    inline void processDspToIndex(int newBlockIndex);
-    
+    const char *getObjectLabel();
+  
   private:
-    PdGraph *pdGraph;
+    void processMessage(int inletIndex, PdMessage *message);
+    void processDspWithIndex(int fromIndex, int toIndex);
+  
+    /** The name of the table. It is looked up every block, so the table may come and go. */
+    char *name;
 };
 
 #endif // _DSP_TABLE_READ_H_
@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DspTable.h"
+#include "DspTableRead4.h"
+#include "PdGraph.h"
+
+DspTableRead4::DspTableRead4(PdMessage *initMessage, PdGraph *graph) : DspObject(1, 1, 0, 1, graph) {
+  name = initMessage->isSymbol(0) ? StaticUtils::copyString(initMessage->getSymbol(0)) : NULL;
+}
+
+DspTableRead4::~DspTableRead4() {
+  free(name);
+}
+
+const char *DspTableRead4::getObjectLabel() {
+  return "tabread4~";
+}
+
+void DspTableRead4::processMessage(int inletIndex, PdMessage *message) {
+  if (message->isSymbol(0) && strcmp(message->getSymbol(0), "set") == 0 && message->isSymbol(1)) {
+    free(name);
+    name = StaticUtils::copyString(message->getSymbol(1));
+  }
+}
+
+void DspTableRead4::processDspWithIndex(int fromIndex, int toIndex) {
+  float *outputBuffer = localDspBufferAtOutlet[0];
+  DspTable *table = (name != NULL) ? graph->getTable(name) : NULL;
+  int length = 0;
+  float *buffer = (table != NULL) ? table->getBuffer(&length) : NULL;
+  if (length < 3) {
+    // there must be at least one sample with a neighbour on either side
+    memset(outputBuffer + fromIndex, 0, (toIndex - fromIndex) * sizeof(float));
+  } else {
+    /*
+     * The index is limited with min/max instead of branches. The guard samples of the table
+     * cover the neighbours read beyond either end. NaN indices read the second sample.
+     */
+    float *inputBuffer = localDspBufferAtInlet[0];
+    float maxIndex = (float) (length - 2);
+    int i = fromIndex;
+    #if __SSE2__
+    __m128 minVec = _mm_set1_ps(1.0f);
+    __m128 maxVec = _mm_set1_ps(maxIndex);
+    for (; i <= toIndex - 4; i += 4) {
+      __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(inputBuffer + i), minVec), maxVec);
+      __m128i index = _mm_cvttps_epi32(x);
+      __m128 fraction = _mm_sub_ps(x, _mm_cvtepi32_ps(index));
+      _mm_storeu_ps(outputBuffer + i, DspTable::interpolate4(buffer, index, fraction));
+    }
+    #endif // __SSE2__
+    for (; i < toIndex; i++) {
+      float x = (inputBuffer[i] > 1.0f) ? inputBuffer[i] : 1.0f;
+      x = (x < maxIndex) ? x : maxIndex;
+      int index = (int) x;
+      outputBuffer[i] = DspTable::interpolate4(buffer, index, x - (float) index);
+    }
+  }
+}
@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DspTable.h"
+#include "DspTableWrite.h"
+#include "PdGraph.h"
+
+DspTableWrite::DspTableWrite(PdMessage *initMessage, PdGraph *graph) : DspObject(1, 1, 0, 0, graph) {
+  name = initMessage->isSymbol(0) ? StaticUtils::copyString(initMessage->getSymbol(0)) : NULL;
+  isRecording = false;
+  currentIndex = 0;
+}
+
+DspTableWrite::~DspTableWrite() {
+  free(name);
+}
+
+const char *DspTableWrite::getObjectLabel() {
+  return "tabwrite~";
+}
+
+void DspTableWrite::processMessage(int inletIndex, PdMessage *message) {
+  switch (message->getType(0)) {
+    case BANG: {
+      currentIndex = 0;
+      isRecording = true;
+      break;
+    }
+    case SYMBOL: {
+      if (strcmp(message->getSymbol(0), "start") == 0) {
+        currentIndex = (message->isFloat(1) && message->getFloat(1) > 0.0f) ? (int) message->getFloat(1) : 0;
+        isRecording = true;
+      } else if (strcmp(message->getSymbol(0), "stop") == 0) {
+        isRecording = false;
+      } else if (strcmp(message->getSymbol(0), "set") == 0 && message->isSymbol(1)) {
+        free(name);
+        name = StaticUtils::copyString(message->getSymbol(1));
+        isRecording = false;
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+void DspTableWrite::processDspWithIndex(int fromIndex, int toIndex) {
+  if (isRecording && fromIndex < toIndex) {
+    DspTable *table = (name != NULL) ? graph->getTable(name) : NULL;
+    int length = 0;
+    float *buffer = (table != NULL) ? table->getWritableBuffer(&length) : NULL;
+    int numSamples = length - currentIndex;
+    if (numSamples > toIndex - fromIndex) {
+      numSamples = toIndex - fromIndex;
+    }
+    if (numSamples > 0) {
+      memcpy(buffer + currentIndex, localDspBufferAtInlet[0] + fromIndex, numSamples * sizeof(float));
+      currentIndex += numSamples;
+    }
+    if (currentIndex >= length) {
+      isRecording = false; // the table is full
+    }
+  }
+}
@@ -0,0 +1,52 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DSP_TABLE_WRITE_H_
+#define _DSP_TABLE_WRITE_H_
+
+#include "DspObject.h"
+
+/**
+ * [tabwrite~ name]
+ * Records a signal into a table. A bang or <code>start</code> records from the beginning of the
+ * table, <code>start float</code> records from the given sample. Recording stops when the table
+ * is full or on <code>stop</code>.
+ */
+class DspTableWrite : public DspObject {
+  
+  public:
+    DspTableWrite(PdMessage *initMessage, PdGraph *graph);
+    ~DspTableWrite();
+  
+    const char *getObjectLabel();
+  
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+    void processDspWithIndex(int fromIndex, int toIndex);
+  
+    /** The name of the table. It is looked up every block, so the table may come and go. */
+    char *name;
+    bool isRecording;
+    int currentIndex;
+};
+
+#endif // _DSP_TABLE_WRITE_H_
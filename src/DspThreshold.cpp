@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArrayArithmetic.h"
+#include "DspThreshold.h"
+#include "PdGraph.h"
+
+DspThreshold::DspThreshold(PdMessage *initMessage, PdGraph *graph) : DspObject(1, 1, 2, 0, graph) {
+  isTriggered = false;
+  numDeadSamples = 0;
+  setThresholds(initMessage, 0);
+}
+
+DspThreshold::~DspThreshold() {
+  // nothing to do
+}
+
+const char *DspThreshold::getObjectLabel() {
+  return "threshold~";
+}
+
+ConnectionType DspThreshold::getConnectionType(int outletIndex) {
+  return MESSAGE;
+}
+
+void DspThreshold::setThresholds(PdMessage *message, int index) {
+  triggerThreshold = message->isFloat(index) ? message->getFloat(index) : 0.0f;
+  float triggerDeadMs = message->isFloat(index+1) ? message->getFloat(index+1) : 0.0f;
+  restThreshold = message->isFloat(index+2) ? message->getFloat(index+2) : 0.0f;
+  float restDeadMs = message->isFloat(index+3) ? message->getFloat(index+3) : 0.0f;
+  
+  // the signal must be able to rest while triggered
+  if (restThreshold > triggerThreshold) {
+    restThreshold = triggerThreshold;
+  }
+  triggerDeadSamples = (triggerDeadMs > 0.0f) ?
+      (int) StaticUtils::millisecondsToSamples(triggerDeadMs, graph->getSampleRate()) : 0;
+  restDeadSamples = (restDeadMs > 0.0f) ?
+      (int) StaticUtils::millisecondsToSamples(restDeadMs, graph->getSampleRate()) : 0;
+}
+
+void DspThreshold::processMessage(int inletIndex, PdMessage *message) {
+  if (message->isSymbol(0)) {
+    if (strcmp(message->getSymbol(0), "set") == 0) {
+      setThresholds(message, 1);
+    } else if (strcmp(message->getSymbol(0), "state") == 0) {
+      isTriggered = message->isFloat(1) && message->getFloat(1) != 0.0f;
+      numDeadSamples = 0;
+    } else {
+      graph->printErr("threshold~ does not understand the message \"%s\".\n", message->getSymbol(0));
+    }
+  }
+}
+
+void DspThreshold::processDspWithIndex(int fromIndex, int toIndex) {
+  float *inputBuffer = localDspBufferAtInlet[0];
+  int i = fromIndex;
+  while (i < toIndex) {
+    if (numDeadSamples > 0) {
+      int numSkipped = (toIndex - i < numDeadSamples) ? (toIndex - i) : numDeadSamples;
+      numDeadSamples -= numSkipped;
+      i += numSkipped;
+    } else if (isTriggered) {
+      i = ArrayArithmetic::findLessThan(inputBuffer, restThreshold, i, toIndex);
+      if (i < toIndex) {
+        isTriggered = false;
+        sendBang(1, i);
+        numDeadSamples = restDeadSamples;
+        i++;
+      }
+    } else {
+      i = ArrayArithmetic::findGreaterThanOrEqual(inputBuffer, triggerThreshold, i, toIndex);
+      if (i < toIndex) {
+        isTriggered = true;
+        sendBang(0, i);
+        numDeadSamples = triggerDeadSamples;
+        i++;
+      }
+    }
+  }
+}
+
+void DspThreshold::sendBang(int outletIndex, int blockIndex) {
+  PdMessage *outgoingMessage = getNextOutgoingMessage(outletIndex);
+  // the crossing has already passed, so the bang follows it by exactly one block. It thus arrives
+  // at the same block index in the next block, and the interval between bangs is preserved.
+  outgoingMessage->setTimestamp(graph->getBlockStartTimestamp() +
+      (blockSizeInt + blockIndex) * ZG_TIME_ONE_SAMPLE);
+  outgoingMessage->getElement(0)->setBang();
+  graph->scheduleMessage(this, outletIndex, outgoingMessage);
+}
@@ -0,0 +1,67 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DSP_THRESHOLD_H_
+#define _DSP_THRESHOLD_H_
+
+#include "DspObject.h"
+
+/**
+ * [threshold~ float float float float]
+ * <br>
+ * Bangs the left outlet when the signal rises to the trigger threshold and the right outlet when
+ * it then falls below the rest threshold. After each bang, the signal is ignored for the given
+ * dead time in milliseconds. The block is scanned four samples at a time, and each bang is
+ * scheduled exactly one block after the sample of its crossing.
+ */
+class DspThreshold : public DspObject {
+  
+  public:
+    DspThreshold(PdMessage *initMessage, PdGraph *graph);
+    ~DspThreshold();
+  
+    const char *getObjectLabel();
+  
+    ConnectionType getConnectionType(int outletIndex);
+  
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+    void processDspWithIndex(int fromIndex, int toIndex);
+  
+    /** Sets both thresholds and dead times, as given in the creation arguments. */
+    void setThresholds(PdMessage *message, int index);
+  
+    /** Schedules a bang at the given outlet and block index. */
+    void sendBang(int outletIndex, int blockIndex);
+  
+    float triggerThreshold;
+    float restThreshold;
+    int triggerDeadSamples;
+    int restDeadSamples;
+  
+    bool isTriggered;
+  
+    /** The number of samples which are still ignored after the last bang. */
+    int numDeadSamples;
+};
+
+#endif // _DSP_THRESHOLD_H_
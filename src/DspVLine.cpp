@@ -0,0 +1,184 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArrayArithmetic.h"
+#include "DspVLine.h"
+#include "PdGraph.h"
+
+DspVLine::DspVLine(PdGraph *graph) : DspObject(3, 0, 0, 1, graph) {
+  segments = (VLineSegment *) malloc(MAX_SEGMENTS * sizeof(VLineSegment));
+  firstSegmentIndex = 0;
+  numSegments = 0;
+  rampTimeMs = 0.0f;
+  delayMs = 0.0f;
+  rampStartTime = 0;
+  rampEndTime = 0;
+  rampStartValue = 0.0f;
+  rampTarget = 0.0f;
+}
+
+DspVLine::~DspVLine() {
+  free(segments);
+}
+
+const char *DspVLine::getObjectLabel() {
+  return "vline~";
+}
+
+void DspVLine::processMessage(int inletIndex, PdMessage *message) {
+  switch (inletIndex) {
+    case 0: {
+      if (message->isFloat(0)) {
+        // a list sets the ramp time and delay along with the target
+        float rampTime = message->isFloat(1) ? message->getFloat(1) : rampTimeMs;
+        float delay = message->isFloat(2) ? message->getFloat(2) : delayMs;
+        float sampleRate = graph->getSampleRate();
+        ZGTime startTime = message->getTimestamp() +
+            ZGTimeUtils::fromMilliseconds((delay > 0.0f) ? delay : 0.0f, sampleRate);
+        ZGTime duration = (rampTime > 0.0f) ? ZGTimeUtils::fromMilliseconds(rampTime, sampleRate) : 0;
+        addSegment(startTime, duration, message->getFloat(0), false);
+        rampTimeMs = 0.0f;
+        delayMs = 0.0f;
+      } else if (message->isSymbol(0) && strcmp(message->getSymbol(0), "stop") == 0) {
+        addSegment(message->getTimestamp(), 0, 0.0f, true);
+      }
+      break;
+    }
+    case 1: {
+      if (message->isFloat(0)) {
+        rampTimeMs = message->getFloat(0);
+      }
+      break;
+    }
+    case 2: {
+      if (message->isFloat(0)) {
+        delayMs = message->getFloat(0);
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+void DspVLine::addSegment(ZGTime startTime, ZGTime duration, float target, bool isStop) {
+  // messages from before this block (e.g., from the host) start at its beginning
+  ZGTime blockStartTime = graph->getBlockStartTimestamp();
+  if (startTime < blockStartTime) {
+    startTime = blockStartTime;
+  }
+  
+  // remove the segments which would start later. One which starts at the same time is only kept if
+  // it is a jump and the new segment is a ramp, such that e.g. "0, 1 100" ramps up from zero.
+  while (numSegments > 0) {
+    VLineSegment *lastSegment = getSegment(numSegments-1);
+    if (lastSegment->startTime > startTime ||
+        (lastSegment->startTime == startTime && (lastSegment->duration > 0 || duration <= 0))) {
+      numSegments--;
+    } else {
+      break;
+    }
+  }
+  
+  if (numSegments == MAX_SEGMENTS) {
+    graph->printErr("vline~: more than %i segments are scheduled. The new one is ignored.\n",
+        MAX_SEGMENTS);
+    return;
+  }
+  VLineSegment *segment = getSegment(numSegments++);
+  segment->startTime = startTime;
+  segment->duration = duration;
+  segment->target = target;
+  segment->isStop = isStop;
+}
+
+float DspVLine::getValueAtTime(ZGTime time) {
+  if (time >= rampEndTime) {
+    return rampTarget;
+  } else if (time <= rampStartTime) {
+    return rampStartValue;
+  } else {
+    double position = ((double) (time - rampStartTime)) / ((double) (rampEndTime - rampStartTime));
+    return rampStartValue + (float) (position * (double) (rampTarget - rampStartValue));
+  }
+}
+
+void DspVLine::processDsp() {
+  // Segments carry their own start times, so the block is computed only once all of its messages
+  // have been received. Otherwise a segment starting within a sample would miss that sample.
+  MessageLetPair *messageLetPair = NULL;
+  while ((messageLetPair = (MessageLetPair *) messageQueue->remove(0)) != NULL) {
+    processMessage(messageLetPair->index, messageLetPair->message);
+    messageLetPair->message->unreserve(this);
+  }
+  
+  ZGTime blockStartTime = graph->getBlockStartTimestamp();
+  int fromIndex = 0;
+  while (numSegments > 0) {
+    VLineSegment *segment = getSegment(0);
+    // the first sample which ends after the segment has started
+    ZGTime startOffset = segment->startTime - blockStartTime;
+    int startIndex = (int) (startOffset >> ZG_TIME_FRACTIONAL_BITS);
+    if (startIndex >= blockSizeInt) {
+      break; // the segment starts in a later block
+    }
+    processRamp(fromIndex, startIndex);
+    fromIndex = (startIndex > fromIndex) ? startIndex : fromIndex;
+    
+    // the new ramp starts from wherever the line is at that time
+    rampStartValue = getValueAtTime(segment->startTime);
+    rampStartTime = segment->startTime;
+    if (segment->isStop) {
+      rampEndTime = rampStartTime;
+      rampTarget = rampStartValue;
+    } else {
+      rampEndTime = rampStartTime + segment->duration;
+      rampTarget = segment->target;
+    }
+    firstSegmentIndex = (firstSegmentIndex + 1) % MAX_SEGMENTS;
+    numSegments--;
+  }
+  processRamp(fromIndex, blockSizeInt);
+}
+
+void DspVLine::processRamp(int fromIndex, int toIndex) {
+  if (fromIndex >= toIndex) {
+    return;
+  }
+  float *outputBuffer = localDspBufferAtOutlet[0];
+  ZGTime blockStartTime = graph->getBlockStartTimestamp();
+  
+  // samples which end before the end of the ramp lie on it, the remainder is at the target
+  ZGTime endOffset = rampEndTime - blockStartTime;
+  int rampIndex = fromIndex;
+  if (endOffset > ((ZGTime) fromIndex + 1) * ZG_TIME_ONE_SAMPLE) {
+    rampIndex = (int) ((endOffset + ZG_TIME_ONE_SAMPLE - 1) >> ZG_TIME_FRACTIONAL_BITS) - 1;
+    rampIndex = (rampIndex < toIndex) ? rampIndex : toIndex;
+    
+    float start = getValueAtTime(blockStartTime + ((ZGTime) fromIndex + 1) * ZG_TIME_ONE_SAMPLE);
+    double slope = ((double) (rampTarget - rampStartValue)) * (double) ZG_TIME_ONE_SAMPLE /
+        (double) (rampEndTime - rampStartTime);
+    ArrayArithmetic::ramp(outputBuffer, start, (float) slope, fromIndex, rampIndex);
+  }
+  ArrayArithmetic::fill(outputBuffer, rampTarget, rampIndex, toIndex);
+}
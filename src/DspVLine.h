@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DSP_VLINE_H_
+#define _DSP_VLINE_H_
+
+#include "DspObject.h"
+
+/** A ramp which is scheduled to start at a given time. */
+typedef struct {
+  ZGTime startTime;
+  ZGTime duration; // zero for a jump
+  float target;
+  bool isStop; // the line holds its value from startTime on
+} VLineSegment;
+
+/**
+ * [vline~]
+ * <br>
+ * A ramp generator whose segments start at the exact (sub-sample) time of their message plus an
+ * optional delay in milliseconds, given to the right inlet. The middle inlet sets the ramp time.
+ * Both are reset to zero after each segment. A new segment cancels all segments which are
+ * scheduled to start after it. Each output sample is the value of the line at its end, as with
+ * [line~]. Ramps are computed directly from their start and end points.
+ */
+class DspVLine : public DspObject {
+  
+  public:
+    DspVLine(PdGraph *graph);
+    ~DspVLine();
+  
+    const char *getObjectLabel();
+  
+    void processDsp();
+    
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+  
+    /** Schedules a segment, removing those which it cancels. */
+    void addSegment(ZGTime startTime, ZGTime duration, float target, bool isStop);
+  
+    /** Returns the scheduled segment at the given index, counted from the next one to start. */
+    inline VLineSegment *getSegment(int index) {
+      return segments + ((firstSegmentIndex + index) % MAX_SEGMENTS);
+    }
+  
+    /** Returns the value of the current ramp at the given time. */
+    float getValueAtTime(ZGTime time);
+  
+    /** Computes the current ramp in the sample range [fromIndex, toIndex). */
+    void processRamp(int fromIndex, int toIndex);
+  
+    /** The maximum number of segments which may be scheduled at any time. */
+    static const int MAX_SEGMENTS = 64;
+  
+    /**
+     * The segments which have not started yet, in order of their start time. They are held in a
+     * ring of <code>MAX_SEGMENTS</code> preallocated segments, such that none are allocated while
+     * the graph is processed.
+     */
+    VLineSegment *segments;
+    int firstSegmentIndex;
+    int numSegments;
+  
+    float rampTimeMs; // from the middle inlet
+    float delayMs; // from the right inlet
+  
+    // the current ramp. The line is at rampTarget from rampEndTime on.
+    ZGTime rampStartTime;
+    ZGTime rampEndTime;
+    float rampStartValue;
+    float rampTarget;
+};
+
+#endif // _DSP_VLINE_H_
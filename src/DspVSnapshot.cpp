@@ -0,0 +1,74 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DspVSnapshot.h"
+#include "PdGraph.h"
+
+DspVSnapshot::DspVSnapshot(PdMessage *initMessage, PdGraph *graph) : DspObject(1, 1, 1, 0, graph) {
+  // nothing to do
+}
+
+DspVSnapshot::~DspVSnapshot() {
+  // nothing to do
+}
+
+const char *DspVSnapshot::getObjectLabel() {
+  return "vsnapshot~";
+}
+
+ConnectionType DspVSnapshot::getConnectionType(int outletIndex) {
+  return MESSAGE;
+}
+
+void DspVSnapshot::processMessage(int inletIndex, PdMessage *message) {
+  switch (message->getType(0)) {
+    case SYMBOL: {
+      graph->printErr("vsnapshot~ does not support the \"set\" message.\n");
+      break;
+    }
+    case BANG: {
+      float blockIndex = message->getBlockIndex(graph->getBlockStartTimestamp());
+      if (blockIndex < 0.0f) {
+        blockIndex = 0.0f;
+      }
+      int index = (int) blockIndex;
+      if (index >= blockSizeInt - 1) {
+        index = blockSizeInt - 1;
+        blockIndex = (float) index;
+      }
+      float *inputBuffer = localDspBufferAtInlet[0];
+      float fraction = blockIndex - (float) index;
+      float value = (fraction > 0.0f)
+          ? inputBuffer[index] + fraction * (inputBuffer[index+1] - inputBuffer[index])
+          : inputBuffer[index];
+      
+      PdMessage *outgoingMessage = getNextOutgoingMessage(0);
+      outgoingMessage->setTimestamp(message->getTimestamp());
+      outgoingMessage->setFloat(0, value);
+      sendMessage(0, outgoingMessage);
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DSP_VSNAPSHOT_H_
+#define _DSP_VSNAPSHOT_H_
+
+#include "DspObject.h"
+
+/**
+ * [vsnapshot~]
+ * <br>
+ * As [snapshot~], but the signal is linearly interpolated at the exact (sub-sample) time of the
+ * bang, instead of being read at the sample before it.
+ */
+class DspVSnapshot : public DspObject {
+  
+  public:
+    DspVSnapshot(PdMessage *initMessage, PdGraph *graph);
+    ~DspVSnapshot();
+  
+    const char *getObjectLabel();
+  
+    ConnectionType getConnectionType(int outletIndex);
+  
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+};
+
+#endif // _DSP_VSNAPSHOT_H_
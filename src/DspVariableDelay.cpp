@@ -54,43 +54,50 @@ const char *DspVariableDelay::getObjectLabel() {
   return "vd~";
 }
 
-void DspVariableDelay::processDspToIndex(float newBlockIndex) {
+void DspVariableDelay::processDspWithIndex(int fromIndex, int toIndex) {
+  if (delayline == NULL) {
+    // there is no delwrite~ with the given name (anymore). Output silence.
+    memset(localDspBufferAtOutlet[0] + fromIndex, 0, (toIndex - fromIndex) * sizeof(float));
+    return;
+  }
   int headIndex;
   int bufferLength;
   float *buffer = delayline->getBuffer(&headIndex, &bufferLength);
   float bufferLengthFloat = (float) bufferLength;
-  float *inputBuffer = localDspBufferAtInlet[0];
-  float *outputBuffer = localDspBufferAtOutlet[0];
-  
-  float targetIndexBase = (float) (headIndex - blockSizeInt);
+  float targetIndexBase = (float) (headIndex - blockSizeInt + fromIndex);
   #if TARGET_OS_MAC || TARGET_OS_IPHONE
+  float *inputBuffer = localDspBufferAtInlet[0] + fromIndex;
+  float *outputBuffer = localDspBufferAtOutlet[0] + fromIndex;
+  int duration = toIndex - fromIndex;
   // calculate delay in samples (vector version of StaticUtils::millisecondsToSamples)
   float samplesPerMillisecond = sampleRate / 1000.0f;
-  vDSP_vsmul(inputBuffer, 1, &samplesPerMillisecond, xArray, 1, blockSizeInt);
+  vDSP_vsmul(inputBuffer, 1, &samplesPerMillisecond, xArray, 1, duration);
   
   float zero = 0.0f;
   float one = 1.0f;
-  vDSP_vclip(xArray, 1, &zero, &bufferLengthFloat, xArray, 1, blockSizeInt); // clip the delay between 0 and the buffer length
-  vDSP_vramp(&targetIndexBase, &one, targetIndexBaseArray, 1, blockSizeInt);  // create targetIndexBaseArray
-  vDSP_vsub(xArray, 1, targetIndexBaseArray, 1, xArray, 1, blockSizeInt); // targetIndexBaseArray - xArray (== targetSampleIndex)
+  vDSP_vclip(xArray, 1, &zero, &bufferLengthFloat, xArray, 1, duration); // clip the delay between 0 and the buffer length
+  vDSP_vramp(&targetIndexBase, &one, targetIndexBaseArray, 1, duration);  // create targetIndexBaseArray
+  vDSP_vsub(xArray, 1, targetIndexBaseArray, 1, xArray, 1, duration); // targetIndexBaseArray - xArray (== targetSampleIndex)
   
   // ensure that targetSampleIndex is positive
   // TODO(mhroth): vectorise this!
-  for (int i = 0; i < blockSizeInt; i++) {
+  for (int i = 0; i < duration; i++) {
     if (xArray[i] < 0.0f) {
       xArray[i] += bufferLengthFloat;
     }
   }
   
-  vDSP_vindex(buffer, xArray, 1, y0Array, 1, blockSizeInt); // calculate y0 based on xArray index
-  vDSP_vsadd(xArray, 1, &one, xArray, 1, blockSizeInt); // increment index by 1
-  vDSP_vindex(buffer, xArray, 1, y1Array, 1, blockSizeInt); // calculate y1 based on index
+  vDSP_vindex(buffer, xArray, 1, y0Array, 1, duration); // calculate y0 based on xArray index
+  vDSP_vsadd(xArray, 1, &one, xArray, 1, duration); // increment index by 1
+  vDSP_vindex(buffer, xArray, 1, y1Array, 1, duration); // calculate y1 based on index
   
-  vDSP_vfrac(xArray, 1, xArray, 1, blockSizeInt); // get the fractional part of x
-  vDSP_vsbm(y1Array, 1, y0Array, 1, xArray, 1, outputBuffer, 1, blockSizeInt); // output = (y1-y0)*x
-  vDSP_vadd(outputBuffer, 1, y0Array, 1, outputBuffer, 1, blockSizeInt); // output = output + y0
+  vDSP_vfrac(xArray, 1, xArray, 1, duration); // get the fractional part of x
+  vDSP_vsbm(y1Array, 1, y0Array, 1, xArray, 1, outputBuffer, 1, duration); // output = (y1-y0)*x
+  vDSP_vadd(outputBuffer, 1, y0Array, 1, outputBuffer, 1, duration); // output = output + y0
   #else
-  for (int i = 0; i < blockSizeInt; i++, targetIndexBase+=1.0f) {
+  float *inputBuffer = localDspBufferAtInlet[0];
+  float *outputBuffer = localDspBufferAtOutlet[0];
+  for (int i = fromIndex; i < toIndex; i++, targetIndexBase+=1.0f) {
     float delayInSamples = StaticUtils::millisecondsToSamples(inputBuffer[i], sampleRate);
     if (delayInSamples < 0.0f) {
       delayInSamples = 0.0f;
@@ -41,7 +41,7 @@ class DspVariableDelay : public DelayReceiver {
     
   private:
     // vd~ does not process any messages and thus does not implement processMessage()
-    void processDspToIndex(float newBlockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
   
     float sampleRate;
     float *y0Array;
@@ -20,6 +20,8 @@
  *
  */
 
+#include "CodeGenerator.h"
+#include "DspFusedChain.h"
 #include "DspWrap.h"
 
 DspWrap::DspWrap(PdMessage *initMessage, PdGraph *graph) : DspObject(0, 1, 0, 1, graph) {
@@ -34,13 +36,27 @@ const char *DspWrap::getObjectLabel() {
   return "wrap~";
 }
 
-void DspWrap::processDspToIndex(float blockIndex) {
-  int endSampleIndex = getEndSampleIndex(blockIndex);
+void DspWrap::processDspWithIndex(int fromIndex, int toIndex) {
   float *inputBuffer = localDspBufferAtInlet[0];
   float *outputBuffer = localDspBufferAtOutlet[0];
-  for (int i = getStartSampleIndex(); i < endSampleIndex; i++) {
+  for (int i = fromIndex; i < toIndex; i++) {
     float f = inputBuffer[i];
     outputBuffer[i] = f - floorf(f);
   }
-  blockIndexOfLastMessage = blockIndex;
+}
+
+bool DspWrap::generateCode(CodeGenerator *codeGenerator) {
+  codeGenerator->addCode("for (int i = 0; i < BLOCK_SIZE; i++) %s[i] = wrap(%s[i]);",
+      codeGenerator->getOutputBuffer(this, 0), codeGenerator->getInputBuffer(this, 0));
+  return true;
+}
+
+bool DspWrap::getElementwiseOperation(ElementwiseOperation *operation) {
+  operation->type = ELEMENTWISE_WRAP;
+  operation->operandBuffer = NULL;
+  return true;
+}
+
+bool DspWrap::isElementwise() {
+  return true;
 }
@@ -34,8 +34,12 @@ class DspWrap : public DspObject {
 
     const char *getObjectLabel();
 
+    bool generateCode(CodeGenerator *codeGenerator);
+    bool getElementwiseOperation(ElementwiseOperation *operation);
+    bool isElementwise();
+
   protected:
-    void processDspToIndex(float blockIndex);
+    void processDspWithIndex(int fromIndex, int toIndex);
 };
 
 #endif // _DSP_WRAP_H_
@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DiskStreamer.h"
+#include "DspWriteSoundfile.h"
+#include "PdGraph.h"
+#include "SoundfileStream.h"
+
+/** The default amount of audio which may wait for the disk, in bytes per channel, as in Pd. */
+#define DEFAULT_WRITESF_BUFFER_SIZE 262144
+
+DspWriteSoundfile::DspWriteSoundfile(PdMessage *initMessage, PdGraph *graph) :
+    DspObject(1, (initMessage->isFloat(0) && initMessage->getFloat(0) > 1.0f) ? (int) initMessage->getFloat(0) : 1,
+              0, 0, graph) {
+  numChannels = numDspInlets;
+  int bufferSize = initMessage->isFloat(1) ? (int) initMessage->getFloat(1) : DEFAULT_WRITESF_BUFFER_SIZE;
+  if (bufferSize <= 0) {
+    bufferSize = DEFAULT_WRITESF_BUFFER_SIZE;
+  }
+  
+  stream = new SoundfileStream(SOUNDFILE_STREAM_WRITE, numChannels, bufferSize / sizeof(float));
+  graph->getDiskStreamer()->addClient(stream);
+  isOpen = false;
+  isRecording = false;
+}
+
+DspWriteSoundfile::~DspWriteSoundfile() {
+  if (isOpen) {
+    // the audio thread has let go of this object, so the file can be closed from here
+    stream->requestClose();
+  }
+  graph->getDiskStreamer()->removeClient(stream);
+  delete stream;
+}
+
+const char *DspWriteSoundfile::getObjectLabel() {
+  return "writesf~";
+}
+
+void DspWriteSoundfile::processMessage(int inletIndex, PdMessage *message) {
+  if (message->isSymbol(0)) {
+    char *command = message->getSymbol(0);
+    if (strcmp(command, "open") == 0) {
+      open(message);
+    } else if (strcmp(command, "start") == 0) {
+      isRecording = isOpen;
+    } else if (strcmp(command, "stop") == 0) {
+      if (isOpen) {
+        isRecording = false;
+        isOpen = false;
+        stream->requestClose();
+      }
+    } else if (strcmp(command, "print") == 0) {
+      graph->printStd("writesf~: %i channels, %s, %i dropouts.\n", numChannels,
+          isRecording ? "recording" : (isOpen ? "open" : "closed"), stream->getNumDropouts());
+    }
+  }
+}
+
+void DspWriteSoundfile::open(PdMessage *message) {
+  int bitsPerSample = 16;
+  int sampleRate = (int) graph->getSampleRate();
+  int index = 1;
+  while (message->isSymbol(index) && message->getSymbol(index)[0] == '-') {
+    char *flag = message->getSymbol(index);
+    if (strcmp(flag, "-bytes") == 0 && message->isFloat(index+1)) {
+      bitsPerSample = 8 * (int) message->getFloat(index+1);
+      if (bitsPerSample != 16 && bitsPerSample != 24 && bitsPerSample != 32) {
+        graph->printErr("writesf~: -bytes must be 2, 3 or 4. Using 2.\n");
+        bitsPerSample = 16;
+      }
+    } else if (strcmp(flag, "-rate") == 0 && message->isFloat(index+1)) {
+      sampleRate = (int) message->getFloat(index+1);
+    }
+    // other flags (e.g. file types) are ignored. Files are always written as WAV.
+    index += message->isFloat(index+1) ? 2 : 1;
+  }
+  if (!message->isSymbol(index)) {
+    graph->printErr("writesf~: open requires a file name.\n");
+    return;
+  }
+  isRecording = false;
+  isOpen = stream->requestOpen(graph->getDirectory(), message->getSymbol(index), 0, bitsPerSample,
+      sampleRate);
+  if (!isOpen) {
+    graph->printErr("writesf~: too many requests. \"%s\" will not be opened.\n", message->getSymbol(index));
+  }
+}
+
+void DspWriteSoundfile::processDspWithIndex(int fromIndex, int toIndex) {
+  if (isRecording && fromIndex < toIndex) {
+    if (stream->didOpenFail()) {
+      graph->printErr("writesf~: the file could not be opened.\n");
+      isRecording = false;
+      isOpen = false;
+    } else {
+      stream->write(localDspBufferAtInlet, fromIndex, toIndex);
+    }
+  }
+}
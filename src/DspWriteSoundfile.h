@@ -0,0 +1,57 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DSP_WRITE_SOUNDFILE_H_
+#define _DSP_WRITE_SOUNDFILE_H_
+
+#include "DspObject.h"
+
+class SoundfileStream;
+
+/**
+ * [writesf~]
+ * Records its inputs to a WAV file. Audio is handed to the disk thread of the graph, so that the
+ * audio thread never waits for the disk. The optional second argument sets the amount of audio
+ * which may be buffered, in bytes per channel, as in Pd.
+ */
+class DspWriteSoundfile : public DspObject {
+  
+  public:
+    DspWriteSoundfile(PdMessage *initMessage, PdGraph *graph);
+    ~DspWriteSoundfile();
+  
+    const char *getObjectLabel();
+  
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+    void processDspWithIndex(int fromIndex, int toIndex);
+  
+    /** Handles the message "open [-bytes n] [-rate r] filename". */
+    void open(PdMessage *message);
+  
+    int numChannels;
+    SoundfileStream *stream;
+    bool isOpen;
+    bool isRecording;
+};
+
+#endif // _DSP_WRITE_SOUNDFILE_H_
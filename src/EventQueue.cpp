@@ -0,0 +1,195 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LockFreeQueue.h"
+#include "EventQueue.h"
+
+/** How long the delivery thread sleeps between deliveries, in microseconds. */
+#define EVENT_QUEUE_DELIVERY_INTERVAL 5000
+
+EventQueue::EventQueue(int capacity) {
+  unsigned int length = 1;
+  while (length < (unsigned int) capacity) {
+    length <<= 1;
+  }
+  records = (EventRecord *) calloc(length, sizeof(EventRecord));
+  mask = length - 1;
+  readIndex = 0;
+  writeIndex = 0;
+  numDroppedEvents = 0;
+  numReportedDroppedEvents = 0;
+  callbackFunction = NULL;
+  callbackUserData = NULL;
+  isRunning = false;
+  hasDeliveryThread = false;
+}
+
+EventQueue::~EventQueue() {
+  if (hasDeliveryThread) {
+    isRunning = false;
+    pthread_join(deliveryThread, NULL);
+  }
+  free(records);
+}
+
+EventQueue::EventRecord *EventQueue::claimRecord() {
+  // producers only compete with each other for the write index
+  unsigned int index;
+  do {
+    index = writeIndex;
+    if (index - readIndex > mask) {
+      ZG_ATOMIC_INCREMENT(&numDroppedEvents);
+      return NULL; // the queue is full
+    }
+  } while (!ZG_COMPARE_AND_SWAP(&writeIndex, index, index + 1));
+  return &records[index & mask];
+}
+
+void EventQueue::publishRecord(EventRecord *record) {
+  // the record must be complete before the consumer can see that it is ready
+  ZG_MEMORY_BARRIER();
+  record->isReady = 1;
+}
+
+bool EventQueue::print(ZGCallbackFunction function, const char *msg, va_list ap) {
+  EventRecord *record = claimRecord();
+  if (record == NULL) {
+    return false;
+  }
+  record->function = function;
+  vsnprintf(record->text, PRINT_RECORD_LENGTH, msg, ap);
+  publishRecord(record);
+  return true;
+}
+
+bool EventQueue::sendMessage(const char *receiverName, double timestamp, PdMessage *message) {
+  EventRecord *record = claimRecord();
+  if (record == NULL) {
+    return false;
+  }
+  record->function = ZG_RECEIVER_MESSAGE;
+  
+  // the receiver name and all symbols are copied into the text of the record, one after another.
+  // Symbols which do not fit are truncated.
+  int pos = snprintf(record->text, PRINT_RECORD_LENGTH, "%s", receiverName) + 1;
+  int numAtoms = 0;
+  int numElements = message->getNumElements();
+  for (int i = 0; i < numElements && numAtoms < EVENT_RECORD_MAX_ATOMS; i++) {
+    ZGAtom *atom = &record->atoms[numAtoms];
+    switch (message->getType(i)) {
+      case FLOAT: {
+        atom->type = ZG_ATOM_FLOAT;
+        atom->f = message->getFloat(i);
+        break;
+      }
+      case SYMBOL: {
+        atom->type = ZG_ATOM_SYMBOL;
+        if (pos >= PRINT_RECORD_LENGTH) {
+          pos = PRINT_RECORD_LENGTH - 1; // the empty string at the end of the text
+        }
+        atom->s = record->text + pos;
+        pos += snprintf(record->text + pos, PRINT_RECORD_LENGTH - pos, "%s", message->getSymbol(i)) + 1;
+        break;
+      }
+      case BANG: {
+        atom->type = ZG_ATOM_BANG;
+        break;
+      }
+      default: {
+        continue; // other types are not passed to the host
+      }
+    }
+    numAtoms++;
+  }
+  
+  record->message.receiverName = record->text;
+  record->message.timestamp = timestamp;
+  record->message.numAtoms = numAtoms;
+  record->message.atoms = record->atoms;
+  publishRecord(record);
+  return true;
+}
+
+int EventQueue::deliver(void (*callbackFunction)(ZGCallbackFunction, void *, void *),
+    void *userData) {
+  int numDelivered = 0;
+  while (readIndex != writeIndex) {
+    EventRecord *record = &records[readIndex & mask];
+    if (!record->isReady) {
+      break; // the record has been claimed but it is still being written
+    }
+    ZG_MEMORY_BARRIER();
+    if (callbackFunction != NULL) {
+      if (record->function == ZG_RECEIVER_MESSAGE) {
+        callbackFunction(record->function, userData, &record->message);
+      } else {
+        callbackFunction(record->function, userData, record->text);
+      }
+    }
+    record->isReady = 0;
+    // the record must be released only after it has been read
+    ZG_MEMORY_BARRIER();
+    readIndex++;
+    numDelivered++;
+  }
+  
+  unsigned int numDropped = numDroppedEvents;
+  if (numDropped != numReportedDroppedEvents) {
+    if (callbackFunction != NULL) {
+      char text[64];
+      snprintf(text, sizeof(text), "%u events for the host were dropped.\n",
+          numDropped - numReportedDroppedEvents);
+      callbackFunction(ZG_PRINT_ERR, userData, text);
+    }
+    numReportedDroppedEvents = numDropped;
+  }
+  return numDelivered;
+}
+
+void EventQueue::startDeliveryThread(void (*callbackFunction)(ZGCallbackFunction, void *, void *),
+    void *userData) {
+  if (!hasDeliveryThread) {
+    this->callbackFunction = callbackFunction;
+    this->callbackUserData = userData;
+    isRunning = true;
+    hasDeliveryThread = true;
+    pthread_create(&deliveryThread, NULL, &EventQueue::deliveryLoop, this);
+  }
+}
+
+void *EventQueue::deliveryLoop(void *eventQueue) {
+  EventQueue *queue = (EventQueue *) eventQueue;
+  while (queue->isRunning) {
+    queue->deliver(queue->callbackFunction, queue->callbackUserData);
+    usleep(EVENT_QUEUE_DELIVERY_INTERVAL);
+  }
+  // deliver anything which remains
+  queue->deliver(queue->callbackFunction, queue->callbackUserData);
+  return NULL;
+}
+
+unsigned int EventQueue::getNumDroppedEvents() {
+  return numDroppedEvents;
+}
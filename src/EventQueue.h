@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _EVENT_QUEUE_H_
+#define _EVENT_QUEUE_H_
+
+#include <pthread.h>
+#include <stdarg.h>
+#include "PdMessage.h"
+#include "ZGCallbackFunction.h"
+#include "ZGReceivedMessage.h"
+
+/** The maximum length of a single printed message, including the terminating null character. */
+#define PRINT_RECORD_LENGTH 512
+
+/** The maximum number of elements of a queued message to a host receiver. Others are dropped. */
+#define EVENT_RECORD_MAX_ATOMS 32
+
+/**
+ * A fixed-capacity queue of events for the host callback: printed messages, and messages to
+ * receivers registered by the host. Events are written directly into preallocated records. Any
+ * number of threads (usually the audio thread) may add events without locking or allocating
+ * memory, while a single consumer delivers them to the host callback, either via
+ * <code>deliver()</code> or on a delivery thread of its own. If the queue is full, events are
+ * dropped and counted rather than waited for.
+ */
+class EventQueue {
+  
+  public:
+    /** The capacity is rounded up to the next power of two. */
+    EventQueue(int capacity);
+    ~EventQueue();
+  
+    /** Formats the message into the next free record. Returns <code>false</code> if it was dropped. */
+    bool print(ZGCallbackFunction function, const char *msg, va_list ap);
+  
+    /**
+     * Copies the elements of the message, sent to the named receiver at the given time (in
+     * milliseconds), into the next free record. Returns <code>false</code> if it was dropped.
+     */
+    bool sendMessage(const char *receiverName, double timestamp, PdMessage *message);
+  
+    /**
+     * Passes all queued events to the given callback, in order, and returns how many there were.
+     * If events were dropped since the last delivery, an error message saying so is delivered
+     * after them. May only be called by one thread at a time.
+     */
+    int deliver(void (*callbackFunction)(ZGCallbackFunction, void *, void *), void *userData);
+  
+    /**
+     * Starts a thread which delivers queued events every few milliseconds, until the queue is
+     * deleted. <code>deliver()</code> must not be called thereafter.
+     */
+    void startDeliveryThread(void (*callbackFunction)(ZGCallbackFunction, void *, void *),
+        void *userData);
+  
+    /** Returns the total number of events which have been dropped because the queue was full. */
+    unsigned int getNumDroppedEvents();
+  
+  private:
+    typedef struct {
+      volatile int isReady; // set once the record has been completely written
+      ZGCallbackFunction function;
+      ZGReceivedMessage message; // only used by ZG_RECEIVER_MESSAGE
+      ZGAtom atoms[EVENT_RECORD_MAX_ATOMS];
+      char text[PRINT_RECORD_LENGTH]; // the printed message, or the receiver name and symbols
+    } EventRecord;
+  
+    /** Returns the next free record, or <code>NULL</code> if the queue is full. */
+    EventRecord *claimRecord();
+  
+    /** Makes a completely written record available to the consumer. */
+    void publishRecord(EventRecord *record);
+  
+    static void *deliveryLoop(void *eventQueue);
+  
+    EventRecord *records;
+    unsigned int mask;
+    volatile unsigned int readIndex;
+    volatile unsigned int writeIndex;
+    volatile unsigned int numDroppedEvents;
+    unsigned int numReportedDroppedEvents;
+  
+    void (*callbackFunction)(ZGCallbackFunction, void *, void *);
+    void *callbackUserData;
+    volatile bool isRunning;
+    bool hasDeliveryThread;
+    pthread_t deliveryThread;
+};
+
+#endif // _EVENT_QUEUE_H_
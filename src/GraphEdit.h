@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GRAPH_EDIT_H_
+#define _GRAPH_EDIT_H_
+
+class CompiledDsp;
+class HashTable;
+class List;
+class MessageObject;
+class PdGraph;
+
+enum GraphEditType {
+  GRAPH_EDIT_ADD_OBJECT,
+  GRAPH_EDIT_REMOVE_OBJECT,
+  GRAPH_EDIT_CONNECT,
+  GRAPH_EDIT_DISCONNECT
+};
+
+/**
+ * A list of a running graph which is replaced by an edit, e.g. the connections at an inlet. The
+ * control thread builds the new list, and the audio thread exchanges it for the one at
+ * <code>slot</code>. The replaced list is freed by the control thread.
+ */
+typedef struct {
+  List **slot;
+  
+  /** The new list. It is never written by the audio thread. */
+  List *newList;
+  
+  /**
+   * The replaced list. It is the list which the edit has been planned against, as edits are
+   * applied in the order in which they are planned.
+   */
+  List *oldList;
+} ListSwap;
+
+/**
+ * A struct describing one change to a running graph. Edits are prepared by the control thread and
+ * applied by the audio thread at the start of the next block. For object edits, only
+ * <code>fromObject</code> is used.
+ * <br>
+ * The control thread builds every list which the edit changes, including the new process order of
+ * the graph, and creates or frees all connections. The audio thread only exchanges the lists, and
+ * hands the edit back such that the control thread can free what has been replaced, as well as any
+ * compiled code which the edit invalidates. Nothing is allocated or freed on the audio thread.
+ */
+typedef struct {
+  GraphEditType type;
+  PdGraph *graph;
+  MessageObject *fromObject;
+  int outletIndex;
+  MessageObject *toObject;
+  int inletIndex;
+  
+  /** The <code>ListSwap</code>s of the edit, in the order in which they are applied. */
+  List *listSwapList;
+  
+  /**
+   * The connections (<code>ObjectLetPair</code>s) which have been created by a connecting edit, or
+   * removed by a disconnecting or removing edit. They are freed if the edit is not applied, or
+   * once it is, respectively.
+   */
+  List *connectionList;
+  
+  /**
+   * The new list of receivers for the name of an added or removed [receive], and the one which it
+   * replaces. See <code>MessageSendController</code>.
+   */
+  List *receiverList;
+  List *replacedReceiverList;
+  
+  /** The name of an added [receive], if no receiver has had it before. Otherwise <code>NULL</code>. */
+  char *receiverName;
+  
+  /** The new table map of the graph, and the one which it replaces. <code>NULL</code> if it is unchanged. */
+  HashTable *tableMap;
+  HashTable *replacedTableMap;
+  
+  /** Indicates that the edit replaces the process order of the audio objects, and with it any compiled code. */
+  bool isDspOrderChanged;
+  
+  /** The compiled code which no longer corresponds to the graph once the edit has been applied. */
+  CompiledDsp *compiledDsp;
+} GraphEdit;
+
+#endif // _GRAPH_EDIT_H_
@@ -0,0 +1,142 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "HashTable.h"
+#include "StaticUtils.h"
+
+#define DEFAULT_NUM_BUCKETS 32
+
+#define FNV_OFFSET_BASIS 2166136261U
+#define FNV_PRIME 16777619U
+
+HashTable::HashTable() {
+  mask = DEFAULT_NUM_BUCKETS - 1;
+  numEntries = 0;
+  buckets = (HashTableEntry **) calloc(DEFAULT_NUM_BUCKETS, sizeof(HashTableEntry *));
+}
+
+HashTable::~HashTable() {
+  for (unsigned int i = 0; i <= mask; i++) {
+    HashTableEntry *entry = buckets[i];
+    while (entry != NULL) {
+      HashTableEntry *next = entry->next;
+      free(entry->key);
+      free(entry);
+      entry = next;
+    }
+  }
+  free(buckets);
+}
+
+unsigned int HashTable::hash(const char *key) {
+  return hash(key, strlen(key), FNV_OFFSET_BASIS);
+}
+
+unsigned int HashTable::hash(const void *data, int numBytes, unsigned int hash) {
+  const unsigned char *bytes = (const unsigned char *) data;
+  for (int i = 0; i < numBytes; i++) {
+    hash = (hash ^ bytes[i]) * FNV_PRIME;
+  }
+  return hash;
+}
+
+HashTableEntry *HashTable::getEntry(const char *key, unsigned int hash) {
+  HashTableEntry *entry = buckets[hash & mask];
+  while (entry != NULL && (entry->hash != hash || strcmp(entry->key, key) != 0)) {
+    entry = entry->next;
+  }
+  return entry;
+}
+
+void *HashTable::put(const char *key, void *value) {
+  unsigned int keyHash = hash(key);
+  HashTableEntry *entry = getEntry(key, keyHash);
+  if (entry != NULL) {
+    void *previousValue = entry->value;
+    entry->value = value;
+    return previousValue;
+  }
+  
+  if (numEntries >= (int) (mask + 1)) {
+    growBuckets(); // keep the average chain length at most one
+  }
+  entry = (HashTableEntry *) malloc(sizeof(HashTableEntry));
+  entry->key = StaticUtils::copyString((char *) key);
+  entry->hash = keyHash;
+  entry->value = value;
+  entry->next = buckets[keyHash & mask];
+  buckets[keyHash & mask] = entry;
+  numEntries++;
+  return NULL;
+}
+
+void *HashTable::get(const char *key) {
+  HashTableEntry *entry = getEntry(key, hash(key));
+  return (entry != NULL) ? entry->value : NULL;
+}
+
+void *HashTable::remove(const char *key) {
+  unsigned int keyHash = hash(key);
+  HashTableEntry **link = &buckets[keyHash & mask];
+  while (*link != NULL) {
+    HashTableEntry *entry = *link;
+    if (entry->hash == keyHash && strcmp(entry->key, key) == 0) {
+      void *value = entry->value;
+      *link = entry->next;
+      free(entry->key);
+      free(entry);
+      numEntries--;
+      return value;
+    }
+    link = &entry->next;
+  }
+  return NULL;
+}
+
+HashTable *HashTable::copy() {
+  HashTable *table = new HashTable();
+  for (unsigned int i = 0; i <= mask; i++) {
+    for (HashTableEntry *entry = buckets[i]; entry != NULL; entry = entry->next) {
+      table->put(entry->key, entry->value);
+    }
+  }
+  return table;
+}
+
+void HashTable::growBuckets() {
+  unsigned int newMask = (mask << 1) | 1;
+  HashTableEntry **newBuckets = (HashTableEntry **) calloc(newMask + 1, sizeof(HashTableEntry *));
+  for (unsigned int i = 0; i <= mask; i++) {
+    HashTableEntry *entry = buckets[i];
+    while (entry != NULL) {
+      HashTableEntry *next = entry->next;
+      entry->next = newBuckets[entry->hash & newMask];
+      newBuckets[entry->hash & newMask] = entry;
+      entry = next;
+    }
+  }
+  free(buckets);
+  buckets = newBuckets;
+  mask = newMask;
+}
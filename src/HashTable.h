@@ -0,0 +1,76 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _HASH_TABLE_H_
+#define _HASH_TABLE_H_
+
+/** An entry in a <code>HashTable</code> bucket. */
+typedef struct HashTableEntry {
+  char *key;
+  unsigned int hash;
+  void *value;
+  struct HashTableEntry *next;
+} HashTableEntry;
+
+/**
+ * Implements a map from strings to pointers with constant time lookup. Keys are copied. Values are
+ * not owned by the table. The number of buckets grows with the number of entries.
+ */
+class HashTable {
+  
+  public:
+    HashTable();
+  
+    /** The values in the table are not destroyed. */
+    ~HashTable();
+  
+    /** The number of entries in the table. */
+    inline int size() { return numEntries; }
+  
+    /** Associates the value with the key, replacing and returning any previous value (or NULL). */
+    void *put(const char *key, void *value);
+  
+    /** Returns the value associated with the key, or <code>NULL</code> if there is none. */
+    void *get(const char *key);
+  
+    /** Removes the key from the table. Returns its value, or <code>NULL</code> if there was none. */
+    void *remove(const char *key);
+  
+    /** Returns a new table with the same entries. */
+    HashTable *copy();
+  
+    /** Returns the 32-bit FNV-1a hash of the given string. */
+    static unsigned int hash(const char *key);
+  
+    /** Returns the 32-bit FNV-1a hash of the given bytes, continuing from a previous hash. */
+    static unsigned int hash(const void *data, int numBytes, unsigned int hash);
+  
+  private:
+    HashTableEntry *getEntry(const char *key, unsigned int hash);
+    void growBuckets();
+  
+    HashTableEntry **buckets;
+    unsigned int mask;
+    int numEntries;
+};
+
+#endif // _HASH_TABLE_H_
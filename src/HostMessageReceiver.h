@@ -0,0 +1,46 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _HOST_MESSAGE_RECEIVER_H_
+#define _HOST_MESSAGE_RECEIVER_H_
+
+#include "RemoteMessageReceiver.h"
+
+/**
+ * Receives the messages sent to a name which the host has registered with
+ * <code>zg_register_receiver()</code>, and passes them to the host callback as
+ * <code>ZGReceivedMessage</code>s. It is not part of any patch; it is added to and removed from the
+ * root graph with the live editing functions, such that the audio thread is never blocked.
+ */
+class HostMessageReceiver : public RemoteMessageReceiver {
+  
+  public:
+    HostMessageReceiver(char *receiverName, PdGraph *graph);
+    ~HostMessageReceiver();
+  
+    const char *getObjectLabel();
+  
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+};
+
+#endif // _HOST_MESSAGE_RECEIVER_H_
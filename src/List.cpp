@@ -117,3 +117,12 @@ bool List::exists(void *element) {
   }
   return false;
 }
+
+int List::indexOf(void *element) {
+  for (int i = 0; i < numElements; i++) {
+    if (arrayList[i] == element) {
+      return i;
+    }
+  }
+  return -1;
+}
@@ -57,6 +57,9 @@ class List {
   
     /** Returns <code>true</code> if the given element exists in the list. <code>false</code> otherwise. */
     bool exists(void *element);
+  
+    /** Returns the index of the given element in the list, or -1 if it does not exist. */
+    int indexOf(void *element);
 
     /**
      * Resets the number of elements to zero.
@@ -0,0 +1,77 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include "LockFreeQueue.h"
+
+LockFreeQueue::LockFreeQueue(int capacity) {
+  unsigned int length = 1;
+  while (length < (unsigned int) capacity) {
+    length <<= 1;
+  }
+  buffer = (void **) calloc(length, sizeof(void *));
+  mask = length - 1;
+  readIndex = 0;
+  writeIndex = 0;
+}
+
+LockFreeQueue::~LockFreeQueue() {
+  free(buffer);
+}
+
+bool LockFreeQueue::push(void *element) {
+  unsigned int index = writeIndex;
+  if (index - readIndex > mask) {
+    return false; // the queue is full
+  }
+  buffer[index & mask] = element;
+  // the element must be visible to the consumer before the write index is advanced
+  ZG_MEMORY_BARRIER();
+  writeIndex = index + 1;
+  return true;
+}
+
+void *LockFreeQueue::pop() {
+  unsigned int index = readIndex;
+  if (index == writeIndex) {
+    return NULL; // the queue is empty
+  }
+  // the element must be read only after the write index has been observed
+  ZG_MEMORY_BARRIER();
+  void *element = buffer[index & mask];
+  ZG_MEMORY_BARRIER();
+  readIndex = index + 1;
+  return element;
+}
+
+void *LockFreeQueue::peek() {
+  unsigned int index = readIndex;
+  if (index == writeIndex) {
+    return NULL;
+  }
+  ZG_MEMORY_BARRIER();
+  return buffer[index & mask];
+}
+
+bool LockFreeQueue::isEmpty() {
+  return (readIndex == writeIndex);
+}
@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _LOCK_FREE_QUEUE_H_
+#define _LOCK_FREE_QUEUE_H_
+
+#if __APPLE__
+#include <libkern/OSAtomic.h>
+#define ZG_MEMORY_BARRIER() OSMemoryBarrier()
+#define ZG_COMPARE_AND_SWAP(ptr, oldValue, newValue) \
+    OSAtomicCompareAndSwap32Barrier((int32_t) (oldValue), (int32_t) (newValue), (volatile int32_t *) (ptr))
+#define ZG_ATOMIC_INCREMENT(ptr) OSAtomicIncrement32Barrier((volatile int32_t *) (ptr))
+#else
+#define ZG_MEMORY_BARRIER() __sync_synchronize()
+#define ZG_COMPARE_AND_SWAP(ptr, oldValue, newValue) __sync_bool_compare_and_swap(ptr, oldValue, newValue)
+#define ZG_ATOMIC_INCREMENT(ptr) __sync_add_and_fetch(ptr, 1)
+#endif
+
+/**
+ * A fixed-capacity, single-producer single-consumer queue of pointers. One thread may call
+ * <code>push()</code> while another thread calls <code>pop()</code> without any locking. Neither
+ * function allocates memory, so both are safe to call from the audio thread.
+ */
+class LockFreeQueue {
+  
+  public:
+    /** The capacity is rounded up to the next power of two. */
+    LockFreeQueue(int capacity);
+    ~LockFreeQueue();
+  
+    /**
+     * Adds an element to the end of the queue. Returns <code>false</code> if the queue is full, in
+     * which case the element is not added. May only be called by the producer thread.
+     */
+    bool push(void *element);
+  
+    /**
+     * Removes and returns the element at the front of the queue, or <code>NULL</code> if the queue
+     * is empty. May only be called by the consumer thread.
+     */
+    void *pop();
+  
+    /**
+     * Returns the element at the front of the queue without removing it, or <code>NULL</code> if
+     * the queue is empty. May only be called by the consumer thread.
+     */
+    void *peek();
+  
+    /** Returns <code>true</code> if there are no elements in the queue. */
+    bool isEmpty();
+  
+  private:
+    void **buffer;
+    unsigned int mask;
+    volatile unsigned int readIndex;
+    volatile unsigned int writeIndex;
+};
+
+#endif // _LOCK_FREE_QUEUE_H_
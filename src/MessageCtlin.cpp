@@ -0,0 +1,76 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MessageCtlin.h"
+
+// the number of outlets depends on the arguments
+static int numOutletsForArguments(PdMessage *initMessage) {
+  if (!initMessage->isFloat(0)) {
+    return 3; // value, controller, channel
+  } else if (MidiReceiver::channelFromMessage(initMessage, 1) == -1) {
+    return 2; // value, channel
+  } else {
+    return 1; // value
+  }
+}
+
+MessageCtlin::MessageCtlin(PdMessage *initMessage, PdGraph *graph) :
+    MidiReceiver(MIDI_CONTROL_CHANGE, initMessage->isFloat(0) ?
+        MidiReceiver::channelFromMessage(initMessage, 1) : -1,
+        numOutletsForArguments(initMessage), graph) {
+  controller = initMessage->isFloat(0) ? (int) initMessage->getFloat(0) : -1;
+}
+
+MessageCtlin::~MessageCtlin() {
+  // nothing to do
+}
+
+const char *MessageCtlin::getObjectLabel() {
+  return "ctlin";
+}
+
+void MessageCtlin::processMessage(int inletIndex, PdMessage *message) {
+  if (controller != -1 && controller != (int) message->getFloat(1)) {
+    return; // not the controller that this object listens to
+  }
+  
+  // send right to left
+  int outletIndex = getNumOutlets() - 1;
+  if (isOmni()) {
+    PdMessage *outgoingMessage = getNextOutgoingMessage(outletIndex);
+    outgoingMessage->setTimestamp(message->getTimestamp());
+    outgoingMessage->setFloat(0, message->getFloat(2));
+    sendMessage(outletIndex--, outgoingMessage);
+  }
+  
+  if (controller == -1) {
+    PdMessage *outgoingMessage = getNextOutgoingMessage(outletIndex);
+    outgoingMessage->setTimestamp(message->getTimestamp());
+    outgoingMessage->setFloat(0, message->getFloat(1));
+    sendMessage(outletIndex--, outgoingMessage);
+  }
+  
+  PdMessage *outgoingMessage = getNextOutgoingMessage(0);
+  outgoingMessage->setTimestamp(message->getTimestamp());
+  outgoingMessage->setFloat(0, message->getFloat(0));
+  sendMessage(0, outgoingMessage);
+}
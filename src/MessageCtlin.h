@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _MESSAGE_CTLIN_H_
+#define _MESSAGE_CTLIN_H_
+
+#include "MidiReceiver.h"
+
+/**
+ * [ctlin], [ctlin float], [ctlin float float]
+ * Outputs the value, controller number and channel of control changes. Outlets for the controller
+ * number and channel are only present if they are not given as arguments.
+ */
+class MessageCtlin : public MidiReceiver {
+  
+  public:
+    MessageCtlin(PdMessage *initMessage, PdGraph *graph);
+    ~MessageCtlin();
+    
+    const char *getObjectLabel();
+    
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+
+    /** The controller number to listen to, or -1 for all controllers. */
+    int controller;
+};
+
+#endif // _MESSAGE_CTLIN_H_
@@ -41,7 +41,7 @@ MessageDelay::~MessageDelay() {
 }
 
 void MessageDelay::init(float delayMs) {
-  this->delayMs = (double) delayMs;
+  delayTime = graph->millisecondsToTime((double) delayMs);
 }
 
 const char *MessageDelay::getObjectLabel() {
@@ -63,7 +63,7 @@ void MessageDelay::processMessage(int inletIndex, PdMessage *message) {
         case FLOAT:
         case BANG: {
           PdMessage *outgoingMessage = getNextOutgoingMessage(0);
-          outgoingMessage->setTimestamp(message->getTimestamp() + delayMs);
+          outgoingMessage->setTimestamp(message->getTimestamp() + delayTime);
           graph->scheduleMessage(this, 0, outgoingMessage);
           break;
         }
@@ -76,7 +76,7 @@ void MessageDelay::processMessage(int inletIndex, PdMessage *message) {
     case 1: {
       MessageElement *messageElement = message->getElement(0);
       if (messageElement->getType() == FLOAT) {
-        delayMs = (double) messageElement->getFloat();
+        delayTime = graph->millisecondsToTime((double) messageElement->getFloat());
       }
       break;
     }
@@ -39,7 +39,8 @@ class MessageDelay : public MessageObject {
     void init(float delayMs);
     void processMessage(int inletIndex, PdMessage *message);
   
-    double delayMs;
+    /** The delay, converted from milliseconds. */
+    ZGTime delayTime;
 };
 
 #endif // _MESSAGE_DELAY_H_
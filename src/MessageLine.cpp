@@ -106,7 +106,7 @@ void MessageLine::processMessage(int inletIndex, PdMessage *message) {
             
             // schedule the next message
             pendingMessage = getNextOutgoingMessage(0);
-            pendingMessage->setTimestamp(message->getTimestamp() + grainRate);
+            pendingMessage->setTimestamp(message->getTimestamp() + graph->millisecondsToTime(grainRate));
             pendingMessage->getElement(0)->setFloat(currentValue + slope);
             graph->scheduleMessage(this, 0, pendingMessage);
           }
@@ -24,9 +24,7 @@
 #include "PdGraph.h"
 
 MessageLoadbang::MessageLoadbang(PdGraph *graph) : MessageObject(0, 1, graph) {
-  PdMessage *outgoingMessage = getNextOutgoingMessage(0);
-  outgoingMessage->setTimestamp(0.0);
-  graph->scheduleMessage(this, 0, outgoingMessage);
+  // nothing to do
 }
 
 MessageLoadbang::~MessageLoadbang() {
@@ -36,3 +34,9 @@ MessageLoadbang::~MessageLoadbang() {
 const char *MessageLoadbang::getObjectLabel() {
   return "loadbang";
 }
+
+void MessageLoadbang::scheduleLoadbang() {
+  PdMessage *outgoingMessage = getNextOutgoingMessage(0);
+  outgoingMessage->setTimestamp(0);
+  graph->scheduleMessage(this, 0, outgoingMessage);
+}
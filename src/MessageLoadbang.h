@@ -33,6 +33,13 @@ class MessageLoadbang : public MessageObject {
     ~MessageLoadbang();
   
     const char *getObjectLabel();
+  
+    /**
+     * Schedules the bang to be sent at the beginning of the next block. This is called by the graph
+     * once the object has been added to it, such that objects created on another thread (i.e. while
+     * editing a running graph) do not touch the message queue.
+     */
+    void scheduleLoadbang();
 };
 
 #endif // _MESSAGE_LOADBANG_H_
@@ -25,7 +25,7 @@
 
 MessageMetro::MessageMetro(PdMessage *initMessage, PdGraph *graph) : MessageObject(2, 1, graph) {
   // default to interval of one second
-  intervalInMs = initMessage->isFloat(0) ? (double) initMessage->getFloat(0) : 1000.0;
+  interval = graph->millisecondsToTime(initMessage->isFloat(0) ? (double) initMessage->getFloat(0) : 1000.0);
   pendingMessage = NULL;
 }
 
@@ -67,7 +67,7 @@ void MessageMetro::processMessage(int inletIndex, PdMessage *message) {
     }
     case 1: {
       if (message->isFloat(0)) {
-        intervalInMs = (double) message->getFloat(0);
+        interval = graph->millisecondsToTime((double) message->getFloat(0));
       }
       break;
     }
@@ -86,14 +86,14 @@ void MessageMetro::sendMessage(int outletIndex, PdMessage *message) {
   // schedule the pending message before the current one is sent so that if a stop message
   // arrives at this object while in this function, then the next message can be cancelled
   pendingMessage = getNextOutgoingMessage(0);
-  pendingMessage->setTimestamp(message->getTimestamp() + intervalInMs);
+  pendingMessage->setTimestamp(message->getTimestamp() + interval);
   graph->scheduleMessage(this, 0, pendingMessage);
   
   MessageObject::sendMessage(outletIndex, message);
   message->unreserve(this);
 }
 
-void MessageMetro::startMetro(double timestamp) {
+void MessageMetro::startMetro(ZGTime timestamp) {
   // Ensure that there is no pending message for this metro. If there is, then cancel it.
   // This allows a metro to be banged multiple times and always restart the timing from the most
   // recently received bang.
@@ -45,10 +45,11 @@ class MessageMetro : public MessageObject {
     void stopMetro();
   
     /** @param  timestamp The time at which the metro should be started. */
-    void startMetro(double timestamp);
+    void startMetro(ZGTime timestamp);
   
     PdMessage *pendingMessage;
-    double intervalInMs;
+    /** The interval, converted from milliseconds. */
+    ZGTime interval;
 };
 
 #endif // _MESSAGE_METRO_H_
@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MessageMidiController.h"
+#include "PdGraph.h"
+
+#define OMNI_INDEX NUM_MIDI_CHANNELS
+
+MessageMidiController::MessageMidiController(PdGraph *graph) :
+    MessageObject(0, NUM_MIDI_EVENT_TYPES, graph) {
+  for (int i = 0; i < NUM_MIDI_EVENT_TYPES; i++) {
+    for (int j = 0; j <= NUM_MIDI_CHANNELS; j++) {
+      receiverLists[i][j] = new List();
+    }
+  }
+}
+
+MessageMidiController::~MessageMidiController() {
+  for (int i = 0; i < NUM_MIDI_EVENT_TYPES; i++) {
+    for (int j = 0; j <= NUM_MIDI_CHANNELS; j++) {
+      delete receiverLists[i][j];
+    }
+  }
+}
+
+const char *MessageMidiController::getObjectLabel() {
+  return "midicontroller";
+}
+
+PdMessage *MessageMidiController::newCanonicalMessage(int outletIndex) {
+  PdMessage *message = new PdMessage();
+  message->addElement(new MessageElement(0.0f));
+  message->addElement(new MessageElement(0.0f));
+  if (outletIndex == MIDI_NOTE || outletIndex == MIDI_CONTROL_CHANGE) {
+    message->addElement(new MessageElement(0.0f));
+  }
+  return message;
+}
+
+bool MessageMidiController::hasReceivers(MidiEventType midiEventType, int channel) {
+  return (receiverLists[midiEventType][channel]->size() > 0 ||
+      receiverLists[midiEventType][OMNI_INDEX]->size() > 0);
+}
+
+void MessageMidiController::scheduleMidiEvents(const ZGMidiEvent *events, int numEvents) {
+  ZGTime blockStartTimestamp = graph->getBlockStartTimestamp();
+  double maxBlockIndex = (double) (graph->getBlockSize()-1);
+  for (int i = 0; i < numEvents; i++) {
+    const ZGMidiEvent *event = &events[i];
+    int channel = event->status & 0x0F;
+    MidiEventType midiEventType;
+    float value0, value1; // as defined by MidiEventType
+    switch (event->status & 0xF0) {
+      case 0x80: { midiEventType = MIDI_NOTE; value0 = event->data1; value1 = 0.0f; break; }
+      case 0x90: { midiEventType = MIDI_NOTE; value0 = event->data1; value1 = event->data2; break; }
+      case 0xB0: { midiEventType = MIDI_CONTROL_CHANGE; value0 = event->data2; value1 = event->data1; break; }
+      case 0xD0: { midiEventType = MIDI_AFTERTOUCH; value0 = event->data1; value1 = 0.0f; break; }
+      case 0xE0: {
+        midiEventType = MIDI_PITCH_BEND;
+        value0 = (float) ((event->data2 << 7) | event->data1);
+        value1 = 0.0f;
+        break;
+      }
+      default: continue; // all other messages are not supported
+    }
+    if (!hasReceivers(midiEventType, channel)) {
+      continue; // nobody is listening
+    }
+    
+    PdMessage *message = getNextOutgoingMessage(midiEventType);
+    ZGTime timestamp = blockStartTimestamp;
+    if (event->blockIndex >= 0.0 && event->blockIndex <= maxBlockIndex) {
+      timestamp += ZGTimeUtils::fromSamples(event->blockIndex);
+    }
+    message->setTimestamp(timestamp);
+    message->setFloat(0, value0);
+    if (message->getNumElements() == 3) {
+      message->setFloat(1, value1);
+      message->setFloat(2, (float) channel);
+    } else {
+      message->setFloat(1, (float) channel);
+    }
+    graph->scheduleMessage(this, midiEventType, message);
+  }
+}
+
+void MessageMidiController::sendMessage(int outletIndex, PdMessage *message) {
+  int channel = (int) message->getFloat(message->getNumElements()-1);
+  List *receiverList = receiverLists[outletIndex][channel];
+  int numReceivers = receiverList->size();
+  for (int i = 0; i < numReceivers; i++) {
+    ((MidiReceiver *) receiverList->get(i))->receiveMessage(0, message);
+  }
+  receiverList = receiverLists[outletIndex][OMNI_INDEX];
+  numReceivers = receiverList->size();
+  for (int i = 0; i < numReceivers; i++) {
+    ((MidiReceiver *) receiverList->get(i))->receiveMessage(0, message);
+  }
+}
+
+void MessageMidiController::addReceiver(MidiReceiver *receiver) {
+  int channel = receiver->isOmni() ? OMNI_INDEX : receiver->getChannel();
+  receiverLists[receiver->getMidiEventType()][channel]->add(receiver);
+}
+
+void MessageMidiController::removeReceiver(MidiReceiver *receiver) {
+  int channel = receiver->isOmni() ? OMNI_INDEX : receiver->getChannel();
+  List *receiverList = receiverLists[receiver->getMidiEventType()][channel];
+  receiverList->remove(receiverList->indexOf(receiver));
+}
+
+List **MessageMidiController::getReceiverListSlot(MidiReceiver *receiver) {
+  int channel = receiver->isOmni() ? OMNI_INDEX : receiver->getChannel();
+  return &receiverLists[receiver->getMidiEventType()][channel];
+}
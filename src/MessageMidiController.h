@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _MESSAGE_MIDI_CONTROLLER_H_
+#define _MESSAGE_MIDI_CONTROLLER_H_
+
+#include "MessageObject.h"
+#include "MidiReceiver.h"
+#include "ZGMidiEvent.h"
+
+/**
+ * The <code>MessageMidiController</code> delivers MIDI events from the host to [notein], [ctlin],
+ * [bendin] and [touchin] objects. Receivers are kept in a table indexed by event type and channel,
+ * such that events are scheduled and dispatched without any receiver name lookups. Events for
+ * which there is no receiver are dropped before they are scheduled.
+ *
+ * Events are scheduled in the global message queue with this object as the sender, and with the
+ * event type as the outlet index. When they become due, they are sent to all receivers of their
+ * channel and then to all omni receivers.
+ */
+class MessageMidiController : public MessageObject {
+  
+  public:
+    MessageMidiController(PdGraph *graph);
+    ~MessageMidiController();
+  
+    const char *getObjectLabel();
+  
+    /** Schedules the given events in the global message queue, relative to the next block. */
+    void scheduleMidiEvents(const ZGMidiEvent *events, int numEvents);
+  
+    void sendMessage(int outletIndex, PdMessage *message);
+  
+    void addReceiver(MidiReceiver *receiver);
+    void removeReceiver(MidiReceiver *receiver);
+  
+    /**
+     * Returns the address of the list of receivers to which the given receiver belongs, which an
+     * edit of the running graph replaces.
+     */
+    List **getReceiverListSlot(MidiReceiver *receiver);
+  
+  private:
+    PdMessage *newCanonicalMessage(int outletIndex);
+  
+    /** Returns <code>true</code> if there is a receiver for events of the given type and channel. */
+    bool hasReceivers(MidiEventType midiEventType, int channel);
+  
+    /** Receivers by event type and channel. The last channel holds all omni receivers. */
+    List *receiverLists[NUM_MIDI_EVENT_TYPES][NUM_MIDI_CHANNELS+1];
+};
+
+#endif // _MESSAGE_MIDI_CONTROLLER_H_
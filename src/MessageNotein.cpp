@@ -20,40 +20,21 @@
  *
  */
 
-#include <stdio.h>
 #include "MessageNotein.h"
 
 MessageNotein::MessageNotein(PdMessage *initMessage, PdGraph *graph) :
-    RemoteMessageReceiver(0, 3, graph) {
-  if (initMessage->isFloat(0) &&
-      (initMessage->getFloat(0) >= 1.0f && initMessage->isFloat(0) <= 16.0f)) {
-    // channel provided (Pd channels are indexed from 1, while ZG channels are indexed from 0)
-    channel = (int) (initMessage->getFloat(0)-1.0f);
-    name = (char *) malloc(13 * sizeof(char));
-    sprintf(name, "zg_notein_%i", channel);
-  } else {
-    // no channel provided, use omni
-    channel = -1;
-    name = StaticUtils::copyString((char *) "zg_notein_omni");
-  }
+    MidiReceiver(MIDI_NOTE, MidiReceiver::channelFromMessage(initMessage, 0), 3, graph) {
+  // nothing to do
 }
 
 MessageNotein::~MessageNotein() {
-  free(name);
+  // nothing to do
 }
 
 const char *MessageNotein::getObjectLabel() {
   return "notein";
 }
 
-int MessageNotein::getChannel() {
-  return channel;
-}
-
-bool MessageNotein::isOmni() {
-  return (channel == -1);
-}
-
 void MessageNotein::processMessage(int inletIndex, PdMessage *message) {
   if (isOmni()) {
     // send channel
@@ -23,25 +23,19 @@
 #ifndef _MESSAGE_NOTEIN_H_
 #define _MESSAGE_NOTEIN_H_
 
-#include "RemoteMessageReceiver.h"
+#include "MidiReceiver.h"
 
 /** [notein], [notein float] */
-class MessageNotein : public RemoteMessageReceiver {
+class MessageNotein : public MidiReceiver {
   
   public:
     MessageNotein(PdMessage *initMessage, PdGraph *graph);
     ~MessageNotein();
     
     const char *getObjectLabel();
-  
-    /** Returns the zero-indexed midi channel which this object outputs. -1 if omni. */
-    int getChannel();
     
   private:
     void processMessage(int inletIndex, PdMessage *message);
-    bool isOmni();
-
-    int channel;
 };
 
 #endif // _MESSAGE_NOTEIN_H_
@@ -173,6 +173,61 @@ void MessageObject::addConnectionToObjectFromOutlet(MessageObject *messageObject
   }
 }
 
+void MessageObject::removeConnectionFromObjectToInlet(MessageObject *messageObject, int outletIndex, int inletIndex) {
+  if (messageObject->getConnectionType(outletIndex) == MESSAGE) {
+    removeConnectionFromList(incomingMessageConnectionsListAtInlet[inletIndex], messageObject, outletIndex);
+  }
+}
+
+void MessageObject::removeConnectionToObjectFromOutlet(MessageObject *messageObject, int inletIndex, int outletIndex) {
+  if (getConnectionType(outletIndex) == MESSAGE) {
+    removeConnectionFromList(outgoingMessageConnectionsListAtOutlet[outletIndex], messageObject, inletIndex);
+  }
+}
+
+bool MessageObject::removeConnectionFromList(List *connectionList, MessageObject *messageObject, int letIndex) {
+  for (int i = 0; i < connectionList->size(); i++) {
+    ObjectLetPair *objectLetPair = (ObjectLetPair *) connectionList->get(i);
+    if (objectLetPair->object == messageObject && objectLetPair->index == letIndex) {
+      connectionList->remove(i);
+      free(objectLetPair);
+      return true;
+    }
+  }
+  return false;
+}
+
+void MessageObject::removeAllConnections() {
+  for (int i = 0; i < numMessageInlets; i++) {
+    List *list = incomingMessageConnectionsListAtInlet[i];
+    while (list->size() > 0) {
+      ObjectLetPair *objectLetPair = (ObjectLetPair *) list->get(0);
+      MessageObject *remoteObject = objectLetPair->object;
+      int outletIndex = objectLetPair->index;
+      remoteObject->removeConnectionToObjectFromOutlet(this, i, outletIndex);
+      removeConnectionFromObjectToInlet(remoteObject, outletIndex, i);
+    }
+  }
+  for (int i = 0; i < numMessageOutlets; i++) {
+    List *list = outgoingMessageConnectionsListAtOutlet[i];
+    while (list->size() > 0) {
+      ObjectLetPair *objectLetPair = (ObjectLetPair *) list->get(0);
+      MessageObject *remoteObject = objectLetPair->object;
+      int inletIndex = objectLetPair->index;
+      remoteObject->removeConnectionFromObjectToInlet(this, i, inletIndex);
+      removeConnectionToObjectFromOutlet(remoteObject, inletIndex, i);
+    }
+  }
+}
+
+int MessageObject::getNumInlets() {
+  return numMessageInlets;
+}
+
+int MessageObject::getNumOutlets() {
+  return numMessageOutlets;
+}
+
 PdMessage *MessageObject::getNextOutgoingMessage(int outletIndex) {
   List *messageOutletPool = messageOutletPools[outletIndex];
   int numMessagesInPool = messageOutletPool->size();
@@ -195,15 +250,6 @@ PdMessage *MessageObject::newCanonicalMessage(int outletIndex) {
   return outgoingMessage;
 }
 
-bool MessageObject::isRootNode() {
-  for (int i = 0; i < numMessageInlets; i++) {
-    if (incomingMessageConnectionsListAtInlet[i]->size() > 0) {
-      return false;
-    }
-  }
-  return true;
-}
-
 bool MessageObject::isLeafNode() {
   for (int i = 0; i < numMessageOutlets; i++) {
     if (outgoingMessageConnectionsListAtOutlet[i]->size() > 0) {
@@ -213,24 +259,18 @@ bool MessageObject::isLeafNode() {
   return true;
 }
 
-List *MessageObject::getProcessOrder() {
-  if (isOrdered) {
-    // if this object has already been ordered, then move on
-    return new List();
+List **MessageObject::getIncomingConnectionsSlot(ConnectionType type, int inletIndex) {
+  if (type == MESSAGE && inletIndex >= 0 && inletIndex < numMessageInlets) {
+    return &incomingMessageConnectionsListAtInlet[inletIndex];
   } else {
-    isOrdered = true;
-    List *processList = new List();
-    if (!isRootNode()) {
-      for (int i = 0; i < numMessageInlets; i++) {
-        for (int j = 0; j < incomingMessageConnectionsListAtInlet[i]->size(); j++) {
-          ObjectLetPair *objectLetPair = (ObjectLetPair *) incomingMessageConnectionsListAtInlet[i]->get(j);
-          List *parentProcessList = objectLetPair->object->getProcessOrder();
-          processList->add(parentProcessList);
-          delete parentProcessList;
-        }
-      }
-    }
-    processList->add(this);
-    return processList;
+    return NULL;
+  }
+}
+
+List **MessageObject::getOutgoingConnectionsSlot(ConnectionType type, int outletIndex) {
+  if (type == MESSAGE && outletIndex >= 0 && outletIndex < numMessageOutlets) {
+    return &outgoingMessageConnectionsListAtOutlet[outletIndex];
+  } else {
+    return NULL;
   }
 }
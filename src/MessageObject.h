@@ -63,6 +63,35 @@ class MessageObject {
     /** Establish a connection to another object from this object. */
     virtual void addConnectionToObjectFromOutlet(MessageObject *messageObject, int inletIndex, int outletIndex);
   
+    /** Remove a connection from another object to this object. Does nothing if no such connection exists. */
+    virtual void removeConnectionFromObjectToInlet(MessageObject *messageObject, int outletIndex, int inletIndex);
+  
+    /** Remove a connection to another object from this object. Does nothing if no such connection exists. */
+    virtual void removeConnectionToObjectFromOutlet(MessageObject *messageObject, int inletIndex, int outletIndex);
+  
+    /**
+     * Remove all connections to and from this object, on both ends of each connection. Used when
+     * the object is removed from a running graph.
+     */
+    virtual void removeAllConnections();
+  
+    /** Returns the graph to which this object belongs. */
+    inline PdGraph *getGraph() { return graph; }
+  
+    /** Returns the number of inlets of this object. */
+    virtual int getNumInlets();
+  
+    /** Returns the number of message inlets of this object. */
+    inline int getNumMessageInlets() { return numMessageInlets; }
+  
+    /** Returns the list of objects (and their outlets) from which messages arrive at the given inlet. */
+    inline List *getIncomingMessageConnections(int inletIndex) {
+      return incomingMessageConnectionsListAtInlet[inletIndex];
+    }
+  
+    /** Returns the number of outlets of this object. */
+    virtual int getNumOutlets();
+  
     /** Returns the label for this object. */
     virtual const char *getObjectLabel() = 0;
   
@@ -80,13 +109,6 @@ class MessageObject {
      */
     virtual bool shouldDistributeMessageToInlets();
   
-   /**
-    * Returns <code>true</code> if this object is a root in the Pd tree. <code>false</code> otherwise.
-    * This function is used only while computing the process order of objects. For this reason it also
-    * returns true in the cases when the object is receive, receive~, or catch~.
-    */
-    virtual bool isRootNode();
-  
     /**
      * Returns <code>true</code> if this object is a leaf in the Pd tree. <code>false</code> otherwise.
      * This function is used only while computing the process order of objects. For this reason it also
@@ -94,10 +116,24 @@ class MessageObject {
      */
     virtual bool isLeafNode();
   
-    /** Returns an ordered list of all parent objects of this object. */
-    virtual List *getProcessOrder();
+    /**
+     * Returns the address of the list of connections of the given type arriving at the given inlet,
+     * or <code>NULL</code> if this object has no such list. A running graph is edited by replacing
+     * these lists, such that the audio thread never allocates memory.
+     */
+    virtual List **getIncomingConnectionsSlot(ConnectionType type, int inletIndex);
+  
+    /** Returns the address of the list of connections of the given type leaving the given outlet, or <code>NULL</code>. */
+    virtual List **getOutgoingConnectionsSlot(ConnectionType type, int outletIndex);
+  
+    /** Returns <code>true</code> if this object has already been considered while ordering the process tree. */
+    inline bool isOrderedFlagSet() { return isOrdered; }
   
-    // TODO(mhroth): one day there will have to be a recusive function to reset the isOrdered flag.
+    /**
+     * Sets or clears the flag indicating that this object has already been ordered, such that the
+     * process order of the graph can be recomputed.
+     */
+    inline void setOrderedFlag(bool isOrdered) { this->isOrdered = isOrdered; }
     
   protected:
     /** Returns a message that can be sent from the given outlet. */
@@ -106,6 +142,12 @@ class MessageObject {
     /** Returns a new message for use at the given outlet. */
     virtual PdMessage *newCanonicalMessage(int outletIndex);
   
+    /**
+     * Removes the connection to or from the given object and let index from the given list.
+     * Returns <code>true</code> if the connection was found (and removed), <code>false</code> otherwise.
+     */
+    bool removeConnectionFromList(List *connectionList, MessageObject *messageObject, int letIndex);
+  
     PdGraph *graph;    
     int numMessageInlets;
     int numMessageOutlets;
@@ -26,9 +26,9 @@
 MessagePipe::MessagePipe(PdMessage *initMessage, PdGraph *graph) : MessageObject(1, 1, graph) {
   if (initMessage->getNumElements() > 0 &&
       initMessage->getElement(0)->getType() == FLOAT) {
-    delayMs = (double) initMessage->getElement(0)->getFloat();
+    delayTime = graph->millisecondsToTime((double) initMessage->getElement(0)->getFloat());
   } else {
-    delayMs = 0.0;
+    delayTime = 0;
   }
 }
 
@@ -57,7 +57,7 @@ void MessagePipe::processMessage(int inletIndex, PdMessage *message) {
         }
         case FLOAT:
         case BANG: {
-          message->setTimestamp(message->getTimestamp() + delayMs);
+          message->setTimestamp(message->getTimestamp() + delayTime);
           graph->scheduleMessage(this, 0, message);
           break;
         }
@@ -36,7 +36,7 @@ class MessagePipe : public MessageObject {
   private:
     void processMessage(int inletIndex, PdMessage *message);
   
-    double delayMs; // the delay in milliseconds
+    ZGTime delayTime; // the delay, converted from milliseconds
 };
 
 #endif // _MESSAGE_PIPE_H_
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MessagePoly.h"
+
+MessagePoly::MessagePoly(PdMessage *initMessage, PdGraph *graph) : MessageObject(2, 3, graph) {
+  numVoices = initMessage->isFloat(0) ? (int) initMessage->getFloat(0) : 1;
+  if (numVoices < 1) {
+    numVoices = 1;
+  }
+  shouldSteal = initMessage->isFloat(1) && initMessage->getFloat(1) != 0.0f;
+  velocity = 0.0f;
+  voicePitch = (float *) calloc(numVoices, sizeof(float));
+  isVoiceUsed = (bool *) calloc(numVoices, sizeof(bool));
+  voiceSerial = (unsigned int *) calloc(numVoices, sizeof(unsigned int));
+  serial = 0;
+}
+
+MessagePoly::~MessagePoly() {
+  free(voicePitch);
+  free(isVoiceUsed);
+  free(voiceSerial);
+}
+
+const char *MessagePoly::getObjectLabel() {
+  return "poly";
+}
+
+void MessagePoly::processMessage(int inletIndex, PdMessage *message) {
+  switch (inletIndex) {
+    case 0: {
+      if (message->isFloat(0)) {
+        processNote(message->getFloat(0), message->getTimestamp());
+      } else if (message->isSymbol(0)) {
+        if (strcmp(message->getSymbol(0), "stop") == 0) {
+          stop(message->getTimestamp());
+        } else if (strcmp(message->getSymbol(0), "clear") == 0) {
+          // forget all notes without turning them off
+          for (int i = 0; i < numVoices; i++) {
+            isVoiceUsed[i] = false;
+            voiceSerial[i] = 0;
+          }
+          serial = 0;
+        }
+      }
+      break;
+    }
+    case 1: {
+      if (message->isFloat(0)) {
+        velocity = message->getFloat(0);
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+void MessagePoly::processNote(float pitch, ZGTime timestamp) {
+  if (velocity > 0.0f) {
+    // find the voice which has been free for the longest time, and otherwise the oldest note
+    int freeVoice = -1;
+    int oldestVoice = -1;
+    for (int i = 0; i < numVoices; i++) {
+      if (!isVoiceUsed[i]) {
+        if (freeVoice == -1 || voiceSerial[i] < voiceSerial[freeVoice]) {
+          freeVoice = i;
+        }
+      } else if (oldestVoice == -1 || voiceSerial[i] < voiceSerial[oldestVoice]) {
+        oldestVoice = i;
+      }
+    }
+    if (freeVoice == -1) {
+      if (!shouldSteal) {
+        return; // all voices are busy. The note is dropped.
+      }
+      // turn off the oldest note before its voice is reused
+      freeVoice = oldestVoice;
+      sendVoice(freeVoice, voicePitch[freeVoice], 0.0f, timestamp);
+    }
+    isVoiceUsed[freeVoice] = true;
+    voicePitch[freeVoice] = pitch;
+    voiceSerial[freeVoice] = ++serial;
+    sendVoice(freeVoice, pitch, velocity, timestamp);
+  } else {
+    // free the voice playing the oldest note of this pitch
+    int usedVoice = -1;
+    for (int i = 0; i < numVoices; i++) {
+      if (isVoiceUsed[i] && voicePitch[i] == pitch &&
+          (usedVoice == -1 || voiceSerial[i] < voiceSerial[usedVoice])) {
+        usedVoice = i;
+      }
+    }
+    if (usedVoice != -1) {
+      isVoiceUsed[usedVoice] = false;
+      voiceSerial[usedVoice] = ++serial;
+      sendVoice(usedVoice, pitch, 0.0f, timestamp);
+    }
+  }
+}
+
+void MessagePoly::stop(ZGTime timestamp) {
+  for (int i = 0; i < numVoices; i++) {
+    if (isVoiceUsed[i]) {
+      isVoiceUsed[i] = false;
+      voiceSerial[i] = ++serial;
+      sendVoice(i, voicePitch[i], 0.0f, timestamp);
+    }
+  }
+}
+
+void MessagePoly::sendVoice(int voiceIndex, float pitch, float velocity, ZGTime timestamp) {
+  PdMessage *outgoingMessage = getNextOutgoingMessage(2);
+  outgoingMessage->setTimestamp(timestamp);
+  outgoingMessage->setFloat(0, velocity);
+  sendMessage(2, outgoingMessage);
+  
+  outgoingMessage = getNextOutgoingMessage(1);
+  outgoingMessage->setTimestamp(timestamp);
+  outgoingMessage->setFloat(0, pitch);
+  sendMessage(1, outgoingMessage);
+  
+  outgoingMessage = getNextOutgoingMessage(0);
+  outgoingMessage->setTimestamp(timestamp);
+  outgoingMessage->setFloat(0, (float) (voiceIndex + 1));
+  sendMessage(0, outgoingMessage);
+}
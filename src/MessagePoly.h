@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _MESSAGE_POLY_H_
+#define _MESSAGE_POLY_H_
+
+#include "MessageObject.h"
+
+/**
+ * [poly], [poly numVoices], [poly numVoices steal]
+ * Allocates voices for notes. A note with non-zero velocity is given the free voice which has been
+ * free for the longest time. If no voice is free and stealing is on, the oldest note is turned off
+ * and its voice is reused. A note with zero velocity frees the voice which plays it. Voices are
+ * numbered from 1, and are sent as <voice, pitch, velocity> from right to left.
+ */
+class MessagePoly : public MessageObject {
+  
+  public:
+    MessagePoly(PdMessage *initMessage, PdGraph *graph);
+    ~MessagePoly();
+  
+    const char *getObjectLabel();
+  
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+  
+    /** Handles a note at the left inlet, using the most recently received velocity. */
+    void processNote(float pitch, ZGTime timestamp);
+  
+    /** Sends the voice, pitch and velocity from right to left. */
+    void sendVoice(int voiceIndex, float pitch, float velocity, ZGTime timestamp);
+  
+    /** Turns off all active voices. */
+    void stop(ZGTime timestamp);
+  
+    int numVoices;
+    bool shouldSteal;
+  
+    /** The velocity received at the right inlet, which applies to the next note. */
+    float velocity;
+  
+    /** The pitch currently played by each voice. */
+    float *voicePitch;
+  
+    /** Indicates which voices are currently playing a note. */
+    bool *isVoiceUsed;
+  
+    /**
+     * The serial number of the last change of each voice. The voice with the lowest serial
+     * number among those which are free (or used) has been so for the longest time.
+     */
+    unsigned int *voiceSerial;
+    unsigned int serial;
+};
+
+#endif // _MESSAGE_POLY_H_
@@ -22,6 +22,7 @@
 
 #include "MessagePrint.h"
 #include "PdGraph.h"
+#include "EventQueue.h"
 
 MessagePrint::MessagePrint(PdMessage *initMessage, PdGraph *graph) : MessageObject(1, 0, graph) {
   if (initMessage->getNumElements() > 0) {
@@ -47,11 +48,11 @@ const char *MessagePrint::getObjectLabel() {
 }
 
 void MessagePrint::processMessage(int inletIndex, PdMessage *message) {
-  char *out = message->toString();
+  char out[PRINT_RECORD_LENGTH];
+  message->toString(out, PRINT_RECORD_LENGTH);
   if (name != NULL) {
-    graph->printStd("[@ %.3fms] %s: %s\n", message->getTimestamp(), name, out);
+    graph->printStd("[@ %.3fms] %s: %s\n", graph->timeToMilliseconds(message->getTimestamp()), name, out);
   } else {
-    graph->printStd("[@ %.3fms] %s\n", message->getTimestamp(), out);
+    graph->printStd("[@ %.3fms] %s\n", graph->timeToMilliseconds(message->getTimestamp()), out);
   }
-  free(out);
 }
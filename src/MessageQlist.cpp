@@ -0,0 +1,165 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MessageQlist.h"
+#include "PdGraph.h"
+#include "TextSequence.h"
+
+MessageQlist::MessageQlist(PdMessage *initMessage, PdGraph *graph) : MessageTextfile(initMessage, graph) {
+  isPlaying = false;
+  startTimestamp = 0;
+  startOnset = 0.0;
+  timeScale = 1.0;
+}
+
+MessageQlist::~MessageQlist() {
+  // nothing to do
+}
+
+const char *MessageQlist::getObjectLabel() {
+  return "qlist";
+}
+
+ZGTime MessageQlist::getNextLineTimestamp() {
+  return startTimestamp +
+      graph->millisecondsToTime((sequence->getOnset(lineIndex) - startOnset) * timeScale);
+}
+
+void MessageQlist::processMessage(int inletIndex, PdMessage *message) {
+  // message boxes send the symbol "bang"
+  MessageElementType type = (message->isSymbol(0) && strcmp(message->getSymbol(0), "bang") == 0)
+      ? BANG : message->getType(0);
+  switch (type) {
+    case BANG: {
+      lineIndex = 0;
+      play(message->getTimestamp());
+      break;
+    }
+    case SYMBOL: {
+      const char *command = message->getSymbol(0);
+      if (strcmp(command, "rewind") == 0) {
+        stop();
+        lineIndex = 0;
+      } else if (strcmp(command, "stop") == 0) {
+        stop();
+      } else if (strcmp(command, "next") == 0) {
+        bool isWaitDropped = message->isFloat(1) && message->getFloat(1) != 0.0f;
+        while (lineIndex < sequence->getNumLines()) {
+          int index = lineIndex++;
+          if (!sequence->isWait(index)) {
+            sendLine(index, message->getTimestamp());
+            if (lineIndex != index + 1) {
+              return; // the line has moved this object to another line, e.g. with "rewind"
+            }
+          } else {
+            if (!isWaitDropped) {
+              sendLine(index, message->getTimestamp());
+            }
+            return;
+          }
+        }
+        sendEnd(message->getTimestamp());
+      } else if (strcmp(command, "tempo") == 0) {
+        if (message->isFloat(1)) {
+          float tempo = message->getFloat(1);
+          if (isPlaying) {
+            // continue from the current position of the sequence, at the new tempo
+            ZGTime timestamp = message->getTimestamp();
+            startOnset += graph->timeToMilliseconds(timestamp - startTimestamp) / timeScale;
+            startTimestamp = timestamp;
+          }
+          timeScale = 1.0 / ((tempo > 1e-20f) ? (double) tempo : 1e-20);
+        }
+      } else {
+        if (strcmp(command, "clear") == 0 || strcmp(command, "set") == 0 ||
+            strcmp(command, "read") == 0) {
+          stop(); // the lines are replaced
+        }
+        if (!processSequenceMessage(message)) {
+          graph->printErr("qlist: unknown message \"%s\".\n", command);
+        }
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+void MessageQlist::play(ZGTime timestamp) {
+  if (!isPlaying) {
+    isPlaying = true;
+    graph->scheduleSequence(this);
+  }
+  startTimestamp = timestamp;
+  startOnset = sequence->getOnset(lineIndex);
+  
+  // the lines which are due now are sent immediately, as they would be by a message box
+  while (isPlaying && lineIndex < sequence->getNumLines() && getNextLineTimestamp() <= timestamp) {
+    sendNextLine();
+  }
+  if (isPlaying && lineIndex >= sequence->getNumLines()) {
+    stop();
+    sendEnd(timestamp);
+  }
+}
+
+void MessageQlist::stop() {
+  if (isPlaying) {
+    isPlaying = false;
+    graph->cancelSequence(this);
+  }
+}
+
+void MessageQlist::sendNextLine() {
+  ZGTime timestamp = getNextLineTimestamp();
+  if (timestamp < graph->getBlockStartTimestamp()) {
+    timestamp = graph->getBlockStartTimestamp(); // as for scheduled messages
+  }
+  // the line index is advanced first, such that the receivers of the line may control this object
+  int index = lineIndex++;
+  sendLine(index, timestamp);
+  if (isPlaying && lineIndex >= sequence->getNumLines()) {
+    stop();
+    sendEnd(timestamp);
+  }
+}
+
+void MessageQlist::sendLine(int index, ZGTime timestamp) {
+  PdMessage *outgoingMessage = getNextOutgoingMessage(0);
+  outgoingMessage->setTimestamp(timestamp);
+  if (sequence->isWait(index)) {
+    sequence->copyLineToMessage(index, 0, outgoingMessage);
+    sendMessage(0, outgoingMessage);
+  } else {
+    sequence->copyLineToMessage(index, 1, outgoingMessage);
+    graph->dispatchMessageToNamedReceivers(sequence->getSymbol(index, 0), outgoingMessage);
+  }
+}
+
+void MessageQlist::sendEnd(ZGTime timestamp) {
+  PdMessage *outgoingMessage = getNextOutgoingMessage(1);
+  outgoingMessage->setTimestamp(timestamp);
+  outgoingMessage->getElement(0)->setBang();
+  sendMessage(1, outgoingMessage);
+}
@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _MESSAGE_QLIST_H_
+#define _MESSAGE_QLIST_H_
+
+#include "MessageTextfile.h"
+
+/**
+ * [qlist]
+ * Plays a sequence of lines. A line which starts with a float is sent from the left outlet, and
+ * the following lines are sent that many milliseconds later. All other lines are sent to the
+ * receivers named by their first element. A bang starts playback from the first line, and the
+ * right outlet bangs when the last one has been sent. "next [1]" instead sends the lines up to and
+ * including the next wait immediately (the wait itself is dropped if the argument is given).
+ * <br>
+ * While playing, the <code>PdGraph</code> asks for the timestamp of the next line in every block
+ * and sends it in order with the scheduled messages, such that no message is scheduled per line.
+ */
+class MessageQlist : public MessageTextfile {
+  
+  public:
+    MessageQlist(PdMessage *initMessage, PdGraph *graph);
+    ~MessageQlist();
+  
+    const char *getObjectLabel();
+  
+    /** Returns the time at which the next line is due. Only valid while playing. */
+    ZGTime getNextLineTimestamp();
+  
+    /**
+     * Sends the next line, and bangs the right outlet if it was the last. Called by the
+     * <code>PdGraph</code> while playing.
+     */
+    void sendNextLine();
+  
+  private:
+    void processMessage(int inletIndex, PdMessage *message);
+  
+    /** Starts playback from the current line at the given time. */
+    void play(ZGTime timestamp);
+  
+    /** Stops playback. The current line is kept. */
+    void stop();
+  
+    /** Sends the given line, from the left outlet if it is a wait, or to the named receivers. */
+    void sendLine(int index, ZGTime timestamp);
+  
+    /** Bangs the right outlet at the given time. */
+    void sendEnd(ZGTime timestamp);
+  
+    bool isPlaying;
+  
+    /** The time at which the sequence is at <code>startOnset</code>. */
+    ZGTime startTimestamp;
+    double startOnset;
+  
+    /** The duration of one millisecond of the sequence, in milliseconds. Set with "tempo". */
+    double timeScale;
+};
+
+#endif // _MESSAGE_QLIST_H_
@@ -21,6 +21,7 @@
  */
 
 #include "MessageRandom.h"
+#include "PdGraph.h"
 
 MessageRandom::MessageRandom(PdMessage *initMessage, PdGraph *graph) : MessageObject(2, 1, graph) {
   if (initMessage->getNumElements() > 0 &&
@@ -29,22 +30,26 @@ MessageRandom::MessageRandom(PdMessage *initMessage, PdGraph *graph) : MessageOb
   } else {
     max_inc = 1;
   }
-  twister = new MTRand();
+  generator = graph->newRandomGenerator();
 }
 
 MessageRandom::MessageRandom(int N, PdGraph *graph) : MessageObject(2, 1, graph) {
   this->max_inc = N-1;
-  twister = new MTRand();
+  generator = graph->newRandomGenerator();
 }
 
 MessageRandom::~MessageRandom() {
-  delete twister;
+  delete generator;
 }
 
 const char *MessageRandom::getObjectLabel() {
   return "random";
 }
 
+bool MessageRandom::shouldDistributeMessageToInlets() {
+  return false;
+}
+
 void MessageRandom::processMessage(int inletIndex, PdMessage *message) {
   switch (inletIndex) {
     case 0: {
@@ -54,14 +59,16 @@ void MessageRandom::processMessage(int inletIndex, PdMessage *message) {
           if (strcmp(messageElement->getSymbol(), "seed") == 0 &&
               message->getNumElements() > 1 &&
               message->getElement(1)->getType() == FLOAT) {
-            twister->seed((int) message->getElement(1)->getFloat()); // reset the seed
+            generator->seed((unsigned int) message->getElement(1)->getFloat()); // reset the seed
           }
           break;
         }
         case BANG: {
           PdMessage *outgoingMessage = getNextOutgoingMessage(0);
           outgoingMessage->setTimestamp(message->getTimestamp());
-          outgoingMessage->getElement(0)->setFloat((float) twister->randInt(max_inc));
+          // a range of less than one always yields zero
+          unsigned int maxValue = (max_inc > 0) ? (unsigned int) max_inc : 0;
+          outgoingMessage->getElement(0)->setFloat((float) generator->nextInt(maxValue));
           sendMessage(0, outgoingMessage);
           break;
         }
@@ -69,6 +76,7 @@ void MessageRandom::processMessage(int inletIndex, PdMessage *message) {
           break;
         }
       }
+      break;
     }
     case 1: {
       if (message->getElement(0)->getType() == FLOAT) {
@@ -23,8 +23,8 @@
 #ifndef _MESSAGE_RANDOM_H_
 #define _MESSAGE_RANDOM_H_
 
-#include "MersenneTwister.h"
 #include "MessageObject.h"
+#include "RandomGenerator.h"
 
 class PdGraph;
 
@@ -40,10 +40,13 @@ class MessageRandom : public MessageObject {
     
   protected:
     void processMessage(int inletIndex, PdMessage *message);
+  
+    /** A seed message must reach the left inlet whole, instead of its seed setting the range. */
+    bool shouldDistributeMessageToInlets();
     
   private:
     int max_inc; // random output is in range [0, max_inc]
-    MTRand *twister;
+    RandomGenerator *generator;
 };
 
 #endif // _MESSAGE_RANDOM_H_
@@ -57,22 +57,30 @@ const char *MessageSendController::getObjectLabel() {
   return "sendcontroller";
 }
 
-int MessageSendController::getNameIndex(char *receiverName) {
-  int numNames = nameList->size();
+int MessageSendController::findName(List *list, char *receiverName) {
+  int numNames = list->size();
   for (int i = 0; i < numNames; i++) {
-    char *name = (char *) nameList->get(i);
+    char *name = (char *) list->get(i);
     if (strcmp(name, receiverName) == 0) {
       return i;
     }
   }
-  if (strcmp("pd", receiverName) == 0) {
+  return -1;
+}
+
+int MessageSendController::getNameIndex(char *receiverName) {
+  int nameIndex = findName(nameList, receiverName);
+  if (nameIndex == -1 && strcmp("pd", receiverName) == 0) {
     return SYSTEM_NAME_INDEX; // a special case for sending messages to the system
   }
-  return -1;
+  return nameIndex;
 }
 
 void MessageSendController::receiveMessage(char *name, PdMessage *message) {
-  processMessage(getNameIndex(name), message);
+  int nameIndex = getNameIndex(name);
+  if (nameIndex >= 0) { // nothing to do if there has never been a receiver with this name
+    processMessage(nameIndex, message);
+  }
 }
 
 void MessageSendController::processMessage(int inletIndex, PdMessage *message) {
@@ -104,3 +112,39 @@ void MessageSendController::addReceiver(RemoteMessageReceiver *receiver) {
   List *receiverList = (List *) receiverLists->get(nameIndex);
   receiverList->add(receiver);
 }
+
+void MessageSendController::removeReceiver(RemoteMessageReceiver *receiver) {
+  int nameIndex = getNameIndex(receiver->getName());
+  if (nameIndex >= 0 && nameIndex != SYSTEM_NAME_INDEX) {
+    List *receiverList = (List *) receiverLists->get(nameIndex);
+    receiverList->remove(receiverList->indexOf(receiver));
+  }
+}
+
+void MessageSendController::planAddReceiver(RemoteMessageReceiver *receiver, GraphEdit *graphEdit) {
+  int nameIndex = findName(graph->getPlannedList(&nameList), receiver->getName());
+  List *newReceiverLists = graph->getEditedList(graphEdit, &receiverLists);
+  if (nameIndex == -1) {
+    graphEdit->receiverName = StaticUtils::copyString(receiver->getName());
+    graph->getEditedList(graphEdit, &nameList)->add(graphEdit->receiverName);
+    graphEdit->receiverList = new List();
+    newReceiverLists->add((void *) graphEdit->receiverList);
+  } else {
+    // the list of receivers is read by the audio thread, and so is replaced by a copy
+    graphEdit->replacedReceiverList = (List *) newReceiverLists->get(nameIndex);
+    graphEdit->receiverList = (new List())->add(graphEdit->replacedReceiverList);
+    newReceiverLists->replace(nameIndex, graphEdit->receiverList);
+  }
+  graphEdit->receiverList->add(receiver);
+}
+
+void MessageSendController::planRemoveReceiver(RemoteMessageReceiver *receiver, GraphEdit *graphEdit) {
+  int nameIndex = findName(graph->getPlannedList(&nameList), receiver->getName());
+  if (nameIndex >= 0) {
+    List *newReceiverLists = graph->getEditedList(graphEdit, &receiverLists);
+    graphEdit->replacedReceiverList = (List *) newReceiverLists->get(nameIndex);
+    graphEdit->receiverList = (new List())->add(graphEdit->replacedReceiverList);
+    graphEdit->receiverList->remove(graphEdit->receiverList->indexOf(receiver));
+    newReceiverLists->replace(nameIndex, graphEdit->receiverList);
+  }
+}
@@ -23,6 +23,7 @@
 #ifndef _MESSAGE_SEND_CONTROLLER_H_
 #define _MESSAGE_SEND_CONTROLLER_H_
 
+#include "GraphEdit.h"
 #include "MessageObject.h"
 #include "RemoteMessageReceiver.h"
 
@@ -63,9 +64,27 @@ class MessageSendController : public MessageObject {
   
     void addReceiver(RemoteMessageReceiver *receiver);
   
+    /**
+     * Removes the receiver from the list of receivers for its name. The name itself remains known
+     * such that indicies which have already been handed out remain valid.
+     */
+    void removeReceiver(RemoteMessageReceiver *receiver);
+  
+    /**
+     * Adds the lists of names and receivers which include the given receiver to the given edit of
+     * the running graph, which exchanges them for the current ones. Called by the control thread.
+     */
+    void planAddReceiver(RemoteMessageReceiver *receiver, GraphEdit *graphEdit);
+  
+    /** Adds the lists of receivers which exclude the given receiver to the given edit. */
+    void planRemoveReceiver(RemoteMessageReceiver *receiver, GraphEdit *graphEdit);
+  
   private:
     void processMessage(int inletIndex, PdMessage *message);
   
+    /** Returns the index of the given name in the given list of names, or -1 if it is not there. */
+    static int findName(List *list, char *name);
+  
     List *nameList;
     List *receiverLists;
   
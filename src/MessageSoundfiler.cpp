@@ -1,5 +1,5 @@
 /*
- *  Copyright 2009 Reality Jockey, Ltd.
+ *  Copyright 2009,2010 Reality Jockey, Ltd.
  *                 info@rjdj.me
  *                 http://rjdj.me/
  * 
@@ -20,102 +20,207 @@
  *
  */
 
-#include <sndfile.h>
-#include "MessageSoundfiler.h"
 #include "DspTable.h"
-#include "StaticUtils.h"
+#include "MessageSoundfiler.h"
+#include "PdGraph.h"
+#include "SampleLoader.h"
+
+/** The maximum number of channels of a sound file, as in Pd. */
+#define MAX_SOUNDFILER_CHANNELS 64
 
-MessageSoundfiler::MessageSoundfiler(PdGraph *pdGraph, char *initString) : 
-    MessageInputMessageOutputObject(1, 1, initString) {
-  this->pdGraph = pdGraph;
+MessageSoundfiler::MessageSoundfiler(PdMessage *initMessage, PdGraph *graph) : MessageObject(1, 1, graph) {
+  // nothing to do
 }
 
 MessageSoundfiler::~MessageSoundfiler() {
-  // nothing to do
+  graph->getSampleLoader()->cancelRequests(this);
+}
+
+const char *MessageSoundfiler::getObjectLabel() {
+  return "soundfiler";
+}
+
+void MessageSoundfiler::processMessage(int inletIndex, PdMessage *message) {
+  if (message->isSymbol(0)) {
+    if (strcmp(message->getSymbol(0), "read") == 0) {
+      read(message);
+    } else if (strcmp(message->getSymbol(0), "write") == 0) {
+      write(message);
+    } else {
+      graph->printErr("soundfiler: unknown message \"%s\".\n", message->getSymbol(0));
+    }
+  }
 }
 
-inline void MessageSoundfiler::processMessage(int inletIndex, PdMessage *message) {
-  if (inletIndex == 0) {
-    int currentElementIndex = 0;
-    bool shouldResizeTable = false;
-    MessageElement *messageElement = message->getElement(currentElementIndex++);
-    if (messageElement != NULL && 
-        messageElement->getType() == SYMBOL &&
-        strcmp(messageElement->getSymbol(), "read") == 0) {
-      while ((messageElement = message->getElement(currentElementIndex++)) != NULL) {
-        if (messageElement->getType() == SYMBOL) {
-          // only the -resize flag is supported for now
-          if (strcmp(messageElement->getSymbol(), "-resize") == 0) {
-            shouldResizeTable = true;
-          } else {
-            // all of the flags should have been seen now and now we expect the last two parameters,
-            // which are file location and destination table name
-            MessageElement *tableNameElement = message->getElement(currentElementIndex++);
-            if (messageElement != NULL && messageElement->getType() == SYMBOL &&
-                tableNameElement != NULL && tableNameElement->getType() == SYMBOL) {
-              // use libsndfile to load and read the file (also converting the samples to [-1,1] float)
-              SF_INFO sfInfo;
-              char *filename = StaticUtils::joinPaths(pdGraph->getDirectory(), messageElement->getSymbol());
-              SNDFILE *sndFile = sf_open(filename, SFM_READ, &sfInfo);
-              free(filename);
-              if (sndFile == NULL) {
-                return; // there was an error reading the file. Move on with life.
-              } else if (!((sfInfo.format & 0x00FF0000) == SF_FORMAT_WAV ||
-                         (sfInfo.format & 0x00FF0000) == SF_FORMAT_AIFF)) {
-                // we only support WAV and AIFF files (somewhat artificially
-                // because libsndfile can easily load other formats)
-                return;
-              }
-              // It is assumed that the channels are interleaved.
-              int samplesPerChannel = sfInfo.frames;
-              int bufferLength = samplesPerChannel * sfInfo.channels;
-              float *buffer = (float *) malloc(bufferLength * sizeof(float)); // create a buffer in memory for the file data
-              sf_read_float(sndFile, buffer, bufferLength); // read the whole file into memory
-              sf_close(sndFile); // release the handle to the file
-              
-              if (sfInfo.channels > 0) { // sanity check
-                // extract the first channel
-                float *channelBuffer = (float *) malloc(samplesPerChannel * sizeof(float));
-                for (int i = 0, j = 0; i < bufferLength; i+=sfInfo.channels, j++) {
-                  channelBuffer[j] = buffer[i];
-                }
-                DspTable *table = pdGraph->getTable(tableNameElement->getSymbol());
-                if (table != NULL) {
-                  // copy the buffer to the table
-                  table->setBuffer(channelBuffer, samplesPerChannel, shouldResizeTable);
-                  
-                  PdMessage *outgoingMessage = getNextOutgoingMessage(0);
-                  outgoingMessage->setBlockIndex(message->getBlockIndex());
-                  outgoingMessage->getElement(0)->setFloat((float) samplesPerChannel);
-                }
-                
-                // extract the second channel (if it exists and if there is a table to write it to)
-                if (sfInfo.channels > 1 &&
-                    (tableNameElement = message->getElement(currentElementIndex++)) != NULL &&
-                    tableNameElement->getType() == SYMBOL &&
-                    (table = pdGraph->getTable(tableNameElement->getSymbol())) != NULL) {
-                  for (int i = 1, j = 0; i < bufferLength; i+=sfInfo.channels, j++) {
-                    channelBuffer[j] = buffer[i];
-                  }
-                  table->setBuffer(channelBuffer, samplesPerChannel, shouldResizeTable);
-                }
-                free(channelBuffer);
-              }
-              free(buffer);
-            }
-          }
-        }
-      }
-    } else if (messageElement != NULL && 
-        messageElement->getType() == SYMBOL &&
-        strcmp(messageElement->getSymbol(), "write") == 0) {
-      // TODO(mhroth): not supported yet
+char *MessageSoundfiler::getPath(char *filename) {
+  if (filename[0] == '/' || graph->getDirectory() == NULL) {
+    return StaticUtils::copyString(filename);
+  } else {
+    return StaticUtils::joinPaths(graph->getDirectory(), filename);
+  }
+}
+
+void MessageSoundfiler::read(PdMessage *message) {
+  bool shouldResize = false;
+  int skipFrames = 0;
+  int maxFrames = -1;
+  int index = 1;
+  while (message->isSymbol(index) && message->getSymbol(index)[0] == '-') {
+    char *flag = message->getSymbol(index++);
+    if (strcmp(flag, "-resize") == 0) {
+      shouldResize = true;
+    } else if (strcmp(flag, "-skip") == 0 && message->isFloat(index)) {
+      skipFrames = (int) message->getFloat(index++);
+    } else if (strcmp(flag, "-maxsize") == 0 && message->isFloat(index)) {
+      maxFrames = (int) message->getFloat(index++);
+    } else {
+      graph->printErr("soundfiler: read flag \"%s\" is not supported.\n", flag);
+      return;
+    }
+  }
+  if (!message->isSymbol(index)) {
+    graph->printErr("soundfiler: read requires a file name.\n");
+    return;
+  }
+  char *filename = message->getSymbol(index++);
+  int numTables = 0;
+  while (message->isSymbol(index + numTables) && numTables < MAX_SOUNDFILER_CHANNELS) {
+    numTables++;
+  }
+  
+  char *path = getPath(filename);
+  SampleLoadRequest *request = SampleLoader::newRequest(SAMPLE_LOAD_READ, this, path, numTables);
+  free(path);
+  request->shouldResize = shouldResize;
+  request->skipFrames = (skipFrames > 0) ? skipFrames : 0;
+  request->maxFrames = maxFrames;
+  for (int i = 0; i < numTables; i++, index++) {
+    // tables are looked up again when the request completes. Missing tables are skipped.
+    request->tableNames[i] = StaticUtils::copyString(message->getSymbol(index));
+    DspTable *table = graph->getTable(request->tableNames[i]);
+    if (table == NULL) {
+      graph->printErr("soundfiler: table \"%s\" does not exist.\n", request->tableNames[i]);
+      request->tableLengths[i] = -1;
+    } else {
+      table->getBuffer(&request->tableLengths[i]);
     }
   }
+  if (!graph->getSampleLoader()->submit(request)) {
+    graph->printErr("soundfiler: too many requests. \"%s\" will not be read.\n", filename);
+  }
 }
 
-PdMessage *MessageSoundfiler::newCanonicalMessage() {
-  PdMessage *message = new PdMessage();
-  message->addElement(new MessageElement(0.0f));
-  return message;
+void MessageSoundfiler::write(PdMessage *message) {
+  int bitsPerSample = 16;
+  int sampleRate = (int) graph->getSampleRate();
+  int skipFrames = 0;
+  int maxFrames = -1;
+  int index = 1;
+  while (message->isSymbol(index) && message->getSymbol(index)[0] == '-') {
+    char *flag = message->getSymbol(index++);
+    if (strcmp(flag, "-bytes") == 0 && message->isFloat(index)) {
+      bitsPerSample = 8 * (int) message->getFloat(index++);
+    } else if (strcmp(flag, "-rate") == 0 && message->isFloat(index)) {
+      sampleRate = (int) message->getFloat(index++);
+    } else if (strcmp(flag, "-skip") == 0 && message->isFloat(index)) {
+      skipFrames = (int) message->getFloat(index++);
+    } else if (strcmp(flag, "-nframes") == 0 && message->isFloat(index)) {
+      maxFrames = (int) message->getFloat(index++);
+    } else if (strcmp(flag, "-wave") == 0) {
+      // WAV is the only supported format
+    } else {
+      graph->printErr("soundfiler: write flag \"%s\" is not supported.\n", flag);
+      return;
+    }
+  }
+  if (!message->isSymbol(index)) {
+    graph->printErr("soundfiler: write requires a file name.\n");
+    return;
+  }
+  char *filename = message->getSymbol(index++);
+  
+  // all tables must exist. The shortest table determines the number of frames.
+  DspTable *tables[MAX_SOUNDFILER_CHANNELS];
+  int numTables = 0;
+  int numFrames = -1;
+  for (; message->isSymbol(index) && numTables < MAX_SOUNDFILER_CHANNELS; index++) {
+    DspTable *table = graph->getTable(message->getSymbol(index));
+    if (table == NULL) {
+      graph->printErr("soundfiler: table \"%s\" does not exist.\n", message->getSymbol(index));
+      return;
+    }
+    int length;
+    table->getBuffer(&length);
+    if (numFrames < 0 || length < numFrames) {
+      numFrames = length;
+    }
+    tables[numTables++] = table;
+  }
+  if (numTables == 0) {
+    graph->printErr("soundfiler: write requires at least one table.\n");
+    return;
+  }
+  skipFrames = (skipFrames > 0) ? skipFrames : 0;
+  numFrames -= skipFrames;
+  if (numFrames < 0) {
+    numFrames = 0;
+  }
+  if (maxFrames >= 0 && numFrames > maxFrames) {
+    numFrames = maxFrames;
+  }
+  
+  // the tables are copied, as they may change while the file is being written
+  char *path = getPath(filename);
+  SampleLoadRequest *request = SampleLoader::newRequest(SAMPLE_LOAD_WRITE, this, path, numTables);
+  free(path);
+  request->bitsPerSample = bitsPerSample;
+  request->sampleRate = sampleRate;
+  request->numFrames = numFrames;
+  for (int i = 0; i < numTables; i++) {
+    int length;
+    float *buffer = tables[i]->getBuffer(&length);
+    request->tableBuffers[i] = (float *) malloc(numFrames * sizeof(float));
+    memcpy(request->tableBuffers[i], buffer + skipFrames, numFrames * sizeof(float));
+  }
+  if (!graph->getSampleLoader()->submit(request)) {
+    graph->printErr("soundfiler: too many requests. \"%s\" will not be written.\n", filename);
+  }
+}
+
+void MessageSoundfiler::completeRequest(SampleLoadRequest *request) {
+  if (request->didFail) {
+    graph->printErr("soundfiler: \"%s\" could not be opened.\n", request->path);
+    return;
+  }
+  if (request->type == SAMPLE_LOAD_READ) {
+    completeRead(request);
+  }
+  
+  // the result is sent at the beginning of the current block
+  PdMessage *outgoingMessage = getNextOutgoingMessage(0);
+  outgoingMessage->setTimestamp(graph->getBlockStartTimestamp());
+  outgoingMessage->getElement(0)->setFloat((float) request->numFrames);
+  graph->scheduleMessage(this, 0, outgoingMessage);
+}
+
+void MessageSoundfiler::completeRead(SampleLoadRequest *request) {
+  for (int i = 0; i < request->numTables; i++) {
+    DspTable *table = graph->getTable(request->tableNames[i]);
+    if (table == NULL || request->tableLengths[i] < 0) {
+      continue;
+    }
+    int length = request->shouldResize ?
+        ((request->numFrames > 0) ? request->numFrames : 1) : request->tableLengths[i];
+    int currentLength;
+    table->getBuffer(&currentLength);
+    if (!request->shouldResize && currentLength != length) {
+      graph->printErr("soundfiler: table \"%s\" was resized while being read. It is not changed.\n",
+          request->tableNames[i]);
+    } else if (request->tableBuffers[i] != NULL) {
+      table->adopt(request->tableBuffers[i], length);
+      request->tableBuffers[i] = NULL; // the table now owns the storage
+    } else {
+      table->share(request->sample, i, request->skipFrames, length);
+    }
+  }
 }
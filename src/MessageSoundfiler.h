@@ -1,5 +1,5 @@
 /*
- *  Copyright 2009 Reality Jockey, Ltd.
+ *  Copyright 2009,2010 Reality Jockey, Ltd.
  *                 info@rjdj.me
  *                 http://rjdj.me/
  * 
@@ -23,27 +23,42 @@
 #ifndef _MESSAGE_SOUNDFILER_H_
 #define _MESSAGE_SOUNDFILER_H_
 
-#include "MessageInputMessageOutputObject.h"
-#include "PdGraph.h"
+#include "MessageObject.h"
+
+struct SampleLoadRequest;
 
 /**
- * Implements the soundfiler message object.
- *
- * This is it, this bad boy reads (and is supposed to write according to the specifications)
- * wav (and supposedly aiff) files into memory.
+ * [soundfiler]
+ * Reads sound files into tables, and writes tables to sound files. Each channel of the file
+ * corresponds to one table. The files are read and written by the disk thread, and the number of
+ * frames read or written is sent from the outlet at the beginning of the block in which the
+ * operation completes. Decoded files are shared via the <code>SampleCache</code>.
  */
-class MessageSoundfiler : public MessageInputMessageOutputObject {
+class MessageSoundfiler : public MessageObject {
   
   public:
-    MessageSoundfiler(PdGraph *pdGraph, char *initString);
+    MessageSoundfiler(PdMessage *initMessage, PdGraph *graph);
     ~MessageSoundfiler();
-    
-  protected:
-    inline void processMessage(int inletIndex, PdMessage *message);
-    PdMessage *newCanonicalMessage();
   
+    const char *getObjectLabel();
+  
+    /** Called by the <code>SampleLoader</code> when a request of this object has been serviced. */
+    void completeRequest(struct SampleLoadRequest *request);
+    
   private:
-    PdGraph *pdGraph;
+    void processMessage(int inletIndex, PdMessage *message);
+  
+    /** Handles the message "read [-resize] [-skip n] [-maxsize n] filename table...". */
+    void read(PdMessage *message);
+  
+    /** Handles the message "write [-bytes n] [-rate r] [-skip n] [-nframes n] filename table...". */
+    void write(PdMessage *message);
+  
+    /** Installs the contents of a completed read request in its tables. */
+    void completeRead(struct SampleLoadRequest *request);
+  
+    /** Returns the full path of the given file name. The result must be freed. */
+    char *getPath(char *filename);
 };
 
 #endif // _MESSAGE_SOUNDFILER_H_
@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MessageTextfile.h"
+#include "PdGraph.h"
+#include "TextSequence.h"
+
+MessageTextfile::MessageTextfile(PdMessage *initMessage, PdGraph *graph) : MessageObject(1, 2, graph) {
+  sequence = new TextSequence();
+  lineIndex = 0;
+}
+
+MessageTextfile::~MessageTextfile() {
+  delete sequence;
+}
+
+const char *MessageTextfile::getObjectLabel() {
+  return "textfile";
+}
+
+PdMessage *MessageTextfile::newCanonicalMessage(int outletIndex) {
+  PdMessage *message = new PdMessage();
+  message->addElement(new MessageElement());
+  return message;
+}
+
+char *MessageTextfile::getPath(char *filename) {
+  if (filename[0] == '/' || graph->getDirectory() == NULL) {
+    return StaticUtils::copyString(filename);
+  } else {
+    return StaticUtils::joinPaths(graph->getDirectory(), filename);
+  }
+}
+
+void MessageTextfile::processMessage(int inletIndex, PdMessage *message) {
+  // message boxes send the symbol "bang"
+  MessageElementType type = (message->isSymbol(0) && strcmp(message->getSymbol(0), "bang") == 0)
+      ? BANG : message->getType(0);
+  switch (type) {
+    case BANG: {
+      PdMessage *outgoingMessage = getNextOutgoingMessage((lineIndex < sequence->getNumLines()) ? 0 : 1);
+      outgoingMessage->setTimestamp(message->getTimestamp());
+      if (lineIndex < sequence->getNumLines()) {
+        sequence->copyLineToMessage(lineIndex++, 0, outgoingMessage);
+        sendMessage(0, outgoingMessage);
+      } else {
+        outgoingMessage->getElement(0)->setBang();
+        sendMessage(1, outgoingMessage);
+      }
+      break;
+    }
+    case SYMBOL: {
+      if (strcmp(message->getSymbol(0), "rewind") == 0) {
+        lineIndex = 0;
+      } else if (!processSequenceMessage(message)) {
+        graph->printErr("textfile: unknown message \"%s\".\n", message->getSymbol(0));
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+bool MessageTextfile::processSequenceMessage(PdMessage *message) {
+  const char *command = message->getSymbol(0);
+  if (strcmp(command, "clear") == 0) {
+    sequence->clear();
+    lineIndex = 0;
+  } else if (strcmp(command, "set") == 0) {
+    sequence->clear();
+    lineIndex = 0;
+    sequence->addElements(message, 1);
+    sequence->endLine();
+  } else if (strcmp(command, "add") == 0) {
+    sequence->addElements(message, 1);
+    sequence->endLine();
+  } else if (strcmp(command, "add2") == 0) {
+    sequence->addElements(message, 1); // the line remains open
+  } else if (strcmp(command, "read") == 0 || strcmp(command, "write") == 0) {
+    if (!message->isSymbol(1)) {
+      graph->printErr("%s: \"%s\" requires a file name.\n", getObjectLabel(), command);
+      return true;
+    }
+    bool isLineTerminated = message->isSymbol(2) && strcmp(message->getSymbol(2), "cr") == 0;
+    char *path = getPath(message->getSymbol(1));
+    if (command[0] == 'r') {
+      lineIndex = 0;
+      if (!sequence->read(path, isLineTerminated)) {
+        graph->printErr("%s: %s: cannot be read.\n", getObjectLabel(), path);
+      }
+    } else if (!sequence->write(path, isLineTerminated)) {
+      graph->printErr("%s: %s: cannot be written.\n", getObjectLabel(), path);
+    }
+    free(path);
+  } else if (strcmp(command, "print") == 0) {
+    char buffer[1024];
+    for (int i = 0; i < sequence->getNumLines(); i++) {
+      sequence->lineToString(i, buffer, sizeof(buffer));
+      graph->printStd("%s: %s;\n", getObjectLabel(), buffer);
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
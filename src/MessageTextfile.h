@@ -0,0 +1,66 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _MESSAGE_TEXTFILE_H_
+#define _MESSAGE_TEXTFILE_H_
+
+#include "MessageObject.h"
+
+class TextSequence;
+
+/**
+ * [textfile]
+ * Stores lines of floats and symbols, which are sent one after another from the left outlet on
+ * every bang. The right outlet bangs when there are no more lines. The lines may be edited with
+ * "clear", "set", "add" and "add2", and read from and written to files with
+ * "read filename [cr]" and "write filename [cr]".
+ */
+class MessageTextfile : public MessageObject {
+  
+  public:
+    MessageTextfile(PdMessage *initMessage, PdGraph *graph);
+    virtual ~MessageTextfile();
+  
+    virtual const char *getObjectLabel();
+  
+  protected:
+    virtual void processMessage(int inletIndex, PdMessage *message);
+  
+    /**
+     * Handles the messages which edit, read, write, or print the lines, which [textfile] and
+     * [qlist] have in common. Returns <code>false</code> if the message is not one of them.
+     */
+    bool processSequenceMessage(PdMessage *message);
+  
+    /** Outgoing messages have as many elements as the line which they carry. */
+    PdMessage *newCanonicalMessage(int outletIndex);
+  
+    /** Returns the full path of the given file name. The result must be freed. */
+    char *getPath(char *filename);
+  
+    TextSequence *sequence;
+  
+    /** The index of the next line. */
+    int lineIndex;
+};
+
+#endif // _MESSAGE_TEXTFILE_H_
@@ -21,9 +21,10 @@
  */
 
 #include "MessageTimer.h"
+#include "PdGraph.h"
 
-MessageTimer::MessageTimer(PdMessage *initMessage, PdGraph *grap) : MessageObject(2, 1, graph) {
-  timestampStart = 0.0;
+MessageTimer::MessageTimer(PdMessage *initMessage, PdGraph *graph) : MessageObject(2, 1, graph) {
+  timestampStart = 0;
 }
 
 MessageTimer::~MessageTimer() {
@@ -45,9 +46,10 @@ void MessageTimer::processMessage(int inletIndex, PdMessage *message) {
     case 1: {
       if (message->isBang(0)) {
         PdMessage *outgoingMessage = getNextOutgoingMessage(0);
-        double currentTimestamp = message->getTimestamp();
+        ZGTime currentTimestamp = message->getTimestamp();
         outgoingMessage->setTimestamp(currentTimestamp);
-        outgoingMessage->getElement(0)->setFloat((float) (currentTimestamp - timestampStart));
+        outgoingMessage->getElement(0)->setFloat(
+            (float) graph->timeToMilliseconds(currentTimestamp - timestampStart));
         sendMessage(0, outgoingMessage);
       }
       break;
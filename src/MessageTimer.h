@@ -37,7 +37,7 @@ class MessageTimer : public MessageObject {
   private:
     void processMessage(int inletIndex, PdMessage *message);
   
-    double timestampStart;
+    ZGTime timestampStart;
 };
 
 #endif // _MESSAGE_TIMER_H_
@@ -0,0 +1,53 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MessageTouchin.h"
+
+MessageTouchin::MessageTouchin(PdMessage *initMessage, PdGraph *graph) :
+    MidiReceiver(MIDI_AFTERTOUCH, MidiReceiver::channelFromMessage(initMessage, 0),
+        (MidiReceiver::channelFromMessage(initMessage, 0) == -1) ? 2 : 1, graph) {
+  // nothing to do
+}
+
+MessageTouchin::~MessageTouchin() {
+  // nothing to do
+}
+
+const char *MessageTouchin::getObjectLabel() {
+  return "touchin";
+}
+
+void MessageTouchin::processMessage(int inletIndex, PdMessage *message) {
+  if (isOmni()) {
+    // send channel
+    PdMessage *outgoingMessage = getNextOutgoingMessage(1);
+    outgoingMessage->setTimestamp(message->getTimestamp());
+    outgoingMessage->setFloat(0, message->getFloat(1));
+    sendMessage(1, outgoingMessage);
+  }
+  
+  // send value
+  PdMessage *outgoingMessage = getNextOutgoingMessage(0);
+  outgoingMessage->setTimestamp(message->getTimestamp());
+  outgoingMessage->setFloat(0, message->getFloat(0));
+  sendMessage(0, outgoingMessage);
+}
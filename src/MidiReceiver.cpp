@@ -0,0 +1,71 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include "MidiReceiver.h"
+
+MidiReceiver::MidiReceiver(MidiEventType midiEventType, int channel, int numMessageOutlets,
+    PdGraph *graph) : RemoteMessageReceiver(0, numMessageOutlets, graph) {
+  this->midiEventType = midiEventType;
+  this->channel = channel;
+  
+  const char *prefix;
+  switch (midiEventType) {
+    default:
+    case MIDI_NOTE: prefix = "zg_notein"; break;
+    case MIDI_CONTROL_CHANGE: prefix = "zg_ctlin"; break;
+    case MIDI_PITCH_BEND: prefix = "zg_bendin"; break;
+    case MIDI_AFTERTOUCH: prefix = "zg_touchin"; break;
+  }
+  name = (char *) malloc((strlen(prefix) + 6) * sizeof(char));
+  if (isOmni()) {
+    sprintf(name, "%s_omni", prefix);
+  } else {
+    sprintf(name, "%s_%i", prefix, channel);
+  }
+}
+
+MidiReceiver::~MidiReceiver() {
+  free(name);
+}
+
+MidiEventType MidiReceiver::getMidiEventType() {
+  return midiEventType;
+}
+
+int MidiReceiver::getChannel() {
+  return channel;
+}
+
+bool MidiReceiver::isOmni() {
+  return (channel == -1);
+}
+
+int MidiReceiver::channelFromMessage(PdMessage *initMessage, int index) {
+  // Pd channels are indexed from 1, while ZG channels are indexed from 0
+  if (initMessage->isFloat(index) &&
+      initMessage->getFloat(index) >= 1.0f && initMessage->getFloat(index) <= NUM_MIDI_CHANNELS) {
+    return (int) initMessage->getFloat(index) - 1;
+  } else {
+    return -1;
+  }
+}
@@ -0,0 +1,71 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _MIDI_RECEIVER_H_
+#define _MIDI_RECEIVER_H_
+
+#include "RemoteMessageReceiver.h"
+
+/** The kinds of MIDI events which are dispatched by the <code>MessageMidiController</code>. */
+typedef enum MidiEventType {
+  MIDI_NOTE,            // note, velocity, channel
+  MIDI_CONTROL_CHANGE,  // value, controller number, channel
+  MIDI_PITCH_BEND,      // value (0 to 16383), channel
+  MIDI_AFTERTOUCH,      // value, channel
+  NUM_MIDI_EVENT_TYPES
+} MidiEventType;
+
+#define NUM_MIDI_CHANNELS 16
+
+/**
+ * This is a superclass of all objects which receive MIDI events from the host, such as [notein] and
+ * [ctlin]. Events arrive as messages in the format given by <code>MidiEventType</code>, with a
+ * zero-indexed channel as the last element. They are delivered by the
+ * <code>MessageMidiController</code>, which indexes receivers by event type and channel. Receivers
+ * can also be reached by name (e.g. "zg_ctlin_0" or "zg_ctlin_omni"), like a [receive].
+ */
+class MidiReceiver : public RemoteMessageReceiver {
+  
+  public:
+    /** A <code>channel</code> of -1 receives events on all channels (omni). */
+    MidiReceiver(MidiEventType midiEventType, int channel, int numMessageOutlets, PdGraph *graph);
+    virtual ~MidiReceiver();
+  
+    MidiEventType getMidiEventType();
+  
+    /** Returns the zero-indexed midi channel which this object outputs. -1 if omni. */
+    int getChannel();
+  
+    bool isOmni();
+  
+    /**
+     * Returns the zero-indexed channel given by the (one-indexed) Pd channel at the given index of
+     * the message, or -1 if there is none.
+     */
+    static int channelFromMessage(PdMessage *initMessage, int index);
+  
+  protected:
+    MidiEventType midiEventType;
+    int channel;
+};
+
+#endif // _MIDI_RECEIVER_H_
@@ -0,0 +1,280 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "DiskStreamer.h"
+#include "LockFreeQueue.h"
+#include "OfflineRenderer.h"
+#include "PdGraph.h"
+
+/** The number of chunks circulating between the render and writer threads. */
+#define NUM_RENDER_CHUNKS 4
+
+/** The approximate length of one chunk, in frames. Each chunk is written with a single call. */
+#define NUM_FRAMES_PER_RENDER_CHUNK 65536
+
+OfflineRenderer::OfflineRenderer(PdGraph *graph, ZGRenderOptions *options) {
+  this->graph = graph;
+  this->options = *options;
+  blockSize = graph->getBlockSize();
+  numInputChannels = graph->getNumInputChannels();
+  numOutputChannels = graph->getNumOutputChannels();
+  
+  inputFile = NULL;
+  numInputFileChannels = 0;
+  inputFileBuffer = NULL;
+  outputFile = NULL;
+  
+  // chunks hold a whole number of blocks
+  numFramesPerChunk = (NUM_FRAMES_PER_RENDER_CHUNK / blockSize) * blockSize;
+  if (numFramesPerChunk < blockSize) {
+    numFramesPerChunk = blockSize;
+  }
+  chunks = (RenderChunk *) malloc(NUM_RENDER_CHUNKS * sizeof(RenderChunk));
+  filledChunkQueue = new LockFreeQueue(NUM_RENDER_CHUNKS);
+  emptyChunkQueue = new LockFreeQueue(NUM_RENDER_CHUNKS);
+  for (int i = 0; i < NUM_RENDER_CHUNKS; i++) {
+    chunks[i].buffer = (float *) malloc(numFramesPerChunk * numOutputChannels * sizeof(float));
+    chunks[i].numFrames = 0;
+    emptyChunkQueue->push(&chunks[i]);
+  }
+  
+  pthread_mutex_init(&waitMutex, NULL);
+  pthread_cond_init(&waitCondition, NULL);
+  isRenderFinished = false;
+  hasWriteFailed = false;
+}
+
+OfflineRenderer::~OfflineRenderer() {
+  for (int i = 0; i < NUM_RENDER_CHUNKS; i++) {
+    free(chunks[i].buffer);
+  }
+  free(chunks);
+  delete filledChunkQueue;
+  delete emptyChunkQueue;
+  free(inputFileBuffer);
+  pthread_mutex_destroy(&waitMutex);
+  pthread_cond_destroy(&waitCondition);
+}
+
+long long OfflineRenderer::renderToFile(const char *outputPath) {
+  int format = SF_FORMAT_WAV;
+  switch (options.bitsPerSample) {
+    case 16: format |= SF_FORMAT_PCM_16; break;
+    case 24: format |= SF_FORMAT_PCM_24; break;
+    case 32: format |= SF_FORMAT_FLOAT; break;
+    default: {
+      graph->printErr("Render output must have 16, 24 or 32 bits per sample, not %i.",
+          options.bitsPerSample);
+      return -1;
+    }
+  }
+  if (options.durationSeconds <= 0.0 && options.silenceSeconds <= 0.0) {
+    graph->printErr("A render requires a duration, a silence condition, or both.");
+    return -1;
+  }
+  if (numOutputChannels <= 0) {
+    graph->printErr("A graph without output channels cannot be rendered to a file.");
+    return -1;
+  }
+  
+  float sampleRate = graph->getSampleRate();
+  if (options.inputPath != NULL) {
+    SF_INFO inputInfo;
+    memset(&inputInfo, 0, sizeof(SF_INFO));
+    inputFile = sf_open(options.inputPath, SFM_READ, &inputInfo);
+    if (inputFile == NULL) {
+      graph->printErr("Render input file \"%s\" could not be opened.", options.inputPath);
+      return -1;
+    }
+    if ((float) inputInfo.samplerate != sampleRate) {
+      graph->printErr("Render input file \"%s\" has a sample rate of %iHz but the graph runs at %gHz. "
+          "The file will not be resampled.", options.inputPath, inputInfo.samplerate, sampleRate);
+    }
+    numInputFileChannels = inputInfo.channels;
+    inputFileBuffer = (float *) malloc(blockSize * numInputFileChannels * sizeof(float));
+  }
+  
+  SF_INFO outputInfo;
+  memset(&outputInfo, 0, sizeof(SF_INFO));
+  outputInfo.samplerate = (int) sampleRate;
+  outputInfo.channels = numOutputChannels;
+  outputInfo.format = format;
+  outputFile = sf_open(outputPath, SFM_WRITE, &outputInfo);
+  if (outputFile == NULL) {
+    graph->printErr("Render output file \"%s\" could not be opened: %s", outputPath, sf_strerror(NULL));
+    if (inputFile != NULL) {
+      sf_close(inputFile);
+      inputFile = NULL;
+    }
+    return -1;
+  }
+  
+  pthread_t writerThread;
+  pthread_create(&writerThread, NULL, &OfflineRenderer::writeLoop, this);
+  
+  // [readsf~] and [writesf~] must not drop audio because the render runs faster than real time
+  DiskStreamer *diskStreamer = graph->getDiskStreamer();
+  diskStreamer->setWaitsForDisk(true);
+  
+  long long maxNumBlocks = (options.durationSeconds > 0.0)
+      ? (long long) ceil(options.durationSeconds * sampleRate / blockSize) : -1;
+  long long numSilentFramesToStop = (options.silenceSeconds > 0.0)
+      ? (long long) (options.silenceSeconds * sampleRate) : -1;
+  
+  float *inputBuffers = (float *) calloc(blockSize * numInputChannels, sizeof(float));
+  float *outputBuffers = (float *) malloc(blockSize * numOutputChannels * sizeof(float));
+  RenderChunk *chunk = (RenderChunk *) emptyChunkQueue->pop();
+  long long numBlocks = 0;
+  long long numSilentFrames = 0;
+  while (chunk != NULL && (maxNumBlocks < 0 || numBlocks < maxNumBlocks)) {
+    readInput(inputBuffers);
+    graph->process(inputBuffers, outputBuffers);
+    appendOutput(chunk, outputBuffers);
+    numBlocks++;
+    
+    if (numSilentFramesToStop >= 0) {
+      numSilentFrames = isSilent(outputBuffers) ? numSilentFrames + blockSize : 0;
+      if (numSilentFrames >= numSilentFramesToStop) {
+        break;
+      }
+    }
+    if (chunk->numFrames == numFramesPerChunk) {
+      chunk = swapChunk(chunk);
+    }
+  }
+  
+  // hand over the final partial chunk and let the writer finish
+  if (chunk != NULL && chunk->numFrames > 0) {
+    filledChunkQueue->push(chunk);
+  }
+  pthread_mutex_lock(&waitMutex);
+  isRenderFinished = true;
+  pthread_cond_broadcast(&waitCondition);
+  pthread_mutex_unlock(&waitMutex);
+  pthread_join(writerThread, NULL);
+  diskStreamer->setWaitsForDisk(false);
+  
+  free(inputBuffers);
+  free(outputBuffers);
+  sf_close(outputFile);
+  outputFile = NULL;
+  if (inputFile != NULL) {
+    sf_close(inputFile);
+    inputFile = NULL;
+  }
+  
+  if (hasWriteFailed) {
+    graph->printErr("Render output file \"%s\" could not be written.", outputPath);
+    return -1;
+  }
+  return numBlocks * blockSize;
+}
+
+void OfflineRenderer::readInput(float *inputBuffers) {
+  if (inputFile == NULL || numInputChannels == 0) {
+    return; // the input buffers remain silent
+  }
+  int numFrames = (int) sf_readf_float(inputFile, inputFileBuffer, blockSize);
+  int numChannels = (numInputFileChannels < numInputChannels) ? numInputFileChannels : numInputChannels;
+  for (int i = 0; i < numChannels; i++) {
+    float *channelBuffer = inputBuffers + (i * blockSize);
+    for (int j = 0, k = i; j < numFrames; j++, k += numInputFileChannels) {
+      channelBuffer[j] = inputFileBuffer[k];
+    }
+    memset(channelBuffer + numFrames, 0, (blockSize - numFrames) * sizeof(float));
+  }
+}
+
+void OfflineRenderer::appendOutput(RenderChunk *chunk, float *outputBuffers) {
+  float *interleavedBuffer = chunk->buffer + (chunk->numFrames * numOutputChannels);
+  for (int i = 0; i < numOutputChannels; i++) {
+    float *channelBuffer = outputBuffers + (i * blockSize);
+    for (int j = 0, k = i; j < blockSize; j++, k += numOutputChannels) {
+      interleavedBuffer[k] = channelBuffer[j];
+    }
+  }
+  chunk->numFrames += blockSize;
+}
+
+bool OfflineRenderer::isSilent(float *outputBuffers) {
+  int numSamples = blockSize * numOutputChannels;
+  for (int i = 0; i < numSamples; i++) {
+    if (fabsf(outputBuffers[i]) >= options.silenceThreshold) {
+      return false;
+    }
+  }
+  return true;
+}
+
+RenderChunk *OfflineRenderer::swapChunk(RenderChunk *chunk) {
+  // there are only NUM_RENDER_CHUNKS chunks, so the filled queue always has room
+  filledChunkQueue->push(chunk);
+  pthread_mutex_lock(&waitMutex);
+  pthread_cond_broadcast(&waitCondition);
+  RenderChunk *emptyChunk = NULL;
+  while ((emptyChunk = (RenderChunk *) emptyChunkQueue->pop()) == NULL && !hasWriteFailed) {
+    pthread_cond_wait(&waitCondition, &waitMutex);
+  }
+  pthread_mutex_unlock(&waitMutex);
+  if (emptyChunk != NULL) {
+    emptyChunk->numFrames = 0;
+  }
+  return emptyChunk; // NULL if the writer has given up
+}
+
+void *OfflineRenderer::writeLoop(void *renderer) {
+  OfflineRenderer *offlineRenderer = (OfflineRenderer *) renderer;
+  while (true) {
+    RenderChunk *chunk = (RenderChunk *) offlineRenderer->filledChunkQueue->pop();
+    if (chunk == NULL) {
+      pthread_mutex_lock(&offlineRenderer->waitMutex);
+      while (offlineRenderer->filledChunkQueue->isEmpty() && !offlineRenderer->isRenderFinished) {
+        pthread_cond_wait(&offlineRenderer->waitCondition, &offlineRenderer->waitMutex);
+      }
+      bool isDone = offlineRenderer->filledChunkQueue->isEmpty();
+      pthread_mutex_unlock(&offlineRenderer->waitMutex);
+      if (isDone) {
+        break;
+      } else {
+        continue;
+      }
+    }
+    
+    sf_count_t numFramesWritten = sf_writef_float(offlineRenderer->outputFile, chunk->buffer,
+        chunk->numFrames);
+    pthread_mutex_lock(&offlineRenderer->waitMutex);
+    if (numFramesWritten != chunk->numFrames) {
+      offlineRenderer->hasWriteFailed = true;
+    } else {
+      offlineRenderer->emptyChunkQueue->push(chunk);
+    }
+    pthread_cond_broadcast(&offlineRenderer->waitCondition);
+    pthread_mutex_unlock(&offlineRenderer->waitMutex);
+    if (offlineRenderer->hasWriteFailed) {
+      break;
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _OFFLINE_RENDERER_H_
+#define _OFFLINE_RENDERER_H_
+
+#include <pthread.h>
+#include <sndfile.h>
+#include "ZGRenderOptions.h"
+
+class LockFreeQueue;
+class PdGraph;
+
+/** A block of interleaved output frames on its way to disk. */
+typedef struct {
+  float *buffer;
+  int numFrames;
+} RenderChunk;
+
+/**
+ * <code>OfflineRenderer</code> runs a graph as fast as possible and writes its output to a sound
+ * file. The graph is processed on the calling thread. Output is collected into large chunks which
+ * are handed to a separate writer thread, so that disk writes overlap with audio processing. The
+ * graph must not be processed by any other thread while a render is in progress.
+ */
+class OfflineRenderer {
+  
+  public:
+    OfflineRenderer(PdGraph *graph, ZGRenderOptions *options);
+    ~OfflineRenderer();
+  
+    /**
+     * Renders the graph into a WAV file at the given path. Returns the number of frames written,
+     * or -1 if the render could not be started or a file could not be written.
+     */
+    long long renderToFile(const char *outputPath);
+  
+  private:
+    static void *writeLoop(void *renderer);
+  
+    /** Reads the next block of input from the input file into the input buffers of the graph. */
+    void readInput(float *inputBuffers);
+  
+    /** Interleaves one block of graph output into the given chunk. */
+    void appendOutput(RenderChunk *chunk, float *outputBuffers);
+  
+    /** Returns <code>true</code> if all samples in the block are below the silence threshold. */
+    bool isSilent(float *outputBuffers);
+  
+    /** Passes a chunk to the writer thread and returns an empty one, waiting if necessary. */
+    RenderChunk *swapChunk(RenderChunk *chunk);
+  
+    PdGraph *graph;
+    ZGRenderOptions options;
+    int blockSize;
+    int numInputChannels;
+    int numOutputChannels;
+  
+    SNDFILE *inputFile;
+    int numInputFileChannels;
+    float *inputFileBuffer;
+  
+    SNDFILE *outputFile;
+    RenderChunk *chunks;
+    int numFramesPerChunk;
+  
+    /** Chunks filled by the render thread and waiting to be written. */
+    LockFreeQueue *filledChunkQueue;
+  
+    /** Chunks which have been written and may be filled again. */
+    LockFreeQueue *emptyChunkQueue;
+  
+    /** Only used to sleep while a queue is empty. The queues themselves are lock-free. */
+    pthread_mutex_t waitMutex;
+    pthread_cond_t waitCondition;
+  
+    volatile bool isRenderFinished;
+    volatile bool hasWriteFailed;
+};
+
+#endif // _OFFLINE_RENDERER_H_
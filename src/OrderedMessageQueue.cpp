@@ -37,17 +37,18 @@ void OrderedMessageQueue::insertMessage(MessageObject *messageObject, int outlet
   destination->message = message;
   destination->index = outletIndex;
   
-  LinkedListNode *node = head;
-  while (node != NULL) {
-    destination = (MessageDestination *) node->data;
-    if (message->getTimestamp() < destination->message->getTimestamp()) {
-      insertBefore(newNode, node);
-      return;
-    } else {
-      node = node->next;
-    }
+  // messages are mostly scheduled in time order, so search from the back of the queue. The new
+  // message is inserted after all messages with the same timestamp.
+  LinkedListNode *node = tail;
+  while (node != NULL &&
+      message->getTimestamp() < ((MessageDestination *) node->data)->message->getTimestamp()) {
+    node = node->previous;
+  }
+  if (node == NULL) {
+    insertBefore(newNode, head);
+  } else {
+    insertAfter(newNode, node);
   }
-  insertAfter(newNode, tail);
 }
 
 void OrderedMessageQueue::removeMessage(MessageObject *messageObject, int outletIndex, PdMessage *message) {
@@ -65,6 +66,19 @@ void OrderedMessageQueue::removeMessage(MessageObject *messageObject, int outlet
   }
 }
 
+void OrderedMessageQueue::removeAllMessages(MessageObject *messageObject) {
+  LinkedListNode *iteratorNode = head;
+  while (iteratorNode != NULL) {
+    LinkedListNode *nextNode = iteratorNode->next;
+    MessageDestination *destination = (MessageDestination *) iteratorNode->data;
+    if (destination->object == messageObject) {
+      destination->message->unreserve(messageObject);
+      remove(iteratorNode);
+    }
+    iteratorNode = nextNode;
+  }
+}
+
 void *OrderedMessageQueue::newDataHolder() {
   return malloc(sizeof(MessageDestination));
 }
@@ -39,6 +39,12 @@ class OrderedMessageQueue : public ZGLinkedList {
     /** Removes the given message addressed to the given <code>MessageObject</code> from the queue. */
     void removeMessage(MessageObject *messageObject, int outletIndex, PdMessage *message);
   
+    /**
+     * Removes all messages scheduled by the given <code>MessageObject</code> from the queue. The
+     * messages are unreserved.
+     */
+    void removeAllMessages(MessageObject *messageObject);
+  
   protected:
     void *newDataHolder();
     void deleteDataHolder(void *data);
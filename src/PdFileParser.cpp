@@ -23,55 +23,79 @@
 #include "PdFileParser.h"
 
 PdFileParser::PdFileParser(char *filePath) {
-  fp = fopen(filePath, "r");
-  if (fp == NULL) {
-    // error condition
-    isDone = true;
-  } else {
-    line = (char *) calloc(LINE_LENGTH, sizeof(char));
-    nextLine();
-    buffer = NULL;
-    isDone = false;
+  messageList = new List();
+  messageIndex = 0;
+  buffer = NULL;
+  
+  FILE *fp = fopen(filePath, "r");
+  if (fp != NULL) {
+    // read the whole file at once
+    fseek(fp, 0, SEEK_END);
+    long length = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *text = (char *) malloc((length + 1) * sizeof(char));
+    size_t numBytesRead = fread(text, sizeof(char), length, fp);
+    text[numBytesRead] = '\0';
+    fclose(fp);
+    parse(text);
+    free(text);
   }
 }
 
 PdFileParser::~PdFileParser() {
-  free(line);
+  for (int i = 0; i < messageList->size(); i++) {
+    free(messageList->get(i));
+  }
+  delete messageList;
   free(buffer);
-  fclose(fp);
-  fp = NULL;
 }
 
-/*
- * This function creates and destroys lots of memory, basically every time that a new string is
- * considered. I find this a bit dirty and would like to make it one buffer. However, for the time-
- * being, this approach works and is robust.
- */
-char *PdFileParser::nextMessage() {
-  if (!isDone) {
-    free(buffer);
-    buffer = StaticUtils::copyString(line); // copy line to buffer 
-    while (nextLine() != NULL &&
-           !(strncmp(line, "#X", 2) == 0 || strncmp(line, "#N", 2) == 0 || 
-             strncmp(line, "#A", 2) == 0)) {
-      char *temp = buffer;
-      buffer = StaticUtils::joinPaths(buffer, line);
+void PdFileParser::parse(char *text) {
+  char *message = NULL;
+  char *line = text;
+  while (*line != '\0') {
+    // terminate the line, and remove any trailing carriage return
+    char *end = strchr(line, '\n');
+    char *next = (end == NULL) ? line + strlen(line) : end + 1;
+    if (end != NULL) {
+      *end = '\0';
+    }
+    int lineLength = strlen(line);
+    if (lineLength > 0 && line[lineLength-1] == '\r') {
+      line[--lineLength] = '\0';
+    }
+    
+    if (message == NULL || strncmp(line, "#X", 2) == 0 || strncmp(line, "#N", 2) == 0 ||
+        strncmp(line, "#A", 2) == 0) {
+      // a new logical message begins
+      if (message != NULL) {
+        messageList->add(message);
+      }
+      message = StaticUtils::copyString(line);
+    } else {
+      // Pd breaks long lines in place of a space
+      char *temp = message;
+      message = (char *) malloc((strlen(temp) + lineLength + 2) * sizeof(char));
+      sprintf(message, "%s %s", temp, line);
       free(temp);
     }
+    line = next;
+  }
+  if (message != NULL) {
+    messageList->add(message);
+  }
+}
+
+char *PdFileParser::nextMessage() {
+  if (messageIndex < messageList->size()) {
+    free(buffer);
+    buffer = StaticUtils::copyString((char *) messageList->get(messageIndex++));
     return buffer;
   } else {
     return NULL;
   }
 }
 
-char *PdFileParser::nextLine() {
-  char *out = fgets(line, LINE_LENGTH, fp);
-  if (out == NULL) {
-    isDone = true;
-  } else {
-    // remove trailing '\n' from the line
-    int length = strlen(line);
-    line[length-1] = '\0';
-  }
-  return out;
+void PdFileParser::rewind() {
+  messageIndex = 0;
 }
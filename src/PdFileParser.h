@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "List.h"
 #include "StaticUtils.h"
 
 /**
@@ -33,6 +34,9 @@
  * no more are available. Messages are returned as strings (<code>char*</code>), which represent
  * the entire logical message (though the original message may have been broken up over several
  * lines in the file.
+ * The file is read and split into messages once, such that the messages may be iterated over any
+ * number of times with <code>rewind()</code>. [clone] uses this to create all of its instances
+ * from a single parse of the abstraction.
  */
 class PdFileParser {
 
@@ -42,24 +46,26 @@ class PdFileParser {
     
     /**
      * Returns the next logical message in the file, or <code>NULL</code> if the end of the file
-     * has been reached.
+     * has been reached. The returned string may be modified by the caller, e.g. with
+     * <code>strtok()</code>, and remains valid until the next call.
      */
     char *nextMessage();
   
+    /** Restarts the iteration at the first message of the file. */
+    void rewind();
+  
   private:
-    /**
-     * Reads the next line and puts the contents into the <code>line</code> buffer.
-     * A pointer to the <code>line</code> buffer is returned, or <code>NULL</code> if the end of the
-     * file has been reached.
-     */
-    char *nextLine();
+    /** Splits the contents of the file into logical messages and adds them to the message list. */
+    void parse(char *text);
+  
+    /** The logical messages of the file, in order. */
+    List *messageList;
+  
+    /** The index of the message to be returned next. */
+    int messageIndex;
   
-    FILE *fp;
-    char *line;
-    static const int LINE_LENGTH = 256;
+    /** A copy of the most recently returned message. */
     char *buffer;
-    int bufferLength;
-    bool isDone;
 };
 
 #endif // _PD_FILE_PARSER_H_
@@ -20,7 +20,16 @@
  *
  */
 
+#include "BlockAdapter.h"
+#include "CodeGenerator.h"
+#include "CompiledDsp.h"
+#include "DiskStreamer.h"
+#include "HashTable.h"
+#include "SampleLoader.h"
+#include "EventQueue.h"
+#include "HostMessageReceiver.h"
 #include "PdGraph.h"
+#include "RandomGenerator.h"
 #include "StaticUtils.h"
 
 #include "MessageAbsoluteValue.h"
@@ -28,9 +37,11 @@
 #include "MessageArcTangent.h"
 #include "MessageArcTangent2.h"
 #include "MessageBang.h"
+#include "MessageBendin.h"
 #include "MessageCosine.h"
 #include "MessageChange.h"
 #include "MessageClip.h"
+#include "MessageCtlin.h"
 #include "MessageDeclare.h"
 #include "MessageDelay.h"
 #include "MessageDivide.h"
@@ -62,9 +73,11 @@
 #include "MessageOutlet.h"
 #include "MessagePack.h"
 #include "MessagePipe.h"
+#include "MessagePoly.h"
 #include "MessagePow.h"
 #include "MessagePowToDb.h"
 #include "MessagePrint.h"
+#include "MessageQlist.h"
 #include "MessageRandom.h"
 #include "MessageReceive.h"
 #include "MessageRemainder.h"
@@ -73,6 +86,7 @@
 #include "MessageSelect.h"
 #include "MessageSend.h"
 #include "MessageSine.h"
+#include "MessageSoundfiler.h"
 #include "MessageSpigot.h"
 #include "MessageSqrt.h"
 #include "MessageSubtract.h"
@@ -81,26 +95,32 @@
 #include "MessageSymbol.h"
 #include "MessageTangent.h"
 #include "MessageText.h"
+#include "MessageTextfile.h"
 #include "MessageTimer.h"
 #include "MessageToggle.h"
+#include "MessageTouchin.h"
 #include "MessageTrigger.h"
 #include "MessageUntil.h"
 #include "MessageUnpack.h"
 #include "MessageWrap.h"
 
+#include "MessageMidiController.h"
 #include "MessageSendController.h"
 
 #include "DspAdc.h"
 #include "DspAdd.h"
 #include "DspBandpassFilter.h"
+#include "DspBang.h"
 #include "DspCatch.h"
 #include "DspClip.h"
+#include "DspClone.h"
 #include "DspCosine.h"
 #include "DspDac.h"
 #include "DspDelayRead.h"
 #include "DspDelayWrite.h"
 #include "DspDivide.h"
 #include "DspEnvelope.h"
+#include "DspFusedChain.h"
 #include "DspHighpassFilter.h"
 #include "DspInlet.h"
 #include "DspLine.h"
@@ -111,51 +131,90 @@
 #include "DspOsc.h"
 #include "DspOutlet.h"
 #include "DspPhasor.h"
+#include "DspReadSoundfile.h"
 #include "DspReceive.h"
 #include "DspSend.h"
 #include "DspSig.h"
 #include "DspSnapshot.h"
 #include "DspSubtract.h"
+#include "DspTable.h"
+#include "DspTableOsc4.h"
+#include "DspTablePlay.h"
+#include "DspTableRead.h"
+#include "DspTableRead4.h"
+#include "DspTableWrite.h"
+#include "DspThreshold.h"
 #include "DspThrow.h"
 #include "DspVariableDelay.h"
+#include "DspVLine.h"
+#include "DspVSnapshot.h"
 #include "DspWrap.h"
+#include "DspWriteSoundfile.h"
 
 // initialise the global graph counter
 int PdGraph::globalGraphId = 0;
 
 PdGraph *PdGraph::newInstance(char *directory, char *filename, int blockSize,
-    int numInputChannels, int numOutputChannels, float sampleRate, PdGraph *parentGraph) {
-  PdGraph *pdGraph = NULL;
-
+    int numInputChannels, int numOutputChannels, float sampleRate, PdGraph *parentGraph,
+    PdMessage *arguments) {
   // create file path based on directory and filename. Parse the file.
   char *filePath = StaticUtils::joinPaths(directory, filename);
   PdFileParser *fileParser = new PdFileParser(filePath);
   free(filePath);
+  
+  PdGraph *pdGraph = newInstance(fileParser, directory, blockSize, numInputChannels,
+      numOutputChannels, sampleRate, parentGraph, arguments);
+  delete fileParser;
+  return pdGraph;
+}
 
+PdGraph *PdGraph::newInstance(PdFileParser *fileParser, char *directory, int blockSize,
+    int numInputChannels, int numOutputChannels, float sampleRate, PdGraph *parentGraph,
+    PdMessage *arguments) {
+  PdGraph *pdGraph = NULL;
+  fileParser->rewind();
   char *line = fileParser->nextMessage();
   if (line != NULL && strncmp(line, "#N canvas", strlen("#N canvas")) == 0) {
-    pdGraph = new PdGraph(fileParser, directory, blockSize, numInputChannels, numOutputChannels, sampleRate, parentGraph);
-  } else {
+    pdGraph = new PdGraph(fileParser, directory, blockSize, numInputChannels, numOutputChannels,
+        sampleRate, parentGraph, arguments);
+  } else if (line != NULL) {
     printf("WARNING | The first line of the pd file does not define a canvas:\n  \"%s\".\n", line);
   }
-  delete fileParser;
   return pdGraph;
 }
 
 PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
-    int numInputChannels, int numOutputChannels, float sampleRate, PdGraph *parentGraph) :
-    DspObject(16, 16, 16, 16, blockSize, this) {
+    int numInputChannels, int numOutputChannels, float sampleRate, PdGraph *parentGraph,
+    PdMessage *arguments) :
+    DspObject(MAX_NUM_LETS, MAX_NUM_LETS, MAX_NUM_LETS, MAX_NUM_LETS, blockSize, this) {
   this->numInputChannels = numInputChannels;
   this->numOutputChannels = numOutputChannels;
   this->blockSize = blockSize;
   this->sampleRate = sampleRate;
   this->parentGraph = parentGraph;
-  blockStartTimestamp = 0.0;
-  blockDurationMs = ((double) blockSize / (double) sampleRate) * 1000.0;
+  this->directory = StaticUtils::copyString(directory);
+  diskStreamer = NULL;
+  sampleLoader = NULL;
+  randomSeed = (parentGraph == NULL) ? RandomGenerator::newGraphSeed() : 0;
+  numRandomGenerators = 0;
+  blockAdapter = NULL;
+  compiledDsp = NULL;
+  eventQueue = NULL;
+  eventDelivery = ZG_DELIVER_IMMEDIATELY;
+  blockStartTimestamp = 0;
+  blockDuration = (ZGTime) blockSize * ZG_TIME_ONE_SAMPLE;
   switched = true; // graphs are switched on by default
+  sleeping = false;
+  isProfiling = false;
+  isProfileResetPending = false;
+  Profiler::resetCounter(&blockProfileCounter);
+  Profiler::resetCounter(&compiledProfileCounter);
+  memset(blockTimeHistogram, 0, sizeof(blockTimeHistogram));
 
   nodeList = new List();
   dspNodeList = new List();
+  dspProcessList = new List();
+  fusedChainList = new List();
   inletList = new List();
   outletList = new List();
       
@@ -165,14 +224,24 @@ PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
   graphId = globalGraphId++;
   graphArguments = new PdMessage();
   graphArguments->addElement(new MessageElement((float) graphId)); // $0
+  if (arguments != NULL) {
+    // $1, $2, etc.
+    for (int i = 0; i < arguments->getNumElements(); i++) {
+      graphArguments->addElement(arguments->getElement(i)->copy());
+    }
+  }
 
   if (isRootGraph()) {
     // if this is the top-level graph
     messageCallbackQueue = new OrderedMessageQueue();
+    sequenceList = new List();
     numBytesInInputBuffers = numInputChannels * blockSize * sizeof(float);
     numBytesInOutputBuffers = numOutputChannels * blockSize * sizeof(float);
     globalDspInputBuffers = (float *) malloc(numBytesInInputBuffers);
     globalDspOutputBuffers = (float *) malloc(numBytesInOutputBuffers);
+    memset(globalDspInputBuffers, 0, numBytesInInputBuffers);
+    isDithering = false;
+    SampleConversion::initDitherState(ditherState);
     dspReceiveList = new List();
     dspSendList = new List();
     delaylineList = new List();
@@ -180,9 +249,16 @@ PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
     throwList = new List();
     catchList = new List();
     declareList = new List();
+    tableMap = new HashTable();
     sendController = new MessageSendController(this);
+    midiController = new MessageMidiController(this);
+    hostReceiverList = new List();
+    pendingEditQueue = new LockFreeQueue(MAX_OUTSTANDING_EDITS);
+    completedEditQueue = new LockFreeQueue(MAX_OUTSTANDING_EDITS);
+    plannedEditList = new List();
   } else {
     messageCallbackQueue = NULL;
+    sequenceList = NULL;
     numBytesInInputBuffers = 0;
     numBytesInOutputBuffers = 0;
     globalDspInputBuffers = NULL;
@@ -194,17 +270,24 @@ PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
     throwList = NULL;
     catchList = NULL;
     declareList = NULL;
+    tableMap = NULL;
     sendController = NULL;
+    midiController = NULL;
+    hostReceiverList = NULL;
+    pendingEditQueue = NULL;
+    completedEditQueue = NULL;
+    plannedEditList = NULL;
   }
 
   char *line = NULL;
+  DspTable *array = NULL; // the most recently defined array, filled by subsequent #A lines
   while ((line = fileParser->nextMessage()) != NULL) {
     char *hashType = strtok(line, " ");
     if (strcmp(hashType, "#N") == 0) {
       char *objectType = strtok(NULL, " ");
       if (strcmp(objectType, "canvas") == 0) {
-        // a new subgraph is defined inline
-        PdGraph *graph = new PdGraph(fileParser, directory, blockSize, numInputChannels, numOutputChannels, sampleRate, this);
+        // a new subgraph is defined inline. It shares the arguments of this graph.
+        PdGraph *graph = new PdGraph(fileParser, directory, blockSize, numInputChannels, numOutputChannels, sampleRate, this, arguments);
         addObject(graph);
       } else {
         printErr("Unrecognised #N object type: \"%s\".\n", line);
@@ -218,13 +301,12 @@ PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
         char *objectInitString = strtok(NULL, ";"); // get the object initialisation string
         PdMessage *initMessage = new PdMessage(objectInitString, getArguments());
         MessageObject *pdNode = newObject(objectType, objectLabel, initMessage, this);
-        delete initMessage;
         if (pdNode == NULL) {
           // object could not be instantiated, probably because the object is unknown
           // look for the object definition in an abstraction
           // first look in the local directory (the same directory as the original file)...
           char *filename = StaticUtils::joinPaths(objectLabel, ".pd");
-          pdNode = PdGraph::newInstance(directory, filename, blockSize, numInputChannels, numOutputChannels, sampleRate, this);
+          pdNode = PdGraph::newInstance(directory, filename, blockSize, numInputChannels, numOutputChannels, sampleRate, this, initMessage);
           if (pdNode == NULL) {
             // ...and if that fails, look in the declared directories
             List *declareList = getDeclareList();
@@ -232,11 +314,12 @@ PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
             while (pdNode == NULL && i < declareList->size()) {
               char *librarySubpath = (char *) declareList->get(i++);
               char *fullPath = StaticUtils::joinPaths(directory, librarySubpath); 
-              pdNode = PdGraph::newInstance(fullPath, filename, blockSize, numInputChannels, numOutputChannels, sampleRate, this);
+              pdNode = PdGraph::newInstance(fullPath, filename, blockSize, numInputChannels, numOutputChannels, sampleRate, this, initMessage);
               free(fullPath);
             }
             if (pdNode == NULL) {
               free(filename);
+              delete initMessage;
               printErr("Unknown object or abstraction \"%s\".\n", objectInitString);
               return;
             }
@@ -244,6 +327,7 @@ PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
           }
           free(filename);
         }
+        delete initMessage;
         // add the object to the local graph and make any necessary registrations
         addObject(pdNode);
       } else if (strcmp(objectType, "msg") == 0) {
@@ -270,6 +354,15 @@ PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
         char *comment = strtok(NULL, ";"); // get the comment
         MessageText *messageText = new MessageText(comment, graph);
         addObject(messageText);
+      } else if (strcmp(objectType, "array") == 0) {
+        // an array is a table: #X array name size float flags
+        char *objectInitString = strtok(NULL, ";");
+        PdMessage *initMessage = new PdMessage(objectInitString, getArguments());
+        array = new DspTable(initMessage, this);
+        delete initMessage;
+        addObject(array);
+      } else if (strcmp(objectType, "coords") == 0) {
+        // the coordinates of a graph on its parent are irrelevant
       } else if (strcmp(objectType, "declare") == 0) {
         // set environment for loading patch
         char *objectInitString = strtok(NULL, ";"); // get the arguments to declare
@@ -290,6 +383,14 @@ PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
       } else {
         printErr("Unrecognised #X object type on line: \"%s\"\n", line);
       }
+    } else if (strcmp(hashType, "#A") == 0) {
+      // the saved contents of the last array: #A startIndex values...
+      // the values are not resolved against the graph arguments, as they may be many
+      PdMessage *values = new PdMessage(strtok(NULL, ";"));
+      if (array != NULL && values->isFloat(0)) {
+        array->setValues((int) values->getFloat(0), values, 1);
+      }
+      delete values;
     } else {
       printErr("Unrecognised hash type on line: \"%s\"\n", line);
     }
@@ -300,12 +401,31 @@ PdGraph::PdGraph(PdFileParser *fileParser, char *directory, int blockSize,
 
 PdGraph::~PdGraph() {
   if (isRootGraph()) {
+    // objects which have been queued for addition have never become part of the graph
+    GraphEdit *graphEdit = NULL;
+    while ((graphEdit = (GraphEdit *) pendingEditQueue->pop()) != NULL) {
+      if (graphEdit->type == GRAPH_EDIT_ADD_OBJECT) {
+        delete graphEdit->fromObject;
+      }
+      discardGraphEdit(graphEdit);
+    }
+    releaseCompletedGraphEdits();
+    delete pendingEditQueue;
+    delete completedEditQueue;
+    delete plannedEditList;
+    
     delete messageCallbackQueue;
+    delete sequenceList;
     delete dspReceiveList;
     delete dspSendList;
     delete sendController;
+    delete midiController;
+    delete hostReceiverList; // the receivers themselves are deleted with the other objects
     delete delaylineList;
     delete delayReceiverList;
+    delete throwList;
+    delete catchList;
+    delete tableMap;
     free(globalDspInputBuffers);
     free(globalDspOutputBuffers);
     
@@ -316,6 +436,11 @@ PdGraph::~PdGraph() {
     delete declareList;
   }
   delete dspNodeList;
+  delete dspProcessList;
+  for (int i = 0; i < fusedChainList->size(); i++) {
+    delete (DspFusedChain *) fusedChainList->get(i);
+  }
+  delete fusedChainList;
   delete inletList;
   delete outletList;
   delete graphArguments;
@@ -326,6 +451,29 @@ PdGraph::~PdGraph() {
     delete messageObject;
   }
   delete nodeList;
+  
+  // the disk thread is stopped only once all streaming objects have been deleted
+  if (sampleLoader != NULL) {
+    diskStreamer->removeClient(sampleLoader);
+    delete sampleLoader;
+  }
+  if (diskStreamer != NULL) {
+    delete diskStreamer;
+  }
+  if (blockAdapter != NULL) {
+    delete blockAdapter;
+  }
+  if (compiledDsp != NULL) {
+    delete compiledDsp;
+  }
+  if (eventQueue != NULL) {
+    // remaining messages are delivered immediately
+    EventQueue *queue = eventQueue;
+    eventQueue = NULL;
+    queue->deliver(callbackFunction, callbackUserData);
+    delete queue;
+  }
+  free(directory);
 }
 
 const char *PdGraph::getObjectLabel() {
@@ -379,12 +527,18 @@ MessageObject *PdGraph::newObject(char *objectType, char *objectLabel, PdMessage
     } else if (strcmp(objectLabel, "bang") == 0 ||
                strcmp(objectLabel, "bng") == 0) {
       return new MessageBang(graph);
+    } else if (strcmp(objectLabel, "bendin") == 0) {
+      return new MessageBendin(initMessage, graph);
     } else if (strcmp(objectLabel, "change") == 0) {
       return new MessageChange(initMessage, graph);
     } else if (strcmp(objectLabel, "cos") == 0) {
       return new MessageCosine(initMessage, graph);
+    } else if (strcmp(objectLabel, "clone") == 0) {
+      return new DspClone(initMessage, graph);
     } else if (strcmp(objectLabel, "clip") == 0) {
       return new MessageClip(initMessage, graph);
+    } else if (strcmp(objectLabel, "ctlin") == 0) {
+      return new MessageCtlin(initMessage, graph);
     } else if (strcmp(objectLabel, "declare") == 0) {
       return new MessageDeclare(initMessage, graph);
     } else if (strcmp(objectLabel, "delay") == 0) {
@@ -442,8 +596,12 @@ MessageObject *PdGraph::newObject(char *objectType, char *objectLabel, PdMessage
       return new MessagePack(initMessage, graph);
     } else if (strcmp(objectLabel, "pipe") == 0) {
       return new MessagePipe(initMessage, graph);
+    } else if (strcmp(objectLabel, "poly") == 0) {
+      return new MessagePoly(initMessage, graph);
     } else if (strcmp(objectLabel, "print") == 0) {
       return new MessagePrint(initMessage, graph);
+    } else if (strcmp(objectLabel, "qlist") == 0) {
+      return new MessageQlist(initMessage, graph);
     } else if (strcmp(objectLabel, "outlet") == 0) {
       return new MessageOutlet(graph);
     } else if (strcmp(objectLabel, "random") == 0) {
@@ -459,19 +617,27 @@ MessageObject *PdGraph::newObject(char *objectType, char *objectLabel, PdMessage
       return new MessageSend(initMessage, graph);
     } else if (strcmp(objectLabel, "sin") == 0) {
       return new MessageSine(initMessage, graph);
+    } else if (strcmp(objectLabel, "soundfiler") == 0) {
+      return new MessageSoundfiler(initMessage, graph);
     } else if (strcmp(objectLabel, "spigot") == 0) {
       return new MessageSpigot(initMessage, graph);
     } else if (strcmp(objectLabel, "swap") == 0) {
       return new MessageSwap(initMessage, graph);
     } else if (strcmp(objectLabel, "symbol") == 0) {
       return new MessageSymbol(initMessage, graph);
+    } else if (strcmp(objectLabel, "table") == 0) {
+      return new DspTable(initMessage, graph);
     } else if (strcmp(objectLabel, "tan") == 0) {
       return new MessageTangent(initMessage, graph);
+    } else if (strcmp(objectLabel, "textfile") == 0) {
+      return new MessageTextfile(initMessage, graph);
     } else if (strcmp(objectLabel, "timer") == 0) {
       return new MessageTimer(initMessage, graph);
     } else if (strcmp(objectLabel, "toggle") == 0 ||
                strcmp(objectLabel, "tgl") == 0) {
       return new MessageToggle(initMessage, graph);
+    } else if (strcmp(objectLabel, "touchin") == 0) {
+      return new MessageTouchin(initMessage, graph);
     } else if (strcmp(objectLabel, "trigger") == 0 ||
                strcmp(objectLabel, "t") == 0) {
       return new MessageTrigger(initMessage, graph);
@@ -495,6 +661,8 @@ MessageObject *PdGraph::newObject(char *objectType, char *objectLabel, PdMessage
       return new DspDivide(initMessage, graph);
     } else if (strcmp(objectLabel, "adc~") == 0) {
       return new DspAdc(graph);
+    } else if (strcmp(objectLabel, "bang~") == 0) {
+      return new DspBang(graph);
     } else if (strcmp(objectLabel, "bp~") == 0) {
       return new DspBandpassFilter(initMessage, graph);
     } else if (strcmp(objectLabel, "catch~") == 0) {
@@ -522,13 +690,15 @@ MessageObject *PdGraph::newObject(char *objectType, char *objectLabel, PdMessage
     } else if (strcmp(objectLabel, "lop~") == 0) {
       return new DspLowpassFilter(initMessage, graph);
     } else if (strcmp(objectLabel, "noise~") == 0) {
-      return new DspNoise(graph);
+      return new DspNoise(initMessage, graph);
     } else if (strcmp(objectLabel, "osc~") == 0) {
       return new DspOsc(initMessage, graph);
     } else if (strcmp(objectLabel, "outlet~") == 0) {
       return new DspOutlet(graph);
     } else if (strcmp(objectLabel, "phasor~") == 0) {
       return new DspPhasor(initMessage, graph);
+    } else if (strcmp(objectLabel, "readsf~") == 0) {
+      return new DspReadSoundfile(initMessage, graph);
     } else if (strcmp(objectLabel, "receive~") == 0 ||
                strcmp(objectLabel, "r~") == 0) {
       return new DspReceive(initMessage, graph);
@@ -543,12 +713,30 @@ MessageObject *PdGraph::newObject(char *objectType, char *objectLabel, PdMessage
       return new DspSnapshot(initMessage, graph);
     } else if (strcmp(objectLabel, "switch~") == 0) {
       return new MessageSwitch(initMessage, graph);
+    } else if (strcmp(objectLabel, "tabosc4~") == 0) {
+      return new DspTableOsc4(initMessage, graph);
+    } else if (strcmp(objectLabel, "tabplay~") == 0) {
+      return new DspTablePlay(initMessage, graph);
+    } else if (strcmp(objectLabel, "tabread~") == 0) {
+      return new DspTableRead(initMessage, graph);
+    } else if (strcmp(objectLabel, "tabread4~") == 0) {
+      return new DspTableRead4(initMessage, graph);
+    } else if (strcmp(objectLabel, "tabwrite~") == 0) {
+      return new DspTableWrite(initMessage, graph);
+    } else if (strcmp(objectLabel, "threshold~") == 0) {
+      return new DspThreshold(initMessage, graph);
     } else if (strcmp(objectLabel, "throw~") == 0) {
       return new DspThrow(initMessage, graph);
     } else if (strcmp(objectLabel, "vd~") == 0) {
       return new DspVariableDelay(initMessage, graph);
+    } else if (strcmp(objectLabel, "vline~") == 0) {
+      return new DspVLine(graph);
+    } else if (strcmp(objectLabel, "vsnapshot~") == 0) {
+      return new DspVSnapshot(initMessage, graph);
     } else if (strcmp(objectLabel, "wrap~") == 0) {
       return new DspWrap(initMessage, graph);
+    } else if (strcmp(objectLabel, "writesf~") == 0) {
+      return new DspWriteSoundfile(initMessage, graph);
     }
   } else if (strcmp(objectType, "msg") == 0) {
     // TODO(mhroth)
@@ -569,8 +757,16 @@ void PdGraph::addObject(MessageObject *node) {
     outletList->add(node);
     ((MessageOutlet *) node)->setOutletIndex(outletList->size()-1);
   } else if (strcmp(node->getObjectLabel(), "receive") == 0 ||
-             strcmp(node->getObjectLabel(), "notein") == 0) {
-    sendController->addReceiver((RemoteMessageReceiver *) node);
+             strcmp(node->getObjectLabel(), "hostreceive") == 0) {
+    registerRemoteMessageReceiver((RemoteMessageReceiver *) node);
+  } else if (strcmp(node->getObjectLabel(), "notein") == 0 ||
+             strcmp(node->getObjectLabel(), "ctlin") == 0 ||
+             strcmp(node->getObjectLabel(), "bendin") == 0 ||
+             strcmp(node->getObjectLabel(), "touchin") == 0) {
+    registerRemoteMessageReceiver((RemoteMessageReceiver *) node);
+    registerMidiReceiver((MidiReceiver *) node);
+  } else if (strcmp(node->getObjectLabel(), "loadbang") == 0) {
+    ((MessageLoadbang *) node)->scheduleLoadbang();
   } else if (strcmp(node->getObjectLabel(), "catch~") == 0) {
     registerDspCatch((DspCatch *) node);
   } else if (strcmp(node->getObjectLabel(), "delread~") == 0 ||
@@ -580,9 +776,7 @@ void PdGraph::addObject(MessageObject *node) {
     registerDelayline((DspDelayWrite *) node);
   } else if (strcmp(node->getObjectLabel(), "inlet~") == 0) {
     inletList->add(node);
-    //((DspInlet *) node)->setInletBuffer(localDspBufferAtInlet + inletList->size() - 1);
     ((DspInlet *) node)->setInletBuffer(&localDspBufferAtInlet[inletList->size()-1]);
-    inletList->add(node);
   } else if (strcmp(node->getObjectLabel(), "outlet~") == 0) {
     outletList->add(node);
     ((DspOutlet *) node)->setOutletIndex(outletList->size()-1);
@@ -592,6 +786,8 @@ void PdGraph::addObject(MessageObject *node) {
     registerDspReceive((DspReceive *) node);
   } else if (strcmp(node->getObjectLabel(), "throw~") == 0) {
     registerDspThrow((DspThrow *) node);
+  } else if (strcmp(node->getObjectLabel(), "table") == 0) {
+    registerTable((DspTable *) node);
   }
 }
 
@@ -606,16 +802,692 @@ void PdGraph::connect(int fromObjectIndex, int outletIndex, int toObjectIndex, i
   connect(fromObject, outletIndex, toObject, inletIndex);
 }
 
+void PdGraph::removeObject(MessageObject *node) {
+  cancelAllMessages(node);
+  node->removeAllConnections();
+  
+  if (strcmp(node->getObjectLabel(), "receive") == 0 ||
+      strcmp(node->getObjectLabel(), "hostreceive") == 0) {
+    unregisterRemoteMessageReceiver((RemoteMessageReceiver *) node);
+  } else if (strcmp(node->getObjectLabel(), "notein") == 0 ||
+             strcmp(node->getObjectLabel(), "ctlin") == 0 ||
+             strcmp(node->getObjectLabel(), "bendin") == 0 ||
+             strcmp(node->getObjectLabel(), "touchin") == 0) {
+    unregisterRemoteMessageReceiver((RemoteMessageReceiver *) node);
+    unregisterMidiReceiver((MidiReceiver *) node);
+  } else if (strcmp(node->getObjectLabel(), "catch~") == 0) {
+    unregisterDspCatch((DspCatch *) node);
+  } else if (strcmp(node->getObjectLabel(), "delread~") == 0 ||
+             strcmp(node->getObjectLabel(), "vd~") == 0) {
+    unregisterDelayReceiver((DelayReceiver *) node);
+  } else if (strcmp(node->getObjectLabel(), "delwrite~") == 0) {
+    unregisterDelayline((DspDelayWrite *) node);
+  } else if (strcmp(node->getObjectLabel(), "send~") == 0) {
+    unregisterDspSend((DspSend *) node);
+  } else if (strcmp(node->getObjectLabel(), "receive~") == 0) {
+    unregisterDspReceive((DspReceive *) node);
+  } else if (strcmp(node->getObjectLabel(), "throw~") == 0) {
+    unregisterDspThrow((DspThrow *) node);
+  } else if (strcmp(node->getObjectLabel(), "table") == 0) {
+    unregisterTable((DspTable *) node);
+  } else if (strcmp(node->getObjectLabel(), "qlist") == 0) {
+    cancelSequence((MessageQlist *) node);
+  }
+  
+  nodeList->remove(nodeList->indexOf(node));
+}
+
+MessageObject *PdGraph::createObject(char *initString) {
+  char *string = StaticUtils::copyString(initString);
+  MessageObject *messageObject = NULL;
+  char *objectLabel = strtok(string, " ;");
+  if (objectLabel == NULL) {
+    printErr("An object cannot be created from an empty string.\n");
+  } else if (strcmp(objectLabel, "msg") == 0) {
+    char *messageInitString = strtok(NULL, "");
+    if (messageInitString != NULL) {
+      messageObject = new MessageMessageBox(messageInitString, this);
+    } else {
+      printErr("An empty message box cannot be created.\n");
+    }
+  } else if (strcmp(objectLabel, "inlet") == 0 || strcmp(objectLabel, "inlet~") == 0 ||
+             strcmp(objectLabel, "outlet") == 0 || strcmp(objectLabel, "outlet~") == 0 ||
+             strcmp(objectLabel, "pd") == 0 || strcmp(objectLabel, "clone") == 0) {
+    printErr("\"%s\" objects cannot be added to a running graph.\n", objectLabel);
+  } else {
+    char *objectInitString = strtok(NULL, ";");
+    PdMessage *initMessage = new PdMessage(objectInitString, getArguments());
+    // NOTE(mhroth): abstractions are not searched for, as they register objects with the root
+    // graph while being loaded
+    messageObject = newObject((char *) "obj", objectLabel, initMessage, this);
+    delete initMessage;
+  }
+  free(string);
+  return messageObject;
+}
+
+bool PdGraph::queueAddObject(MessageObject *object) {
+  if (object == NULL || !isRootGraph() || object->getGraph() != this ||
+      getPlannedList(&nodeList)->exists(object)) {
+    return false;
+  }
+  return queueGraphEdit(GRAPH_EDIT_ADD_OBJECT, object, 0, NULL, 0);
+}
+
+bool PdGraph::queueRemoveObject(MessageObject *object) {
+  if (object == NULL) {
+    return false;
+  } else if (!isRootGraph() || !getPlannedList(&nodeList)->exists(object)) {
+    // an object which has been removed already would otherwise be deleted twice
+    printErr("\"%s\" is not part of the running graph, or has been removed already.\n",
+        object->getObjectLabel());
+    return false;
+  } else if (strcmp(object->getObjectLabel(), "pd") == 0 ||
+             strcmp(object->getObjectLabel(), "clone") == 0) {
+    // the objects of a subgraph are registered with the root graph
+    printErr("\"%s\" objects cannot be removed from a running graph.\n", object->getObjectLabel());
+    return false;
+  }
+  return queueGraphEdit(GRAPH_EDIT_REMOVE_OBJECT, object, 0, NULL, 0);
+}
+
+bool PdGraph::queueConnect(MessageObject *fromObject, int outletIndex, MessageObject *toObject, int inletIndex) {
+  if (fromObject == NULL || toObject == NULL ||
+      outletIndex < 0 || outletIndex >= fromObject->getNumOutlets() ||
+      inletIndex < 0 || inletIndex >= toObject->getNumInlets()) {
+    printErr("Connection from outlet %i to inlet %i does not exist.\n", outletIndex, inletIndex);
+    return false;
+  }
+  List *plannedNodeList = isRootGraph() ? getPlannedList(&nodeList) : NULL;
+  if (plannedNodeList == NULL || !plannedNodeList->exists(fromObject) ||
+      !plannedNodeList->exists(toObject)) {
+    printErr("Only objects which are part of the running graph can be connected.\n");
+    return false;
+  }
+  ConnectionType type = fromObject->getConnectionType(outletIndex);
+  if (type == DSP) {
+    if (!toObject->doesProcessAudio() || inletIndex >= ((DspObject *) toObject)->getNumDspInlets()) {
+      printErr("Signal outlet of \"%s\" cannot be connected to message inlet %i of \"%s\".\n",
+          fromObject->getObjectLabel(), inletIndex, toObject->getObjectLabel());
+      return false;
+    }
+  } else if (inletIndex >= toObject->getNumMessageInlets()) {
+    printErr("Message outlet of \"%s\" cannot be connected to signal inlet %i of \"%s\".\n",
+        fromObject->getObjectLabel(), inletIndex, toObject->getObjectLabel());
+    return false;
+  }
+  if (getPlannedConnection(fromObject->getOutgoingConnectionsSlot(type, outletIndex), toObject,
+      inletIndex) != NULL) {
+    return false; // the objects are connected already
+  }
+  return queueGraphEdit(GRAPH_EDIT_CONNECT, fromObject, outletIndex, toObject, inletIndex);
+}
+
+bool PdGraph::queueDisconnect(MessageObject *fromObject, int outletIndex, MessageObject *toObject, int inletIndex) {
+  if (fromObject == NULL || toObject == NULL || !isRootGraph()) {
+    return false;
+  }
+  List *plannedNodeList = getPlannedList(&nodeList);
+  if (!plannedNodeList->exists(fromObject) || !plannedNodeList->exists(toObject) ||
+      outletIndex < 0 || outletIndex >= fromObject->getNumOutlets()) {
+    return false;
+  }
+  ConnectionType type = fromObject->getConnectionType(outletIndex);
+  if (getPlannedConnection(fromObject->getOutgoingConnectionsSlot(type, outletIndex), toObject,
+      inletIndex) == NULL) {
+    return false; // the objects are not connected
+  }
+  return queueGraphEdit(GRAPH_EDIT_DISCONNECT, fromObject, outletIndex, toObject, inletIndex);
+}
+
+MessageObject *PdGraph::getObject(int index) {
+  List *plannedNodeList = getPlannedList(&nodeList);
+  return (index >= 0 && index < plannedNodeList->size())
+      ? (MessageObject *) plannedNodeList->get(index) : NULL;
+}
+
+bool PdGraph::queueGraphEdit(GraphEditType type, MessageObject *fromObject, int outletIndex,
+    MessageObject *toObject, int inletIndex) {
+  if (isRootGraph()) {
+    releaseCompletedGraphEdits();
+    if (plannedEditList->size() >= MAX_OUTSTANDING_EDITS) {
+      printErr("Too many graph edits are outstanding. The edit is ignored.\n");
+      return false;
+    }
+    GraphEdit *graphEdit = (GraphEdit *) malloc(sizeof(GraphEdit));
+    graphEdit->type = type;
+    graphEdit->graph = this; // objects can only be added to the root graph
+    graphEdit->fromObject = fromObject;
+    graphEdit->outletIndex = outletIndex;
+    graphEdit->toObject = toObject;
+    graphEdit->inletIndex = inletIndex;
+    graphEdit->listSwapList = new List();
+    graphEdit->connectionList = new List();
+    graphEdit->receiverList = NULL;
+    graphEdit->replacedReceiverList = NULL;
+    graphEdit->receiverName = NULL;
+    graphEdit->tableMap = NULL;
+    graphEdit->replacedTableMap = NULL;
+    graphEdit->isDspOrderChanged = false;
+    graphEdit->compiledDsp = NULL;
+    plannedEditList->add(graphEdit);
+    planGraphEdit(graphEdit);
+    // the number of outstanding edits bounds the number of elements in either queue, so this
+    // push cannot fail
+    pendingEditQueue->push(graphEdit);
+    return true;
+  } else {
+    return parentGraph->queueGraphEdit(type, fromObject, outletIndex, toObject, inletIndex);
+  }
+}
+
+List *PdGraph::getPlannedList(List **slot) {
+  if (isRootGraph()) {
+    // the latest edit replacing the list decides. Lists which no edit replaces are not written by
+    // the audio thread.
+    for (int i = plannedEditList->size()-1; i >= 0; i--) {
+      List *listSwapList = ((GraphEdit *) plannedEditList->get(i))->listSwapList;
+      for (int j = 0; j < listSwapList->size(); j++) {
+        ListSwap *listSwap = (ListSwap *) listSwapList->get(j);
+        if (listSwap->slot == slot) {
+          return listSwap->newList;
+        }
+      }
+    }
+    return *slot;
+  } else {
+    return parentGraph->getPlannedList(slot);
+  }
+}
+
+List *PdGraph::getEditedList(GraphEdit *graphEdit, List **slot) {
+  for (int i = 0; i < graphEdit->listSwapList->size(); i++) {
+    ListSwap *listSwap = (ListSwap *) graphEdit->listSwapList->get(i);
+    if (listSwap->slot == slot) {
+      return listSwap->newList;
+    }
+  }
+  ListSwap *listSwap = (ListSwap *) malloc(sizeof(ListSwap));
+  listSwap->slot = slot;
+  listSwap->oldList = getPlannedList(slot);
+  listSwap->newList = (new List())->add(listSwap->oldList);
+  graphEdit->listSwapList->add(listSwap);
+  return listSwap->newList;
+}
+
+HashTable *PdGraph::getPlannedTableMap() {
+  for (int i = plannedEditList->size()-1; i >= 0; i--) {
+    GraphEdit *graphEdit = (GraphEdit *) plannedEditList->get(i);
+    if (graphEdit->tableMap != NULL) {
+      return graphEdit->tableMap;
+    }
+  }
+  return tableMap;
+}
+
+ObjectLetPair *PdGraph::getPlannedConnection(List **slot, MessageObject *messageObject, int letIndex) {
+  if (slot != NULL) {
+    List *connectionList = getPlannedList(slot);
+    for (int i = 0; i < connectionList->size(); i++) {
+      ObjectLetPair *objectLetPair = (ObjectLetPair *) connectionList->get(i);
+      if (objectLetPair->object == messageObject && objectLetPair->index == letIndex) {
+        return objectLetPair;
+      }
+    }
+  }
+  return NULL;
+}
+
+void PdGraph::planGraphEdit(GraphEdit *graphEdit) {
+  switch (graphEdit->type) {
+    case GRAPH_EDIT_ADD_OBJECT: {
+      planAddObject(graphEdit);
+      break;
+    }
+    case GRAPH_EDIT_REMOVE_OBJECT: {
+      planRemoveObject(graphEdit);
+      break;
+    }
+    case GRAPH_EDIT_CONNECT: {
+      MessageObject *fromObject = graphEdit->fromObject;
+      MessageObject *toObject = graphEdit->toObject;
+      ConnectionType type = fromObject->getConnectionType(graphEdit->outletIndex);
+      ObjectLetPair *outgoingPair = (ObjectLetPair *) malloc(sizeof(ObjectLetPair));
+      outgoingPair->object = toObject;
+      outgoingPair->index = graphEdit->inletIndex;
+      getEditedList(graphEdit, fromObject->getOutgoingConnectionsSlot(type, graphEdit->outletIndex))->add(outgoingPair);
+      ObjectLetPair *incomingPair = (ObjectLetPair *) malloc(sizeof(ObjectLetPair));
+      incomingPair->object = fromObject;
+      incomingPair->index = graphEdit->outletIndex;
+      getEditedList(graphEdit, toObject->getIncomingConnectionsSlot(type, graphEdit->inletIndex))->add(incomingPair);
+      graphEdit->connectionList->add(outgoingPair)->add(incomingPair);
+      break;
+    }
+    case GRAPH_EDIT_DISCONNECT: {
+      MessageObject *fromObject = graphEdit->fromObject;
+      MessageObject *toObject = graphEdit->toObject;
+      ConnectionType type = fromObject->getConnectionType(graphEdit->outletIndex);
+      List **outgoingSlot = fromObject->getOutgoingConnectionsSlot(type, graphEdit->outletIndex);
+      List **incomingSlot = toObject->getIncomingConnectionsSlot(type, graphEdit->inletIndex);
+      ObjectLetPair *outgoingPair = getPlannedConnection(outgoingSlot, toObject, graphEdit->inletIndex);
+      ObjectLetPair *incomingPair = getPlannedConnection(incomingSlot, fromObject, graphEdit->outletIndex);
+      List *list = getEditedList(graphEdit, outgoingSlot);
+      list->remove(list->indexOf(outgoingPair));
+      list = getEditedList(graphEdit, incomingSlot);
+      list->remove(list->indexOf(incomingPair));
+      graphEdit->connectionList->add(outgoingPair)->add(incomingPair);
+      break;
+    }
+  }
+  planDspProcessOrder(graphEdit);
+}
+
+void PdGraph::planAddObject(GraphEdit *graphEdit) {
+  MessageObject *node = graphEdit->fromObject;
+  getEditedList(graphEdit, &nodeList)->add(node);
+  
+  // the objects which must be connected to the added one are connected by the audio thread, once
+  // the lists have been exchanged. See applyGraphEdit().
+  const char *objectLabel = node->getObjectLabel();
+  if (strcmp(objectLabel, "receive") == 0 ||
+      strcmp(objectLabel, "hostreceive") == 0) {
+    sendController->planAddReceiver((RemoteMessageReceiver *) node, graphEdit);
+  } else if (strcmp(objectLabel, "notein") == 0 ||
+             strcmp(objectLabel, "ctlin") == 0 ||
+             strcmp(objectLabel, "bendin") == 0 ||
+             strcmp(objectLabel, "touchin") == 0) {
+    sendController->planAddReceiver((RemoteMessageReceiver *) node, graphEdit);
+    getEditedList(graphEdit, midiController->getReceiverListSlot((MidiReceiver *) node))->add(node);
+  } else if (strcmp(objectLabel, "catch~") == 0) {
+    DspCatch *dspCatch = (DspCatch *) node;
+    if (findDspCatch(getPlannedList(&catchList), dspCatch->getName()) != NULL) {
+      printErr("catch~ with duplicate name \"%s\" already exists.\n", dspCatch->getName());
+    } else {
+      getEditedList(graphEdit, &catchList)->add(dspCatch);
+      List *plannedThrowList = getPlannedList(&throwList);
+      for (int i = 0; i < plannedThrowList->size(); i++) {
+        DspThrow *dspThrow = (DspThrow *) plannedThrowList->get(i);
+        if (strcmp(dspThrow->getName(), dspCatch->getName()) == 0) {
+          getEditedList(graphEdit, dspCatch->getThrowListSlot())->add(dspThrow);
+        }
+      }
+    }
+  } else if (strcmp(objectLabel, "delread~") == 0 ||
+             strcmp(objectLabel, "vd~") == 0) {
+    getEditedList(graphEdit, &delayReceiverList)->add(node);
+  } else if (strcmp(objectLabel, "delwrite~") == 0) {
+    DspDelayWrite *delayline = (DspDelayWrite *) node;
+    if (findDelayline(getPlannedList(&delaylineList), delayline->getName()) != NULL) {
+      printErr("delwrite~ with duplicate name \"%s\" registered.", delayline->getName());
+    } else {
+      getEditedList(graphEdit, &delaylineList)->add(delayline);
+    }
+  } else if (strcmp(objectLabel, "send~") == 0) {
+    DspSend *dspSend = (DspSend *) node;
+    if (findDspSend(getPlannedList(&dspSendList), dspSend->getName()) != NULL) {
+      printErr("Duplicate send~ object with name \"%s\" found.\n", dspSend->getName());
+    } else {
+      getEditedList(graphEdit, &dspSendList)->add(dspSend);
+    }
+  } else if (strcmp(objectLabel, "receive~") == 0) {
+    getEditedList(graphEdit, &dspReceiveList)->add(node);
+  } else if (strcmp(objectLabel, "throw~") == 0) {
+    DspThrow *dspThrow = (DspThrow *) node;
+    getEditedList(graphEdit, &throwList)->add(dspThrow);
+    DspCatch *dspCatch = findDspCatch(getPlannedList(&catchList), dspThrow->getName());
+    if (dspCatch != NULL) {
+      getEditedList(graphEdit, dspCatch->getThrowListSlot())->add(dspThrow);
+    }
+  } else if (strcmp(objectLabel, "table") == 0) {
+    DspTable *table = (DspTable *) node;
+    HashTable *plannedTableMap = getPlannedTableMap();
+    if (plannedTableMap->get(table->getName()) != NULL) {
+      printErr("table with duplicate name \"%s\" already exists.\n", table->getName());
+    } else {
+      graphEdit->replacedTableMap = plannedTableMap;
+      graphEdit->tableMap = plannedTableMap->copy();
+      graphEdit->tableMap->put(table->getName(), table);
+    }
+  }
+}
+
+void PdGraph::planRemoveObject(GraphEdit *graphEdit) {
+  MessageObject *node = graphEdit->fromObject;
+  List *list = getEditedList(graphEdit, &nodeList);
+  list->remove(list->indexOf(node));
+  planRemoveConnections(graphEdit, node);
+  
+  // lists from which the object is absent anyway are left alone
+  const char *objectLabel = node->getObjectLabel();
+  if (strcmp(objectLabel, "receive") == 0 ||
+      strcmp(objectLabel, "hostreceive") == 0) {
+    sendController->planRemoveReceiver((RemoteMessageReceiver *) node, graphEdit);
+  } else if (strcmp(objectLabel, "notein") == 0 ||
+             strcmp(objectLabel, "ctlin") == 0 ||
+             strcmp(objectLabel, "bendin") == 0 ||
+             strcmp(objectLabel, "touchin") == 0) {
+    sendController->planRemoveReceiver((RemoteMessageReceiver *) node, graphEdit);
+    list = getEditedList(graphEdit, midiController->getReceiverListSlot((MidiReceiver *) node));
+    list->remove(list->indexOf(node));
+  } else if (strcmp(objectLabel, "catch~") == 0) {
+    if (getPlannedList(&catchList)->exists(node)) { // duplicate catch~s are never registered
+      list = getEditedList(graphEdit, &catchList);
+      list->remove(list->indexOf(node));
+    }
+  } else if (strcmp(objectLabel, "delread~") == 0 ||
+             strcmp(objectLabel, "vd~") == 0) {
+    list = getEditedList(graphEdit, &delayReceiverList);
+    list->remove(list->indexOf(node));
+  } else if (strcmp(objectLabel, "delwrite~") == 0) {
+    if (getPlannedList(&delaylineList)->exists(node)) {
+      list = getEditedList(graphEdit, &delaylineList);
+      list->remove(list->indexOf(node));
+    }
+  } else if (strcmp(objectLabel, "send~") == 0) {
+    if (getPlannedList(&dspSendList)->exists(node)) {
+      list = getEditedList(graphEdit, &dspSendList);
+      list->remove(list->indexOf(node));
+    }
+  } else if (strcmp(objectLabel, "receive~") == 0) {
+    list = getEditedList(graphEdit, &dspReceiveList);
+    list->remove(list->indexOf(node));
+  } else if (strcmp(objectLabel, "throw~") == 0) {
+    DspThrow *dspThrow = (DspThrow *) node;
+    list = getEditedList(graphEdit, &throwList);
+    list->remove(list->indexOf(dspThrow));
+    DspCatch *dspCatch = findDspCatch(getPlannedList(&catchList), dspThrow->getName());
+    if (dspCatch != NULL) {
+      list = getEditedList(graphEdit, dspCatch->getThrowListSlot());
+      list->remove(list->indexOf(dspThrow));
+    }
+  } else if (strcmp(objectLabel, "table") == 0) {
+    DspTable *table = (DspTable *) node;
+    HashTable *plannedTableMap = getPlannedTableMap();
+    if (plannedTableMap->get(table->getName()) == table) { // duplicate tables are never registered
+      graphEdit->replacedTableMap = plannedTableMap;
+      graphEdit->tableMap = plannedTableMap->copy();
+      graphEdit->tableMap->remove(table->getName());
+    }
+  }
+}
+
+void PdGraph::planRemoveConnections(GraphEdit *graphEdit, MessageObject *object) {
+  // The lists of the object itself are not replaced. Its connections are freed with it, and those
+  // at the other ends with the edit.
+  ConnectionType types[] = {MESSAGE, DSP};
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < object->getNumInlets(); j++) {
+      List **slot = object->getIncomingConnectionsSlot(types[i], j);
+      if (slot == NULL) {
+        continue;
+      }
+      List *connectionList = getPlannedList(slot);
+      for (int k = 0; k < connectionList->size(); k++) {
+        ObjectLetPair *objectLetPair = (ObjectLetPair *) connectionList->get(k);
+        List **remoteSlot = objectLetPair->object->getOutgoingConnectionsSlot(types[i], objectLetPair->index);
+        ObjectLetPair *remotePair = getPlannedConnection(remoteSlot, object, j);
+        List *list = getEditedList(graphEdit, remoteSlot);
+        list->remove(list->indexOf(remotePair));
+        graphEdit->connectionList->add(remotePair);
+      }
+    }
+    for (int j = 0; j < object->getNumOutlets(); j++) {
+      List **slot = object->getOutgoingConnectionsSlot(types[i], j);
+      if (slot == NULL) {
+        continue;
+      }
+      List *connectionList = getPlannedList(slot);
+      for (int k = 0; k < connectionList->size(); k++) {
+        ObjectLetPair *objectLetPair = (ObjectLetPair *) connectionList->get(k);
+        List **remoteSlot = objectLetPair->object->getIncomingConnectionsSlot(types[i], objectLetPair->index);
+        ObjectLetPair *remotePair = getPlannedConnection(remoteSlot, object, j);
+        List *list = getEditedList(graphEdit, remoteSlot);
+        list->remove(list->indexOf(remotePair));
+        graphEdit->connectionList->add(remotePair);
+      }
+    }
+  }
+}
+
+void PdGraph::planDspProcessOrder(GraphEdit *graphEdit) {
+  List *orderList = new List();
+  orderDspObjects(orderList);
+  List *plannedDspNodeList = getPlannedList(&dspNodeList);
+  bool isOrderChanged = (orderList->size() != plannedDspNodeList->size());
+  for (int i = 0; i < orderList->size() && !isOrderChanged; i++) {
+    isOrderChanged = (orderList->get(i) != plannedDspNodeList->get(i));
+  }
+  // a signal connection may change which objects can be fused, even if the order remains
+  bool isDspConnectionChanged = (graphEdit->type == GRAPH_EDIT_CONNECT ||
+      graphEdit->type == GRAPH_EDIT_DISCONNECT) &&
+      graphEdit->fromObject->getConnectionType(graphEdit->outletIndex) == DSP;
+  if (isOrderChanged || isDspConnectionChanged) {
+    graphEdit->isDspOrderChanged = true;
+    List *reusableChainList = (new List())->add(getPlannedList(&fusedChainList));
+    List *newDspNodeList = getEditedList(graphEdit, &dspNodeList);
+    newDspNodeList->clear();
+    newDspNodeList->add(orderList);
+    List *newDspProcessList = getEditedList(graphEdit, &dspProcessList);
+    newDspProcessList->clear();
+    List *newChainList = getEditedList(graphEdit, &fusedChainList);
+    newChainList->clear();
+    fuseDspChains(newDspNodeList, reusableChainList, newDspProcessList, newChainList);
+    delete reusableChainList;
+  }
+  delete orderList;
+}
+
+void PdGraph::discardGraphEdit(GraphEdit *graphEdit) {
+  for (int i = 0; i < graphEdit->listSwapList->size(); i++) {
+    ListSwap *listSwap = (ListSwap *) graphEdit->listSwapList->get(i);
+    if (listSwap->slot == &fusedChainList) {
+      for (int j = 0; j < listSwap->newList->size(); j++) {
+        if (!listSwap->oldList->exists(listSwap->newList->get(j))) {
+          delete (DspFusedChain *) listSwap->newList->get(j);
+        }
+      }
+    }
+    delete listSwap->newList;
+    free(listSwap);
+  }
+  delete graphEdit->listSwapList;
+  if (graphEdit->type == GRAPH_EDIT_CONNECT) {
+    // removed connections are still part of the graph
+    for (int i = 0; i < graphEdit->connectionList->size(); i++) {
+      free(graphEdit->connectionList->get(i));
+    }
+  }
+  delete graphEdit->connectionList;
+  delete graphEdit->receiverList;
+  free(graphEdit->receiverName);
+  delete graphEdit->tableMap;
+  plannedEditList->remove(plannedEditList->indexOf(graphEdit));
+  free(graphEdit);
+}
+
+void PdGraph::releaseCompletedGraphEdits() {
+  if (isRootGraph()) {
+    GraphEdit *graphEdit = NULL;
+    while ((graphEdit = (GraphEdit *) completedEditQueue->pop()) != NULL) {
+      // free everything which the edit has replaced
+      for (int i = 0; i < graphEdit->listSwapList->size(); i++) {
+        ListSwap *listSwap = (ListSwap *) graphEdit->listSwapList->get(i);
+        if (listSwap->slot == &fusedChainList) {
+          for (int j = 0; j < listSwap->oldList->size(); j++) {
+            if (!listSwap->newList->exists(listSwap->oldList->get(j))) {
+              delete (DspFusedChain *) listSwap->oldList->get(j);
+            }
+          }
+        }
+        delete listSwap->oldList;
+        free(listSwap);
+      }
+      delete graphEdit->listSwapList;
+      if (graphEdit->type != GRAPH_EDIT_CONNECT) {
+        for (int i = 0; i < graphEdit->connectionList->size(); i++) {
+          free(graphEdit->connectionList->get(i));
+        }
+      }
+      delete graphEdit->connectionList;
+      delete graphEdit->replacedReceiverList;
+      delete graphEdit->replacedTableMap;
+      if (graphEdit->type == GRAPH_EDIT_REMOVE_OBJECT) {
+        delete graphEdit->fromObject;
+      }
+      if (graphEdit->compiledDsp != NULL) {
+        printErr("The graph has been edited. Its audio objects are no longer compiled.\n");
+        delete graphEdit->compiledDsp;
+      }
+      plannedEditList->remove(0); // edits are applied in the order in which they are planned
+      free(graphEdit);
+    }
+  } else {
+    parentGraph->releaseCompletedGraphEdits();
+  }
+}
+
+void PdGraph::applyGraphEdits() {
+  if (pendingEditQueue->isEmpty()) {
+    return; // the common case
+  }
+  
+  GraphEdit *graphEdit = NULL;
+  while ((graphEdit = (GraphEdit *) pendingEditQueue->pop()) != NULL) {
+    graphEdit->graph->applyGraphEdit(graphEdit);
+    // hand the edit back to the control thread, which frees it and anything which it has replaced
+    completedEditQueue->push(graphEdit);
+  }
+}
+
+void PdGraph::applyGraphEdit(GraphEdit *graphEdit) {
+  // Exchange the lists which have been built by the control thread. Each replaced list is the one
+  // which the edit has been planned against, as edits are applied in order.
+  for (int i = 0; i < graphEdit->listSwapList->size(); i++) {
+    ListSwap *listSwap = (ListSwap *) graphEdit->listSwapList->get(i);
+    *(listSwap->slot) = listSwap->newList;
+  }
+  if (graphEdit->tableMap != NULL) {
+    tableMap = graphEdit->tableMap;
+  }
+  
+  // connect the objects which refer to each other by name, now that the lists are up to date
+  MessageObject *node = graphEdit->fromObject;
+  switch (graphEdit->type) {
+    case GRAPH_EDIT_ADD_OBJECT: {
+      const char *objectLabel = node->getObjectLabel();
+      if (strcmp(objectLabel, "loadbang") == 0) {
+        ((MessageLoadbang *) node)->scheduleLoadbang();
+      } else if (strcmp(objectLabel, "delread~") == 0 ||
+                 strcmp(objectLabel, "vd~") == 0) {
+        DelayReceiver *delayReceiver = (DelayReceiver *) node;
+        delayReceiver->setDelayline(getDelayline(delayReceiver->getName()));
+      } else if (strcmp(objectLabel, "delwrite~") == 0) {
+        DspDelayWrite *delayline = (DspDelayWrite *) node;
+        if (getDelayline(delayline->getName()) == delayline) {
+          for (int i = 0; i < delayReceiverList->size(); i++) {
+            DelayReceiver *delayReceiver = (DelayReceiver *) delayReceiverList->get(i);
+            if (strcmp(delayReceiver->getName(), delayline->getName()) == 0) {
+              delayReceiver->setDelayline(delayline);
+            }
+          }
+        }
+      } else if (strcmp(objectLabel, "send~") == 0) {
+        DspSend *dspSend = (DspSend *) node;
+        if (getDspSend(dspSend->getName()) == dspSend) {
+          for (int i = 0; i < dspReceiveList->size(); i++) {
+            DspReceive *dspReceive = (DspReceive *) dspReceiveList->get(i);
+            if (strcmp(dspReceive->getName(), dspSend->getName()) == 0) {
+              dspReceive->setBuffer(dspSend->getBuffer());
+            }
+          }
+        }
+      } else if (strcmp(objectLabel, "receive~") == 0) {
+        DspReceive *dspReceive = (DspReceive *) node;
+        DspSend *dspSend = getDspSend(dspReceive->getName());
+        if (dspSend != NULL) {
+          dspReceive->setBuffer(dspSend->getBuffer());
+        }
+      }
+      break;
+    }
+    case GRAPH_EDIT_REMOVE_OBJECT: {
+      cancelAllMessages(node);
+      const char *objectLabel = node->getObjectLabel();
+      if (strcmp(objectLabel, "delwrite~") == 0) {
+        DspDelayWrite *delayline = (DspDelayWrite *) node;
+        if (getDelayline(delayline->getName()) == NULL) { // unless a duplicate remains registered
+          for (int i = 0; i < delayReceiverList->size(); i++) {
+            DelayReceiver *delayReceiver = (DelayReceiver *) delayReceiverList->get(i);
+            if (strcmp(delayReceiver->getName(), delayline->getName()) == 0) {
+              delayReceiver->setDelayline(NULL);
+            }
+          }
+        }
+      } else if (strcmp(objectLabel, "send~") == 0) {
+        DspSend *dspSend = (DspSend *) node;
+        if (getDspSend(dspSend->getName()) == NULL) {
+          for (int i = 0; i < dspReceiveList->size(); i++) {
+            DspReceive *dspReceive = (DspReceive *) dspReceiveList->get(i);
+            if (strcmp(dspReceive->getName(), dspSend->getName()) == 0) {
+              dspReceive->setBuffer(NULL);
+            }
+          }
+        }
+      } else if (strcmp(objectLabel, "qlist") == 0) {
+        cancelSequence((MessageQlist *) node);
+      }
+      if (node->doesProcessAudio()) {
+        // the objects which received its signals may no longer receive any
+        DspObject *dspObject = (DspObject *) node;
+        for (int i = 0; i < dspObject->getNumOutlets(); i++) {
+          List **slot = dspObject->getOutgoingConnectionsSlot(DSP, i);
+          for (int j = 0; slot != NULL && j < (*slot)->size(); j++) {
+            ObjectLetPair *objectLetPair = (ObjectLetPair *) (*slot)->get(j);
+            ((DspObject *) objectLetPair->object)->updateInletConnections(objectLetPair->index);
+          }
+        }
+      }
+      break;
+    }
+    case GRAPH_EDIT_CONNECT:
+    case GRAPH_EDIT_DISCONNECT: {
+      if (node->getConnectionType(graphEdit->outletIndex) == DSP) {
+        ((DspObject *) graphEdit->toObject)->updateInletConnections(graphEdit->inletIndex);
+      }
+      break;
+    }
+  }
+  
+  if (graphEdit->isDspOrderChanged) {
+    // the new process order has been swapped in. Any compiled code no longer corresponds to the
+    // graph, and is handed back with the edit.
+    graphEdit->compiledDsp = compiledDsp;
+    compiledDsp = NULL;
+  }
+}
+
 float PdGraph::getSampleRate() {
   return sampleRate;
 }
 
-double PdGraph::getBlockStartTimestamp() {
-  return blockStartTimestamp;
+ZGTime PdGraph::getBlockStartTimestamp() {
+  if (isRootGraph()) {
+    return blockStartTimestamp;
+  } else {
+    return parentGraph->getBlockStartTimestamp();
+  }
+}
+
+ZGTime PdGraph::getBlockDuration() {
+  return blockDuration;
 }
 
-double PdGraph::getBlockDuration() {
-  return blockDurationMs;
+ZGTime PdGraph::millisecondsToTime(double milliseconds) {
+  return ZGTimeUtils::fromMilliseconds(milliseconds, sampleRate);
+}
+
+double PdGraph::timeToMilliseconds(ZGTime time) {
+  return ZGTimeUtils::toMilliseconds(time, sampleRate);
 }
 
 void PdGraph::scheduleMessage(MessageObject *messageObject, int outletIndex, PdMessage *message) {
@@ -627,6 +1499,14 @@ void PdGraph::scheduleMessage(MessageObject *messageObject, int outletIndex, PdM
   }
 }
 
+void PdGraph::cancelAllMessages(MessageObject *messageObject) {
+  if (isRootGraph()) {
+    messageCallbackQueue->removeAllMessages(messageObject);
+  } else {
+    parentGraph->cancelAllMessages(messageObject);
+  }
+}
+
 void PdGraph::cancelMessage(MessageObject *messageObject, int outletIndex, PdMessage *message) {
   if (isRootGraph()) {
     message->unreserve(messageObject);
@@ -636,6 +1516,22 @@ void PdGraph::cancelMessage(MessageObject *messageObject, int outletIndex, PdMes
   }
 }
 
+void PdGraph::scheduleSequence(MessageQlist *qlist) {
+  if (isRootGraph()) {
+    sequenceList->add(qlist);
+  } else {
+    parentGraph->scheduleSequence(qlist);
+  }
+}
+
+void PdGraph::cancelSequence(MessageQlist *qlist) {
+  if (isRootGraph()) {
+    sequenceList->remove(sequenceList->indexOf(qlist)); // a no-op if it is not playing
+  } else {
+    parentGraph->cancelSequence(qlist);
+  }
+}
+
 float *PdGraph::getGlobalDspBufferAtInlet(int inletIndex) {
   if (isRootGraph()) {
     return globalDspInputBuffers + (inletIndex * blockSize);
@@ -660,19 +1556,60 @@ void PdGraph::dispatchMessageToNamedReceivers(char *name, PdMessage *message) {
   }
 }
 
-PdMessage *PdGraph::scheduleExternalMessage(char *receiverName) {
+PdMessage *PdGraph::scheduleExternalMessage(char *receiverName, ZGTime timestamp) {
   if (isRootGraph()) {
     int receiverNameIndex = sendController->getNameIndex(receiverName);
     if (receiverNameIndex < 0) {
       return NULL; // return no message if the receiver name is unknown
     } else {
       PdMessage *message = getNextOutgoingMessage(0);
-      message->setTimestamp(0.0); // message is processed at start of the next block
+      // the timestamp must be set before the message is inserted into the ordered queue
+      message->setTimestamp(timestamp);
       graph->scheduleMessage(sendController, receiverNameIndex, message);
       return message;
     }
   } else {
-    return parentGraph->scheduleExternalMessage(receiverName);
+    return parentGraph->scheduleExternalMessage(receiverName, timestamp);
+  }
+}
+
+void PdGraph::registerRemoteMessageReceiver(RemoteMessageReceiver *receiver) {
+  if (isRootGraph()) {
+    sendController->addReceiver(receiver);
+  } else {
+    parentGraph->registerRemoteMessageReceiver(receiver);
+  }
+}
+
+void PdGraph::unregisterRemoteMessageReceiver(RemoteMessageReceiver *receiver) {
+  if (isRootGraph()) {
+    sendController->removeReceiver(receiver);
+  } else {
+    parentGraph->unregisterRemoteMessageReceiver(receiver);
+  }
+}
+
+void PdGraph::registerMidiReceiver(MidiReceiver *receiver) {
+  if (isRootGraph()) {
+    midiController->addReceiver(receiver);
+  } else {
+    parentGraph->registerMidiReceiver(receiver);
+  }
+}
+
+void PdGraph::unregisterMidiReceiver(MidiReceiver *receiver) {
+  if (isRootGraph()) {
+    midiController->removeReceiver(receiver);
+  } else {
+    parentGraph->unregisterMidiReceiver(receiver);
+  }
+}
+
+void PdGraph::scheduleMidiEvents(const ZGMidiEvent *events, int numEvents) {
+  if (isRootGraph()) {
+    midiController->scheduleMidiEvents(events, numEvents);
+  } else {
+    parentGraph->scheduleMidiEvents(events, numEvents);
   }
 }
 
@@ -713,8 +1650,12 @@ void PdGraph::registerDspSend(DspSend *dspSend) {
 }
 
 DspSend *PdGraph::getDspSend(char *name) {
-  for (int i = 0; i < dspSendList->size(); i++) {
-    DspSend *dspSend = (DspSend *) dspSendList->get(i);
+  return findDspSend(dspSendList, name);
+}
+
+DspSend *PdGraph::findDspSend(List *list, char *name) {
+  for (int i = 0; i < list->size(); i++) {
+    DspSend *dspSend = (DspSend *) list->get(i);
     if (strcmp(dspSend->getName(), name) == 0) {
       return dspSend;
     }
@@ -759,18 +1700,22 @@ void PdGraph::registerDelayReceiver(DelayReceiver *delayReceiver) {
 
 DspDelayWrite *PdGraph::getDelayline(char *name) {
   if (isRootGraph()) {
-    for (int i = 0; i < delaylineList->size(); i++) {
-      DspDelayWrite *delayline = (DspDelayWrite *) delaylineList->get(i);
-      if (strcmp(delayline->getName(), name) == 0) {
-        return delayline;
-      }
-    }
-    return NULL;
+    return findDelayline(delaylineList, name);
   } else {
     return parentGraph->getDelayline(name);
   }
 }
 
+DspDelayWrite *PdGraph::findDelayline(List *list, char *name) {
+  for (int i = 0; i < list->size(); i++) {
+    DspDelayWrite *delayline = (DspDelayWrite *) list->get(i);
+    if (strcmp(delayline->getName(), name) == 0) {
+      return delayline;
+    }
+  }
+  return NULL;
+}
+
 void PdGraph::registerDspThrow(DspThrow *dspThrow) {
   if (isRootGraph()) {
     throwList->add(dspThrow);
@@ -803,9 +1748,119 @@ void PdGraph::registerDspCatch(DspCatch *dspCatch) {
   }
 }
 
-DspCatch *PdGraph::getDspCatch(char *name) {
-  for (int i = 0; i < catchList->size(); i++) {
-    DspCatch *dspCatch = (DspCatch *) catchList->get(i);
+void PdGraph::unregisterDspReceive(DspReceive *dspReceive) {
+  if (isRootGraph()) {
+    dspReceiveList->remove(dspReceiveList->indexOf(dspReceive));
+  } else {
+    parentGraph->unregisterDspReceive(dspReceive);
+  }
+}
+
+void PdGraph::unregisterDspSend(DspSend *dspSend) {
+  if (isRootGraph()) {
+    int index = dspSendList->indexOf(dspSend);
+    if (index >= 0) { // duplicate send~s are never registered
+      dspSendList->remove(index);
+      
+      // disconnect associated receive~s from send~
+      for (int i = 0; i < dspReceiveList->size(); i++) {
+        DspReceive *dspReceive = (DspReceive *) dspReceiveList->get(i);
+        if (strcmp(dspReceive->getName(), dspSend->getName()) == 0) {
+          dspReceive->setBuffer(NULL);
+        }
+      }
+    }
+  } else {
+    parentGraph->unregisterDspSend(dspSend);
+  }
+}
+
+void PdGraph::unregisterDelayline(DspDelayWrite *delayline) {
+  if (isRootGraph()) {
+    int index = delaylineList->indexOf(delayline);
+    if (index >= 0) { // duplicate delwrite~s are never registered
+      delaylineList->remove(index);
+      
+      // disconnect all same-named delay receivers from this delayline
+      for (int i = 0; i < delayReceiverList->size(); i++) {
+        DelayReceiver *delayReceiver = (DelayReceiver *) delayReceiverList->get(i);
+        if (strcmp(delayReceiver->getName(), delayline->getName()) == 0) {
+          delayReceiver->setDelayline(NULL);
+        }
+      }
+    }
+  } else {
+    parentGraph->unregisterDelayline(delayline);
+  }
+}
+
+void PdGraph::unregisterDelayReceiver(DelayReceiver *delayReceiver) {
+  if (isRootGraph()) {
+    delayReceiverList->remove(delayReceiverList->indexOf(delayReceiver));
+  } else {
+    parentGraph->unregisterDelayReceiver(delayReceiver);
+  }
+}
+
+void PdGraph::unregisterDspThrow(DspThrow *dspThrow) {
+  if (isRootGraph()) {
+    throwList->remove(throwList->indexOf(dspThrow));
+    
+    DspCatch *dspCatch = getDspCatch(dspThrow->getName());
+    if (dspCatch != NULL) {
+      dspCatch->removeThrow(dspThrow);
+    }
+  } else {
+    parentGraph->unregisterDspThrow(dspThrow);
+  }
+}
+
+void PdGraph::unregisterDspCatch(DspCatch *dspCatch) {
+  if (isRootGraph()) {
+    catchList->remove(catchList->indexOf(dspCatch));
+  } else {
+    parentGraph->unregisterDspCatch(dspCatch);
+  }
+}
+
+void PdGraph::registerTable(DspTable *table) {
+  if (isRootGraph()) {
+    if (tableMap->get(table->getName()) != NULL) {
+      printErr("table with duplicate name \"%s\" already exists.\n", table->getName());
+      return;
+    }
+    tableMap->put(table->getName(), table);
+  } else {
+    parentGraph->registerTable(table);
+  }
+}
+
+void PdGraph::unregisterTable(DspTable *table) {
+  if (isRootGraph()) {
+    // duplicate tables are never registered
+    if (tableMap->get(table->getName()) == table) {
+      tableMap->remove(table->getName());
+    }
+  } else {
+    parentGraph->unregisterTable(table);
+  }
+}
+
+DspTable *PdGraph::getTable(char *name) {
+  if (isRootGraph()) {
+    return (DspTable *) tableMap->get(name);
+  } else {
+    return parentGraph->getTable(name);
+  }
+}
+
+DspCatch *PdGraph::getDspCatch(char *name) {
+  return findDspCatch(catchList, name);
+}
+
+DspCatch *PdGraph::findDspCatch(List *list, char *name) {
+  for (int i = 0; i < list->size(); i++) {
+    DspCatch *dspCatch = (DspCatch *) list->get(i);
     if (strcmp(dspCatch->getName(), name) == 0) {
       return dspCatch;
     }
@@ -821,6 +1876,41 @@ List *PdGraph::getDeclareList() {
   }
 }
 
+char *PdGraph::getDirectory() {
+  return directory;
+}
+
+DiskStreamer *PdGraph::getDiskStreamer() {
+  if (isRootGraph()) {
+    if (diskStreamer == NULL) {
+      diskStreamer = new DiskStreamer();
+    }
+    return diskStreamer;
+  } else {
+    return parentGraph->getDiskStreamer();
+  }
+}
+
+SampleLoader *PdGraph::getSampleLoader() {
+  if (isRootGraph()) {
+    if (sampleLoader == NULL) {
+      sampleLoader = new SampleLoader();
+      getDiskStreamer()->addClient(sampleLoader);
+    }
+    return sampleLoader;
+  } else {
+    return parentGraph->getSampleLoader();
+  }
+}
+
+RandomGenerator *PdGraph::newRandomGenerator() {
+  if (isRootGraph()) {
+    return new RandomGenerator(randomSeed, numRandomGenerators++);
+  } else {
+    return parentGraph->newRandomGenerator();
+  }
+}
+
 void PdGraph::receiveMessage(int inletIndex, PdMessage *message) {
   processMessage(inletIndex, message);
 }
@@ -828,9 +1918,9 @@ void PdGraph::receiveMessage(int inletIndex, PdMessage *message) {
 void PdGraph::receiveSystemMessage(PdMessage *message) {
   // TODO(mhroth): What are all of the possible system messages?
   // probably need to register a callback to the outside world and let the user deal with it
-  char *messageString = message->toString();
+  char messageString[PRINT_RECORD_LENGTH];
+  message->toString(messageString, PRINT_RECORD_LENGTH);
   printStd("SYSTEM: %s\n", messageString);
-  free(messageString);
 }
 
 void PdGraph::processMessage(int inletIndex, PdMessage *message) {
@@ -840,17 +1930,98 @@ void PdGraph::processMessage(int inletIndex, PdMessage *message) {
 }
 
 void PdGraph::process(float *inputBuffers, float *outputBuffers) {
-  // set up adc~ buffers
-  memcpy(globalDspInputBuffers, inputBuffers, numBytesInInputBuffers);
+  if (inputBuffers != NULL) {
+    memcpy(globalDspInputBuffers, inputBuffers, numBytesInInputBuffers);
+  }
+  processBlock();
+  if (outputBuffers != NULL) {
+    memcpy(outputBuffers, globalDspOutputBuffers, numBytesInOutputBuffers);
+  }
+}
+
+// the conversions write straight into the buffers read by adc~, and read straight from those
+// written by dac~, so that there is no copy in addition to the conversion itself
+void PdGraph::processInterleaved(float *inputBuffers, float *outputBuffers) {
+  SampleConversion::deinterleave(inputBuffers, globalDspInputBuffers, numInputChannels, blockSize);
+  processBlock();
+  SampleConversion::interleave(globalDspOutputBuffers, outputBuffers, numOutputChannels, blockSize);
+}
+
+void PdGraph::processShort(short *inputBuffers, short *outputBuffers) {
+  SampleConversion::deinterleaveShort(inputBuffers, globalDspInputBuffers, numInputChannels, blockSize);
+  processBlock();
+  SampleConversion::interleaveShort(globalDspOutputBuffers, outputBuffers, numOutputChannels, blockSize,
+      isDithering ? ditherState : NULL);
+}
+
+void PdGraph::processInt24(int *inputBuffers, int *outputBuffers) {
+  SampleConversion::deinterleaveInt24(inputBuffers, globalDspInputBuffers, numInputChannels, blockSize);
+  processBlock();
+  SampleConversion::interleaveInt24(globalDspOutputBuffers, outputBuffers, numOutputChannels, blockSize,
+      isDithering ? ditherState : NULL);
+}
+
+void PdGraph::processFrames(float *inputBuffers, float *outputBuffers, int numFrames) {
+  if (blockAdapter == NULL) {
+    blockAdapter = new BlockAdapter(this);
+  }
+  blockAdapter->process(inputBuffers, outputBuffers, numFrames);
+}
+
+int PdGraph::getLatency() {
+  return (blockAdapter == NULL) ? 0 : blockAdapter->getLatency();
+}
+
+void PdGraph::setDithering(bool isDithering) {
+  this->isDithering = isDithering;
+}
 
+void PdGraph::processBlock() {
+  unsigned long long blockStartTicks = 0;
+  if (isProfiling) {
+    if (isProfileResetPending) {
+      resetProfile();
+      isProfileResetPending = false;
+    }
+    blockStartTicks = Profiler::getTicks();
+  }
+  
+  // apply any changes to the graph which have been made since the last block
+  applyGraphEdits();
+  
+  // complete any [soundfiler] operations which the disk thread has finished
+  if (sampleLoader != NULL) {
+    sampleLoader->dispatchCompletedRequests();
+  }
+  
   // clear the global output audio buffers so that dac~ nodes can write to it
   memset(globalDspOutputBuffers, 0, numBytesInOutputBuffers);
 
-  // Send all messages for this block
+  // Send all messages for this block, and the lines of all playing [qlist]s in order with them.
+  // Messages are sent first if they are due at the same time as a line.
   MessageDestination *destination = NULL;
-  double nextBlockStartTimestamp = blockStartTimestamp + blockDurationMs;
-  while ((destination = (MessageDestination *) messageCallbackQueue->get(0)) != NULL &&
-      destination->message->getTimestamp() < nextBlockStartTimestamp) {
+  ZGTime nextBlockStartTimestamp = blockStartTimestamp + blockDuration;
+  while (true) {
+    destination = (MessageDestination *) messageCallbackQueue->get(0);
+    ZGTime messageTimestamp = (destination != NULL)
+        ? destination->message->getTimestamp() : nextBlockStartTimestamp;
+    MessageQlist *nextSequence = NULL;
+    ZGTime sequenceTimestamp = nextBlockStartTimestamp;
+    for (int i = 0; i < sequenceList->size(); i++) {
+      MessageQlist *qlist = (MessageQlist *) sequenceList->get(i);
+      ZGTime lineTimestamp = qlist->getNextLineTimestamp();
+      if (lineTimestamp < sequenceTimestamp) {
+        nextSequence = qlist;
+        sequenceTimestamp = lineTimestamp;
+      }
+    }
+    if (nextSequence != NULL && sequenceTimestamp < messageTimestamp) {
+      nextSequence->sendNextLine(); // may start or stop any [qlist]
+      continue;
+    } else if (messageTimestamp >= nextBlockStartTimestamp) {
+      break;
+    }
+    
     messageCallbackQueue->remove(0); // remove the message from the queue
     destination->message->unreserve(destination->object);
     if (destination->message->getTimestamp() < blockStartTimestamp) {
@@ -866,13 +2037,29 @@ void PdGraph::process(float *inputBuffers, float *outputBuffers) {
     destination->object->sendMessage(destination->index, destination->message);
   }
 
-  // execute all audio objects in this graph
-  processDsp();
-
-  // copy the output audio to the given buffer
-  memcpy(outputBuffers, globalDspOutputBuffers, numBytesInOutputBuffers);
+  // execute all audio objects in this graph, or the compiled code which replaces them
+  if (compiledDsp != NULL) {
+    if (isProfiling) {
+      // the objects are not processed on their own, so only the compiled code as a whole is measured
+      unsigned long long startTicks = Profiler::getTicks();
+      compiledDsp->process(globalDspInputBuffers, globalDspOutputBuffers);
+      Profiler::addTicks(&compiledProfileCounter, Profiler::getTicks() - startTicks);
+    } else {
+      compiledDsp->process(globalDspInputBuffers, globalDspOutputBuffers);
+    }
+  } else {
+    processDsp();
+  }
 
   blockStartTimestamp = nextBlockStartTimestamp;
+  
+  if (isProfiling) {
+    unsigned long long blockTicks = Profiler::getTicks() - blockStartTicks;
+    Profiler::addTicks(&blockProfileCounter, blockTicks);
+    int histogramIndex = Profiler::getHistogramIndex(
+        blockTicks * Profiler::getNanosecondsPerTick(), ZG_PROFILE_HISTOGRAM_LENGTH);
+    blockTimeHistogram[histogramIndex]++;
+  }
 }
 
 void PdGraph::processDspToIndex(float blockIndex) {
@@ -880,18 +2067,67 @@ void PdGraph::processDspToIndex(float blockIndex) {
   // processDsp() can sum all incoming audio signals
   if (switched) {
     // DSP processing elements are only executed if the graph is switched on
-    int numNodes = dspNodeList->size();
+    // execute all nodes which process audio, with chains of elementwise objects fused
+    int numNodes = dspProcessList->size();
     DspObject *dspObject = NULL;
     //for (int i = 0; i < 1; i++) { // TODO(mhroth): iterate depending on local blocksize relative to parent
-      // execute all nodes which process audio
-      for (int j = 0; j < numNodes; j++) {
-        dspObject = (DspObject *) dspNodeList->get(j);
-        dspObject->processDsp();
+      if (isProfiling) {
+        // measure how long each one takes. A fused chain is measured as a whole.
+        for (int j = 0; j < numNodes; j++) {
+          dspObject = (DspObject *) dspProcessList->get(j);
+          unsigned long long startTicks = Profiler::getTicks();
+          dspObject->processDsp();
+          Profiler::addTicks(dspObject->getProfileCounter(), Profiler::getTicks() - startTicks);
+        }
+      } else {
+        for (int j = 0; j < numNodes; j++) {
+          dspObject = (DspObject *) dspProcessList->get(j);
+          dspObject->processDsp();
+        }
       }
     //}
   }
 }
 
+bool PdGraph::generateCode(CodeGenerator *codeGenerator) {
+  for (int i = 0; i < nodeList->size(); i++) {
+    MessageObject *messageObject = (MessageObject *) nodeList->get(i);
+    if (strcmp(messageObject->getObjectLabel(), "switch~") == 0) {
+      printErr("[switch~] cannot be compiled.");
+      return false;
+    }
+  }
+  
+  // the inlet~ objects pass on the signals arriving at the inlets of this graph
+  for (int i = 0; i < inletList->size(); i++) {
+    MessageObject *messageObject = (MessageObject *) inletList->get(i);
+    if (strcmp(messageObject->getObjectLabel(), "inlet~") == 0) {
+      codeGenerator->setOutputBuffer((DspObject *) messageObject, 0,
+          codeGenerator->getInputBuffer(this, i));
+    }
+  }
+  
+  for (int i = 0; i < dspNodeList->size(); i++) {
+    if (!codeGenerator->generateObject((DspObject *) dspNodeList->get(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PdGraph::loadCompiledDsp(const char *libraryPath) {
+  if (!isRootGraph()) {
+    return false;
+  }
+  CompiledDsp *newCompiledDsp = CompiledDsp::newInstance(libraryPath, this);
+  if (newCompiledDsp == NULL) {
+    return false;
+  }
+  delete compiledDsp;
+  compiledDsp = newCompiledDsp;
+  return true;
+}
+
 void PdGraph::computeDspProcessOrder() {
 
   /* clear/reset dspNodeList
@@ -906,58 +2142,387 @@ void PdGraph::computeDspProcessOrder() {
    */
 
   // compute process order for local graph
+  dspNodeList->clear(); // reset the dsp node list
+  orderDspObjects(dspNodeList);
 
-  // generate the leafnode list
-  List *leafNodeList = new List();
-  MessageObject *object = NULL;
-  for (int i = 0; i < nodeList->size(); i++) {
-    object = (MessageObject *) nodeList->get(i);
-    // TODO(mhroth): clear ordered flag
-    // generate leaf node list
-    if (object->isLeafNode()) { // isLeafNode() takes into account send/~ and throw~ objects
-      leafNodeList->add(object);
+  if (dspNodeList->size() > 0) {
+    // print dsp evaluation order for debugging, but only if there are any nodes to list
+    printStd("--- ordered evaluation list ---\n");
+    for (int i = 0; i < dspNodeList->size(); i++) {
+      MessageObject *messageObject = (MessageObject *) dspNodeList->get(i);
+      printStd("%s\n", messageObject->getObjectLabel());
     }
   }
+  
+  // chains which are still the same are kept, the others are deleted
+  List *reusableChainList = (new List())->add(fusedChainList);
+  fusedChainList->clear();
+  dspProcessList->clear();
+  fuseDspChains(dspNodeList, reusableChainList, dspProcessList, fusedChainList);
+  for (int i = 0; i < reusableChainList->size(); i++) {
+    if (!fusedChainList->exists(reusableChainList->get(i))) {
+      delete (DspFusedChain *) reusableChainList->get(i);
+    }
+  }
+  delete reusableChainList;
+}
 
+void PdGraph::orderDspObjects(List *orderList) {
+  // the order is that of the graph once all queued edits have been applied
+  List *plannedNodeList = getPlannedList(&nodeList);
+  for (int i = 0; i < plannedNodeList->size(); i++) {
+    // clear the ordered flag, in case the order is being recomputed
+    ((MessageObject *) plannedNodeList->get(i))->setOrderedFlag(false);
+  }
+  
   // for all leaf nodes, order the tree
   List *processList = new List();
-  for (int i = 0; i < leafNodeList->size(); i++) {
-    object = (MessageObject *) leafNodeList->get(i);
-    List *processSubList = object->getProcessOrder();
-    processList->add(processSubList);
-    delete processSubList;
+  for (int i = 0; i < plannedNodeList->size(); i++) {
+    MessageObject *object = (MessageObject *) plannedNodeList->get(i);
+    if (isPlannedLeaf(object)) {
+      orderObject(object, processList);
+    }
   }
-
-  delete leafNodeList;
-
+  
   // add only those nodes which process audio to the final list
-  dspNodeList->clear(); // reset the dsp node list
   for (int i = 0; i < processList->size(); i++) {
-    // reverse order of process list such that the dsp elements at the top of the graph are processed first
-    object = (MessageObject *) processList->get(i);
+    MessageObject *object = (MessageObject *) processList->get(i);
     if (object->doesProcessAudio()) {
-      dspNodeList->add(object);
+      orderList->add(object);
     }
   }
-
   delete processList;
+}
 
-  if (dspNodeList->size() > 0) {
-    // print dsp evaluation order for debugging, but only if there are any nodes to list
-    printStd("--- ordered evaluation list ---\n");
-    for (int i = 0; i < dspNodeList->size(); i++) {
-      MessageObject *messageObject = (MessageObject *) dspNodeList->get(i);
-      printStd("%s\n", messageObject->getObjectLabel());
+void PdGraph::orderObject(MessageObject *object, List *processList) {
+  if (object->isOrderedFlagSet()) {
+    return; // if this object has already been ordered, then move on
+  }
+  object->setOrderedFlag(true);
+  // every object follows those which send messages to it, and then those which send signals to it
+  ConnectionType types[] = {MESSAGE, DSP};
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < object->getNumInlets(); j++) {
+      List **slot = object->getIncomingConnectionsSlot(types[i], j);
+      if (slot == NULL) {
+        continue;
+      }
+      List *connectionList = getPlannedList(slot);
+      for (int k = 0; k < connectionList->size(); k++) {
+        orderObject(((ObjectLetPair *) connectionList->get(k))->object, processList);
+      }
+    }
+  }
+  processList->add(object);
+}
+
+bool PdGraph::isPlannedLeaf(MessageObject *messageObject) {
+  ConnectionType types[] = {MESSAGE, DSP};
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < messageObject->getNumOutlets(); j++) {
+      List **slot = messageObject->getOutgoingConnectionsSlot(types[i], j);
+      if (slot != NULL && getPlannedList(slot)->size() > 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void PdGraph::fuseDspChains(List *orderList, List *reusableChainList, List *processList, List *chainList) {
+  // Collect the chains in process order. An object continues the chain of the object feeding its
+  // left inlet, which has been processed (and so assigned to a chain) before it.
+  List *objectListList = new List(); // a List of Lists of DspObjects
+  for (int i = 0; i < orderList->size(); i++) {
+    DspObject *dspObject = (DspObject *) orderList->get(i);
+    if (dspObject->getNumDspInlets() == 0) {
+      continue;
+    }
+    List *connectionList = getPlannedList(dspObject->getIncomingConnectionsSlot(DSP, 0));
+    if (connectionList->size() != 1) {
+      continue;
+    }
+    DspObject *fromObject = (DspObject *) ((ObjectLetPair *) connectionList->get(0))->object;
+    if (DspFusedChain::canFuse(fromObject, dspObject, this)) {
+      List *objectList = NULL;
+      for (int j = 0; j < objectListList->size(); j++) {
+        List *list = (List *) objectListList->get(j);
+        if (list->get(list->size()-1) == fromObject) {
+          objectList = list;
+          break;
+        }
+      }
+      if (objectList == NULL) {
+        objectList = new List();
+        objectList->add(fromObject);
+        objectListList->add((void *) objectList);
+      }
+      objectList->add(dspObject);
+    }
+  }
+  for (int i = 0; i < objectListList->size(); i++) {
+    List *objectList = (List *) objectListList->get(i);
+    DspFusedChain *fusedChain = NULL;
+    for (int j = 0; j < reusableChainList->size(); j++) {
+      if (((DspFusedChain *) reusableChainList->get(j))->isChainOf(objectList)) {
+        fusedChain = (DspFusedChain *) reusableChainList->get(j);
+        break;
+      }
+    }
+    chainList->add((fusedChain != NULL) ? fusedChain : new DspFusedChain(objectList, this));
+    delete objectList;
+  }
+  delete objectListList;
+  
+  // A chain is processed in place of its last object. All signals arriving at the chain are then
+  // ready, and the objects depending on its output still follow.
+  for (int i = 0; i < orderList->size(); i++) {
+    DspObject *dspObject = (DspObject *) orderList->get(i);
+    DspFusedChain *fusedChain = NULL;
+    for (int j = 0; j < chainList->size(); j++) {
+      if (((DspFusedChain *) chainList->get(j))->contains(dspObject)) {
+        fusedChain = (DspFusedChain *) chainList->get(j);
+        break;
+      }
+    }
+    if (fusedChain == NULL) {
+      processList->add(dspObject);
+    } else if (fusedChain->getLastObject() == dspObject) {
+      processList->add(fusedChain);
+    }
+  }
+}
+
+int PdGraph::prune() {
+  int numPrunedObjects = 0;
+  for (int i = 0; i < nodeList->size(); i++) {
+    MessageObject *messageObject = (MessageObject *) nodeList->get(i);
+    if (strcmp(messageObject->getObjectLabel(), "pd") == 0) {
+      numPrunedObjects += ((PdGraph *) messageObject)->prune();
+    }
+  }
+  
+  // removing an object may leave the objects feeding it without any use. Repeat until none remain.
+  bool didPrune = true;
+  while (didPrune) {
+    didPrune = false;
+    for (int i = nodeList->size()-1; i >= 0; i--) {
+      MessageObject *messageObject = (MessageObject *) nodeList->get(i);
+      if (isPrunable(messageObject)) {
+        removeObject(messageObject);
+        delete messageObject;
+        numPrunedObjects++;
+        didPrune = true;
+      }
+    }
+  }
+  
+  computeDspProcessOrder();
+  return numPrunedObjects;
+}
+
+bool PdGraph::isPrunable(MessageObject *messageObject) {
+  const char *objectLabel = messageObject->getObjectLabel();
+  if (strcmp(objectLabel, "text") == 0) {
+    return true; // comments
+  } else if (!messageObject->isLeafNode()) {
+    return false; // the output of the object is used
+  } else if (strcmp(objectLabel, "float") == 0 ||
+             strcmp(objectLabel, "symbol") == 0 ||
+             strcmp(objectLabel, "bang") == 0 ||
+             strcmp(objectLabel, "toggle") == 0) {
+    return true; // GUI objects (and their equivalents) which only display what they receive
+  } else if (strcmp(objectLabel, "pd") == 0) {
+    // the subgraph has already been pruned. Whatever remains other than its inlets and outlets
+    // has an effect of its own.
+    PdGraph *graph = (PdGraph *) messageObject;
+    for (int i = 0; i < graph->nodeList->size(); i++) {
+      const char *label = ((MessageObject *) graph->nodeList->get(i))->getObjectLabel();
+      if (strcmp(label, "inlet") != 0 && strcmp(label, "inlet~") != 0 &&
+          strcmp(label, "outlet") != 0 && strcmp(label, "outlet~") != 0) {
+        return false;
+      }
+    }
+    return true;
+  } else {
+    // audio objects which have no effect other than through their outlets
+    return (strcmp(objectLabel, "+~") == 0 ||
+            strcmp(objectLabel, "-~") == 0 ||
+            strcmp(objectLabel, "*~") == 0 ||
+            strcmp(objectLabel, "/~") == 0 ||
+            strcmp(objectLabel, "adc~") == 0 ||
+            strcmp(objectLabel, "bang~") == 0 ||
+            strcmp(objectLabel, "bp~") == 0 ||
+            strcmp(objectLabel, "clip~") == 0 ||
+            strcmp(objectLabel, "cos~") == 0 ||
+            strcmp(objectLabel, "delread~") == 0 ||
+            strcmp(objectLabel, "env~") == 0 ||
+            strcmp(objectLabel, "hip~") == 0 ||
+            strcmp(objectLabel, "line~") == 0 ||
+            strcmp(objectLabel, "log~") == 0 ||
+            strcmp(objectLabel, "lop~") == 0 ||
+            strcmp(objectLabel, "noise~") == 0 ||
+            strcmp(objectLabel, "osc~") == 0 ||
+            strcmp(objectLabel, "phasor~") == 0 ||
+            strcmp(objectLabel, "receive~") == 0 ||
+            strcmp(objectLabel, "sig~") == 0 ||
+            strcmp(objectLabel, "snapshot~") == 0 ||
+            strcmp(objectLabel, "tabosc4~") == 0 ||
+            strcmp(objectLabel, "tabread~") == 0 ||
+            strcmp(objectLabel, "tabread4~") == 0 ||
+            strcmp(objectLabel, "threshold~") == 0 ||
+            strcmp(objectLabel, "vd~") == 0 ||
+            strcmp(objectLabel, "vline~") == 0 ||
+            strcmp(objectLabel, "vsnapshot~") == 0 ||
+            strcmp(objectLabel, "wrap~") == 0);
+  }
+}
+
+void PdGraph::setProfiling(bool profiling) {
+  if (profiling) {
+    // calibrate the tick counter now, such that it is not done on the audio thread
+    Profiler::getNanosecondsPerTick();
+    isProfileResetPending = true;
+  }
+  isProfiling = profiling;
+  for (int i = 0; i < nodeList->size(); i++) {
+    MessageObject *messageObject = (MessageObject *) nodeList->get(i);
+    if (strcmp(messageObject->getObjectLabel(), "pd") == 0) {
+      ((PdGraph *) messageObject)->setProfiling(profiling);
+    }
+  }
+}
+
+void PdGraph::resetProfile() {
+  Profiler::resetCounter(&blockProfileCounter);
+  Profiler::resetCounter(&compiledProfileCounter);
+  memset(blockTimeHistogram, 0, sizeof(blockTimeHistogram));
+  for (int i = 0; i < dspProcessList->size(); i++) {
+    DspObject *dspObject = (DspObject *) dspProcessList->get(i);
+    Profiler::resetCounter(dspObject->getProfileCounter());
+    if (strcmp(dspObject->getObjectLabel(), "pd") == 0) {
+      ((PdGraph *) dspObject)->resetProfile();
     }
   }
 }
 
+int PdGraph::getNumProfiledObjects() {
+  int numObjects = (compiledProfileCounter.numCalls > 0) ? 1 : 0;
+  for (int i = 0; i < dspProcessList->size(); i++) {
+    DspObject *dspObject = (DspObject *) dspProcessList->get(i);
+    numObjects++;
+    if (strcmp(dspObject->getObjectLabel(), "pd") == 0) {
+      numObjects += ((PdGraph *) dspObject)->getNumProfiledObjects();
+    } else if (strcmp(dspObject->getObjectLabel(), "fused~") == 0) {
+      numObjects += ((DspFusedChain *) dspObject)->getNumObjects();
+    }
+  }
+  return numObjects;
+}
+
+int PdGraph::fillObjectProfiles(ZGObjectProfile *objectProfiles, int index, int depth, double nsPerTick) {
+  if (compiledProfileCounter.numCalls > 0) {
+    ZGObjectProfile *objectProfile = objectProfiles + index++;
+    objectProfile->label = "compiled~";
+    objectProfile->depth = depth;
+    objectProfile->numCalls = compiledProfileCounter.numCalls;
+    objectProfile->totalNs = compiledProfileCounter.totalTicks * nsPerTick;
+    objectProfile->maxNs = compiledProfileCounter.maxTicks * nsPerTick;
+  }
+  for (int i = 0; i < dspProcessList->size(); i++) {
+    DspObject *dspObject = (DspObject *) dspProcessList->get(i);
+    ProfileCounter *counter = dspObject->getProfileCounter();
+    ZGObjectProfile *objectProfile = objectProfiles + index++;
+    objectProfile->label = dspObject->getObjectLabel();
+    objectProfile->depth = depth;
+    objectProfile->numCalls = counter->numCalls;
+    objectProfile->totalNs = counter->totalTicks * nsPerTick;
+    objectProfile->maxNs = counter->maxTicks * nsPerTick;
+    if (strcmp(dspObject->getObjectLabel(), "pd") == 0) {
+      // the contents of a subgraph directly follow it
+      index = ((PdGraph *) dspObject)->fillObjectProfiles(objectProfiles, index, depth+1, nsPerTick);
+    } else if (strcmp(dspObject->getObjectLabel(), "fused~") == 0) {
+      // so do the objects of a chain, whose time is only known for the chain as a whole
+      DspFusedChain *fusedChain = (DspFusedChain *) dspObject;
+      for (int j = 0; j < fusedChain->getNumObjects(); j++) {
+        objectProfile = objectProfiles + index++;
+        objectProfile->label = fusedChain->getObject(j)->getObjectLabel();
+        objectProfile->depth = depth+1;
+        objectProfile->numCalls = 0;
+        objectProfile->totalNs = 0.0;
+        objectProfile->maxNs = 0.0;
+      }
+    }
+  }
+  return index;
+}
+
+ZGProfile *PdGraph::getProfile() {
+  double nsPerTick = Profiler::getNanosecondsPerTick();
+  ZGProfile *profile = (ZGProfile *) malloc(sizeof(ZGProfile));
+  profile->numBlocks = blockProfileCounter.numCalls;
+  profile->totalBlockNs = blockProfileCounter.totalTicks * nsPerTick;
+  profile->maxBlockNs = blockProfileCounter.maxTicks * nsPerTick;
+  memcpy(profile->blockHistogram, blockTimeHistogram, sizeof(blockTimeHistogram));
+  profile->numObjects = getNumProfiledObjects();
+  profile->objects = (ZGObjectProfile *) malloc(profile->numObjects * sizeof(ZGObjectProfile));
+  fillObjectProfiles(profile->objects, 0, 0, nsPerTick);
+  return profile;
+}
+
+void PdGraph::deleteProfile(ZGProfile *profile) {
+  if (profile != NULL) {
+    free(profile->objects);
+    free(profile);
+  }
+}
+
+void PdGraph::printProfile() {
+  ZGProfile *profile = getProfile();
+  printStd("--- dsp profile: %u blocks ---\n", profile->numBlocks);
+  if (profile->numBlocks > 0) {
+    printStd("block: mean %.3fus, max %.3fus\n",
+        profile->totalBlockNs / profile->numBlocks / 1000.0, profile->maxBlockNs / 1000.0);
+    for (int i = 0; i < ZG_PROFILE_HISTOGRAM_LENGTH; i++) {
+      if (profile->blockHistogram[i] > 0) {
+        printStd("  [%.3fus, %.3fus): %u\n", (double) (1ULL << i) / 1000.0,
+            (double) (1ULL << (i+1)) / 1000.0, profile->blockHistogram[i]);
+      }
+    }
+  }
+  for (int i = 0; i < profile->numObjects; i++) {
+    ZGObjectProfile *objectProfile = profile->objects + i;
+    if (objectProfile->numCalls == 0) {
+      // e.g. the objects of a fused chain, or those replaced by compiled code
+      printStd("%*s%s: not measured\n", 2 * objectProfile->depth, "", objectProfile->label);
+      continue;
+    }
+    double meanNs = (objectProfile->numCalls > 0) ? objectProfile->totalNs / objectProfile->numCalls : 0.0;
+    double percentOfTotal = (profile->totalBlockNs > 0.0) ? 100.0 * objectProfile->totalNs / profile->totalBlockNs : 0.0;
+    printStd("%*s%s: mean %.3fus, max %.3fus, %.1f%%\n", 2 * objectProfile->depth, "",
+        objectProfile->label, meanNs / 1000.0, objectProfile->maxNs / 1000.0, percentOfTotal);
+  }
+  deleteProfile(profile);
+}
+
 ConnectionType PdGraph::getConnectionType(int outletIndex) {
   // return the connection type depending on the type of outlet object
   MessageObject *messageObject = (MessageObject *) outletList->get(outletIndex);
   return messageObject->getConnectionType(0);
 }
 
+int PdGraph::getNumInlets() {
+  return inletList->size();
+}
+
+int PdGraph::getNumOutlets() {
+  return outletList->size();
+}
+
+void PdGraph::setDspBufferAtInlet(int inletIndex, float *buffer) {
+  localDspBufferAtInlet[inletIndex] = buffer;
+}
+
 bool PdGraph::doesProcessAudio() {
   // This graph processes audio if it contains any nodes which process audio.
   // This works because graph objects are only created after they have been filled with objects.
@@ -981,7 +2546,22 @@ void PdGraph::setSwitch(bool switched) {
 }
 
 bool PdGraph::isSwitchedOn() {
-  return switched;
+  return switched && (parentGraph == NULL || parentGraph->isSwitchedOn());
+}
+
+void PdGraph::setSleeping(bool sleeping) {
+  this->sleeping = sleeping;
+}
+
+bool PdGraph::isSleeping() {
+  return sleeping;
+}
+
+void PdGraph::wake() {
+  sleeping = false;
+  if (parentGraph != NULL) {
+    parentGraph->wake();
+  }
 }
 
 bool PdGraph::isRootGraph() {
@@ -994,45 +2574,150 @@ void PdGraph::registerCallback(void (*function)(ZGCallbackFunction, void *, void
 }
 
 void PdGraph::printErr(char *msg) {
-  if (isRootGraph()) {
-    if (callbackFunction != NULL) {
-      callbackFunction(ZG_PRINT_ERR, callbackUserData, msg);
-    }
-  } else {
-    parentGraph->printErr(msg);
-  }
+  printErr("%s", msg);
 }
 
 void PdGraph::printErr(const char *msg, ...) {
-  int maxStringLength = 1024;
-  char stringBuffer[maxStringLength];
   va_list ap;
   va_start(ap, msg);
-  vsnprintf(stringBuffer, maxStringLength-1, msg, ap);
+  print(ZG_PRINT_ERR, msg, ap);
   va_end(ap);
-  
-  printErr(stringBuffer);
 }
 
 void PdGraph::printStd(char *msg) {
-  if (isRootGraph()) {
-    if (callbackFunction != NULL) {
-      callbackFunction(ZG_PRINT_STD, callbackUserData, msg);
-    }
-  } else {
-    parentGraph->printStd(msg);
-  }
+  printStd("%s", msg);
 }
 
 void PdGraph::printStd(const char *msg, ...) {
-  int maxStringLength = 1024;
-  char stringBuffer[maxStringLength];
   va_list ap;
   va_start(ap, msg);
-  vsnprintf(stringBuffer, maxStringLength-1, msg, ap);
+  print(ZG_PRINT_STD, msg, ap);
   va_end(ap);
+}
+
+void PdGraph::print(ZGCallbackFunction function, const char *msg, va_list ap) {
+  if (isRootGraph()) {
+    if (eventQueue != NULL) {
+      eventQueue->print(function, msg, ap);
+    } else if (callbackFunction != NULL) {
+      char stringBuffer[PRINT_RECORD_LENGTH];
+      vsnprintf(stringBuffer, PRINT_RECORD_LENGTH, msg, ap);
+      callbackFunction(function, callbackUserData, stringBuffer);
+    }
+  } else {
+    parentGraph->print(function, msg, ap);
+  }
+}
+
+void PdGraph::setEventDelivery(ZGEventDelivery delivery) {
+  if (delivery == eventDelivery) {
+    return;
+  }
+  if (eventQueue != NULL) {
+    // deliver what remains before changing over. This also stops any delivery thread.
+    EventQueue *queue = eventQueue;
+    eventQueue = NULL;
+    if (eventDelivery != ZG_DELIVER_ON_THREAD) {
+      queue->deliver(callbackFunction, callbackUserData);
+    }
+    delete queue;
+  }
+  if (delivery != ZG_DELIVER_IMMEDIATELY) {
+    eventQueue = new EventQueue(EVENT_QUEUE_CAPACITY);
+    if (delivery == ZG_DELIVER_ON_THREAD) {
+      eventQueue->startDeliveryThread(callbackFunction, callbackUserData);
+    }
+  }
+  eventDelivery = delivery;
+}
+
+void PdGraph::sendMessageToHost(const char *receiverName, PdMessage *message) {
+  if (isRootGraph()) {
+    if (eventQueue != NULL) {
+      eventQueue->sendMessage(receiverName, timeToMilliseconds(message->getTimestamp()), message);
+    } else if (callbackFunction != NULL) {
+      // the message is passed on directly. Symbols are not copied.
+      int numElements = message->getNumElements();
+      ZGAtom atoms[numElements];
+      int numAtoms = 0;
+      for (int i = 0; i < numElements; i++) {
+        switch (message->getType(i)) {
+          case FLOAT: {
+            atoms[numAtoms].type = ZG_ATOM_FLOAT;
+            atoms[numAtoms++].f = message->getFloat(i);
+            break;
+          }
+          case SYMBOL: {
+            atoms[numAtoms].type = ZG_ATOM_SYMBOL;
+            atoms[numAtoms++].s = message->getSymbol(i);
+            break;
+          }
+          case BANG: {
+            atoms[numAtoms++].type = ZG_ATOM_BANG;
+            break;
+          }
+          default: {
+            break; // other types are not passed to the host
+          }
+        }
+      }
+      ZGReceivedMessage receivedMessage;
+      receivedMessage.receiverName = receiverName;
+      receivedMessage.timestamp = timeToMilliseconds(message->getTimestamp());
+      receivedMessage.numAtoms = numAtoms;
+      receivedMessage.atoms = atoms;
+      callbackFunction(ZG_RECEIVER_MESSAGE, callbackUserData, &receivedMessage);
+    }
+  } else {
+    parentGraph->sendMessageToHost(receiverName, message);
+  }
+}
+
+bool PdGraph::registerHostReceiver(char *receiverName) {
+  if (!isRootGraph()) {
+    return parentGraph->registerHostReceiver(receiverName);
+  }
+  releaseCompletedGraphEdits();
+  for (int i = 0; i < hostReceiverList->size(); i++) {
+    if (strcmp(((HostMessageReceiver *) hostReceiverList->get(i))->getName(), receiverName) == 0) {
+      return true; // the name is already registered
+    }
+  }
+  HostMessageReceiver *receiver = new HostMessageReceiver(receiverName, this);
+  if (!queueAddObject(receiver)) {
+    delete receiver;
+    return false;
+  }
+  hostReceiverList->add(receiver);
+  return true;
+}
+
+void PdGraph::unregisterHostReceiver(char *receiverName) {
+  if (!isRootGraph()) {
+    parentGraph->unregisterHostReceiver(receiverName);
+    return;
+  }
+  for (int i = 0; i < hostReceiverList->size(); i++) {
+    HostMessageReceiver *receiver = (HostMessageReceiver *) hostReceiverList->get(i);
+    if (strcmp(receiver->getName(), receiverName) == 0) {
+      if (queueRemoveObject(receiver)) {
+        hostReceiverList->remove(i);
+      }
+      return;
+    }
+  }
+}
+
+int PdGraph::pollEvents() {
+  if (eventDelivery == ZG_DELIVER_ON_POLL) {
+    return eventQueue->deliver(callbackFunction, callbackUserData);
+  } else {
+    return 0;
+  }
+}
 
-  printStd(stringBuffer);
+unsigned int PdGraph::getNumDroppedEvents() {
+  return (eventQueue != NULL) ? eventQueue->getNumDroppedEvents() : 0;
 }
 
 PdMessage *PdGraph::getArguments() {
@@ -25,26 +25,56 @@
 
 #include <stdio.h>
 #include "DspObject.h"
+#include "GraphEdit.h"
+#include "LockFreeQueue.h"
 #include "OrderedMessageQueue.h"
 #include "PdFileParser.h"
+#include "SampleConversion.h"
 #include "ZGCallbackFunction.h"
+#include "ZGMidiEvent.h"
+#include "ZGProfile.h"
 
+class BlockAdapter;
+class CompiledDsp;
 class DelayReceiver;
+class DiskStreamer;
 class DspCatch;
 class DspDelayWrite;
+class DspFusedChain;
 class DspReceive;
 class DspSend;
+class DspTable;
 class DspThrow;
+class HashTable;
 class MessageObject;
+class MessageQlist;
 class MessageReceive;
 class MessageSend;
+class MessageMidiController;
 class MessageSendController;
+class MidiReceiver;
+class EventQueue;
+class RandomGenerator;
+class SampleLoader;
+class RemoteMessageReceiver;
 
 class PdGraph : public DspObject {
   
   public:
+    /** The maximum number of inlets and of outlets of a graph. */
+    static const int MAX_NUM_LETS = 16;
+  
     static PdGraph *newInstance(char *directory, char *filename, int blockSize,
-        int numInputChannels, int numOutputChannels, float sampleRate, PdGraph *parentGraph);
+        int numInputChannels, int numOutputChannels, float sampleRate, PdGraph *parentGraph,
+        PdMessage *arguments = NULL);
+  
+    /**
+     * Creates a graph from an already parsed file, starting at its first message. The
+     * <code>arguments</code> define $1, $2, etc. and may be <code>NULL</code>.
+     */
+    static PdGraph *newInstance(PdFileParser *fileParser, char *directory, int blockSize,
+        int numInputChannels, int numOutputChannels, float sampleRate, PdGraph *parentGraph,
+        PdMessage *arguments);
     ~PdGraph();
   
     /**
@@ -62,6 +92,15 @@ class PdGraph : public DspObject {
     /** Cancel a scheduled <code>PdMessage</code> according to its id. */
     void cancelMessage(MessageObject *messageObject, int outletIndex, PdMessage *message);
   
+    /**
+     * Starts sending the lines of the given [qlist] in order with the scheduled messages, at the
+     * times given by <code>MessageQlist::getNextLineTimestamp()</code>, until it is cancelled.
+     */
+    void scheduleSequence(MessageQlist *qlist);
+  
+    /** Stops sending the lines of the given [qlist]. Does nothing if it is not playing. */
+    void cancelSequence(MessageQlist *qlist);
+  
     /* 
      * Messages arriving at <code>PdGraph</code>s are processed immediately (passed on to inlet
      * objects, unlike with super-<code>DspObject</code> objects.
@@ -75,21 +114,85 @@ class PdGraph : public DspObject {
     
     /* This functions implements the sub-graph's audio loop. */
     void processDspToIndex(float blockIndex);
+  
+    /** Writes the code of all audio objects of this graph, in process order. */
+    bool generateCode(CodeGenerator *codeGenerator);
+  
+    /**
+     * Replaces the processing of all audio objects of this graph with the compiled code in the
+     * given library, which must have been built from the output of <code>CodeGenerator</code> for
+     * this graph. Messages are still processed by the graph. Returns <code>false</code> if the
+     * library cannot be used. Only applies to the root graph.
+     */
+    bool loadCompiledDsp(const char *libraryPath);
     
-    /**  */
+    /**
+     * Processes one block. The buffers contain the non-interleaved float samples of each channel.
+     * Either buffer may be <code>NULL</code>, in which case the host is expected to have written the
+     * input to, or to read the output from, the global buffers of the graph directly.
+     */
     void process(float *inputBuffers, float *outputBuffers);
   
+    /** Processes one block of interleaved float frames. */
+    void processInterleaved(float *inputBuffers, float *outputBuffers);
+  
+    /** Processes one block of interleaved 16-bit frames. */
+    void processShort(short *inputBuffers, short *outputBuffers);
+  
+    /** Processes one block of interleaved 24-bit frames, each held in the low bytes of an <code>int</code>. */
+    void processInt24(int *inputBuffers, int *outputBuffers);
+  
+    /**
+     * Processes any number of non-interleaved float frames, running as many blocks as are needed.
+     * See <code>BlockAdapter</code>.
+     */
+    void processFrames(float *inputBuffers, float *outputBuffers, int numFrames);
+  
+    /** Returns the number of frames by which <code>processFrames()</code> delays the output. */
+    int getLatency();
+  
+    /** Turns TPDF dithering of 16-bit and 24-bit output on or off. It is off by default. */
+    void setDithering(bool isDithering);
+  
     const char *getObjectLabel();
   
     ConnectionType getConnectionType(int outletIndex);
   
+    /** Returns the number of inlet and inlet~ objects in this graph. */
+    int getNumInlets();
+  
+    /** Returns the number of outlet and outlet~ objects in this graph. */
+    int getNumOutlets();
+  
+    /**
+     * Sets the buffer read by the inlet~ at the given inlet. This is used by containers such as
+     * [clone] which process graphs that are not connected to any other objects.
+     */
+    void setDspBufferAtInlet(int inletIndex, float *buffer);
+  
     bool doesProcessAudio();
     
     /** Turn the audio processing of this graph on or off. */
     void setSwitch(bool switched);
   
-    /** Returns <code>true</code> if the audio processing of this graph is turned on. <code>false</code> otherwise. */
+    /**
+     * Returns <code>true</code> if the audio processing of this graph and of all of its parents is
+     * turned on. <code>false</code> otherwise.
+     */
     bool isSwitchedOn();
+  
+    /**
+     * Puts this graph to sleep, or wakes it. Containers such as [clone] do not process the audio of
+     * a sleeping graph. Unlike a graph which is switched off, it still receives messages, and the
+     * first message which arrives at one of its audio objects, or those of its subgraphs, wakes it.
+     */
+    void setSleeping(bool sleeping);
+  
+    /** Returns <code>true</code> if this graph is asleep. */
+    bool isSleeping();
+  
+    /** Wakes this graph and all of its parents, if they are asleep. */
+    void wake();
     
     /** Set the current block size of this subgraph. */
     void setBlockSize(int blockSize);
@@ -107,6 +210,33 @@ class PdGraph : public DspObject {
     /** Prints the given message to standard output. */
     void printStd(char *msg);
     void printStd(const char *msg, ...);
+  
+    /**
+     * Sets how printed messages and messages to receivers registered by the host are delivered to
+     * the callback function. Must not be called while the graph is being processed.
+     */
+    void setEventDelivery(ZGEventDelivery delivery);
+  
+    /**
+     * Delivers all queued events to the callback function, if delivery is
+     * <code>ZG_DELIVER_ON_POLL</code>. Returns the number of delivered events.
+     */
+    int pollEvents();
+  
+    /** Returns the number of events for the host which have been dropped because the queue was full. */
+    unsigned int getNumDroppedEvents();
+  
+    /** Passes a message sent to a receiver registered by the host to the callback function, or queues it. */
+    void sendMessageToHost(const char *receiverName, PdMessage *message);
+  
+    /**
+     * Registers interest of the host in messages sent to the given name, from the beginning of the
+     * next block. Returns <code>false</code> if that is not possible.
+     */
+    bool registerHostReceiver(char *receiverName);
+  
+    /** Removes a receiver registered by the host at the beginning of the next block. */
+    void unregisterHostReceiver(char *receiverName);
     
     /** Get the argument list in the form of a <code>PdMessage</code> from the graph. */
     PdMessage *getArguments();
@@ -114,17 +244,23 @@ class PdGraph : public DspObject {
     /** Returns the global sample rate. */
     float getSampleRate();
   
-    /** Returns the global dsp buffer at the given inlet. Exclusively used by <code>DspAdc</code>. */
+    /** Returns the global dsp buffer at the given inlet. Used by <code>DspAdc</code>, and by hosts processing in place. */
     float *getGlobalDspBufferAtInlet(int inletIndex);
   
-    /** Returns the global dsp buffer at the given outlet. Exclusively used by <code>DspDac</code>. */
+    /** Returns the global dsp buffer at the given outlet. Used by <code>DspDac</code>, and by hosts processing in place. */
     float *getGlobalDspBufferAtOutlet(int outletIndex);
   
     /** Returns the timestamp of the beginning of the current block. */
-    double getBlockStartTimestamp();
+    ZGTime getBlockStartTimestamp();
+  
+    /** Returns the duration of one block. */
+    ZGTime getBlockDuration();
   
-    /** Returns the duration in milliseconds of one block. */
-    double getBlockDuration();
+    /** Converts a duration in milliseconds, as used by objects such as [delay], into a <code>ZGTime</code>. */
+    ZGTime millisecondsToTime(double milliseconds);
+  
+    /** Converts a <code>ZGTime</code> into milliseconds, the unit in which time is presented to patches. */
+    double timeToMilliseconds(ZGTime time);
   
     int getNumInputChannels();
     int getNumOutputChannels();
@@ -132,6 +268,15 @@ class PdGraph : public DspObject {
     /** (Re-)Computes the tree and node processing ordering for dsp nodes. */
     void computeDspProcessOrder();
   
+    /**
+     * Removes all objects from this graph and its subgraphs which cannot affect the output: comments,
+     * GUI objects (number and symbol boxes, sliders, toggles, bangs) whose outlets are not connected,
+     * and audio objects and subgraphs whose signals reach no output such as <code>dac~</code>,
+     * <code>send~</code>, <code>throw~</code> or <code>delwrite~</code>. Must be called before the
+     * graph is processed. Returns the number of removed objects.
+     */
+    int prune();
+  
     /**
      * Sends the given message to all [receive] objects with the given <code>name</code>.
      * This function is used by message boxes to send messages described be the syntax:
@@ -141,18 +286,122 @@ class PdGraph : public DspObject {
     void dispatchMessageToNamedReceivers(char *name, PdMessage *message);
   
     /**
-     * Schedules a message to be sent to all receivers at the start of the next block.
+     * Schedules a message to be sent to all receivers at the given time. Timestamps behind the
+     * next block are delivered at its start.
      * @returns The <code>PdMessage</code> which will be send. It is intended that the programmer
      * will set the values of the message with a call to <code>setMessage()</code>.
      */
-    PdMessage *scheduleExternalMessage(char *receiverName);
+    PdMessage *scheduleExternalMessage(char *receiverName, ZGTime timestamp);
+  
+    /**
+     * Schedules the given MIDI events in the next block, to be delivered to [notein], [ctlin],
+     * [bendin] and [touchin] objects by the <code>MessageMidiController</code>.
+     */
+    void scheduleMidiEvents(const ZGMidiEvent *events, int numEvents);
   
     /** Returns a list of directories which have neen delcared via a "declare" object. */
     List *getDeclareList();
   
+    /** Returns the directory from which this graph was loaded, including the trailing '/'. */
+    char *getDirectory();
+  
+    /**
+     * Returns the global <code>DiskStreamer</code>, which performs file I/O on behalf of
+     * [readsf~] and [writesf~]. The disk thread is started the first time this function is called.
+     */
+    DiskStreamer *getDiskStreamer();
+  
+    /**
+     * Returns the global <code>SampleLoader</code>, which performs the file operations of
+     * [soundfiler]. It is created the first time this function is called.
+     */
+    SampleLoader *getSampleLoader();
+  
+    /**
+     * Returns a new <code>RandomGenerator</code> for [noise~] or [random], seeded from the seed of
+     * the root graph and the number of generators which it has created before.
+     */
+    RandomGenerator *newRandomGenerator();
+  
+    /**
+     * Returns the named global table ([table] or array), or <code>NULL</code> if there is none.
+     * The lookup takes constant time, such that it may be done in every block.
+     */
+    DspTable *getTable(char *name);
+  
+    /**
+     * Creates a new object from the given string, e.g. "osc~ 440" or "msg hello $1". The object is
+     * <b>not</b> added to the graph. Only built-in objects may be created in this way; abstractions,
+     * subgraphs, and inlet/outlet objects are not supported. Returns <code>NULL</code> if the object
+     * could not be created.
+     */
+    MessageObject *createObject(char *initString);
+  
+    /**
+     * Queues a change to this graph which will be applied by the audio thread at the beginning of
+     * the next block. These functions do not block and may be called from a thread other than the
+     * audio thread, but only from one such thread. Any object of this graph may be connected,
+     * disconnected, or removed (once), whether it has been loaded or added, except for subgraphs,
+     * which cannot be removed. Returns <code>false</code> if the edit is invalid or too many edits
+     * are outstanding, in which case nothing will happen.
+     */
+    bool queueAddObject(MessageObject *object);
+    bool queueRemoveObject(MessageObject *object);
+    bool queueConnect(MessageObject *fromObject, int outletIndex, MessageObject *toObject, int inletIndex);
+    bool queueDisconnect(MessageObject *fromObject, int outletIndex, MessageObject *toObject, int inletIndex);
+  
+    /**
+     * Returns the object at the given index of this graph, counted as in the connections of a Pd
+     * file, or <code>NULL</code> if there is none. Added objects follow the loaded ones. The index
+     * reflects all queued edits. Only used by the control thread.
+     */
+    MessageObject *getObject(int index);
+  
+    /**
+     * Returns the list which will be at the given address once all queued edits have been applied,
+     * e.g. the connections at an inlet. Only used by the control thread.
+     */
+    List *getPlannedList(List **slot);
+  
+    /**
+     * Returns the list which the given edit puts at the given address, creating it as a copy of the
+     * planned list if the edit does not replace that list yet. Only used by the control thread.
+     */
+    List *getEditedList(GraphEdit *graphEdit, List **slot);
+  
+    /**
+     * Turn profiling of this graph (and all of its subgraphs) on or off. Turning profiling on
+     * resets all statistics at the beginning of the next block. While profiling is off, the
+     * statistics are not updated and no time is measured.
+     */
+    void setProfiling(bool profiling);
+  
+    /**
+     * Returns a snapshot of the profiling statistics of this graph. The statistics are read while
+     * they may be updated by the audio thread and so may be very slightly inconsistent. The object
+     * list must not change while the snapshot is taken, i.e. no graph edits may be applied.
+     * The profile must be freed with <code>deleteProfile()</code>.
+     */
+    ZGProfile *getProfile();
+  
+    static void deleteProfile(ZGProfile *profile);
+  
+    /** Prints the profiling statistics to standard output, via the registered callback function. */
+    void printProfile();
+  
+    /**
+     * Frees all edits which have been applied by the audio thread, including the objects which have
+     * been removed from the graph and the process orders and compiled code which have been replaced.
+     * Must be called from the same thread which queues edits.
+     */
+    void releaseCompletedGraphEdits();
+  
   private:
     PdGraph(PdFileParser *fileParser, char *directory, int blockSize, int numInputChannels, 
-            int numOutputChannels, float sampleRate, PdGraph *parentGraph);
+            int numOutputChannels, float sampleRate, PdGraph *parentGraph, PdMessage *arguments);
+  
+    /** Passes a printed message to the callback function, or queues it. */
+    void print(ZGCallbackFunction function, const char *msg, va_list ap);
   
     /** Connect the given <code>MessageObject</code>s from the given outlet to the given inlet. */
     void connect(int fromObjectIndex, int outletIndex, int toObjectIndex, int inletIndex);
@@ -164,6 +413,115 @@ class PdGraph : public DspObject {
     /** Add an object to the graph, taking care of any special object registration. */
     void addObject(MessageObject *node);
   
+    /**
+     * Remove an object from the graph. All of its connections, registrations, and scheduled
+     * messages are removed as well. The object is not deleted.
+     */
+    void removeObject(MessageObject *node);
+  
+    /** Queues an edit to be applied at the beginning of the next block. */
+    bool queueGraphEdit(GraphEditType type, MessageObject *fromObject, int outletIndex,
+        MessageObject *toObject, int inletIndex);
+  
+    /**
+     * Builds everything which the edit changes: the lists of objects, connections and registrations,
+     * and if needed, the new process order of the graph. Audio objects are ordered with the same
+     * rules whether they have been loaded or added, as if the added objects had been loaded after
+     * the others, and added chains of elementwise objects are fused as well.
+     */
+    void planGraphEdit(GraphEdit *graphEdit);
+  
+    /** Plans the registrations of an added or removed object, e.g. those of a [receive~]. */
+    void planAddObject(GraphEdit *graphEdit);
+    void planRemoveObject(GraphEdit *graphEdit);
+  
+    /** Plans the removal of all connections to and from the given object, at the objects on the other end. */
+    void planRemoveConnections(GraphEdit *graphEdit, MessageObject *object);
+  
+    /** Builds the new process order, if the edit changes it. */
+    void planDspProcessOrder(GraphEdit *graphEdit);
+  
+    /**
+     * Frees an edit which will not be applied, and everything which has been built for it. An added
+     * object is not deleted.
+     */
+    void discardGraphEdit(GraphEdit *graphEdit);
+  
+    /**
+     * Returns the connection to or from the given object and let index in the planned list at the
+     * given address, or <code>NULL</code> if there is none.
+     */
+    ObjectLetPair *getPlannedConnection(List **slot, MessageObject *messageObject, int letIndex);
+  
+    /** Returns the table map which the graph will have once all queued edits have been applied. */
+    HashTable *getPlannedTableMap();
+  
+    /**
+     * Applies all queued edits to their graphs, and swaps in the process orders which have been
+     * built for them. Called by the root graph at the beginning of each block.
+     */
+    void applyGraphEdits();
+  
+    /**
+     * Processes one block with the input already in, and leaves the output in, the global buffers.
+     * The public <code>process</code> functions only differ in how they fill and read these buffers.
+     */
+    void processBlock();
+  
+    /** Applies a single edit to this graph. */
+    void applyGraphEdit(GraphEdit *graphEdit);
+  
+    /** Returns <code>true</code> if <code>prune()</code> may remove the given object from this graph. */
+    bool isPrunable(MessageObject *messageObject);
+  
+    /**
+     * Appends the audio objects of this graph to <code>orderList</code> in the order in which they
+     * must be processed, given the connections which it will have once all queued edits have been
+     * applied.
+     */
+    void orderDspObjects(List *orderList);
+  
+    /** Appends the given object to <code>processList</code>, after all unordered objects connected to its inlets. */
+    void orderObject(MessageObject *object, List *processList);
+  
+    /** Returns <code>true</code> if none of the planned connections leave the given object. */
+    bool isPlannedLeaf(MessageObject *messageObject);
+  
+    /**
+     * Fills <code>processList</code> with the audio objects of <code>orderList</code>, replacing each
+     * chain of connected elementwise objects with a <code>DspFusedChain</code> at the position of
+     * its last object. Chains of <code>reusableChainList</code> are used again if they are unchanged.
+     * All chains of the new process list are appended to <code>chainList</code>.
+     */
+    void fuseDspChains(List *orderList, List *reusableChainList, List *processList, List *chainList);
+  
+    /** Resets the profiling statistics of all objects in this graph and its subgraphs. */
+    void resetProfile();
+  
+    /**
+     * Returns the number of entries in the profile of this graph: its processed audio objects, the
+     * objects of its fused chains, the compiled code if it has been processed, and all those of
+     * its subgraphs.
+     */
+    int getNumProfiledObjects();
+  
+    /**
+     * Fills in the profiles of all audio objects in this graph and its subgraphs, starting at
+     * <code>objectProfiles[index]</code>. Returns the next unfilled index.
+     */
+    int fillObjectProfiles(ZGObjectProfile *objectProfiles, int index, int depth, double nsPerTick);
+  
+    /** Remove all scheduled messages which have been sent from the given object. */
+    void cancelAllMessages(MessageObject *messageObject);
+  
+    /** Globally register a [receive] or [notein] object with the <code>MessageSendController</code>. */
+    void registerRemoteMessageReceiver(RemoteMessageReceiver *receiver);
+    void unregisterRemoteMessageReceiver(RemoteMessageReceiver *receiver);
+  
+    /** Globally register a [notein], [ctlin], [bendin] or [touchin] object with the <code>MessageMidiController</code>. */
+    void registerMidiReceiver(MidiReceiver *receiver);
+    void unregisterMidiReceiver(MidiReceiver *receiver);
+  
     /** Globally register a [receive~] object. Connect to registered [send~] objects with the same name. */
     void registerDspReceive(DspReceive *dspReceive);
     
@@ -176,6 +534,11 @@ class PdGraph : public DspObject {
     /** Returns the named global <code>DspCatch</code> object. */
     DspCatch *getDspCatch(char *name);
   
+    /** Returns the object with the given name in the given list of [send~], [delwrite~] or [catch~] objects. */
+    static DspSend *findDspSend(List *list, char *name);
+    static DspDelayWrite *findDelayline(List *list, char *name);
+    static DspCatch *findDspCatch(List *list, char *name);
+  
     /**
      * Globally register a [delwrite~] object. Registration is necessary such that they can
      * be connected to [delread~] and [vd~] objects as are they are added to the graph.
@@ -195,6 +558,21 @@ class PdGraph : public DspObject {
   
     void registerDspCatch(DspCatch *dspCatch);
   
+    /** Globally register a table by name. The first table with a given name is used. */
+    void registerTable(DspTable *table);
+  
+    /*
+     * The unregister functions are the inverse of the above register functions. They are used when
+     * objects are removed from a running graph.
+     */
+    void unregisterDspReceive(DspReceive *dspReceive);
+    void unregisterDspSend(DspSend *dspSend);
+    void unregisterDelayline(DspDelayWrite *delayline);
+    void unregisterDelayReceiver(DelayReceiver *delayReceiver);
+    void unregisterDspThrow(DspThrow *dspThrow);
+    void unregisterDspCatch(DspCatch *dspCatch);
+    void unregisterTable(DspTable *table);
+  
     /** The unique id for this subgraph. Defines "$0". */
     int graphId;
   
@@ -212,6 +590,9 @@ class PdGraph : public DspObject {
     
     /** True if the graph is switch on and should process audio. False otherwise. */
     bool switched;
+  
+    /** True if the graph has been put to sleep by its container. */
+    bool sleeping;
     
     /** The parent graph. NULL if this graph is the root. */
     PdGraph *parentGraph;
@@ -249,14 +630,44 @@ class PdGraph : public DspObject {
     /** A global list of all [catch~] objects. */
     List *catchList;
   
+    /** A global map from names to tables. */
+    HashTable *tableMap;
+  
     /** A global list of all declared directories (-path and -stdpath) */
     List *declareList;
   
+    /** The directory from which this graph was loaded. */
+    char *directory;
+  
+    /** The global disk streaming service. <code>NULL</code> until it is first needed. */
+    DiskStreamer *diskStreamer;
+  
+    /** The global [soundfiler] service. <code>NULL</code> until it is first needed. */
+    SampleLoader *sampleLoader;
+  
+    /** The seed of the random number generators created for this graph. Only used by the root graph. */
+    unsigned int randomSeed;
+  
+    /** The number of random number generators created for this graph. Only used by the root graph. */
+    unsigned int numRandomGenerators;
+  
+    /** Buffers frames for <code>processFrames()</code>. <code>NULL</code> until it is first needed. */
+    BlockAdapter *blockAdapter;
+  
+    /** The compiled code replacing the audio objects. <code>NULL</code> unless it has been loaded. Only used by the root graph. */
+    CompiledDsp *compiledDsp;
+  
     /**
      * The global <code>MessageSendController</code> which dispatches messages to named
      * <code>MessageReceive</code>ers.
      */
     MessageSendController *sendController;
+  
+    /** The global <code>MessageMidiController</code> which dispatches MIDI events from the host. */
+    MessageMidiController *midiController;
+  
+    /** The receivers registered by the host. Only used by the control thread. */
+    List *hostReceiverList;
     
     /**
      * A list of all <code>DspObject</code>s in this graph, in the order in which they should be
@@ -264,14 +675,57 @@ class PdGraph : public DspObject {
      */
     List *dspNodeList;
   
+    /**
+     * The <code>dspNodeList</code> in which each chain of elementwise objects has been replaced by a
+     * <code>DspFusedChain</code> at the position of its last object. This list is processed,
+     * except while profiling, in order to measure the objects individually.
+     */
+    List *dspProcessList;
+  
+    /** The <code>DspFusedChain</code>s in <code>dspProcessList</code>. */
+    List *fusedChainList;
+  
     /** A message queue keeping track of all scheduled messages. */
     OrderedMessageQueue *messageCallbackQueue;
   
-    /** The start of the current block in milliseconds. */
-    double blockStartTimestamp;
+    /** The playing [qlist] objects, whose lines are sent in order with the scheduled messages. */
+    List *sequenceList;
+  
+    /** Graph edits which have been queued by the control thread and are waiting to be applied. */
+    LockFreeQueue *pendingEditQueue;
+  
+    /** Graph edits which have been applied by the audio thread and are waiting to be freed. */
+    LockFreeQueue *completedEditQueue;
+  
+    /**
+     * The edits which have been queued but not yet freed, in order. The lists which they build
+     * describe the graph as it will be once they have been applied. Only used by the control thread.
+     */
+    List *plannedEditList;
+  
+    /** The maximum number of edits which may be outstanding at any time. */
+    static const int MAX_OUTSTANDING_EDITS = 256;
+  
+    /** Indicates that the processing time of objects and blocks should be measured. */
+    bool isProfiling;
   
-    /** The duration of one block in milliseconds. */
-    double blockDurationMs;
+    /** Set by the control thread in order to reset all statistics at the beginning of the next block. */
+    bool isProfileResetPending;
+  
+    /** Timing statistics of whole blocks. Only used by the root graph. */
+    ProfileCounter blockProfileCounter;
+  
+    /** A histogram of block render times, indexed by floor(log2(nanoseconds)). Only used by the root graph. */
+    unsigned int blockTimeHistogram[ZG_PROFILE_HISTOGRAM_LENGTH];
+  
+    /** Timing statistics of the compiled code, in the blocks which it has processed. */
+    ProfileCounter compiledProfileCounter;
+  
+    /** The start of the current block. Only used by the root graph. */
+    ZGTime blockStartTimestamp;
+  
+    /** The duration of one block. */
+    ZGTime blockDuration;
   
     /** The registered callback function for sending data outside of the graph. */
     void (*callbackFunction)(ZGCallbackFunction, void *, void *);
@@ -279,11 +733,26 @@ class PdGraph : public DspObject {
     /** User-provided data associated with the callback function. */
     void *callbackUserData;
   
+    /** How printed messages are delivered to the callback function. Only used by the root graph. */
+    ZGEventDelivery eventDelivery;
+  
+    /** Queues events for the host, unless they are delivered immediately. Only used by the root graph. */
+    EventQueue *eventQueue;
+  
+    /** The number of events for the host which can be queued. */
+    static const int EVENT_QUEUE_CAPACITY = 256;
+  
     int numBytesInInputBuffers;
     int numBytesInOutputBuffers;
   
     float *globalDspInputBuffers;
     float *globalDspOutputBuffers;
+  
+    /** Indicates that integer output is dithered. Only used by the root graph. */
+    bool isDithering;
+  
+    /** The state of the dither noise generators. Only used by the root graph. */
+    unsigned int ditherState[SAMPLE_CONVERSION_DITHER_STATE_LENGTH];
 };
 
 #endif // _PD_GRAPH_H_
@@ -32,7 +32,7 @@ int PdMessage::globalMessageId = 0;
 PdMessage::PdMessage() {
   elementList = new List();
   messageId = globalMessageId++;
-  timestamp = 0.0;
+  timestamp = 0;
   reservedList = new ZGLinkedList();
   
   retainResBuffer();
@@ -41,7 +41,7 @@ PdMessage::PdMessage() {
 PdMessage::PdMessage(char *initString) {
   elementList = new List();
   messageId = globalMessageId++;
-  timestamp = 0.0;
+  timestamp = 0;
   reservedList = new ZGLinkedList();
   
   retainResBuffer();
@@ -53,7 +53,7 @@ PdMessage::PdMessage(char *initString) {
 PdMessage::PdMessage(char *initString, PdMessage *arguments) {
   elementList = new List();
   messageId = globalMessageId++;
-  timestamp = 0.0;
+  timestamp = 0;
   reservedList = new ZGLinkedList();
   
   retainResBuffer();
@@ -131,8 +131,11 @@ char *PdMessage::resolveString(char *initString, PdMessage *arguments, int offse
   } else {
     int numArguments = arguments->getNumElements();
     while ((argPos = strstr(initString + initPos, "\\$")) != NULL) {
-      memcpy(buffer + bufferPos, initString + initPos, argPos - initString - initPos);
-      initPos += 3;
+      // copy any text preceding the argument, e.g. "foo-" in "foo-\$1"
+      int numPrecedingChars = argPos - initString - initPos;
+      memcpy(buffer + bufferPos, initString + initPos, numPrecedingChars);
+      bufferPos += numPrecedingChars;
+      initPos += numPrecedingChars + 3;
       int argumentIndex;
       switch (argPos[2]) {
         case '0': { argumentIndex = 0; break; }
@@ -200,7 +203,7 @@ void PdMessage::setMessage(const char *messageFormat, va_list ap) {
   int numElements = strlen(messageFormat);
   MessageElement *messageElement = NULL;
   for (int i = 0; i < numElements; i++) {
-    messageElement = getElement(i);
+    messageElement = (i < getNumElements()) ? getElement(i) : NULL;
     if (messageElement == NULL) {
       // add extra elements as necessary
       messageElement = new MessageElement();
@@ -224,7 +227,7 @@ void PdMessage::setMessage(const char *messageFormat, va_list ap) {
       }
     }
   }
-  for (int i = numElements; i < getNumElements(); i++) {
+  while (getNumElements() > numElements) {
     // delete extra elements as necessary
     messageElement = (MessageElement *) elementList->remove(numElements);
     delete messageElement;
@@ -243,16 +246,15 @@ MessageElement *PdMessage::getElement(int index) {
   return (MessageElement *) elementList->get(index);
 }
 
-float PdMessage::getBlockIndex(double currentBlockTimestamp, float sampleRate) {
-  // sampleRate is in samples/second, but we need samples/millisecond
-  return ((float) (timestamp - currentBlockTimestamp)) * sampleRate / 1000.0f;
+float PdMessage::getBlockIndex(ZGTime currentBlockTimestamp) {
+  return ZGTimeUtils::toBlockIndex(timestamp, currentBlockTimestamp);
 }
 
-void PdMessage::setTimestamp(double timestamp) {
+void PdMessage::setTimestamp(ZGTime timestamp) {
   this->timestamp = timestamp;
 }
 
-double PdMessage::getTimestamp() {
+ZGTime PdMessage::getTimestamp() {
   return timestamp;
 }
 
@@ -325,13 +327,13 @@ PdMessage *PdMessage::copy() {
   }
   return messageCopy;
 }
-/*
+
 void PdMessage::clear() {
   for (int i = 0; i < elementList->size(); i++) {
     delete (MessageElement *) elementList->get(i);
   }
   elementList->clear();
-  timestamp = 0.0;
+  timestamp = 0;
 }
 
 void PdMessage::clearAndCopyFrom(PdMessage *message, int startIndex) {
@@ -341,68 +343,32 @@ void PdMessage::clearAndCopyFrom(PdMessage *message, int startIndex) {
   }
   timestamp = message->getTimestamp();
 }
-*/
-char *PdMessage::toString() {
-  // http://stackoverflow.com/questions/295013/using-sprintf-without-a-manually-allocated-buffer
-  int listlen = elementList->size();
-  int lengths[listlen]; // how long is the string of each atom
-  char *finalString; // the final buffer we will pass back after concatenating all strings - user should free it
-  int size = 0; // the total length of our final buffer
+
+int PdMessage::toString(char *buffer, int bufferLength) {
   int pos = 0;
-  
-  // loop through every element in our list of atoms
-  // first loop figures out how long our buffer should be
-  // chrism: apparently this might fail under MSVC because of snprintf(NULL) - do we care?
-  for (int i = 0; i < listlen; i++) {
-    lengths[i] = 0;
-    switch (getType(i)) {
-      case FLOAT: {
-        lengths[i] = snprintf(NULL, 0, "%g", getFloat(i));
-        break;
-      }
-      case BANG: {
-        lengths[i] = 4; //snprintf(NULL, 0, "%s", "bang");
-        break;
-      }
-      case SYMBOL: {
-        lengths[i] = snprintf(NULL, 0, "%s", getSymbol(i));
-        break;
-      }
-      default: {
-        break;
-      }
-    }
-    // total length of our string is each atom plus a space, or \0 on the end
-    size += lengths[i] + 1;
-  }
-  
-  // now we do the piecewise concatenation into our final string
-  finalString = (char *)malloc(size);
-  for (int i = 0; i < listlen; i++) {
-    // first element doesn't have a space before it
-    if (i > 0) {
-      strncat(finalString, " ", 1);
-      pos += 1;
-    }
-    // put a string representation of each atom into the final string
+  buffer[0] = '\0';
+  int numElements = elementList->size();
+  for (int i = 0; i < numElements && pos < bufferLength-1; i++) {
+    // elements are separated by a space
+    const char *separator = (i > 0) ? " " : "";
     switch (getType(i)) {
       case FLOAT: {
-        snprintf(&finalString[pos], lengths[i] + 1, "%g", getFloat(i));
+        pos += snprintf(buffer + pos, bufferLength - pos, "%s%g", separator, getFloat(i));
         break;
       }
       case BANG: {
-        snprintf(&finalString[pos], lengths[i] + 1, "%s", "bang");
+        pos += snprintf(buffer + pos, bufferLength - pos, "%sbang", separator);
         break;
       }
       case SYMBOL: {
-        snprintf(&finalString[pos], lengths[i] + 1, "%s", getSymbol(i));
+        pos += snprintf(buffer + pos, bufferLength - pos, "%s%s", separator, getSymbol(i));
         break;
       }
       default: {
         break;
       }
     }
-    pos += lengths[i];
   }
-  return finalString;
+  // snprintf() returns the length that would have been written
+  return (pos < bufferLength) ? pos : bufferLength-1;
 }
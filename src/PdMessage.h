@@ -27,6 +27,7 @@
 #include "List.h"
 #include "MessageElement.h"
 #include "ZGLinkedList.h"
+#include "ZGTime.h"
 
 class MessageObject;
 class PdGraph;
@@ -85,33 +86,34 @@ class PdMessage {
     int getNumElements();
   
     /** A convenience function to determine when in a block a message occurs. */
-    float getBlockIndex(double currentBlockTimestamp, float sampleRate);
+    float getBlockIndex(ZGTime currentBlockTimestamp);
   
-    /** Get the global timestamp of this message (in milliseconds). */
-    double getTimestamp();
+    /** Get the global timestamp of this message (in samples, see <code>ZGTime</code>). */
+    ZGTime getTimestamp();
   
-    /** Set the global timestamp of this message (in milliseconds). */
-    void setTimestamp(double timestamp);
+    /** Set the global timestamp of this message (in samples, see <code>ZGTime</code>). */
+    void setTimestamp(ZGTime timestamp);
   
     bool isReserved();
     void reserve(MessageObject *messageObject);
     void unreserve(MessageObject *messageObject);
   
-    //void clear();
+    /** Removes all elements from the message. */
+    void clear();
   
     /**
      * Replaces the contents of <code>this</code> message with that of the given one, starting
-     * with the <code>MessageElement<code> at <code>startIndex</code>.
+     * with the <code>MessageElement<code> at <code>startIndex</code>. The timestamp is copied as well.
      */
-    //void clearAndCopyFrom(PdMessage *message, int startIndex);
+    void clearAndCopyFrom(PdMessage *message, int startIndex);
   
     PdMessage *copy();
     
     /**
-     * Create a string representation of the message. Suitable for use by the print object.
-     * The resulting string must be <code>free()</code>ed by the caller.
+     * Writes a string representation of the message into the given buffer, truncated to its length.
+     * Suitable for use by the print object. Returns the length of the string. No memory is allocated.
      */
-    char *toString();
+    int toString(char *buffer, int bufferLength);
   
     /** Returns the message id, a globally unique identifier for this message. */ 
     int getMessageId();
@@ -168,7 +170,7 @@ class PdMessage {
     static int globalMessageId;
   
     int messageId;
-    double timestamp;
+    ZGTime timestamp;
     ZGLinkedList *reservedList;
     List *elementList;
 };
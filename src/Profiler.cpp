@@ -0,0 +1,59 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include "Profiler.h"
+
+double Profiler::getNanosecondsPerTick() {
+  static double nanosecondsPerTick = 0.0;
+  if (nanosecondsPerTick == 0.0) {
+    #if __i386__ || __x86_64__
+    // compare the time stamp counter to the wall clock over (at least) 10ms
+    struct timeval start, now;
+    gettimeofday(&start, NULL);
+    unsigned long long startTicks = getTicks();
+    long elapsedUs = 0;
+    do {
+      gettimeofday(&now, NULL);
+      elapsedUs = (now.tv_sec - start.tv_sec) * 1000000L + (now.tv_usec - start.tv_usec);
+    } while (elapsedUs < 10000L);
+    nanosecondsPerTick = (elapsedUs * 1000.0) / (double) (getTicks() - startTicks);
+    #elif __APPLE__
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    nanosecondsPerTick = (double) timebase.numer / (double) timebase.denom;
+    #else
+    nanosecondsPerTick = 1.0; // clock_gettime() already measures nanoseconds
+    #endif
+  }
+  return nanosecondsPerTick;
+}
+
+int Profiler::getHistogramIndex(double nanoseconds, int numBuckets) {
+  int index = 0;
+  while (nanoseconds >= 2.0 && index < numBuckets-1) {
+    nanoseconds *= 0.5;
+    index++;
+  }
+  return index;
+}
@@ -0,0 +1,91 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#elif !(__i386__ || __x86_64__)
+#include <time.h>
+#endif
+
+/** Accumulated timing statistics of one object. All times are measured in ticks. */
+typedef struct {
+  unsigned int numCalls;
+  unsigned long long totalTicks;
+  unsigned long long maxTicks;
+} ProfileCounter;
+
+/**
+ * <code>Profiler</code> provides a cheap, monotonic tick counter for measuring how long objects
+ * take to process. On x86 the time stamp counter is read directly. Elsewhere the system's
+ * monotonic clock is used. Ticks are converted to nanoseconds with a calibrated factor.
+ */
+class Profiler {
+  
+  public:
+    /** Returns the current value of the tick counter. */
+    static inline unsigned long long getTicks() {
+      #if __i386__ || __x86_64__
+      unsigned int lo, hi;
+      __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+      return ((unsigned long long) hi << 32) | lo;
+      #elif __APPLE__
+      return mach_absolute_time();
+      #else
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ((unsigned long long) ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+      #endif
+    }
+  
+    /** Adds a measurement to the given counter. */
+    static inline void addTicks(ProfileCounter *counter, unsigned long long ticks) {
+      counter->numCalls++;
+      counter->totalTicks += ticks;
+      if (ticks > counter->maxTicks) {
+        counter->maxTicks = ticks;
+      }
+    }
+  
+    static inline void resetCounter(ProfileCounter *counter) {
+      counter->numCalls = 0;
+      counter->totalTicks = 0;
+      counter->maxTicks = 0;
+    }
+  
+    /**
+     * Returns the number of nanoseconds per tick. The first call calibrates the tick counter, which
+     * takes several milliseconds, and so should not be made from the audio thread.
+     */
+    static double getNanosecondsPerTick();
+  
+    /** Returns the histogram bucket of the given duration, i.e. floor(log2(nanoseconds)). */
+    static int getHistogramIndex(double nanoseconds, int numBuckets);
+  
+  private:
+    Profiler(); // a private constructor. No instances of this object should be made.
+    ~Profiler();
+};
+
+#endif // _PROFILER_H_
@@ -0,0 +1,168 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <time.h>
+#include "RandomGenerator.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#elif _ARM_ARCH_7
+#include <arm_neon.h>
+#endif
+
+#define NUM_LANES RANDOM_GENERATOR_NUM_LANES
+
+unsigned int RandomGenerator::defaultSeed = 0;
+
+/** Maps the high 23 bits of a random number to a float in the range [-1, 1). */
+static inline float toBipolar(unsigned int r) {
+  // the mantissa bits of a float in [1, 2) are filled with random bits
+  unsigned int u = (r >> 9) | 0x3F800000;
+  float f;
+  memcpy(&f, &u, sizeof(float));
+  return 2.0f * f - 3.0f;
+}
+
+RandomGenerator::RandomGenerator(unsigned int graphSeed, unsigned int index) {
+  // consecutive generators are spread over the seed space
+  seed(graphSeed + index * 0x9E3779B9);
+}
+
+RandomGenerator::~RandomGenerator() {
+  // nothing to do
+}
+
+void RandomGenerator::setDefaultSeed(unsigned int seed) {
+  defaultSeed = seed;
+}
+
+unsigned int RandomGenerator::newGraphSeed() {
+  unsigned int seed = defaultSeed;
+  if (seed == 0) {
+    seed = ((unsigned int) time(NULL)) ^ (((unsigned int) clock()) << 16);
+  }
+  return seed;
+}
+
+void RandomGenerator::seed(unsigned int seed) {
+  // expand the seed into the state in the same way as the Mersenne Twister
+  unsigned int s = seed;
+  for (int i = 0; i < 4 * NUM_LANES; i++) {
+    s = 1812433253u * (s ^ (s >> 30)) + i + 1;
+    state[i] = s;
+  }
+  for (int i = 0; i < NUM_LANES; i++) {
+    // xorshift never leaves the all-zero state
+    if ((state[i] | state[NUM_LANES + i] | state[2*NUM_LANES + i] | state[3*NUM_LANES + i]) == 0) {
+      state[3*NUM_LANES + i] = 1;
+    }
+  }
+  numPending = 0;
+}
+
+void RandomGenerator::next(unsigned int *output) {
+  unsigned int *x = state;
+  unsigned int *y = state + NUM_LANES;
+  unsigned int *z = state + 2*NUM_LANES;
+  unsigned int *w = state + 3*NUM_LANES;
+  for (int i = 0; i < NUM_LANES; i++) {
+    unsigned int t = x[i] ^ (x[i] << 11);
+    x[i] = y[i];
+    y[i] = z[i];
+    z[i] = w[i];
+    w[i] = w[i] ^ (w[i] >> 19) ^ t ^ (t >> 8);
+    output[i] = w[i];
+  }
+}
+
+unsigned int RandomGenerator::nextPending() {
+  if (numPending == 0) {
+    next(pending);
+    numPending = NUM_LANES;
+  }
+  return pending[NUM_LANES - numPending--];
+}
+
+unsigned int RandomGenerator::nextInt(unsigned int maxValue) {
+  unsigned int r = nextPending();
+  // scale instead of taking the remainder, which would favour the low bits
+  return (unsigned int) (((unsigned long long) r * ((unsigned long long) maxValue + 1)) >> 32);
+}
+
+void RandomGenerator::fillBipolar(float *buffer, int length) {
+  // numbers left over from the previous call come first, such that the output depends only on the
+  // seed and the number of samples, and not on how they are split into buffers
+  int i = 0;
+  while (numPending > 0 && i < length) {
+    buffer[i++] = toBipolar(nextPending());
+  }
+  
+  #if __SSE2__
+  __m128i x = _mm_loadu_si128((__m128i *) state);
+  __m128i y = _mm_loadu_si128((__m128i *) (state + NUM_LANES));
+  __m128i z = _mm_loadu_si128((__m128i *) (state + 2*NUM_LANES));
+  __m128i w = _mm_loadu_si128((__m128i *) (state + 3*NUM_LANES));
+  const __m128i one = _mm_set1_epi32(0x3F800000);
+  const __m128 two = _mm_set1_ps(2.0f);
+  const __m128 three = _mm_set1_ps(3.0f);
+  for (; i <= length - NUM_LANES; i += NUM_LANES) {
+    __m128i t = _mm_xor_si128(x, _mm_slli_epi32(x, 11));
+    x = y;
+    y = z;
+    z = w;
+    w = _mm_xor_si128(_mm_xor_si128(w, _mm_srli_epi32(w, 19)), _mm_xor_si128(t, _mm_srli_epi32(t, 8)));
+    __m128 f = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(w, 9), one));
+    _mm_storeu_ps(buffer + i, _mm_sub_ps(_mm_mul_ps(f, two), three));
+  }
+  _mm_storeu_si128((__m128i *) state, x);
+  _mm_storeu_si128((__m128i *) (state + NUM_LANES), y);
+  _mm_storeu_si128((__m128i *) (state + 2*NUM_LANES), z);
+  _mm_storeu_si128((__m128i *) (state + 3*NUM_LANES), w);
+  #elif _ARM_ARCH_7
+  uint32x4_t x = vld1q_u32(state);
+  uint32x4_t y = vld1q_u32(state + NUM_LANES);
+  uint32x4_t z = vld1q_u32(state + 2*NUM_LANES);
+  uint32x4_t w = vld1q_u32(state + 3*NUM_LANES);
+  const uint32x4_t one = vdupq_n_u32(0x3F800000);
+  const float32x4_t two = vdupq_n_f32(2.0f);
+  const float32x4_t three = vdupq_n_f32(3.0f);
+  for (; i <= length - NUM_LANES; i += NUM_LANES) {
+    uint32x4_t t = veorq_u32(x, vshlq_n_u32(x, 11));
+    x = y;
+    y = z;
+    z = w;
+    w = veorq_u32(veorq_u32(w, vshrq_n_u32(w, 19)), veorq_u32(t, vshrq_n_u32(t, 8)));
+    float32x4_t f = vreinterpretq_f32_u32(vorrq_u32(vshrq_n_u32(w, 9), one));
+    vst1q_f32(buffer + i, vsubq_f32(vmulq_f32(f, two), three));
+  }
+  vst1q_u32(state, x);
+  vst1q_u32(state + NUM_LANES, y);
+  vst1q_u32(state + 2*NUM_LANES, z);
+  vst1q_u32(state + 3*NUM_LANES, w);
+  #endif
+  
+  // the remainder, or all of the buffer if there is no vector unit. Unused lanes are kept.
+  for (; i < length; i++) {
+    buffer[i] = toBipolar(nextPending());
+  }
+}
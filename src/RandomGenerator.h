@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _RANDOM_GENERATOR_H_
+#define _RANDOM_GENERATOR_H_
+
+/** The number of independent generators, one per SIMD lane. */
+#define RANDOM_GENERATOR_NUM_LANES 4
+
+/**
+ * <code>RandomGenerator</code> is a xorshift128 pseudo-random number generator which runs
+ * <code>RANDOM_GENERATOR_NUM_LANES</code> independent generators side by side, such that a vector
+ * of random numbers is produced with a handful of SSE2 or NEON instructions. The sequence does not
+ * depend on the instruction set. It is shared by [noise~] and [random].
+ * <br>
+ * Each graph has a seed, and numbers the generators which it creates. A generator is seeded from
+ * both, such that a graph renders identically whenever its seed is the same, independently of
+ * other graphs. The seed of a graph is taken from the clock unless a default seed is set with
+ * <code>setDefaultSeed()</code>.
+ */
+class RandomGenerator {
+  
+  public:
+    /** Creates the generator with the given index in a graph with the given seed. */
+    RandomGenerator(unsigned int graphSeed, unsigned int index);
+    ~RandomGenerator();
+  
+    /** Restarts the sequence from the given seed. */
+    void seed(unsigned int seed);
+  
+    /** Returns a uniformly distributed integer in the range [0, maxValue]. */
+    unsigned int nextInt(unsigned int maxValue);
+  
+    /** Fills the buffer with uniformly distributed floats in the range [-1, 1). */
+    void fillBipolar(float *buffer, int length);
+  
+    /**
+     * Sets the seed of graphs which are created from now on, such that renders are reproducible. A
+     * seed of zero (the default) seeds new graphs from the clock. Must not be called while a graph
+     * is being created.
+     */
+    static void setDefaultSeed(unsigned int seed);
+  
+    /** Returns the seed of a new graph. */
+    static unsigned int newGraphSeed();
+  
+  private:
+    /** Advances all lanes by one step and stores the next number of each lane in <code>output</code>. */
+    void next(unsigned int *output);
+  
+    /** Returns the next pending number, advancing all lanes if there is none. */
+    unsigned int nextPending();
+  
+    /** The x, y, z and w words of each lane, stored word-wise. */
+    unsigned int state[4 * RANDOM_GENERATOR_NUM_LANES];
+  
+    /** Numbers which have been generated but not yet returned by <code>nextInt()</code>. */
+    unsigned int pending[RANDOM_GENERATOR_NUM_LANES];
+    int numPending;
+  
+    static unsigned int defaultSeed;
+};
+
+#endif // _RANDOM_GENERATOR_H_
@@ -0,0 +1,337 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if __SSE__
+#include <xmmintrin.h>
+#endif
+#include "DspTable.h"
+#include "HashTable.h"
+#include "SampleCache.h"
+#include "StaticUtils.h"
+
+/**
+ * The header of a sample in memory and in a cache file. It fills one page, so that the channel
+ * data of a mapped file is as aligned as that of an allocated sample.
+ */
+#define SAMPLE_CACHE_HEADER_SIZE 4096
+#define SAMPLE_CACHE_MAGIC 0x4353475A // "ZGSC"
+#define SAMPLE_CACHE_VERSION 1
+#define SAMPLE_CACHE_KEY_LENGTH (SAMPLE_CACHE_HEADER_SIZE - 4 * sizeof(int))
+
+typedef struct {
+  int magic;
+  int version;
+  int numChannels;
+  int numFrames;
+  char key[SAMPLE_CACHE_KEY_LENGTH];
+} SampleCacheHeader;
+
+/** The number of frames which are read from a file at once while decoding. */
+#define SAMPLE_CACHE_DECODE_FRAMES 16384
+
+#define FNV64_OFFSET_BASIS 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+
+static pthread_mutex_t cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static HashTable *sampleMap = NULL;
+static char *cacheDirectory = NULL;
+
+/** Returns the number of floats between the starts of consecutive channels. */
+static inline long getChannelStride(int numFrames) {
+  return ((long) numFrames + 2 * DSP_TABLE_GUARD_LENGTH + 15) & ~15L;
+}
+
+/** Returns the size in bytes of a sample with the given dimensions. */
+static inline long getDataSize(int numChannels, int numFrames) {
+  return SAMPLE_CACHE_HEADER_SIZE + numChannels * getChannelStride(numFrames) * sizeof(float);
+}
+
+/** Points the channels of the sample into its data. */
+static void initChannels(CachedSample *sample) {
+  sample->channels = (float **) malloc(sample->numChannels * sizeof(float *));
+  float *channelData = (float *) ((char *) sample->data + SAMPLE_CACHE_HEADER_SIZE);
+  long stride = getChannelStride(sample->numFrames);
+  for (int i = 0; i < sample->numChannels; i++) {
+    sample->channels[i] = channelData + i * stride + DSP_TABLE_GUARD_LENGTH;
+  }
+}
+
+/** Copies interleaved frames into the channels of the sample, starting at the given frame. */
+static void deinterleave(float *interleaved, int numFrames, CachedSample *sample, int frameIndex) {
+  if (sample->numChannels == 1) {
+    memcpy(sample->channels[0] + frameIndex, interleaved, numFrames * sizeof(float));
+  } else if (sample->numChannels == 2) {
+    float *left = sample->channels[0] + frameIndex;
+    float *right = sample->channels[1] + frameIndex;
+    int i = 0;
+    #if __SSE__
+    for (; i <= numFrames - 4; i += 4) {
+      __m128 lo = _mm_loadu_ps(interleaved + 2*i); // L0 R0 L1 R1
+      __m128 hi = _mm_loadu_ps(interleaved + 2*i + 4); // L2 R2 L3 R3
+      _mm_storeu_ps(left + i, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2,0,2,0)));
+      _mm_storeu_ps(right + i, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3,1,3,1)));
+    }
+    #endif // __SSE__
+    for (; i < numFrames; i++) {
+      left[i] = interleaved[2*i];
+      right[i] = interleaved[2*i+1];
+    }
+  } else {
+    for (int j = 0; j < sample->numChannels; j++) {
+      float *channel = sample->channels[j] + frameIndex;
+      for (int i = 0, k = j; i < numFrames; i++, k += sample->numChannels) {
+        channel[i] = interleaved[k];
+      }
+    }
+  }
+}
+
+CachedSample *SampleCache::newSample(const char *key, int numChannels, int numFrames) {
+  long dataSize = getDataSize(numChannels, numFrames);
+  void *data = NULL;
+  if (posix_memalign(&data, 64, dataSize) != 0) {
+    return NULL;
+  }
+  CachedSample *sample = (CachedSample *) calloc(1, sizeof(CachedSample));
+  sample->key = StaticUtils::copyString((char *) key);
+  sample->numChannels = numChannels;
+  sample->numFrames = numFrames;
+  sample->data = data;
+  sample->dataSize = dataSize;
+  sample->isMapped = false;
+  pthread_mutex_init(&sample->decodeMutex, NULL);
+  
+  // the header is kept with the data so that the sample can be saved as it is
+  memset(data, 0, SAMPLE_CACHE_HEADER_SIZE);
+  SampleCacheHeader *header = (SampleCacheHeader *) data;
+  header->magic = SAMPLE_CACHE_MAGIC;
+  header->version = SAMPLE_CACHE_VERSION;
+  header->numChannels = numChannels;
+  header->numFrames = numFrames;
+  strncpy(header->key, key, SAMPLE_CACHE_KEY_LENGTH-1);
+  
+  // only the guards and padding are cleared. The frames are all written while decoding.
+  initChannels(sample);
+  long stride = getChannelStride(numFrames);
+  for (int i = 0; i < numChannels; i++) {
+    memset(sample->channels[i] - DSP_TABLE_GUARD_LENGTH, 0, DSP_TABLE_GUARD_LENGTH * sizeof(float));
+    memset(sample->channels[i] + numFrames, 0,
+        (stride - numFrames - DSP_TABLE_GUARD_LENGTH) * sizeof(float));
+  }
+  return sample;
+}
+
+CachedSample *SampleCache::mapSample(const char *key, const char *persistentPath) {
+  int fd = open(persistentPath, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat fileStat;
+  void *data = MAP_FAILED;
+  if (fstat(fd, &fileStat) == 0 && fileStat.st_size >= SAMPLE_CACHE_HEADER_SIZE) {
+    data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd); // the mapping remains valid
+  if (data == MAP_FAILED) {
+    return NULL;
+  }
+  
+  // the file must be complete, and must belong to the same key (its name is only a hash)
+  SampleCacheHeader *header = (SampleCacheHeader *) data;
+  if (header->magic != SAMPLE_CACHE_MAGIC || header->version != SAMPLE_CACHE_VERSION ||
+      header->numChannels <= 0 || header->numFrames < 0 ||
+      fileStat.st_size != getDataSize(header->numChannels, header->numFrames) ||
+      strncmp(header->key, key, SAMPLE_CACHE_KEY_LENGTH) != 0) {
+    munmap(data, fileStat.st_size);
+    return NULL;
+  }
+  CachedSample *sample = (CachedSample *) calloc(1, sizeof(CachedSample));
+  sample->key = StaticUtils::copyString((char *) key);
+  sample->state = CACHED_SAMPLE_READY;
+  sample->numChannels = header->numChannels;
+  sample->numFrames = header->numFrames;
+  sample->data = data;
+  sample->dataSize = fileStat.st_size;
+  sample->isMapped = true;
+  pthread_mutex_init(&sample->decodeMutex, NULL);
+  initChannels(sample);
+  return sample;
+}
+
+void SampleCache::saveSample(CachedSample *sample) {
+  // write to a temporary file first, such that no other process can map a partial file
+  char *temporaryPath = (char *) malloc(strlen(sample->persistentPath) + 32);
+  sprintf(temporaryPath, "%s.%i.tmp", sample->persistentPath, (int) getpid());
+  FILE *file = fopen(temporaryPath, "wb");
+  if (file != NULL) {
+    bool didWrite = (fwrite(sample->data, 1, sample->dataSize, file) == (size_t) sample->dataSize);
+    if (fclose(file) == 0 && didWrite) {
+      rename(temporaryPath, sample->persistentPath);
+    } else {
+      unlink(temporaryPath);
+    }
+  }
+  free(temporaryPath);
+}
+
+void SampleCache::deleteSample(CachedSample *sample) {
+  if (sample->file != NULL) {
+    sf_close(sample->file);
+  }
+  if (sample->isMapped) {
+    munmap(sample->data, sample->dataSize);
+  } else {
+    free(sample->data);
+  }
+  pthread_mutex_destroy(&sample->decodeMutex);
+  free(sample->channels);
+  free(sample->persistentPath);
+  free(sample->key);
+  free(sample);
+}
+
+CachedSample *SampleCache::acquire(const char *path) {
+  char resolvedPath[PATH_MAX];
+  struct stat fileStat;
+  if (realpath(path, resolvedPath) == NULL || stat(resolvedPath, &fileStat) != 0) {
+    return NULL;
+  }
+  // the key is stored in the header of a cache file, which bounds its length. A truncated key
+  // could name another file, so such a path is not loaded.
+  char key[SAMPLE_CACHE_KEY_LENGTH];
+  int keyLength = snprintf(key, sizeof(key), "%s:%lld:%lld", resolvedPath,
+      (long long) fileStat.st_size, (long long) fileStat.st_mtime);
+  if (keyLength < 0 || keyLength >= (int) sizeof(key)) {
+    return NULL;
+  }
+  
+  pthread_mutex_lock(&cacheMutex);
+  if (sampleMap == NULL) {
+    sampleMap = new HashTable();
+  }
+  CachedSample *sample = (CachedSample *) sampleMap->get(key);
+  if (sample == NULL) {
+    char *persistentPath = NULL;
+    if (cacheDirectory != NULL) {
+      unsigned long long hash = FNV64_OFFSET_BASIS;
+      for (char *c = key; *c != '\0'; c++) {
+        hash = (hash ^ (unsigned char) *c) * FNV64_PRIME;
+      }
+      persistentPath = (char *) malloc(strlen(cacheDirectory) + 32);
+      sprintf(persistentPath, "%s/%016llx.zgs", cacheDirectory, hash);
+      sample = mapSample(key, persistentPath);
+    }
+    if (sample == NULL) {
+      SF_INFO info;
+      memset(&info, 0, sizeof(SF_INFO));
+      SNDFILE *file = sf_open(resolvedPath, SFM_READ, &info);
+      if (file != NULL && info.channels > 0 &&
+          (sample = newSample(key, info.channels, (int) info.frames)) != NULL) {
+        sample->state = CACHED_SAMPLE_DECODING;
+        sample->file = file;
+        sample->persistentPath = persistentPath;
+        persistentPath = NULL;
+      } else if (file != NULL) {
+        sf_close(file);
+      }
+    }
+    free(persistentPath);
+    if (sample != NULL) {
+      sampleMap->put(sample->key, sample);
+    }
+  }
+  if (sample != NULL) {
+    sample->refCount++;
+  }
+  pthread_mutex_unlock(&cacheMutex);
+  return sample;
+}
+
+void SampleCache::retain(CachedSample *sample) {
+  pthread_mutex_lock(&cacheMutex);
+  sample->refCount++;
+  pthread_mutex_unlock(&cacheMutex);
+}
+
+void SampleCache::release(CachedSample *sample) {
+  pthread_mutex_lock(&cacheMutex);
+  if (--sample->refCount == 0) {
+    sampleMap->remove(sample->key);
+    deleteSample(sample);
+  }
+  pthread_mutex_unlock(&cacheMutex);
+}
+
+bool SampleCache::decode(CachedSample *sample, int maxFrames) {
+  if (sample->state != CACHED_SAMPLE_DECODING) {
+    return true;
+  }
+  if (pthread_mutex_trylock(&sample->decodeMutex) != 0) {
+    return false; // another thread is decoding this sample
+  }
+  if (sample->state == CACHED_SAMPLE_DECODING) {
+    float *buffer = (float *) malloc(SAMPLE_CACHE_DECODE_FRAMES * sample->numChannels * sizeof(float));
+    bool isEndOfFile = false;
+    while (maxFrames > 0 && !isEndOfFile) {
+      int numFrames = sample->numFrames - sample->numDecodedFrames;
+      numFrames = (numFrames < maxFrames) ? numFrames : maxFrames;
+      numFrames = (numFrames < SAMPLE_CACHE_DECODE_FRAMES) ? numFrames : SAMPLE_CACHE_DECODE_FRAMES;
+      int numReadFrames = (numFrames > 0) ? (int) sf_readf_float(sample->file, buffer, numFrames) : 0;
+      deinterleave(buffer, numReadFrames, sample, sample->numDecodedFrames);
+      sample->numDecodedFrames += numReadFrames;
+      maxFrames -= numReadFrames;
+      isEndOfFile = (numReadFrames < numFrames || sample->numDecodedFrames == sample->numFrames);
+    }
+    free(buffer);
+    
+    if (isEndOfFile) {
+      sf_close(sample->file);
+      sample->file = NULL;
+      // a file which ends early (e.g. because it is truncated) is silent thereafter
+      for (int i = 0; i < sample->numChannels; i++) {
+        memset(sample->channels[i] + sample->numDecodedFrames, 0,
+            (sample->numFrames - sample->numDecodedFrames) * sizeof(float));
+      }
+      if (sample->persistentPath != NULL && sample->numDecodedFrames == sample->numFrames) {
+        saveSample(sample);
+      }
+      sample->state = CACHED_SAMPLE_READY;
+    }
+  }
+  pthread_mutex_unlock(&sample->decodeMutex);
+  return (sample->state != CACHED_SAMPLE_DECODING);
+}
+
+void SampleCache::setDirectory(const char *directory) {
+  pthread_mutex_lock(&cacheMutex);
+  free(cacheDirectory);
+  cacheDirectory = StaticUtils::copyString((char *) directory);
+  pthread_mutex_unlock(&cacheMutex);
+}
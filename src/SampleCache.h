@@ -0,0 +1,107 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _SAMPLE_CACHE_H_
+#define _SAMPLE_CACHE_H_
+
+#include <pthread.h>
+#include <sndfile.h>
+
+typedef enum {
+  CACHED_SAMPLE_DECODING,
+  CACHED_SAMPLE_READY
+} CachedSampleState;
+
+/**
+ * The decoded contents of one sound file. Each channel is stored like the contents of a
+ * <code>DspTable</code>, i.e. 64-byte aligned with zeroed guard samples on either side, so that
+ * tables may use the channels directly.
+ */
+typedef struct CachedSample {
+  char *key;
+  int refCount;
+  volatile CachedSampleState state;
+  int numChannels;
+  int numFrames;
+  float **channels;
+  
+  /** The memory holding all channels. It is either allocated or a mapped cache file. */
+  void *data;
+  long dataSize;
+  bool isMapped;
+  
+  /** Used while decoding. Only one thread decodes a sample at a time. */
+  pthread_mutex_t decodeMutex;
+  SNDFILE *file;
+  int numDecodedFrames;
+  char *persistentPath;
+} CachedSample;
+
+/**
+ * The <code>SampleCache</code> holds the decoded contents of sound files for the whole process,
+ * such that each file is decoded only once no matter how many graphs load it. Samples are keyed by
+ * the identity of the file (its resolved path, size and modification time), so that a modified file
+ * is decoded again.
+ *
+ * If a cache directory is set, decoded samples are also saved there as raw float files, named by
+ * the FNV-1a hash of their key. These are memory mapped instead of being decoded the next time the
+ * file is loaded, also by other processes.
+ *
+ * Decoding is incremental (see <code>decode()</code>) so that a long file does not hold up the
+ * other work of the disk thread. All functions may be called from any thread.
+ */
+class SampleCache {
+  
+  public:
+    /**
+     * Returns the cached sample of the given file, retained for the caller. A sample which is not
+     * yet in memory is mapped from the cache directory if possible, or is otherwise prepared for
+     * decoding. Returns <code>NULL</code> if the file cannot be opened, or if its resolved path is
+     * too long to be stored as the key of a cache file.
+     */
+    static CachedSample *acquire(const char *path);
+  
+    /** Retains a sample for another user. */
+    static void retain(CachedSample *sample);
+  
+    /** Releases a retained sample. Unused samples are removed from memory. */
+    static void release(CachedSample *sample);
+  
+    /**
+     * Decodes up to <code>maxFrames</code> further frames of the sample. Returns <code>true</code>
+     * once the sample is ready. If another thread is currently decoding the sample, this function
+     * returns <code>false</code> at once. A file which ends before its announced length is silent
+     * thereafter.
+     */
+    static bool decode(CachedSample *sample, int maxFrames);
+  
+    /** Sets the directory in which decoded samples are saved. <code>NULL</code> disables saving. */
+    static void setDirectory(const char *directory);
+  
+  private:
+    static CachedSample *newSample(const char *key, int numChannels, int numFrames);
+    static CachedSample *mapSample(const char *key, const char *persistentPath);
+    static void saveSample(CachedSample *sample);
+    static void deleteSample(CachedSample *sample);
+};
+
+#endif // _SAMPLE_CACHE_H_
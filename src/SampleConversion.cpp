@@ -0,0 +1,283 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+#include "SampleConversion.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define SHORT_INPUT_SCALE (1.0f / 32768.0f)
+#define SHORT_OUTPUT_SCALE 32767.0f
+#define INT24_INPUT_SCALE (1.0f / 8388608.0f)
+#define INT24_OUTPUT_SCALE 8388607.0f
+
+static inline unsigned int xorshift(unsigned int x) {
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+/** Returns triangular noise in the range (-1, 1), as the difference of two uniform variables. */
+static inline float nextDither(unsigned int *ditherState) {
+  unsigned int a = xorshift(ditherState[0]);
+  unsigned int b = xorshift(a);
+  ditherState[0] = b;
+  // the mantissa bits of a float in [1, 2) are filled with random bits
+  unsigned int ua = (a >> 9) | 0x3F800000;
+  unsigned int ub = (b >> 9) | 0x3F800000;
+  float fa, fb;
+  memcpy(&fa, &ua, sizeof(float));
+  memcpy(&fb, &ub, sizeof(float));
+  return fa - fb;
+}
+
+static inline short floatToShort(float f, unsigned int *ditherState) {
+  f = (f > 1.0f) ? 1.0f : (f < -1.0f) ? -1.0f : f;
+  f *= SHORT_OUTPUT_SCALE;
+  if (ditherState != NULL) {
+    f += nextDither(ditherState);
+  }
+  long i = lrintf(f);
+  return (short) ((i > 32767) ? 32767 : (i < -32768) ? -32768 : i);
+}
+
+static inline int floatToInt24(float f, unsigned int *ditherState) {
+  f = (f > 1.0f) ? 1.0f : (f < -1.0f) ? -1.0f : f;
+  f *= INT24_OUTPUT_SCALE;
+  if (ditherState != NULL) {
+    f += nextDither(ditherState);
+  }
+  long i = lrintf(f);
+  return (int) ((i > 8388607) ? 8388607 : (i < -8388608) ? -8388608 : i);
+}
+
+#if __SSE2__
+static inline __m128i xorshift(__m128i x) {
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+  return x;
+}
+
+/** The vector equivalent of <code>nextDither()</code>, using one generator per lane. */
+static inline __m128 nextDither(__m128i *state) {
+  __m128i a = xorshift(*state);
+  __m128i b = xorshift(a);
+  *state = b;
+  const __m128i one = _mm_set1_epi32(0x3F800000);
+  __m128 fa = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(a, 9), one));
+  __m128 fb = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(b, 9), one));
+  return _mm_sub_ps(fa, fb);
+}
+
+/**
+ * Loads the next eight interleaved samples from mono or stereo channel buffers, starting at the
+ * given frame. That is eight frames of a mono signal, or four frames of a stereo signal.
+ */
+static inline void loadInterleaved(float *channelBuffers, int numChannels, int numFrames, int frameIndex,
+    __m128 *a, __m128 *b) {
+  if (numChannels == 1) {
+    *a = _mm_loadu_ps(channelBuffers + frameIndex);
+    *b = _mm_loadu_ps(channelBuffers + frameIndex + 4);
+  } else {
+    __m128 left = _mm_loadu_ps(channelBuffers + frameIndex);
+    __m128 right = _mm_loadu_ps(channelBuffers + numFrames + frameIndex);
+    *a = _mm_unpacklo_ps(left, right); // L0 R0 L1 R1
+    *b = _mm_unpackhi_ps(left, right); // L2 R2 L3 R3
+  }
+}
+
+/** The inverse of <code>loadInterleaved()</code>. */
+static inline void storeDeinterleaved(__m128 a, __m128 b, float *channelBuffers, int numChannels,
+    int numFrames, int frameIndex) {
+  if (numChannels == 1) {
+    _mm_storeu_ps(channelBuffers + frameIndex, a);
+    _mm_storeu_ps(channelBuffers + frameIndex + 4, b);
+  } else {
+    _mm_storeu_ps(channelBuffers + frameIndex, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+    _mm_storeu_ps(channelBuffers + numFrames + frameIndex, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)));
+  }
+}
+
+/** Clips, scales and optionally dithers four samples. */
+static inline __m128 quantize(__m128 x, __m128 scale, __m128i *ditherVector, bool isDithering) {
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 minusOne = _mm_set1_ps(-1.0f);
+  x = _mm_mul_ps(_mm_max_ps(_mm_min_ps(x, one), minusOne), scale);
+  return isDithering ? _mm_add_ps(x, nextDither(ditherVector)) : x;
+}
+
+/** Returns the number of frames which are converted per vector iteration, or 0 if there is no vector path. */
+static inline int getVectorFrameStep(int numChannels) {
+  return (numChannels == 1) ? 8 : (numChannels == 2) ? 4 : 0;
+}
+#endif // __SSE2__
+
+void SampleConversion::initDitherState(unsigned int *ditherState) {
+  // arbitrary non-zero seeds, so that dithered output is reproducible
+  ditherState[0] = 0x9E3779B9;
+  ditherState[1] = 0x7F4A7C15;
+  ditherState[2] = 0x85EBCA6B;
+  ditherState[3] = 0xC2B2AE35;
+}
+
+void SampleConversion::deinterleave(float *input, float *channelBuffers, int numChannels, int numFrames) {
+  int i = 0;
+  #if __SSE2__
+  int step = getVectorFrameStep(numChannels);
+  for (; step > 0 && i + step <= numFrames; i += step) {
+    __m128 a = _mm_loadu_ps(input + i*numChannels);
+    __m128 b = _mm_loadu_ps(input + i*numChannels + 4);
+    storeDeinterleaved(a, b, channelBuffers, numChannels, numFrames, i);
+  }
+  #endif
+  for (; i < numFrames; i++) {
+    for (int k = 0; k < numChannels; k++) {
+      channelBuffers[k*numFrames + i] = input[i*numChannels + k];
+    }
+  }
+}
+
+void SampleConversion::interleave(float *channelBuffers, float *output, int numChannels, int numFrames) {
+  int i = 0;
+  #if __SSE2__
+  int step = getVectorFrameStep(numChannels);
+  for (; step > 0 && i + step <= numFrames; i += step) {
+    __m128 a, b;
+    loadInterleaved(channelBuffers, numChannels, numFrames, i, &a, &b);
+    _mm_storeu_ps(output + i*numChannels, a);
+    _mm_storeu_ps(output + i*numChannels + 4, b);
+  }
+  #endif
+  for (; i < numFrames; i++) {
+    for (int k = 0; k < numChannels; k++) {
+      output[i*numChannels + k] = channelBuffers[k*numFrames + i];
+    }
+  }
+}
+
+void SampleConversion::deinterleaveShort(short *input, float *channelBuffers, int numChannels, int numFrames) {
+  int i = 0;
+  #if __SSE2__
+  int step = getVectorFrameStep(numChannels);
+  const __m128 scale = _mm_set1_ps(SHORT_INPUT_SCALE);
+  for (; step > 0 && i + step <= numFrames; i += step) {
+    __m128i s = _mm_loadu_si128((__m128i *) (input + i*numChannels));
+    // sign-extend each short into the upper half of a 32-bit lane, and shift it back down
+    __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16)), scale);
+    __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16)), scale);
+    storeDeinterleaved(a, b, channelBuffers, numChannels, numFrames, i);
+  }
+  #endif
+  for (; i < numFrames; i++) {
+    for (int k = 0; k < numChannels; k++) {
+      channelBuffers[k*numFrames + i] = ((float) input[i*numChannels + k]) * SHORT_INPUT_SCALE;
+    }
+  }
+}
+
+void SampleConversion::interleaveShort(float *channelBuffers, short *output, int numChannels, int numFrames,
+    unsigned int *ditherState) {
+  int i = 0;
+  #if __SSE2__
+  int step = getVectorFrameStep(numChannels);
+  if (step > 0 && step <= numFrames) {
+    const __m128 scale = _mm_set1_ps(SHORT_OUTPUT_SCALE);
+    bool isDithering = (ditherState != NULL);
+    __m128i ditherVector = isDithering ? _mm_loadu_si128((__m128i *) ditherState) : _mm_setzero_si128();
+    for (; i + step <= numFrames; i += step) {
+      __m128 a, b;
+      loadInterleaved(channelBuffers, numChannels, numFrames, i, &a, &b);
+      a = quantize(a, scale, &ditherVector, isDithering);
+      b = quantize(b, scale, &ditherVector, isDithering);
+      // the pack saturates any dithered sample which exceeds the range of a short
+      _mm_storeu_si128((__m128i *) (output + i*numChannels),
+          _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    if (isDithering) {
+      _mm_storeu_si128((__m128i *) ditherState, ditherVector);
+    }
+  }
+  #endif
+  for (; i < numFrames; i++) {
+    for (int k = 0; k < numChannels; k++) {
+      output[i*numChannels + k] = floatToShort(channelBuffers[k*numFrames + i], ditherState);
+    }
+  }
+}
+
+void SampleConversion::deinterleaveInt24(int *input, float *channelBuffers, int numChannels, int numFrames) {
+  int i = 0;
+  #if __SSE2__
+  int step = getVectorFrameStep(numChannels);
+  const __m128 scale = _mm_set1_ps(INT24_INPUT_SCALE);
+  for (; step > 0 && i + step <= numFrames; i += step) {
+    __m128i sa = _mm_loadu_si128((__m128i *) (input + i*numChannels));
+    __m128i sb = _mm_loadu_si128((__m128i *) (input + i*numChannels + 4));
+    // sign-extend from 24 bits, ignoring anything in the top byte
+    __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(sa, 8), 8)), scale);
+    __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(sb, 8), 8)), scale);
+    storeDeinterleaved(a, b, channelBuffers, numChannels, numFrames, i);
+  }
+  #endif
+  for (; i < numFrames; i++) {
+    for (int k = 0; k < numChannels; k++) {
+      int sample = (int) (((unsigned int) input[i*numChannels + k]) << 8) >> 8;
+      channelBuffers[k*numFrames + i] = ((float) sample) * INT24_INPUT_SCALE;
+    }
+  }
+}
+
+void SampleConversion::interleaveInt24(float *channelBuffers, int *output, int numChannels, int numFrames,
+    unsigned int *ditherState) {
+  int i = 0;
+  #if __SSE2__
+  int step = getVectorFrameStep(numChannels);
+  if (step > 0 && step <= numFrames) {
+    const __m128 scale = _mm_set1_ps(INT24_OUTPUT_SCALE);
+    const __m128 maxValue = _mm_set1_ps(8388607.0f);
+    const __m128 minValue = _mm_set1_ps(-8388608.0f);
+    bool isDithering = (ditherState != NULL);
+    __m128i ditherVector = isDithering ? _mm_loadu_si128((__m128i *) ditherState) : _mm_setzero_si128();
+    for (; i + step <= numFrames; i += step) {
+      __m128 a, b;
+      loadInterleaved(channelBuffers, numChannels, numFrames, i, &a, &b);
+      a = _mm_max_ps(_mm_min_ps(quantize(a, scale, &ditherVector, isDithering), maxValue), minValue);
+      b = _mm_max_ps(_mm_min_ps(quantize(b, scale, &ditherVector, isDithering), maxValue), minValue);
+      _mm_storeu_si128((__m128i *) (output + i*numChannels), _mm_cvtps_epi32(a));
+      _mm_storeu_si128((__m128i *) (output + i*numChannels + 4), _mm_cvtps_epi32(b));
+    }
+    if (isDithering) {
+      _mm_storeu_si128((__m128i *) ditherState, ditherVector);
+    }
+  }
+  #endif
+  for (; i < numFrames; i++) {
+    for (int k = 0; k < numChannels; k++) {
+      output[i*numChannels + k] = floatToInt24(channelBuffers[k*numFrames + i], ditherState);
+    }
+  }
+}
@@ -0,0 +1,71 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _SAMPLE_CONVERSION_H_
+#define _SAMPLE_CONVERSION_H_
+
+/** The number of independent dither generators, one per SIMD lane. */
+#define SAMPLE_CONVERSION_DITHER_STATE_LENGTH 4
+
+/**
+ * <code>SampleConversion</code> moves audio between the non-interleaved float buffers of a graph
+ * and the interleaved buffers of the host, converting the sample format on the way. Integer output
+ * is clipped to the range of the format and may be dithered with triangular (TPDF) noise of
+ * +/- 1 LSB. Stereo and mono, the common cases, are handled four frames at a time with SSE2.
+ * <br>
+ * 24-bit samples are stored in the low three bytes of a 32-bit integer and are sign-extended.
+ * Integer input is scaled by 1/32768 (1/8388608), and output by 32767 (8388607).
+ */
+class SampleConversion {
+  
+  public:
+    /** Seeds the given dither state, which must have <code>SAMPLE_CONVERSION_DITHER_STATE_LENGTH</code> elements. */
+    static void initDitherState(unsigned int *ditherState);
+  
+    /** Splits interleaved float frames into consecutive channel buffers of length <code>numFrames</code>. */
+    static void deinterleave(float *input, float *channelBuffers, int numChannels, int numFrames);
+  
+    /** Joins consecutive channel buffers of length <code>numFrames</code> into interleaved float frames. */
+    static void interleave(float *channelBuffers, float *output, int numChannels, int numFrames);
+  
+    /** Converts interleaved 16-bit frames into consecutive float channel buffers. */
+    static void deinterleaveShort(short *input, float *channelBuffers, int numChannels, int numFrames);
+  
+    /**
+     * Converts consecutive float channel buffers into interleaved 16-bit frames. If
+     * <code>ditherState</code> is not <code>NULL</code>, the output is dithered.
+     */
+    static void interleaveShort(float *channelBuffers, short *output, int numChannels, int numFrames,
+        unsigned int *ditherState);
+  
+    /** Converts interleaved 24-bit frames into consecutive float channel buffers. */
+    static void deinterleaveInt24(int *input, float *channelBuffers, int numChannels, int numFrames);
+  
+    /**
+     * Converts consecutive float channel buffers into interleaved 24-bit frames. If
+     * <code>ditherState</code> is not <code>NULL</code>, the output is dithered.
+     */
+    static void interleaveInt24(float *channelBuffers, int *output, int numChannels, int numFrames,
+        unsigned int *ditherState);
+};
+
+#endif // _SAMPLE_CONVERSION_H_
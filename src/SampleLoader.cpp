@@ -0,0 +1,244 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <sndfile.h>
+#include <unistd.h>
+#include "DspTable.h"
+#include "List.h"
+#include "LockFreeQueue.h"
+#include "MessageSoundfiler.h"
+#include "SampleCache.h"
+#include "SampleLoader.h"
+#include "StaticUtils.h"
+
+/** The maximum number of requests which may exist at once. */
+#define MAX_SAMPLE_LOAD_REQUESTS 64
+
+/** The number of frames decoded in one call to service(), so that streams are not held up. */
+#define SAMPLE_LOADER_DECODE_FRAMES 65536
+
+/** The number of frames which are written to a file at once. */
+#define SAMPLE_LOADER_WRITE_FRAMES 16384
+
+SampleLoader::SampleLoader() {
+  requestQueue = new LockFreeQueue(MAX_SAMPLE_LOAD_REQUESTS);
+  completionQueue = new LockFreeQueue(MAX_SAMPLE_LOAD_REQUESTS);
+  disposalQueue = new LockFreeQueue(MAX_SAMPLE_LOAD_REQUESTS);
+  outstandingRequestList = new List();
+  numSubmittedRequests = 0;
+  numDeletedRequests = 0;
+  currentRequest = NULL;
+  waitsForDisk = false;
+}
+
+SampleLoader::~SampleLoader() {
+  // the disk thread no longer services this loader
+  for (int i = 0; i < outstandingRequestList->size(); i++) {
+    deleteRequest((SampleLoadRequest *) outstandingRequestList->get(i));
+  }
+  SampleLoadRequest *request = NULL;
+  while ((request = (SampleLoadRequest *) disposalQueue->pop()) != NULL) {
+    deleteRequest(request);
+  }
+  delete outstandingRequestList;
+  delete requestQueue;
+  delete completionQueue;
+  delete disposalQueue;
+}
+
+SampleLoadRequest *SampleLoader::newRequest(SampleLoadRequestType type, MessageSoundfiler *soundfiler,
+    const char *path, int numTables) {
+  SampleLoadRequest *request = (SampleLoadRequest *) calloc(1, sizeof(SampleLoadRequest));
+  request->type = type;
+  request->soundfiler = soundfiler;
+  request->path = StaticUtils::copyString((char *) path);
+  request->numTables = numTables;
+  request->tableNames = (char **) calloc(numTables, sizeof(char *));
+  request->tableLengths = (int *) calloc(numTables, sizeof(int));
+  request->tableBuffers = (float **) calloc(numTables, sizeof(float *));
+  request->maxFrames = -1;
+  return request;
+}
+
+void SampleLoader::deleteRequest(SampleLoadRequest *request) {
+  for (int i = 0; i < request->numTables; i++) {
+    free(request->tableNames[i]);
+    free(request->tableBuffers[i]);
+  }
+  free(request->tableNames);
+  free(request->tableLengths);
+  free(request->tableBuffers);
+  free(request->path);
+  if (request->sample != NULL) {
+    SampleCache::release(request->sample);
+  }
+  free(request);
+}
+
+bool SampleLoader::submit(SampleLoadRequest *request) {
+  // every request is eventually deleted by the disk thread, so that no queue can overflow
+  if (numSubmittedRequests - numDeletedRequests >= MAX_SAMPLE_LOAD_REQUESTS) {
+    deleteRequest(request);
+    return false;
+  }
+  numSubmittedRequests++;
+  outstandingRequestList->add(request);
+  requestQueue->push(request);
+  return true;
+}
+
+void SampleLoader::dispatchCompletedRequests() {
+  SampleLoadRequest *request = NULL;
+  while ((request = (SampleLoadRequest *) completionQueue->pop()) != NULL ||
+      (waitsForDisk && outstandingRequestList->size() > 0)) {
+    if (request == NULL) {
+      usleep(100); // wait for the disk thread to complete the outstanding requests
+      continue;
+    }
+    outstandingRequestList->remove(outstandingRequestList->indexOf(request));
+    if (request->soundfiler != NULL) {
+      request->soundfiler->completeRequest(request);
+    }
+    disposalQueue->push(request);
+  }
+}
+
+void SampleLoader::cancelRequests(MessageSoundfiler *soundfiler) {
+  for (int i = 0; i < outstandingRequestList->size(); i++) {
+    SampleLoadRequest *request = (SampleLoadRequest *) outstandingRequestList->get(i);
+    if (request->soundfiler == soundfiler) {
+      request->soundfiler = NULL;
+    }
+  }
+}
+
+bool SampleLoader::service() {
+  bool didWork = false;
+  SampleLoadRequest *request = NULL;
+  while ((request = (SampleLoadRequest *) disposalQueue->pop()) != NULL) {
+    deleteRequest(request);
+    numDeletedRequests++;
+    didWork = true;
+  }
+  
+  if (currentRequest == NULL) {
+    currentRequest = (SampleLoadRequest *) requestQueue->pop();
+  }
+  if (currentRequest != NULL) {
+    bool isComplete = true;
+    if (currentRequest->type == SAMPLE_LOAD_READ) {
+      isComplete = serviceRead(currentRequest);
+    } else {
+      serviceWrite(currentRequest);
+    }
+    if (isComplete) {
+      completionQueue->push(currentRequest);
+      currentRequest = NULL;
+    }
+    didWork = true;
+  }
+  return didWork;
+}
+
+void SampleLoader::finish() {
+  // abandon the current request. It is deleted along with the other outstanding requests.
+  currentRequest = NULL;
+}
+
+bool SampleLoader::serviceRead(SampleLoadRequest *request) {
+  if (request->sample == NULL) {
+    request->sample = SampleCache::acquire(request->path);
+    if (request->sample == NULL) {
+      request->didFail = true;
+      return true;
+    }
+  }
+  if (!SampleCache::decode(request->sample, SAMPLE_LOADER_DECODE_FRAMES)) {
+    return false;
+  }
+  
+  CachedSample *sample = request->sample;
+  int numFrames = sample->numFrames - request->skipFrames;
+  numFrames = (numFrames > 0) ? numFrames : 0;
+  if (request->maxFrames >= 0 && numFrames > request->maxFrames) {
+    numFrames = request->maxFrames;
+  }
+  if (!request->shouldResize) {
+    // without -resize, only as many frames as fit into the smallest table are read
+    for (int i = 0; i < request->numTables; i++) {
+      if (request->tableLengths[i] >= 0 && request->tableLengths[i] < numFrames) {
+        numFrames = request->tableLengths[i];
+      }
+    }
+  }
+  request->numFrames = numFrames;
+  
+  // tables which exactly cover a channel use it directly. The others are prepared here.
+  for (int i = 0; i < request->numTables; i++) {
+    int length = request->shouldResize ? ((numFrames > 0) ? numFrames : 1) : request->tableLengths[i];
+    if (length >= 0 && !(i < sample->numChannels && length == numFrames)) {
+      float *storage = DspTable::newStorage(length);
+      if (storage != NULL && i < sample->numChannels) {
+        memcpy(storage + DSP_TABLE_GUARD_LENGTH, sample->channels[i] + request->skipFrames,
+            numFrames * sizeof(float));
+      }
+      request->tableBuffers[i] = storage;
+    }
+  }
+  return true;
+}
+
+void SampleLoader::serviceWrite(SampleLoadRequest *request) {
+  SF_INFO info;
+  memset(&info, 0, sizeof(SF_INFO));
+  info.samplerate = request->sampleRate;
+  info.channels = request->numTables;
+  switch (request->bitsPerSample) {
+    case 24: info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_24; break;
+    case 32: info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT; break;
+    default: info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16; break;
+  }
+  SNDFILE *file = sf_open(request->path, SFM_WRITE, &info);
+  if (file == NULL) {
+    request->didFail = true;
+    return;
+  }
+  
+  // interleave the tables into the file
+  int numChannels = request->numTables;
+  float *buffer = (float *) malloc(SAMPLE_LOADER_WRITE_FRAMES * numChannels * sizeof(float));
+  int numWrittenFrames = 0;
+  for (int i = 0; i < request->numFrames; i += SAMPLE_LOADER_WRITE_FRAMES) {
+    int numFrames = request->numFrames - i;
+    numFrames = (numFrames < SAMPLE_LOADER_WRITE_FRAMES) ? numFrames : SAMPLE_LOADER_WRITE_FRAMES;
+    for (int j = 0; j < numChannels; j++) {
+      float *channel = request->tableBuffers[j] + i;
+      for (int k = 0, m = j; k < numFrames; k++, m += numChannels) {
+        buffer[m] = channel[k];
+      }
+    }
+    numWrittenFrames += (int) sf_writef_float(file, buffer, numFrames);
+  }
+  free(buffer);
+  sf_close(file);
+  request->numFrames = numWrittenFrames;
+}
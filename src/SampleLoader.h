@@ -0,0 +1,140 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _SAMPLE_LOADER_H_
+#define _SAMPLE_LOADER_H_
+
+#include "DiskClient.h"
+
+struct CachedSample;
+class List;
+class LockFreeQueue;
+class MessageSoundfiler;
+
+typedef enum {
+  SAMPLE_LOAD_READ,
+  SAMPLE_LOAD_WRITE
+} SampleLoadRequestType;
+
+/**
+ * A [soundfiler] operation which is performed by the disk thread. The request is created by the
+ * audio thread, serviced by the disk thread, returned to the audio thread to be completed, and
+ * finally deleted by the disk thread.
+ */
+typedef struct SampleLoadRequest {
+  SampleLoadRequestType type;
+  
+  /** The requesting object. It is <code>NULL</code> if the object has been deleted in the meantime. */
+  MessageSoundfiler *soundfiler;
+  char *path;
+  int numTables;
+  char **tableNames;
+  
+  /** The length of each table when the request was made, or -1 if the table did not exist. */
+  int *tableLengths;
+  
+  /**
+   * Reading: storage prepared for each table, or <code>NULL</code> where the table uses the cached
+   * sample directly. Writing: a copy of the contents of each table.
+   */
+  float **tableBuffers;
+  
+  bool shouldResize;
+  int skipFrames;
+  int maxFrames;
+  int bitsPerSample;
+  int sampleRate;
+  
+  // the results
+  struct CachedSample *sample;
+  int numFrames;
+  bool didFail;
+} SampleLoadRequest;
+
+/**
+ * The <code>SampleLoader</code> performs the file operations of all [soundfiler]s of a graph on
+ * the disk thread. Files are read via the <code>SampleCache</code>, so that tables share the decoded
+ * sample data wherever possible. Completed requests are returned to their [soundfiler]s at the
+ * beginning of a block.
+ */
+class SampleLoader : public DiskClient {
+  
+  public:
+    SampleLoader();
+    ~SampleLoader();
+  
+    /** Returns a new request of the given type, to be filled in and submitted. */
+    static SampleLoadRequest *newRequest(SampleLoadRequestType type, MessageSoundfiler *soundfiler,
+        const char *path, int numTables);
+  
+    /**
+     * Submits a request to the disk thread. Returns <code>false</code> if too many requests are
+     * outstanding, in which case the request is deleted. May only be called by the audio thread.
+     */
+    bool submit(SampleLoadRequest *request);
+  
+    /**
+     * Passes all completed requests to their [soundfiler]s. Called at the beginning of every block.
+     * May only be called by the audio thread.
+     */
+    void dispatchCompletedRequests();
+  
+    /** Detaches a [soundfiler] which is being deleted from its outstanding requests. */
+    void cancelRequests(MessageSoundfiler *soundfiler);
+  
+    bool service();
+    void finish();
+  
+    /**
+     * If set, <code>dispatchCompletedRequests()</code> waits for all outstanding requests to complete,
+     * such that offline renders are deterministic.
+     */
+    void setWaitsForDisk(bool waitsForDisk) { this->waitsForDisk = waitsForDisk; }
+  
+  private:
+    /** Reads the file of the request. Returns <code>true</code> once the request is complete. */
+    bool serviceRead(SampleLoadRequest *request);
+    void serviceWrite(SampleLoadRequest *request);
+    static void deleteRequest(SampleLoadRequest *request);
+  
+    /** Requests travelling from the audio thread to the disk thread. */
+    LockFreeQueue *requestQueue;
+  
+    /** Serviced requests returning to the audio thread. */
+    LockFreeQueue *completionQueue;
+  
+    /** Completed requests to be deleted by the disk thread. */
+    LockFreeQueue *disposalQueue;
+  
+    /** Requests which have been submitted but not yet completed. Only used by the audio thread. */
+    List *outstandingRequestList;
+  
+    /** The number of requests submitted by the audio thread, and deleted by the disk thread. */
+    unsigned int numSubmittedRequests;
+    volatile unsigned int numDeletedRequests;
+  
+    /** The request being serviced by the disk thread. Reading a file may take many calls to service(). */
+    SampleLoadRequest *currentRequest;
+    volatile bool waitsForDisk;
+};
+
+#endif // _SAMPLE_LOADER_H_
@@ -0,0 +1,375 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "LockFreeQueue.h"
+#include "SoundfileStream.h"
+
+/** The length of one chunk, in frames. Each chunk is read or written with a single call. */
+#define SOUNDFILE_STREAM_CHUNK_LENGTH 4096
+
+/** The number of open and close requests which may be outstanding at one time. */
+#define NUM_SOUNDFILE_STREAM_COMMANDS 8
+
+/** How long the audio thread sleeps while waiting for the disk, in microseconds. */
+#define SOUNDFILE_STREAM_WAIT_INTERVAL 100
+
+SoundfileStream::SoundfileStream(SoundfileStreamDirection direction, int numChannels,
+    int numBufferedFrames) {
+  this->direction = direction;
+  this->numChannels = (numChannels < 1) ? 1 : numChannels;
+  numFramesPerChunk = SOUNDFILE_STREAM_CHUNK_LENGTH;
+  numChunks = (numBufferedFrames + numFramesPerChunk - 1) / numFramesPerChunk;
+  if (numChunks < 2) {
+    numChunks = 2; // one chunk is always in the hands of the audio thread
+  }
+  
+  chunks = (SoundfileStreamChunk *) malloc(numChunks * sizeof(SoundfileStreamChunk));
+  filledChunkQueue = new LockFreeQueue(numChunks);
+  emptyChunkQueue = new LockFreeQueue(numChunks);
+  for (int i = 0; i < numChunks; i++) {
+    chunks[i].buffer = (float *) malloc(numFramesPerChunk * this->numChannels * sizeof(float));
+    chunks[i].numFrames = 0;
+    chunks[i].generation = 0;
+    chunks[i].isEndOfFile = false;
+    emptyChunkQueue->push(&chunks[i]);
+  }
+  
+  commands = (SoundfileStreamCommand *) malloc(NUM_SOUNDFILE_STREAM_COMMANDS * sizeof(SoundfileStreamCommand));
+  commandQueue = new LockFreeQueue(NUM_SOUNDFILE_STREAM_COMMANDS);
+  freeCommandQueue = new LockFreeQueue(NUM_SOUNDFILE_STREAM_COMMANDS);
+  for (int i = 0; i < NUM_SOUNDFILE_STREAM_COMMANDS; i++) {
+    freeCommandQueue->push(&commands[i]);
+  }
+  
+  generation = 0;
+  currentChunk = NULL;
+  currentChunkPosition = 0;
+  numDropouts = 0;
+  waitsForDisk = false;
+  hasOpenFailed = false;
+  
+  file = NULL;
+  fileGeneration = 0;
+  isFilling = false;
+  numFileChannels = 0;
+  fileBuffer = NULL;
+}
+
+SoundfileStream::~SoundfileStream() {
+  closeFile();
+  for (int i = 0; i < numChunks; i++) {
+    free(chunks[i].buffer);
+  }
+  free(chunks);
+  free(commands);
+  free(fileBuffer);
+  delete filledChunkQueue;
+  delete emptyChunkQueue;
+  delete commandQueue;
+  delete freeCommandQueue;
+}
+
+
+bool SoundfileStream::requestOpen(const char *directory, const char *filename, int onsetFrames,
+    int bitsPerSample, int sampleRate) {
+  hasOpenFailed = false;
+  return sendCommand(SOUNDFILE_STREAM_OPEN, directory, filename, onsetFrames, bitsPerSample, sampleRate);
+}
+
+bool SoundfileStream::requestClose() {
+  return sendCommand(SOUNDFILE_STREAM_CLOSE, NULL, NULL, 0, 0, 0);
+}
+
+bool SoundfileStream::sendCommand(SoundfileStreamCommandType type, const char *directory,
+    const char *filename, int onsetFrames, int bitsPerSample, int sampleRate) {
+  SoundfileStreamCommand *command = (SoundfileStreamCommand *) freeCommandQueue->pop();
+  if (command == NULL) {
+    return false; // the disk thread has not yet caught up with previous requests
+  }
+  
+  if (direction == SOUNDFILE_STREAM_WRITE) {
+    // everything written so far belongs to the current file
+    if (currentChunk != NULL && currentChunk->numFrames > 0) {
+      filledChunkQueue->push(currentChunk);
+      currentChunk = NULL;
+    }
+  } else {
+    // everything read ahead so far belongs to the previous file
+    if (currentChunk != NULL) {
+      emptyChunkQueue->push(currentChunk);
+      currentChunk = NULL;
+    }
+    recycleFilledChunks();
+  }
+  
+  command->type = type;
+  command->generation = ++generation;
+  if (currentChunk != NULL) {
+    currentChunk->generation = generation; // an empty chunk kept by a writing stream
+  }
+  command->path[0] = '\0';
+  if (filename != NULL) {
+    // the path is assembled in place so that no memory is allocated on the audio thread
+    snprintf(command->path, SOUNDFILE_STREAM_PATH_LENGTH, "%s%s",
+        (filename[0] == '/' || directory == NULL) ? "" : directory, filename);
+  }
+  command->onsetFrames = onsetFrames;
+  command->bitsPerSample = bitsPerSample;
+  command->sampleRate = sampleRate;
+  commandQueue->push(command);
+  return true;
+}
+
+void SoundfileStream::recycleFilledChunks() {
+  SoundfileStreamChunk *chunk = NULL;
+  while ((chunk = (SoundfileStreamChunk *) filledChunkQueue->pop()) != NULL) {
+    emptyChunkQueue->push(chunk);
+  }
+}
+
+bool SoundfileStream::read(float **channelBuffers, int startIndex, int endIndex) {
+  bool isEndOfFile = false;
+  int index = startIndex;
+  while (index < endIndex) {
+    if (currentChunk == NULL) {
+      currentChunk = (SoundfileStreamChunk *) filledChunkQueue->pop();
+      if (currentChunk == NULL) {
+        if (waitsForDisk) {
+          usleep(SOUNDFILE_STREAM_WAIT_INTERVAL);
+          continue;
+        }
+        numDropouts++; // the disk thread has fallen behind
+        break;
+      } else if (currentChunk->generation != generation) {
+        // left over from a previous file
+        emptyChunkQueue->push(currentChunk);
+        currentChunk = NULL;
+        continue;
+      }
+      currentChunkPosition = 0;
+    }
+    
+    int numFrames = currentChunk->numFrames - currentChunkPosition;
+    if (numFrames > endIndex - index) {
+      numFrames = endIndex - index;
+    }
+    for (int i = 0; i < numChannels; i++) {
+      float *channelBuffer = channelBuffers[i] + index;
+      float *interleavedBuffer = currentChunk->buffer + (currentChunkPosition * numChannels) + i;
+      for (int j = 0; j < numFrames; j++, interleavedBuffer += numChannels) {
+        channelBuffer[j] = *interleavedBuffer;
+      }
+    }
+    index += numFrames;
+    currentChunkPosition += numFrames;
+    
+    if (currentChunkPosition == currentChunk->numFrames) {
+      isEndOfFile = currentChunk->isEndOfFile;
+      emptyChunkQueue->push(currentChunk);
+      currentChunk = NULL;
+      if (isEndOfFile) {
+        break;
+      }
+    }
+  }
+  
+  // fill whatever could not be read with silence
+  if (index < endIndex) {
+    for (int i = 0; i < numChannels; i++) {
+      memset(channelBuffers[i] + index, 0, (endIndex - index) * sizeof(float));
+    }
+  }
+  return isEndOfFile;
+}
+
+void SoundfileStream::write(float **channelBuffers, int startIndex, int endIndex) {
+  int index = startIndex;
+  while (index < endIndex) {
+    if (currentChunk == NULL) {
+      currentChunk = (SoundfileStreamChunk *) emptyChunkQueue->pop();
+      if (currentChunk == NULL) {
+        if (waitsForDisk) {
+          usleep(SOUNDFILE_STREAM_WAIT_INTERVAL);
+          continue;
+        }
+        numDropouts++; // the disk thread has fallen behind. The audio is lost.
+        return;
+      }
+      currentChunk->numFrames = 0;
+      currentChunk->generation = generation;
+    }
+    
+    int numFrames = numFramesPerChunk - currentChunk->numFrames;
+    if (numFrames > endIndex - index) {
+      numFrames = endIndex - index;
+    }
+    for (int i = 0; i < numChannels; i++) {
+      float *channelBuffer = channelBuffers[i] + index;
+      float *interleavedBuffer = currentChunk->buffer + (currentChunk->numFrames * numChannels) + i;
+      for (int j = 0; j < numFrames; j++, interleavedBuffer += numChannels) {
+        *interleavedBuffer = channelBuffer[j];
+      }
+    }
+    index += numFrames;
+    currentChunk->numFrames += numFrames;
+    
+    if (currentChunk->numFrames == numFramesPerChunk) {
+      filledChunkQueue->push(currentChunk);
+      currentChunk = NULL;
+    }
+  }
+}
+
+
+bool SoundfileStream::service() {
+  bool didWork = false;
+  SoundfileStreamCommand *command = NULL;
+  if (direction == SOUNDFILE_STREAM_READ) {
+    while ((command = (SoundfileStreamCommand *) commandQueue->pop()) != NULL) {
+      executeCommand(command);
+      freeCommandQueue->push(command);
+      didWork = true;
+    }
+    didWork |= fillChunks();
+  } else {
+    // audio must be written to the file which was open when it was produced. Commands are
+    // therefore only executed once all chunks of preceding generations have been written.
+    do {
+      command = (SoundfileStreamCommand *) commandQueue->peek();
+      didWork |= writeChunks(command);
+      if (command != NULL) {
+        commandQueue->pop();
+        executeCommand(command);
+        freeCommandQueue->push(command);
+        didWork = true;
+      }
+    } while (command != NULL);
+  }
+  return didWork;
+}
+
+void SoundfileStream::finish() {
+  while (service());
+  closeFile();
+}
+
+void SoundfileStream::executeCommand(SoundfileStreamCommand *command) {
+  closeFile();
+  fileGeneration = command->generation;
+  isFilling = false;
+  if (command->type == SOUNDFILE_STREAM_CLOSE) {
+    return;
+  }
+  
+  SF_INFO info;
+  memset(&info, 0, sizeof(SF_INFO));
+  if (direction == SOUNDFILE_STREAM_READ) {
+    file = sf_open(command->path, SFM_READ, &info);
+    if (file != NULL) {
+      if (command->onsetFrames > 0) {
+        sf_seek(file, command->onsetFrames, SEEK_SET);
+      }
+      if (info.channels != numChannels) {
+        fileBuffer = (float *) realloc(fileBuffer, numFramesPerChunk * info.channels * sizeof(float));
+      }
+      numFileChannels = info.channels;
+    }
+    // a file which could not be opened is treated as an empty one
+    isFilling = true;
+  } else {
+    info.samplerate = command->sampleRate;
+    info.channels = numChannels;
+    switch (command->bitsPerSample) {
+      case 24: info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_24; break;
+      case 32: info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT; break;
+      default: info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16; break;
+    }
+    file = sf_open(command->path, SFM_WRITE, &info);
+  }
+  if (file == NULL) {
+    hasOpenFailed = true;
+  }
+}
+
+void SoundfileStream::closeFile() {
+  if (file != NULL) {
+    sf_close(file);
+    file = NULL;
+  }
+}
+
+bool SoundfileStream::fillChunks() {
+  bool didWork = false;
+  while (isFilling) {
+    SoundfileStreamChunk *chunk = (SoundfileStreamChunk *) emptyChunkQueue->pop();
+    if (chunk == NULL) {
+      break; // the read-ahead is full
+    }
+    chunk->generation = fileGeneration;
+    if (file == NULL) {
+      chunk->numFrames = 0;
+    } else if (numFileChannels == numChannels) {
+      chunk->numFrames = (int) sf_readf_float(file, chunk->buffer, numFramesPerChunk);
+    } else {
+      // take as many channels from the file as the stream has, and leave any others silent
+      chunk->numFrames = (int) sf_readf_float(file, fileBuffer, numFramesPerChunk);
+      int numCopiedChannels = (numFileChannels < numChannels) ? numFileChannels : numChannels;
+      for (int i = 0; i < chunk->numFrames; i++) {
+        float *inputFrame = fileBuffer + (i * numFileChannels);
+        float *outputFrame = chunk->buffer + (i * numChannels);
+        for (int j = 0; j < numCopiedChannels; j++) {
+          outputFrame[j] = inputFrame[j];
+        }
+        for (int j = numCopiedChannels; j < numChannels; j++) {
+          outputFrame[j] = 0.0f;
+        }
+      }
+    }
+    chunk->isEndOfFile = (chunk->numFrames < numFramesPerChunk);
+    if (chunk->isEndOfFile) {
+      closeFile();
+      isFilling = false;
+    }
+    filledChunkQueue->push(chunk);
+    didWork = true;
+  }
+  return didWork;
+}
+
+bool SoundfileStream::writeChunks(SoundfileStreamCommand *nextCommand) {
+  bool didWork = false;
+  SoundfileStreamChunk *chunk = NULL;
+  while ((chunk = (SoundfileStreamChunk *) filledChunkQueue->peek()) != NULL &&
+      (nextCommand == NULL || (int) (chunk->generation - nextCommand->generation) < 0)) {
+    filledChunkQueue->pop();
+    if (file != NULL && chunk->generation == fileGeneration) {
+      sf_writef_float(file, chunk->buffer, chunk->numFrames);
+    }
+    emptyChunkQueue->push(chunk);
+    didWork = true;
+  }
+  return didWork;
+}
@@ -0,0 +1,185 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _SOUNDFILE_STREAM_H_
+#define _SOUNDFILE_STREAM_H_
+
+#include <sndfile.h>
+#include "DiskClient.h"
+
+class LockFreeQueue;
+
+/** The maximum length of a file path which can be passed to a stream. */
+#define SOUNDFILE_STREAM_PATH_LENGTH 1024
+
+typedef enum {
+  SOUNDFILE_STREAM_READ,
+  SOUNDFILE_STREAM_WRITE
+} SoundfileStreamDirection;
+
+typedef enum {
+  SOUNDFILE_STREAM_OPEN,
+  SOUNDFILE_STREAM_CLOSE
+} SoundfileStreamCommandType;
+
+/** A block of interleaved frames travelling between the audio thread and the disk thread. */
+typedef struct {
+  float *buffer;
+  int numFrames;
+  unsigned int generation;
+  bool isEndOfFile;
+} SoundfileStreamChunk;
+
+/** A request from the audio thread to the disk thread to open or close a file. */
+typedef struct {
+  SoundfileStreamCommandType type;
+  unsigned int generation;
+  char path[SOUNDFILE_STREAM_PATH_LENGTH];
+  int onsetFrames;
+  int bitsPerSample;
+  int sampleRate;
+} SoundfileStreamCommand;
+
+/**
+ * A <code>SoundfileStream</code> moves audio between one sound file and one audio object without
+ * the audio thread ever touching the disk. Audio is exchanged in fixed-size chunks through
+ * lock-free queues, and files are opened and closed by commands passed the same way. All file
+ * access happens in <code>service()</code>, which is called by the disk thread of the
+ * <code>DiskStreamer</code>.
+ *
+ * Every open or close request starts a new generation. Chunks are tagged with the generation to
+ * which they belong, so that data from a previous file is never mistaken for data from the current
+ * one, and no queue needs to be flushed from the audio thread.
+ */
+class SoundfileStream : public DiskClient {
+  
+  public:
+    /**
+     * Creates a stream for the given number of channels. <code>numBufferedFrames</code> is the
+     * amount of audio held in memory, i.e. the read-ahead of a reading stream or the amount of
+     * output which may be waiting for the disk in a writing stream.
+     */
+    SoundfileStream(SoundfileStreamDirection direction, int numChannels, int numBufferedFrames);
+    ~SoundfileStream();
+  
+    /**
+     * Requests that the given file is opened. Relative paths are resolved against
+     * <code>directory</code>. Reading begins at the frame <code>onsetFrames</code>. Written files
+     * are WAV files with the given sample format. Returns <code>false</code> if the request could
+     * not be made because too many are outstanding. May only be called by the audio thread.
+     */
+    bool requestOpen(const char *directory, const char *filename, int onsetFrames,
+        int bitsPerSample, int sampleRate);
+  
+    /**
+     * Requests that the current file is closed. All audio which has been written up to this point
+     * will reach the file. May only be called by the audio thread.
+     */
+    bool requestClose();
+  
+    /**
+     * Reads frames <code>startIndex</code> to <code>endIndex</code> of the given channel buffers
+     * from the stream. Missing audio (if the disk cannot keep up) is replaced with silence.
+     * Returns <code>true</code> if the end of the file has been reached, in which case the
+     * remainder of the range is silent. May only be called by the audio thread.
+     */
+    bool read(float **channelBuffers, int startIndex, int endIndex);
+  
+    /**
+     * Writes frames <code>startIndex</code> to <code>endIndex</code> of the given channel buffers
+     * to the stream. If the disk cannot keep up then the audio is dropped. May only be called by
+     * the audio thread.
+     */
+    void write(float **channelBuffers, int startIndex, int endIndex);
+  
+    /**
+     * If set, <code>read()</code> and <code>write()</code> wait for the disk instead of dropping
+     * audio. This is only appropriate when the graph is not run in real time.
+     */
+    void setWaitsForDisk(bool waitsForDisk) { this->waitsForDisk = waitsForDisk; }
+  
+    /** Returns <code>true</code> if the last requested file could not be opened. */
+    inline bool didOpenFail() { return hasOpenFailed; }
+  
+    /** The number of times that audio was not available in time (reading) or was dropped (writing). */
+    inline int getNumDropouts() { return numDropouts; }
+  
+    /**
+     * Performs all pending file operations. Returns <code>true</code> if any work was done.
+     * May only be called by the disk thread.
+     */
+    bool service();
+  
+    /** Performs all pending operations and closes the file. Called when the stream is retired. */
+    void finish();
+  
+  private:
+    bool sendCommand(SoundfileStreamCommandType type, const char *directory, const char *filename,
+        int onsetFrames, int bitsPerSample, int sampleRate);
+    void executeCommand(SoundfileStreamCommand *command);
+    void closeFile();
+    void recycleFilledChunks();
+    bool fillChunks();
+    bool writeChunks(SoundfileStreamCommand *nextCommand);
+  
+    SoundfileStreamDirection direction;
+    int numChannels;
+    int numFramesPerChunk;
+    int numChunks;
+    SoundfileStreamChunk *chunks;
+    SoundfileStreamCommand *commands;
+  
+    /** Chunks travelling from the producer to the consumer of audio. */
+    LockFreeQueue *filledChunkQueue;
+  
+    /** Chunks returning from the consumer to the producer of audio. */
+    LockFreeQueue *emptyChunkQueue;
+  
+    /** Commands travelling from the audio thread to the disk thread. */
+    LockFreeQueue *commandQueue;
+  
+    /** Processed commands returning to the audio thread. */
+    LockFreeQueue *freeCommandQueue;
+  
+    // the following are only used by the audio thread
+    unsigned int generation;
+    SoundfileStreamChunk *currentChunk;
+    int currentChunkPosition;
+    int numDropouts;
+    volatile bool waitsForDisk;
+  
+    /** Set by the disk thread if a file could not be opened. Reset by the audio thread. */
+    volatile bool hasOpenFailed;
+  
+    // the following are only used by the disk thread
+    SNDFILE *file;
+    unsigned int fileGeneration;
+  
+    /** Indicates that a reading stream has not yet delivered the end of the current file. */
+    bool isFilling;
+  
+    /** The number of channels in the file being read, and a buffer for remapping them. */
+    int numFileChannels;
+    float *fileBuffer;
+};
+
+#endif // _SOUNDFILE_STREAM_H_
@@ -0,0 +1,277 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "TextSequence.h"
+
+/** Longer tokens in a file are truncated. */
+#define TEXT_SEQUENCE_MAX_TOKEN_LENGTH 1024
+
+/** The initial capacity of the line and atom arrays. They grow by doubling. */
+#define TEXT_SEQUENCE_INITIAL_CAPACITY 64
+
+TextSequence::TextSequence() {
+  maxLines = TEXT_SEQUENCE_INITIAL_CAPACITY;
+  lines = (TextSequenceLine *) malloc(maxLines * sizeof(TextSequenceLine));
+  maxAtoms = TEXT_SEQUENCE_INITIAL_CAPACITY;
+  atoms = (TextSequenceAtom *) malloc(maxAtoms * sizeof(TextSequenceAtom));
+  maxSymbolsLength = TEXT_SEQUENCE_INITIAL_CAPACITY;
+  symbols = (char *) malloc(maxSymbolsLength * sizeof(char));
+  clear();
+}
+
+TextSequence::~TextSequence() {
+  free(lines);
+  free(atoms);
+  free(symbols);
+}
+
+void TextSequence::clear() {
+  numLines = 0;
+  numAtoms = 0;
+  symbolsLength = 0;
+  openLineAtomIndex = 0;
+  duration = 0.0;
+}
+
+void TextSequence::ensureCapacity() {
+  if (numLines == maxLines) {
+    maxLines *= 2;
+    lines = (TextSequenceLine *) realloc(lines, maxLines * sizeof(TextSequenceLine));
+  }
+  if (numAtoms == maxAtoms) {
+    maxAtoms *= 2;
+    atoms = (TextSequenceAtom *) realloc(atoms, maxAtoms * sizeof(TextSequenceAtom));
+  }
+}
+
+void TextSequence::addFloat(float constant) {
+  ensureCapacity();
+  atoms[numAtoms].constant = constant;
+  atoms[numAtoms].symbolOffset = -1;
+  numAtoms++;
+}
+
+void TextSequence::addSymbol(const char *symbol, int length) {
+  if (symbolsLength + length + 1 > maxSymbolsLength) {
+    while (symbolsLength + length + 1 > maxSymbolsLength) {
+      maxSymbolsLength *= 2;
+    }
+    symbols = (char *) realloc(symbols, maxSymbolsLength * sizeof(char));
+  }
+  memcpy(symbols + symbolsLength, symbol, length);
+  symbols[symbolsLength + length] = '\0';
+  
+  ensureCapacity();
+  atoms[numAtoms].constant = 0.0f;
+  atoms[numAtoms].symbolOffset = symbolsLength;
+  numAtoms++;
+  symbolsLength += length + 1;
+}
+
+void TextSequence::addToken(char *token) {
+  // Pd writes small and large floats in exponential notation, which isNumeric() does not accept.
+  // Tokens such as "inf" and "nan" remain symbols.
+  char *end = token;
+  double value = 0.0;
+  if ((token[0] >= '0' && token[0] <= '9') || token[0] == '-' || token[0] == '+' || token[0] == '.') {
+    value = strtod(token, &end);
+  }
+  if (end != token && *end == '\0') {
+    addFloat((float) value);
+  } else {
+    addSymbol(token, strlen(token));
+  }
+}
+
+void TextSequence::addElements(PdMessage *message, int startIndex) {
+  for (int i = startIndex; i < message->getNumElements(); i++) {
+    switch (message->getType(i)) {
+      case FLOAT: {
+        addFloat(message->getFloat(i));
+        break;
+      }
+      case SYMBOL: {
+        addSymbol(message->getSymbol(i), strlen(message->getSymbol(i)));
+        break;
+      }
+      default: {
+        addSymbol("bang", 4);
+        break;
+      }
+    }
+  }
+}
+
+void TextSequence::endLine() {
+  if (numAtoms > openLineAtomIndex) {
+    ensureCapacity();
+    TextSequenceLine *line = lines + numLines++;
+    line->onset = duration;
+    line->firstAtomIndex = openLineAtomIndex;
+    line->numAtoms = numAtoms - openLineAtomIndex;
+    if (atoms[openLineAtomIndex].symbolOffset < 0 && atoms[openLineAtomIndex].constant > 0.0f) {
+      duration += (double) atoms[openLineAtomIndex].constant; // negative waits do not go back in time
+    }
+    openLineAtomIndex = numAtoms;
+  }
+}
+
+bool TextSequence::read(const char *path, bool isLineTerminated) {
+  clear();
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    close(fd);
+    return false;
+  }
+  if (fileStat.st_size == 0) {
+    close(fd);
+    return true; // an empty file cannot be mapped, but is a valid (empty) sequence
+  }
+  char *data = (char *) mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping remains valid
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  madvise(data, fileStat.st_size, MADV_SEQUENTIAL);
+  
+  char token[TEXT_SEQUENCE_MAX_TOKEN_LENGTH + 1];
+  int tokenLength = 0;
+  for (off_t i = 0; i < fileStat.st_size; i++) {
+    char c = data[i];
+    switch (c) {
+      case '\\': {
+        // the next character is part of the token, whatever it is
+        if (++i < fileStat.st_size && tokenLength < TEXT_SEQUENCE_MAX_TOKEN_LENGTH) {
+          token[tokenLength++] = data[i];
+        }
+        break;
+      }
+      case ' ':
+      case '\t':
+      case '\r':
+      case '\n':
+      case ';':
+      case ',': {
+        if (tokenLength > 0) {
+          token[tokenLength] = '\0';
+          addToken(token);
+          tokenLength = 0;
+        }
+        if (c == ';' || c == ',' || (c == '\n' && isLineTerminated)) {
+          endLine();
+        }
+        break;
+      }
+      default: {
+        if (tokenLength < TEXT_SEQUENCE_MAX_TOKEN_LENGTH) {
+          token[tokenLength++] = c;
+        }
+        break;
+      }
+    }
+  }
+  if (tokenLength > 0) {
+    token[tokenLength] = '\0';
+    addToken(token);
+  }
+  endLine(); // the last line need not be terminated
+  
+  munmap(data, fileStat.st_size);
+  return true;
+}
+
+bool TextSequence::write(const char *path, bool isLineTerminated) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    return false;
+  }
+  char buffer[TEXT_SEQUENCE_MAX_TOKEN_LENGTH * 4];
+  for (int i = 0; i < numLines; i++) {
+    lineToString(i, buffer, sizeof(buffer));
+    fprintf(file, isLineTerminated ? "%s\n" : "%s;\n", buffer);
+  }
+  return fclose(file) == 0;
+}
+
+void TextSequence::copyLineToMessage(int lineIndex, int startIndex, PdMessage *message) {
+  TextSequenceLine *line = lines + lineIndex;
+  int numElements = line->numAtoms - startIndex;
+  // elements are only (de-)allocated if the length of the message changes
+  if (message->getNumElements() != ((numElements > 0) ? numElements : 1)) {
+    ZGTime timestamp = message->getTimestamp();
+    message->clear();
+    message->setTimestamp(timestamp);
+    for (int i = (numElements > 0) ? numElements : 1; i > 0; i--) {
+      message->addElement(new MessageElement());
+    }
+  }
+  if (numElements <= 0) {
+    message->getElement(0)->setBang();
+  } else {
+    TextSequenceAtom *atom = atoms + line->firstAtomIndex + startIndex;
+    for (int i = 0; i < numElements; i++, atom++) {
+      if (atom->symbolOffset < 0) {
+        message->setFloat(i, atom->constant);
+      } else {
+        message->setSymbol(i, symbols + atom->symbolOffset);
+      }
+    }
+  }
+}
+
+int TextSequence::lineToString(int lineIndex, char *buffer, int bufferLength) {
+  TextSequenceLine *line = lines + lineIndex;
+  int pos = 0;
+  buffer[0] = '\0';
+  for (int i = 0; i < line->numAtoms && pos < bufferLength-1; i++) {
+    TextSequenceAtom *atom = atoms + line->firstAtomIndex + i;
+    if (i > 0) {
+      buffer[pos++] = ' ';
+    }
+    if (atom->symbolOffset < 0) {
+      pos += snprintf(buffer + pos, bufferLength - pos, "%g", atom->constant);
+    } else {
+      for (char *s = symbols + atom->symbolOffset; *s != '\0' && pos < bufferLength-2; s++) {
+        if (*s == ';' || *s == ',' || *s == '\\' || *s == ' ' || *s == '$') {
+          buffer[pos++] = '\\';
+        }
+        buffer[pos++] = *s;
+      }
+    }
+  }
+  if (pos > bufferLength-1) {
+    pos = bufferLength-1;
+  }
+  buffer[pos] = '\0';
+  return pos;
+}
@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _TEXT_SEQUENCE_H_
+#define _TEXT_SEQUENCE_H_
+
+#include "PdMessage.h"
+
+/** One element of a line. Symbols are stored in the symbol pool of the sequence. */
+typedef struct {
+  float constant;
+  int symbolOffset; // negative for a float
+} TextSequenceAtom;
+
+/** One line (message) of a sequence. */
+typedef struct {
+  double onset; // the sum of the waits of all previous lines, in milliseconds
+  int firstAtomIndex;
+  int numAtoms;
+} TextSequenceLine;
+
+/**
+ * The contents of [textfile] and [qlist], in Pd's text format: lines of floats and symbols,
+ * terminated by semicolons. All lines are kept in a single array and all elements in another, in
+ * the order in which they were added, such that hundreds of thousands of lines take little memory
+ * and no allocations are made per line. A line which starts with a float is a wait of that many
+ * milliseconds for a [qlist], and so the onset of each line is known as soon as it is added. The
+ * lines are thereby sorted in time, and a player only needs to advance an index.
+ */
+class TextSequence {
+  
+  public:
+    TextSequence();
+    ~TextSequence();
+  
+    /** Removes all lines. */
+    void clear();
+  
+    /** Appends the elements of the given message, from <code>startIndex</code> on, to the open line. */
+    void addElements(PdMessage *message, int startIndex);
+  
+    /** Terminates the open line. Empty lines are ignored. */
+    void endLine();
+  
+    /**
+     * Replaces the contents with those of the file at the given path, which is mapped into memory
+     * and parsed in place. If <code>isLineTerminated</code> is <code>true</code>, then a line
+     * break terminates a line, as does a semicolon. Returns <code>false</code> if the file cannot
+     * be read, in which case the sequence is empty.
+     */
+    bool read(const char *path, bool isLineTerminated);
+  
+    /** Writes all lines to the given file. Returns <code>false</code> if it cannot be written. */
+    bool write(const char *path, bool isLineTerminated);
+  
+    inline int getNumLines() { return numLines; }
+  
+    /** Returns the onset of the given line. The onset of the end of the sequence may also be requested. */
+    inline double getOnset(int lineIndex) {
+      return (lineIndex < numLines) ? lines[lineIndex].onset : duration;
+    }
+  
+    inline int getNumElements(int lineIndex) { return lines[lineIndex].numAtoms; }
+  
+    /** Returns <code>true</code> if the given line starts with a float, i.e. is a wait in a [qlist]. */
+    inline bool isWait(int lineIndex) {
+      return lines[lineIndex].numAtoms > 0 && atoms[lines[lineIndex].firstAtomIndex].symbolOffset < 0;
+    }
+  
+    /** Returns the given element of a line if it is a symbol, otherwise <code>NULL</code>. */
+    inline char *getSymbol(int lineIndex, int elementIndex) {
+      int symbolOffset = atoms[lines[lineIndex].firstAtomIndex + elementIndex].symbolOffset;
+      return (symbolOffset < 0) ? NULL : symbols + symbolOffset;
+    }
+  
+    /**
+     * Sets the given message to the elements of a line, from <code>startIndex</code> on. If there
+     * are none, then the message is a bang. The timestamp of the message is not changed.
+     */
+    void copyLineToMessage(int lineIndex, int startIndex, PdMessage *message);
+  
+    /**
+     * Writes the given line into the buffer, with spaces between the elements and special
+     * characters escaped. Returns the length of the string.
+     */
+    int lineToString(int lineIndex, char *buffer, int bufferLength);
+  
+  private:
+    /** Appends a float or symbol, parsed from the given null-terminated token, to the open line. */
+    void addToken(char *token);
+  
+    void addFloat(float constant);
+    void addSymbol(const char *symbol, int length);
+  
+    /** Makes room for at least one more atom and one more line. */
+    void ensureCapacity();
+  
+    TextSequenceLine *lines;
+    int numLines;
+    int maxLines;
+  
+    TextSequenceAtom *atoms;
+    int numAtoms;
+    int maxAtoms;
+  
+    /** The null-terminated strings of all symbols, one after another. */
+    char *symbols;
+    int symbolsLength;
+    int maxSymbolsLength;
+  
+    /** The index of the first atom of the open line. */
+    int openLineAtomIndex;
+  
+    /** The onset of the end of the sequence, i.e. the sum of all waits. */
+    double duration;
+};
+
+#endif // _TEXT_SEQUENCE_H_
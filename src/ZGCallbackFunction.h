@@ -25,8 +25,16 @@
 
 /** An enumeration of the different operations available from a graph's callback function. */
 typedef enum {
-  ZG_PRINT_STD, // print to standard out
-  ZG_PRINT_ERR  // print to standard error
+  ZG_PRINT_STD,       // print to standard out
+  ZG_PRINT_ERR,       // print to standard error
+  ZG_RECEIVER_MESSAGE // a message to a registered receiver. The pointer is a ZGReceivedMessage.
 } ZGCallbackFunction;
 
+/** How printed messages are delivered to a graph's callback function. */
+typedef enum {
+  ZG_DELIVER_IMMEDIATELY, // on the printing thread, usually the audio thread (the default)
+  ZG_DELIVER_ON_POLL,     // whenever the host calls zg_poll_events()
+  ZG_DELIVER_ON_THREAD    // on a thread of the graph, every few milliseconds
+} ZGEventDelivery;
+
 #endif // _ZG_CALLBACK_FUNCTION_H_
@@ -166,8 +166,8 @@ void ZGLinkedList::insertAfter(LinkedListNode *nodeA, LinkedListNode *nodeB) {
   } else {
     nodeA->next = nodeB->next;
     nodeA->previous = nodeB;
-    nodeB->next = nodeA;
     nodeB->next->previous = nodeA;
+    nodeB->next = nodeA;
   }
   numElements++;
 }
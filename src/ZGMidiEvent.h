@@ -0,0 +1,45 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _ZG_MIDI_EVENT_H_
+#define _ZG_MIDI_EVENT_H_
+
+/**
+ * A raw channel voice MIDI message, to be delivered with <code>zg_send_midi_events()</code>.
+ * Note on and off (0x90, 0x80), control change (0xB0), channel aftertouch (0xD0) and pitch bend
+ * (0xE0) messages are understood. All others, including running status, are ignored.
+ */
+typedef struct {
+  /**
+   * The position in the next block at which the event occurs, in samples. It behaves in the same
+   * way as the block index given to <code>zg_send_message_at_blockindex()</code>.
+   */
+  double blockIndex;
+  
+  /** The status byte, including the (zero-indexed) channel in its low four bits. */
+  unsigned char status;
+  
+  /** The data bytes. Unused bytes are ignored. */
+  unsigned char data1;
+  unsigned char data2;
+} ZGMidiEvent;
+
+#endif // _ZG_MIDI_EVENT_H_
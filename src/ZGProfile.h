@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _ZG_PROFILE_H_
+#define _ZG_PROFILE_H_
+
+/** The number of buckets in the block render time histogram. */
+#define ZG_PROFILE_HISTOGRAM_LENGTH 32
+
+/** The profile of a single audio object (or subgraph) in a graph. */
+typedef struct {
+  /**
+   * The label of the object, e.g. "osc~". Subgraphs and abstractions are labelled "pd". A chain of
+   * elementwise objects which is computed in one pass is labelled "fused~", and its objects follow
+   * it one level deeper, without any time of their own. Compiled code is labelled "compiled~".
+   */
+  const char *label;
+  
+  /** The depth of the object in the graph hierarchy. Objects in the root graph have depth zero. */
+  int depth;
+  
+  /** The number of times that the object has been processed. */
+  unsigned int numCalls;
+  
+  /** The total time spent processing the object, in nanoseconds. Includes all contained objects in the case of subgraphs. */
+  double totalNs;
+  
+  /** The longest time spent processing the object in any one block, in nanoseconds. */
+  double maxNs;
+} ZGObjectProfile;
+
+/** A snapshot of the profiling statistics of a graph. */
+typedef struct {
+  /** The number of blocks which have been processed since profiling was turned on. */
+  unsigned int numBlocks;
+  
+  /** The total time spent processing all blocks, in nanoseconds. */
+  double totalBlockNs;
+  
+  /** The longest time spent processing one block, in nanoseconds. */
+  double maxBlockNs;
+  
+  /**
+   * A histogram of block render times. Bucket <code>i</code> counts the blocks which took between
+   * 2^i and 2^(i+1) nanoseconds to process.
+   */
+  unsigned int blockHistogram[ZG_PROFILE_HISTOGRAM_LENGTH];
+  
+  /** The number of entries in <code>objects</code>. */
+  int numObjects;
+  
+  /** The profiles of all audio objects, in the order in which they are processed. */
+  ZGObjectProfile *objects;
+} ZGProfile;
+
+#endif // _ZG_PROFILE_H_
@@ -0,0 +1,55 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _ZG_RECEIVED_MESSAGE_H_
+#define _ZG_RECEIVED_MESSAGE_H_
+
+/** The type of an element of a message. */
+typedef enum {
+  ZG_ATOM_FLOAT,
+  ZG_ATOM_SYMBOL,
+  ZG_ATOM_BANG
+} ZGAtomType;
+
+/** An element of a message. Only the field corresponding to the type is defined. */
+typedef struct {
+  ZGAtomType type;
+  float f;
+  const char *s;
+} ZGAtom;
+
+/**
+ * A message which has been sent to a receiver registered with <code>zg_register_receiver()</code>.
+ * It is passed to the callback function with <code>ZG_RECEIVER_MESSAGE</code>, and it (including
+ * all strings) is valid only for the duration of the callback.
+ */
+typedef struct {
+  /** The name of the receiver, e.g. "meter" for messages sent with [send meter]. */
+  const char *receiverName;
+  
+  /** The logical time at which the message was sent, in milliseconds since the graph was created. */
+  double timestamp;
+  
+  int numAtoms;
+  const ZGAtom *atoms;
+} ZGReceivedMessage;
+
+#endif // _ZG_RECEIVED_MESSAGE_H_
@@ -0,0 +1,54 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _ZG_RENDER_OPTIONS_H_
+#define _ZG_RENDER_OPTIONS_H_
+
+/** Options controlling an offline render with <code>zg_render_to_file()</code>. */
+typedef struct {
+  /**
+   * The maximum length of the render, in seconds. If zero or negative, the render continues until
+   * the silence condition is met, in which case <code>silenceSeconds</code> must be positive.
+   */
+  double durationSeconds;
+  
+  /**
+   * The render stops once the output of the graph has stayed below <code>silenceThreshold</code>
+   * (in absolute amplitude) on all channels for this many seconds. Zero or negative disables the
+   * silence condition. Silence is counted from the beginning of the render.
+   */
+  double silenceSeconds;
+  float silenceThreshold;
+  
+  /**
+   * The sample format of the output WAV file. One of 16 or 24 (integer PCM), or 32 (float).
+   */
+  int bitsPerSample;
+  
+  /**
+   * An optional sound file which is fed to the inputs of the graph. Channels beyond those in the
+   * file are silent, as is all input after the end of the file. May be <code>NULL</code>.
+   */
+  const char *inputPath;
+} ZGRenderOptions;
+
+#endif // _ZG_RENDER_OPTIONS_H_
@@ -0,0 +1,33 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _ZG_SAMPLE_TYPE_H_
+#define _ZG_SAMPLE_TYPE_H_
+
+/** The type of the samples with which the code generated by <code>zg_generate_code()</code> computes. */
+typedef enum {
+  ZG_SAMPLE_FLOAT, // 32-bit float, exactly as the interpreted graph (the default)
+  ZG_SAMPLE_Q15,   // 16-bit fixed point in [-1, 1), saturating
+  ZG_SAMPLE_Q31    // 32-bit fixed point in [-1, 1), saturating
+} ZGSampleType;
+
+#endif // _ZG_SAMPLE_TYPE_H_
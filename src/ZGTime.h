@@ -0,0 +1,68 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _ZG_TIME_H_
+#define _ZG_TIME_H_
+
+#include <math.h>
+
+/**
+ * A point in (or span of) time, measured in samples since the graph started to process, as a
+ * 48.16 fixed-point number. The integer part counts samples exactly, such that block boundaries
+ * never drift, and the fractional part gives messages a sub-sample position. At 96kHz, the range
+ * covers more than 40 years.
+ */
+typedef long long ZGTime;
+
+/** The number of fractional bits of a <code>ZGTime</code>. */
+#define ZG_TIME_FRACTIONAL_BITS 16
+
+/** The duration of one sample. */
+#define ZG_TIME_ONE_SAMPLE (1LL << ZG_TIME_FRACTIONAL_BITS)
+
+/** Conversions between <code>ZGTime</code> and samples or milliseconds. */
+class ZGTimeUtils {
+  
+  public:
+    static inline ZGTime fromSamples(double numSamples) {
+      return (ZGTime) llround(numSamples * (double) ZG_TIME_ONE_SAMPLE);
+    }
+  
+    static inline double toSamples(ZGTime time) {
+      return ((double) time) / (double) ZG_TIME_ONE_SAMPLE;
+    }
+  
+    static inline ZGTime fromMilliseconds(double milliseconds, float sampleRate) {
+      return fromSamples(milliseconds * (double) sampleRate / 1000.0);
+    }
+  
+    static inline double toMilliseconds(ZGTime time, float sampleRate) {
+      return toSamples(time) * 1000.0 / (double) sampleRate;
+    }
+  
+    /** Returns the fractional sample index of the given time within the block starting at <code>blockStartTime</code>. */
+    static inline float toBlockIndex(ZGTime time, ZGTime blockStartTime) {
+      return ((float) (time - blockStartTime)) * (1.0f / (float) ZG_TIME_ONE_SAMPLE);
+    }
+};
+
+#endif // _ZG_TIME_H_
@@ -20,7 +20,11 @@
  *
  */
 
+#include "CodeGenerator.h"
+#include "OfflineRenderer.h"
 #include "PdGraph.h"
+#include "RandomGenerator.h"
+#include "SampleCache.h"
 #include "ZenGarden.h"
 
 ZGGraph *zg_new_graph(char *directory, char *filename, int blockSize, 
@@ -29,6 +33,33 @@ ZGGraph *zg_new_graph(char *directory, char *filename, int blockSize,
       sampleRate, NULL);
 }
 
+ZGGraph *zg_new_compiled_graph(const char *libraryPath, char *directory, char *filename,
+    int blockSize, int numInputChannels, int numOutputChannels, float sampleRate) {
+  PdGraph *graph = PdGraph::newInstance(directory, filename, blockSize, numInputChannels,
+      numOutputChannels, sampleRate, NULL);
+  if (graph != NULL && !graph->loadCompiledDsp(libraryPath)) {
+    delete graph;
+    graph = NULL;
+  }
+  return graph;
+}
+
+int zg_generate_code(PdGraph *graph, const char *outputPath) {
+  return zg_generate_code_with_sample_type(graph, outputPath, ZG_SAMPLE_FLOAT);
+}
+
+int zg_generate_code_with_sample_type(PdGraph *graph, const char *outputPath,
+    ZGSampleType sampleType) {
+  CodeGenerator *codeGenerator = new CodeGenerator(graph, sampleType);
+  bool isGenerated = codeGenerator->generate() && codeGenerator->writeToFile(outputPath);
+  delete codeGenerator;
+  return isGenerated ? 1 : 0;
+}
+
+int zg_prune_graph(PdGraph *graph) {
+  return graph->prune();
+}
+
 void zg_delete_graph(PdGraph *graph) {
   if (graph != NULL) {
     delete graph;
@@ -39,8 +70,41 @@ void zg_process(PdGraph *graph, float *inputBuffers, float *outputBuffers) {
   graph->process(inputBuffers, outputBuffers);
 }
 
+void zg_process_frames(PdGraph *graph, float *inputBuffers, float *outputBuffers, int numFrames) {
+  graph->processFrames(inputBuffers, outputBuffers, numFrames);
+}
+
+int zg_get_latency(PdGraph *graph) {
+  return graph->getLatency();
+}
+
+void zg_process_interleaved_f32(PdGraph *graph, float *inputBuffers, float *outputBuffers) {
+  graph->processInterleaved(inputBuffers, outputBuffers);
+}
+
+void zg_process_s16(PdGraph *graph, short *inputBuffers, short *outputBuffers) {
+  graph->processShort(inputBuffers, outputBuffers);
+}
+
+void zg_process_s24(PdGraph *graph, int *inputBuffers, int *outputBuffers) {
+  graph->processInt24(inputBuffers, outputBuffers);
+}
+
+void zg_set_dither(PdGraph *graph, int enabled) {
+  graph->setDithering(enabled != 0);
+}
+
+float *zg_get_input_buffers(PdGraph *graph) {
+  return graph->getGlobalDspBufferAtInlet(0);
+}
+
+float *zg_get_output_buffers(PdGraph *graph) {
+  return graph->getGlobalDspBufferAtOutlet(0);
+}
+
 void zg_send_message(PdGraph *graph, const char *receiverName, const char *messageFormat, ...) {
-  PdMessage *message = graph->scheduleExternalMessage((char *) receiverName);
+  // message is processed at start of the next block
+  PdMessage *message = graph->scheduleExternalMessage((char *) receiverName, 0);
   if (message != NULL) { // message is NULL if no receiver of the given name exists
     va_list ap;
     va_start(ap, messageFormat);
@@ -51,14 +115,12 @@ void zg_send_message(PdGraph *graph, const char *receiverName, const char *messa
 
 void zg_send_message_at_blockindex(ZGGraph *graph, const char *receiverName, double blockIndex,
     const char *messageFormat, ...) {
-  PdMessage *message = graph->scheduleExternalMessage((char *) receiverName);
+  ZGTime timestamp = graph->getBlockStartTimestamp();
+  if (blockIndex >= 0.0 && blockIndex <= (double) (graph->getBlockSize()-1)) {
+    timestamp += ZGTimeUtils::fromSamples(blockIndex);
+  }
+  PdMessage *message = graph->scheduleExternalMessage((char *) receiverName, timestamp);
   if (message != NULL) {
-    double timestamp = graph->getBlockStartTimestamp();
-    if (blockIndex >= 0.0 && blockIndex <= (double) (graph->getBlockSize()-1)) {
-      timestamp += blockIndex / graph->getSampleRate();
-    }
-    message->setTimestamp(timestamp);
-    
     va_list ap;
     va_start(ap, messageFormat);
     message->setMessage(messageFormat, ap);
@@ -67,37 +129,99 @@ void zg_send_message_at_blockindex(ZGGraph *graph, const char *receiverName, dou
 }
 
 void zg_send_midinote(PdGraph *graph, int channel, int noteNumber, int velocity, double blockIndex) {
-  const char *receiverName;
-  switch (channel) {
-    case 0:  { receiverName = "zg_notein_0";  break; }
-    case 1:  { receiverName = "zg_notein_1";  break; }
-    case 2:  { receiverName = "zg_notein_2";  break; }
-    case 3:  { receiverName = "zg_notein_3";  break; }
-    case 4:  { receiverName = "zg_notein_4";  break; }
-    case 5:  { receiverName = "zg_notein_5";  break; }
-    case 6:  { receiverName = "zg_notein_6";  break; }
-    case 7:  { receiverName = "zg_notein_7";  break; }
-    case 8:  { receiverName = "zg_notein_8";  break; }
-    case 9:  { receiverName = "zg_notein_9";  break; }
-    case 10: { receiverName = "zg_notein_10"; break; }
-    case 11: { receiverName = "zg_notein_11"; break; }
-    case 12: { receiverName = "zg_notein_12"; break; }
-    case 13: { receiverName = "zg_notein_13"; break; }
-    case 14: { receiverName = "zg_notein_14"; break; }
-    case 15: { receiverName = "zg_notein_15"; break; }
-    default: {
-      return;
-    }
+  if (channel < 0 || channel > 15) {
+    return;
+  }
+  ZGMidiEvent event;
+  event.blockIndex = blockIndex;
+  event.status = 0x90 | channel;
+  event.data1 = (unsigned char) noteNumber;
+  event.data2 = (unsigned char) velocity;
+  graph->scheduleMidiEvents(&event, 1);
+}
+
+void zg_send_midi_events(PdGraph *graph, const ZGMidiEvent *events, int numEvents) {
+  graph->scheduleMidiEvents(events, numEvents);
+}
+
+ZGObject *zg_add_object(PdGraph *graph, const char *objectString) {
+  // free objects which have been removed in the meantime
+  graph->releaseCompletedGraphEdits();
+  MessageObject *object = graph->createObject((char *) objectString);
+  if (object != NULL && !graph->queueAddObject(object)) {
+    delete object;
+    object = NULL;
   }
-  
-  zg_send_message_at_blockindex(graph, receiverName, blockIndex, "fff",
-      (float) noteNumber, (float) velocity, (float) channel);
-  
-  // all message are also sent to the omni listener
-  zg_send_message_at_blockindex(graph, "zg_notein_omni", blockIndex, "fff",
-      (float) noteNumber, (float) velocity, (float) channel);
+  return object;
+}
+
+MessageObject *zg_get_object(PdGraph *graph, int index) {
+  return graph->getObject(index);
+}
+
+void zg_remove_object(PdGraph *graph, MessageObject *object) {
+  graph->queueRemoveObject(object);
+}
+
+void zg_connect(PdGraph *graph, MessageObject *fromObject, int outletIndex, MessageObject *toObject, int inletIndex) {
+  graph->queueConnect(fromObject, outletIndex, toObject, inletIndex);
+}
+
+void zg_disconnect(PdGraph *graph, MessageObject *fromObject, int outletIndex, MessageObject *toObject, int inletIndex) {
+  graph->queueDisconnect(fromObject, outletIndex, toObject, inletIndex);
+}
+
+void zg_set_profiling(PdGraph *graph, int enabled) {
+  graph->setProfiling(enabled != 0);
+}
+
+ZGProfile *zg_get_profile(PdGraph *graph) {
+  return graph->getProfile();
+}
+
+void zg_delete_profile(ZGProfile *profile) {
+  PdGraph::deleteProfile(profile);
+}
+
+void zg_print_profile(PdGraph *graph) {
+  graph->printProfile();
+}
+
+long long zg_render_to_file(PdGraph *graph, const char *outputPath, ZGRenderOptions *options) {
+  OfflineRenderer *renderer = new OfflineRenderer(graph, options);
+  long long numFrames = renderer->renderToFile(outputPath);
+  delete renderer;
+  return numFrames;
+}
+
+void zg_set_sample_cache_directory(const char *directory) {
+  SampleCache::setDirectory(directory);
+}
+
+void zg_set_random_seed(unsigned int seed) {
+  RandomGenerator::setDefaultSeed(seed);
 }
 
 void zg_register_callback(PdGraph *graph, void (*callbackFunction)(ZGCallbackFunction, void *, void *), void *userData) {
   graph->registerCallback(callbackFunction, userData);
 }
+
+int zg_register_receiver(PdGraph *graph, const char *receiverName) {
+  return graph->registerHostReceiver((char *) receiverName) ? 1 : 0;
+}
+
+void zg_unregister_receiver(PdGraph *graph, const char *receiverName) {
+  graph->unregisterHostReceiver((char *) receiverName);
+}
+
+void zg_set_event_delivery(PdGraph *graph, ZGEventDelivery delivery) {
+  graph->setEventDelivery(delivery);
+}
+
+int zg_poll_events(PdGraph *graph) {
+  return graph->pollEvents();
+}
+
+unsigned int zg_get_num_dropped_events(PdGraph *graph) {
+  return graph->getNumDroppedEvents();
+}
@@ -24,16 +24,24 @@
 #define _ZENGARDEN_H_
 
 #include "ZGCallbackFunction.h"
+#include "ZGMidiEvent.h"
+#include "ZGProfile.h"
+#include "ZGReceivedMessage.h"
+#include "ZGRenderOptions.h"
+#include "ZGSampleType.h"
 
 /**
  * This header file defines the C interface to ZenGarden to the outside world. Include this header
  * along with the <code>libzengarden</code> library in your project in order to integrate it.
  */
 #ifdef __cplusplus
+class MessageObject;
 class PdGraph;
+typedef MessageObject ZGObject;
 typedef PdGraph ZGGraph;
 extern "C" {
 #else
+  typedef void ZGObject;
   typedef void ZGGraph;
 #endif
   
@@ -41,12 +49,94 @@ extern "C" {
   ZGGraph *zg_new_graph(char *directory, char *filename, int blockSize, 
       int numInputChannels, int numOutputChannels, float sampleRate);
   
+  /**
+   * Create a new graph with the given parameters, whose audio objects are replaced by the compiled
+   * code in the given shared library. The library is built by <code>zgcompile</code> from the same
+   * patch with the same parameters, or from the output of <code>zg_generate_code()</code>. The graph
+   * is otherwise the same as one created by <code>zg_new_graph()</code>, and processes messages in
+   * the same way. Returns <code>NULL</code> if the library cannot be used with the graph.
+   */
+  ZGGraph *zg_new_compiled_graph(const char *libraryPath, char *directory, char *filename,
+      int blockSize, int numInputChannels, int numOutputChannels, float sampleRate);
+  
+  /**
+   * Writes the code of the audio objects of the given graph to the given path, as a C++ translation
+   * unit to be built into a shared library for <code>zg_new_compiled_graph()</code>. Returns 0,
+   * having printed the reason, if the graph cannot be compiled. Graphs can be compiled if all of
+   * their audio objects are supported and do not receive any messages.
+   */
+  int zg_generate_code(ZGGraph *graph, const char *outputPath);
+  
+  /**
+   * As <code>zg_generate_code()</code>, but the generated code computes with the given type of
+   * samples. With fixed-point samples, the code uses no floating point except to convert the input
+   * and output of each block, but all signals are limited to [-1, 1), and only the basic
+   * arithmetic, filter and oscillator objects are supported. The output is close to, but not
+   * exactly the same as that of the interpreted graph.
+   */
+  int zg_generate_code_with_sample_type(ZGGraph *graph, const char *outputPath,
+      ZGSampleType sampleType);
+  
+  /**
+   * Removes everything from a newly created graph which cannot affect its output: comments,
+   * unconnected number boxes, sliders, toggles and bangs, and audio objects and subpatches whose
+   * signals reach no <code>dac~</code>, <code>send~</code>, <code>throw~</code>,
+   * <code>delwrite~</code> or other output, such as unused scopes and meters. Must be called before
+   * the graph is first processed. Returns the number of removed objects.
+   */
+  int zg_prune_graph(ZGGraph *graph);
+  
   /** Delete the given graph. */
   void zg_delete_graph(ZGGraph *graph);
   
-  /** Process the given graph. */
+  /**
+   * Process the given graph. The buffers hold one block of non-interleaved samples per channel.
+   * Either buffer may be <code>NULL</code>, in which case the graph's own buffers are used as they
+   * are (see <code>zg_get_input_buffers()</code>). No copy is then made on that side.
+   */
   void zg_process(ZGGraph *graph, float *inputBuffers, float *outputBuffers);
   
+  /**
+   * Process any number of frames, independently of the block size of the graph. The buffers hold
+   * <code>numFrames</code> non-interleaved samples for each channel. Blocks are run as they are
+   * filled, and the output is delayed by <code>zg_get_latency()</code> frames. With a constant
+   * number of frames N and a block size of B, the delay is B - gcd(N, B), e.g. 0 if N is a
+   * multiple of B. It is set by the first call, and grows by inserting silence only if a later call
+   * is given more frames than can be produced in time. Must not be mixed with the other process functions.
+   */
+  void zg_process_frames(ZGGraph *graph, float *inputBuffers, float *outputBuffers, int numFrames);
+  
+  /** Returns the number of frames by which <code>zg_process_frames()</code> delays the output. */
+  int zg_get_latency(ZGGraph *graph);
+  
+  /** Process the given graph with interleaved float frames. */
+  void zg_process_interleaved_f32(ZGGraph *graph, float *inputBuffers, float *outputBuffers);
+  
+  /** Process the given graph with interleaved 16-bit frames. Output is clipped. */
+  void zg_process_s16(ZGGraph *graph, short *inputBuffers, short *outputBuffers);
+  
+  /**
+   * Process the given graph with interleaved 24-bit frames. Each sample is held in the low three
+   * bytes of an <code>int</code>; the top byte of input samples is ignored, and output samples are
+   * sign-extended. Output is clipped.
+   */
+  void zg_process_s24(ZGGraph *graph, int *inputBuffers, int *outputBuffers);
+  
+  /** Turn TPDF dithering of the output of <code>zg_process_s16()</code> and <code>zg_process_s24()</code> on or off. */
+  void zg_set_dither(ZGGraph *graph, int enabled);
+  
+  /**
+   * Returns the non-interleaved input buffers of the graph, which are read by [adc~]. A host may
+   * write the input of the next block here and pass <code>NULL</code> to <code>zg_process()</code>.
+   */
+  float *zg_get_input_buffers(ZGGraph *graph);
+  
+  /**
+   * Returns the non-interleaved output buffers of the graph, which are written by [dac~]. They are
+   * valid after <code>zg_process()</code> returns, until the next block is processed.
+   */
+  float *zg_get_output_buffers(ZGGraph *graph);
+  
   /**
    * Send a message to the named receiver with the given format at the beginning of the next audio block.
    * If no receiver exists with the given name, then this funtion does nothing.
@@ -82,9 +172,135 @@ extern "C" {
    */
   void zg_send_midinote(ZGGraph *graph, int channel, int noteNumber, int velocity, double blockIndex);
   
+  /**
+   * Send any number of raw MIDI events, each at its own block index in the next block, to the
+   * [notein], [ctlin], [bendin] and [touchin] objects of the graph. Events are delivered directly to
+   * the objects listening on their channel (or on all channels), without looking up any receiver
+   * names, and events which no object listens to cost (almost) nothing. They need not be sorted.
+   */
+  void zg_send_midi_events(ZGGraph *graph, const ZGMidiEvent *events, int numEvents);
+  
+  /**
+   * Create a new object and add it to the given (possibly running) graph. The object is described
+   * in the same way as in a Pd file, e.g. "osc~ 440", "+ 1", or "msg hello $1". Only built-in
+   * objects are supported; abstractions, subgraphs, and inlet/outlet objects are not. The object
+   * is created on the calling thread, but it becomes part of the graph only at the beginning of the
+   * next call to <code>zg_process()</code>. Returns <code>NULL</code> if the object could not be
+   * created.
+   * The live editing functions never block the audio thread. They may be called from a thread
+   * other than the one calling <code>zg_process()</code>, but only from one such thread.
+   * Edits are applied in the order in which they are made. Everything an edit needs, including the
+   * new process order, is prepared on the calling thread; the audio thread only swaps it in. Added
+   * objects are ordered (and fused) as if they had been loaded after all others, so they are not
+   * delayed by a block. Compiled code is no longer used once the process order changes.
+   */
+  ZGObject *zg_add_object(ZGGraph *graph, const char *objectString);
+  
+  /**
+   * Returns the object at the given index of the top-level graph, as numbered in the Pd file
+   * (including comments) and followed by the added objects, or <code>NULL</code> if there is none.
+   * Queued edits are taken into account: removed objects no longer count.
+   */
+  ZGObject *zg_get_object(ZGGraph *graph, int index);
+  
+  /**
+   * Remove the given object from the graph at the beginning of the next block. All of its
+   * connections are removed as well. The object is deleted during a later call to one of the live
+   * editing functions, or when the graph is deleted. It must not be referred to again. Any object of
+   * the top-level graph can be removed, except subgraphs and abstractions.
+   */
+  void zg_remove_object(ZGGraph *graph, ZGObject *object);
+  
+  /**
+   * Connect the outlet of one object to the inlet of another at the beginning of the next block.
+   * Connections can be made between any objects of the top-level graph, whether loaded or added.
+   */
+  void zg_connect(ZGGraph *graph, ZGObject *fromObject, int outletIndex, ZGObject *toObject, int inletIndex);
+  
+  /** Remove the given connection at the beginning of the next block, if it exists. */
+  void zg_disconnect(ZGGraph *graph, ZGObject *fromObject, int outletIndex, ZGObject *toObject, int inletIndex);
+  
+  /**
+   * Turn profiling on (non-zero) or off (zero). While profiling is on, the time taken to process
+   * each audio object, each subgraph, and each whole block is measured. Turning profiling on resets
+   * all statistics. Profiling is off by default, in which case it costs (almost) nothing.
+   */
+  void zg_set_profiling(ZGGraph *graph, int enabled);
+  
+  /**
+   * Returns a snapshot of the profiling statistics of the graph. It may be taken while the graph
+   * is being processed, but not while it is being edited. The returned profile must be freed with
+   * <code>zg_delete_profile()</code>. Object labels remain valid only as long as the objects exist.
+   * Objects are measured as they are processed, i.e. fused chains as a whole. While the graph is
+   * processed by compiled code, only the compiled code as a whole is measured.
+   */
+  ZGProfile *zg_get_profile(ZGGraph *graph);
+  
+  /** Free a profile returned by <code>zg_get_profile()</code>. */
+  void zg_delete_profile(ZGProfile *profile);
+  
+  /** Print the profiling statistics of the graph via the <code>ZG_PRINT_STD</code> callback. */
+  void zg_print_profile(ZGGraph *graph);
+  
+  /**
+   * Render the graph offline into a WAV file at the given path, as fast as possible. The render
+   * runs on the calling thread, which must not call <code>zg_process()</code> at the same time.
+   * Returns the number of frames written, or -1 on error (which is reported via the
+   * <code>ZG_PRINT_ERR</code> callback).
+   */
+  long long zg_render_to_file(ZGGraph *graph, const char *outputPath, ZGRenderOptions *options);
+  
+  /**
+   * Set the directory in which decoded sound files are persisted, so that later runs can map them
+   * into memory instead of decoding them again. Pass <code>NULL</code> to disable persistence.
+   */
+  void zg_set_sample_cache_directory(const char *directory);
+  
+  /**
+   * Seed the random number generators of [noise~] and [random] objects in graphs which are created
+   * from now on, such that a graph produces the same output on every run. Each object is seeded
+   * differently, according to the order in which it is created in its graph. A seed of zero (the
+   * default) seeds each graph from the clock. Must not be called while a graph is being created.
+   */
+  void zg_set_random_seed(unsigned int seed);
+  
   void zg_register_callback(ZGGraph *graph,
       void (*callbackFunction)(ZGCallbackFunction function, void *userData, void *ptr), void *userData);
   
+  /**
+   * Register interest in messages sent to the given name, e.g. with [send meter] or from a message
+   * box. From the beginning of the next block, they are passed to the callback function as
+   * <code>ZG_RECEIVER_MESSAGE</code>, with a <code>ZGReceivedMessage</code> holding their elements
+   * (not a string). They are delivered in the same way as printed messages. Registering a name
+   * twice has no further effect. May be called while the graph is being processed, from the thread
+   * which also uses the live editing functions. Returns 0 if the receiver could not be registered.
+   */
+  int zg_register_receiver(ZGGraph *graph, const char *receiverName);
+  
+  /** Stop passing messages sent to the given name to the callback, from the beginning of the next block. */
+  void zg_unregister_receiver(ZGGraph *graph, const char *receiverName);
+  
+  /**
+   * Set how events, i.e. printed messages (from [print] and from errors) and messages to registered
+   * receivers, are delivered to the callback function. By default they are delivered immediately,
+   * i.e. usually on the audio thread, where a slow callback may cause dropouts. Otherwise they are
+   * written into a fixed-size queue without locking or allocating memory, and delivered either by
+   * <code>zg_poll_events()</code> or on a thread of the graph. Queued messages to registered
+   * receivers keep at most 32 elements. If the queue is full, events are dropped and counted. The
+   * callback must be registered beforehand. Must not be called while the graph is being processed.
+   */
+  void zg_set_event_delivery(ZGGraph *graph, ZGEventDelivery delivery);
+  
+  /**
+   * Delivers all queued events to the callback function on the calling thread, if delivery is
+   * <code>ZG_DELIVER_ON_POLL</code>. Returns the number of delivered events. If any events were
+   * dropped since the last poll, an error message saying so is delivered as well.
+   */
+  int zg_poll_events(ZGGraph *graph);
+  
+  /** Returns the total number of events which have been dropped because the queue was full. */
+  unsigned int zg_get_num_dropped_events(ZGGraph *graph);
+  
 #ifdef __cplusplus
 }
 #endif
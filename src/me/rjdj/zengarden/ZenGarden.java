@@ -150,6 +150,20 @@ public class ZenGarden {
   private native void sendMidinote(int channel, int noteNumber, int velocity, double blockIndex,
       long nativePointer);
   
+  /**
+   * Send a raw MIDI event to the <code>notein</code>, <code>ctlin</code>, <code>bendin</code> and
+   * <code>touchin</code> objects listening on its channel, at the given index of the next block.
+   * The status byte includes the (zero-indexed) channel in its low four bits.
+   * E.g., sendMidiEvent(0xB1, 7, 100, 0.0);
+   * sends a control change of controller 7 to value 100 on the second channel.
+   */
+  public void sendMidiEvent(int status, int data1, int data2, double blockIndex) {
+    sendMidiEvent(status, data1, data2, blockIndex, nativePtr);
+  }
+  
+  private native void sendMidiEvent(int status, int data1, int data2, double blockIndex,
+      long nativePointer);
+  
   /**
    * This method allows the native component to be manually unloaded.
    * This allows memory to be better managed.
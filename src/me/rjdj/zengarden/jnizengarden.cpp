@@ -20,7 +20,6 @@
  *
  */
 
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include "me_rjdj_zengarden_ZenGarden.h"
@@ -33,13 +32,11 @@ JavaVM *jvm = NULL; // global variable
 typedef struct {
   jobject zgObject;
   PdGraph *pdGraph;
-  float *finputBuffer;
-  float *foutputBuffer;
+  short *sinputBuffer;
+  short *soutputBuffer;
   int blockSize;
   int numInputChannels; // the number of input channels supplied by the system
   int numOutputChannels; // the number of input channels supplied by the system
-  float *shortToFloatLookupTable;
-  int numBytesInBlock;
 } PureDataMobileNativeVars;
 
 extern "C" {
@@ -71,19 +68,6 @@ extern "C" {
   }
 }
 
-inline float shortSampleToFloat(short s, PureDataMobileNativeVars *pdmnv) {
-  //pdmnv->finputBuffer[z] = ((float) cinputBuffer[j]) / 32767.0f;
-  if (s >= 0) {
-    return pdmnv->shortToFloatLookupTable[s];
-  } else {
-    // short s is known to be a negative number. It is made positive by taking the 2's complement.
-    // The complement is then used to lookup the corresponding float value from the lookup table.
-    // The (positive) float is then made negative by setting the high bit to 1.
-    int floatAsInt = (*(int *)(pdmnv->shortToFloatLookupTable + (~s + 1))) | 0x80000000;
-    return *(float *)&floatAsInt;
-  }
-}
-
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *ur_jvm, void *reserved) {
   // cache the java vm pointer
   // used for getting a pointer to the java environment during callbacks
@@ -113,24 +97,16 @@ JNIEXPORT jlong JNICALL Java_me_rjdj_zengarden_ZenGarden_loadPdPatch(
   // initialise the PureDataMobile native variables
   PureDataMobileNativeVars *pdmnv = (PureDataMobileNativeVars *) malloc(sizeof(PureDataMobileNativeVars));
   pdmnv->pdGraph = pdGraph;
-  pdmnv->finputBuffer = (float *) malloc(blockSize * numInputChannels * sizeof(float));
-  pdmnv->foutputBuffer = (float *) malloc(blockSize * numOutputChannels * sizeof(float));
+  pdmnv->sinputBuffer = (short *) malloc(blockSize * numInputChannels * sizeof(short));
+  pdmnv->soutputBuffer = (short *) malloc(blockSize * numOutputChannels * sizeof(short));
   pdmnv->blockSize = blockSize;
   pdmnv->numInputChannels = numInputChannels;
   pdmnv->numOutputChannels = numOutputChannels;
-  pdmnv->shortToFloatLookupTable = (float *) malloc(32768 * sizeof(float));
-  pdmnv->numBytesInBlock = blockSize * sizeof(float);
   
   // register the callback
   pdmnv->zgObject = env->NewGlobalRef(jobj);
   zg_register_callback(pdGraph, java_callback, pdmnv->zgObject);
   
-  // define the input (microphone) waveshaper
-  // linear
-  for (int i = 0; i < 32768; i++) {
-    pdmnv->shortToFloatLookupTable[i] = ((float) i) / 32767.0f;
-  }
-  
   return (jlong) pdmnv;
 }
 
@@ -141,74 +117,48 @@ JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZenGarden_unloadPdPatch(
     // free all of the pure data mobile native variables
     PureDataMobileNativeVars *pdmnv = (PureDataMobileNativeVars *) nativePtr;
     env->DeleteGlobalRef(pdmnv->zgObject);
-    free(pdmnv->finputBuffer);
-    free(pdmnv->foutputBuffer);
-    free(pdmnv->shortToFloatLookupTable);
+    free(pdmnv->sinputBuffer);
+    free(pdmnv->soutputBuffer);
     zg_delete_graph(pdmnv->pdGraph);
     free(pdmnv);
   }
 }
 
-// this function uses bit-wise manupulation in order to more quickly multiply floats by
-// -1 or 32768. See http://en.wikipedia.org/wiki/IEEE_754-1985
+// The conversion between shorts and floats, as well as the (de-)interleaving, is done by
+// zg_process_s16() directly on the graph's own buffers. The arrays are only copied to and from
+// native memory, as the graph may call back into Java while processing, which is not allowed
+// while holding a critical array.
 JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZenGarden_process(
     JNIEnv *env, jobject jobj, jshortArray jinputBuffer, jshortArray joutputBuffer, jlong nativePtr) {
   
   PureDataMobileNativeVars *pdmnv = (PureDataMobileNativeVars *) nativePtr;
   
-  // set up the floating point input buffers
-  short *cinputBuffer = (short *) env->GetPrimitiveArrayCritical(jinputBuffer, NULL);
-  switch (pdmnv->numInputChannels) {
-    case 1: { // if there is only one input channel (mono)
-      // convert all shorts to floats
-      for (int i = 0; i < pdmnv->blockSize; i++) {
-        pdmnv->finputBuffer[i] = shortSampleToFloat(cinputBuffer[i], pdmnv);
-      }
-      // copy the float buffer from the left to right channel
-      memcpy(pdmnv->finputBuffer + pdmnv->blockSize, pdmnv->finputBuffer, pdmnv->numBytesInBlock);
-      break;
-    }
-    case 2: { // if there is a stereo input
-      // uninterleave the short buffer
-      for (int i = 0, j = 0; i < pdmnv->blockSize; i++) {
-        for (int k = 0, z = i; k < pdmnv->numInputChannels; k++, j++, z+=pdmnv->blockSize) {
-          pdmnv->finputBuffer[z] = shortSampleToFloat(cinputBuffer[j], pdmnv);
-        }
-      }
-      break;
-    }
-    default: {
-      break;
-    }
-  }
-  env->ReleasePrimitiveArrayCritical(jinputBuffer, cinputBuffer, JNI_ABORT); // no need to copy back changes. release native buffer.
+  env->GetShortArrayRegion(jinputBuffer, 0, pdmnv->blockSize * pdmnv->numInputChannels,
+      pdmnv->sinputBuffer);
   
-  zg_process(pdmnv->pdGraph, pdmnv->finputBuffer, pdmnv->foutputBuffer);
+  zg_process_s16(pdmnv->pdGraph, pdmnv->sinputBuffer, pdmnv->soutputBuffer);
   
-  // read back from the floating point output buffers
-  // regarding use of lrintf, see http://www.mega-nerd.com/FPcast/
-  short *coutputBuffer = (short *) env->GetPrimitiveArrayCritical(joutputBuffer, NULL);
-  for (int i = 0, j = 0; i < pdmnv->blockSize; i++) {
-    for (int k = 0, z = i; k < pdmnv->numOutputChannels; k++, j++, z+=pdmnv->blockSize) {
-      // clip the output (like Pd does)
-      float f = pdmnv->foutputBuffer[z];
-      if (f > 1.0f) {
-        coutputBuffer[j] = 32767;
-      } else if (f < -1.0f) {
-        coutputBuffer[j] = -32768;
-      } else {
-        coutputBuffer[j] = (short) lrintf(f * 32767.0f);
-      }
-      /*
-       * WARNING: if pdmnv->foutputBuffer[z] == 1.0f, this method will result in -32768, not 32767
-       * and cause a click in the output (i.e., there is overflow when converting to a short)
-       int floatAsInt = *(int *)(pdmnv->foutputBuffer+z);
-       int exponent = floatAsInt & 0x7F800000;
-       exponent += 0x07800000; // multiply by 32768.0f == 2^15 (add 15 to the exponent)
-       floatAsInt = (floatAsInt & 0x807FFFFF) | exponent;
-       coutputBuffer[j] = (short) lrintf(*(float *)&floatAsInt);
-       */
-    }
-  }
-  env->ReleasePrimitiveArrayCritical(joutputBuffer, coutputBuffer, 0); // copy back the changes and release native buffer
+  env->SetShortArrayRegion(joutputBuffer, 0, pdmnv->blockSize * pdmnv->numOutputChannels,
+      pdmnv->soutputBuffer);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZenGarden_sendMidinote(
+    JNIEnv *env, jobject jobj, jint channel, jint noteNumber, jint velocity, jdouble blockIndex,
+    jlong nativePtr) {
+  
+  PureDataMobileNativeVars *pdmnv = (PureDataMobileNativeVars *) nativePtr;
+  zg_send_midinote(pdmnv->pdGraph, channel, noteNumber, velocity, blockIndex);
+}
+
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZenGarden_sendMidiEvent(
+    JNIEnv *env, jobject jobj, jint status, jint data1, jint data2, jdouble blockIndex,
+    jlong nativePtr) {
+  
+  PureDataMobileNativeVars *pdmnv = (PureDataMobileNativeVars *) nativePtr;
+  ZGMidiEvent event;
+  event.blockIndex = blockIndex;
+  event.status = (unsigned char) status;
+  event.data1 = (unsigned char) data1;
+  event.data2 = (unsigned char) data2;
+  zg_send_midi_events(pdmnv->pdGraph, &event, 1);
 }
@@ -23,6 +23,22 @@ JNIEXPORT jlong JNICALL Java_me_rjdj_zengarden_ZenGarden_loadPdPatch
 JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZenGarden_process
   (JNIEnv *, jobject, jshortArray, jshortArray, jlong);
 
+/*
+ * Class:     me_rjdj_zengarden_ZenGarden
+ * Method:    sendMidinote
+ * Signature: (IIIDJ)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZenGarden_sendMidinote
+  (JNIEnv *, jobject, jint, jint, jint, jdouble, jlong);
+
+/*
+ * Class:     me_rjdj_zengarden_ZenGarden
+ * Method:    sendMidiEvent
+ * Signature: (IIIDJ)V
+ */
+JNIEXPORT void JNICALL Java_me_rjdj_zengarden_ZenGarden_sendMidiEvent
+  (JNIEnv *, jobject, jint, jint, jint, jdouble, jlong);
+
 /*
  * Class:     me_rjdj_zengarden_ZenGarden
  * Method:    unloadPdPatch
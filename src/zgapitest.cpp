@@ -0,0 +1,372 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ *
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * zgapitest tests the behaviour of the C API which the golden tests of the Java bindings cannot
+ * observe, such as audio output and calls made between blocks. It loads the patches Api*.pd from
+ * the given directory, and prints a line for each failed check.
+ *
+ * usage: zgapitest path/to/unittests/
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ZenGarden.h"
+
+#define BLOCK_SIZE 64
+#define NUM_CHANNELS 2
+#define SAMPLE_RATE 44100.0f
+
+/** The number of blocks rendered by each check. */
+#define NUM_TEST_BLOCKS 128
+
+extern "C" {
+  void callbackFunction(ZGCallbackFunction function, void *userData, void *ptr) {
+    switch (function) {
+      case ZG_PRINT_ERR: {
+        fprintf(stderr, "ERROR: %s\n", (char *) ptr);
+        (*((int *) userData))++;
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+};
+
+/** The number of errors reported by all graphs. */
+static int numErrors = 0;
+
+static ZGGraph *newGraph(const char *directory, const char *filename) {
+  ZGGraph *graph = zg_new_graph((char *) directory, (char *) filename, BLOCK_SIZE, NUM_CHANNELS,
+      NUM_CHANNELS, SAMPLE_RATE);
+  if (graph == NULL) {
+    fprintf(stderr, "Could not load \"%s%s\". Is the given path correct?\n", directory, filename);
+  } else {
+    zg_register_callback(graph, callbackFunction, &numErrors);
+  }
+  return graph;
+}
+
+/** Returns the index of the first frame at which the buffers differ, or -1 if they are equal. */
+static int findFirstDifference(const float *a, const float *b, int numFrames) {
+  for (int i = 0; i < numFrames; i++) {
+    if (a[i] != b[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Renders the left output of ApiNoise.pd from a graph created with the given seed into
+ * <code>output</code>. If <code>shouldSplitBlocks</code> is set, every block is split by messages
+ * at indices which are not multiples of the vector width. If <code>reseed</code> is not zero, then
+ * the [noise~] is sent "seed <code>reseed</code>" before the first block. Returns false if the patch
+ * could not be loaded.
+ */
+static bool renderNoise(const char *directory, unsigned int seed, bool shouldSplitBlocks,
+    unsigned int reseed, float *output) {
+  zg_set_random_seed(seed);
+  ZGGraph *graph = newGraph(directory, "ApiNoise.pd");
+  zg_set_random_seed(0);
+  if (graph == NULL) {
+    return false;
+  }
+  float inputBuffers[BLOCK_SIZE * NUM_CHANNELS] = {0.0f};
+  float outputBuffers[BLOCK_SIZE * NUM_CHANNELS];
+  if (reseed != 0) {
+    zg_send_message(graph, "zgapitest", "sf", "seed", (float) reseed);
+  }
+  for (int i = 0; i < NUM_TEST_BLOCKS; i++) {
+    if (shouldSplitBlocks) {
+      // [noise~] ignores anything but a seed, but processes up to the message first
+      zg_send_message_at_blockindex(graph, "zgapitest", 5.0, "s", "split");
+      zg_send_message_at_blockindex(graph, "zgapitest", 22.5, "s", "split");
+      zg_send_message_at_blockindex(graph, "zgapitest", 43.0, "s", "split");
+    }
+    zg_process(graph, inputBuffers, outputBuffers);
+    memcpy(output + i * BLOCK_SIZE, outputBuffers, BLOCK_SIZE * sizeof(float));
+  }
+  zg_delete_graph(graph);
+  return true;
+}
+
+/**
+ * [noise~] must render the same signal whenever its graph is created with the same seed, no matter
+ * how its blocks are split by messages, and a different signal with a different seed. A "seed"
+ * message restarts it independently of the seed of the graph.
+ */
+static int testNoiseSeed(const char *directory) {
+  const int numFrames = NUM_TEST_BLOCKS * BLOCK_SIZE;
+  float *reference = (float *) malloc(numFrames * sizeof(float));
+  float *output = (float *) malloc(numFrames * sizeof(float));
+  int numFailures = 0;
+  if (!renderNoise(directory, 1234, false, 0, reference)) {
+    numFailures++;
+  } else {
+    renderNoise(directory, 1234, false, 0, output);
+    int frameIndex = findFirstDifference(reference, output, numFrames);
+    if (frameIndex >= 0) {
+      printf("FAIL: noise~ with the same seed differs at frame %i\n", frameIndex);
+      numFailures++;
+    }
+
+    renderNoise(directory, 1234, true, 0, output);
+    frameIndex = findFirstDifference(reference, output, numFrames);
+    if (frameIndex >= 0) {
+      printf("FAIL: noise~ split by messages differs at frame %i\n", frameIndex);
+      numFailures++;
+    }
+
+    renderNoise(directory, 4321, false, 0, output);
+    if (findFirstDifference(reference, output, numFrames) < 0) {
+      printf("FAIL: noise~ with a different seed is the same\n");
+      numFailures++;
+    }
+
+    renderNoise(directory, 1234, false, 7, reference);
+    renderNoise(directory, 4321, true, 7, output);
+    frameIndex = findFirstDifference(reference, output, numFrames);
+    if (frameIndex >= 0) {
+      printf("FAIL: noise~ after a seed message differs at frame %i\n", frameIndex);
+      numFailures++;
+    }
+  }
+  free(reference);
+  free(output);
+  return numFailures;
+}
+
+/** The input of ApiThrough.pd. Every sample is exactly representable and identifies its frame. */
+static inline float getTestSample(int frameIndex) {
+  return (float) (frameIndex + 1);
+}
+
+/**
+ * Processes ApiThrough.pd with <code>zg_process_frames()</code>, with host buffers of the given
+ * number of frames. The output must be that of <code>zg_process()</code>, delayed by the given
+ * number of frames, which must also be reported by <code>zg_get_latency()</code>.
+ */
+static int testProcessFrames(const char *directory, int numHostFrames, int expectedLatency) {
+  ZGGraph *reference = newGraph(directory, "ApiThrough.pd");
+  ZGGraph *graph = newGraph(directory, "ApiThrough.pd");
+  if (reference == NULL || graph == NULL) {
+    if (reference != NULL) {
+      zg_delete_graph(reference);
+    }
+    if (graph != NULL) {
+      zg_delete_graph(graph);
+    }
+    return 1;
+  }
+
+  // render the reference a block at a time
+  const int numFrames = NUM_TEST_BLOCKS * BLOCK_SIZE;
+  float *expectedSamples = (float *) malloc(NUM_CHANNELS * numFrames * sizeof(float));
+  float inputBuffers[BLOCK_SIZE * NUM_CHANNELS] = {0.0f};
+  float outputBuffers[BLOCK_SIZE * NUM_CHANNELS];
+  for (int i = 0; i < numFrames; i += BLOCK_SIZE) {
+    for (int j = 0; j < BLOCK_SIZE; j++) {
+      inputBuffers[j] = getTestSample(i + j);
+    }
+    zg_process(reference, inputBuffers, outputBuffers);
+    for (int k = 0; k < NUM_CHANNELS; k++) {
+      memcpy(expectedSamples + (k * numFrames) + i, outputBuffers + (k * BLOCK_SIZE),
+          BLOCK_SIZE * sizeof(float));
+    }
+  }
+  zg_delete_graph(reference);
+
+  // render in host buffers, as long as the reference lasts
+  float *hostInputBuffers = (float *) calloc(NUM_CHANNELS * numHostFrames, sizeof(float));
+  float *hostOutputBuffers = (float *) malloc(NUM_CHANNELS * numHostFrames * sizeof(float));
+  int numFailures = 0;
+  for (int i = 0; i + numHostFrames <= numFrames && numFailures == 0; i += numHostFrames) {
+    for (int j = 0; j < numHostFrames; j++) {
+      hostInputBuffers[j] = getTestSample(i + j);
+    }
+    zg_process_frames(graph, hostInputBuffers, hostOutputBuffers, numHostFrames);
+    int latency = zg_get_latency(graph);
+    if (latency != expectedLatency) {
+      printf("FAIL: zg_process_frames() with %i frames has a latency of %i frames instead of %i\n",
+          numHostFrames, latency, expectedLatency);
+      numFailures++;
+      break;
+    }
+    for (int k = 0; k < NUM_CHANNELS && numFailures == 0; k++) {
+      for (int j = 0; j < numHostFrames; j++) {
+        int frameIndex = i + j - latency;
+        float expectedSample = (frameIndex < 0) ? 0.0f : expectedSamples[(k * numFrames) + frameIndex];
+        if (hostOutputBuffers[(k * numHostFrames) + j] != expectedSample) {
+          printf("FAIL: zg_process_frames() with %i frames differs at frame %i of channel %i\n",
+              numHostFrames, i + j, k);
+          numFailures++;
+          break;
+        }
+      }
+    }
+  }
+  zg_delete_graph(graph);
+  free(expectedSamples);
+  free(hostInputBuffers);
+  free(hostOutputBuffers);
+  return numFailures;
+}
+
+/**
+ * Renders the given number of blocks of the graph into <code>output</code>, a block of each channel
+ * after the other, with the test signal at the left input. Processing begins at the given block.
+ */
+static void renderBlocks(ZGGraph *graph, int blockIndex, int numBlocks, float *output) {
+  float inputBuffers[BLOCK_SIZE * NUM_CHANNELS] = {0.0f};
+  for (int i = blockIndex; i < blockIndex + numBlocks; i++) {
+    for (int j = 0; j < BLOCK_SIZE; j++) {
+      inputBuffers[j] = getTestSample(i * BLOCK_SIZE + j);
+    }
+    zg_process(graph, inputBuffers, output + i * BLOCK_SIZE * NUM_CHANNELS);
+  }
+}
+
+/**
+ * Edits the loaded objects of ApiEdit.pd while it is running, such that it becomes ApiEditResult.pd.
+ * From then on, the outputs of both must be the same. The added [+~] must be processed in the block
+ * in which it is connected, and the [loadbang] must fire then. Only the right output of the first
+ * edited block may differ, as [receive~] reads what the added [send~] wrote in the previous block.
+ * Removing the [+~] afterwards must silence the left output.
+ */
+static int testEdit(const char *directory) {
+  const int editBlockIndex = 8;
+  const int removeBlockIndex = NUM_TEST_BLOCKS / 2;
+  ZGGraph *reference = newGraph(directory, "ApiEditResult.pd");
+  ZGGraph *graph = newGraph(directory, "ApiEdit.pd");
+  if (reference == NULL || graph == NULL) {
+    if (reference != NULL) {
+      zg_delete_graph(reference);
+    }
+    if (graph != NULL) {
+      zg_delete_graph(graph);
+    }
+    return 1;
+  }
+  const int blockLength = BLOCK_SIZE * NUM_CHANNELS;
+  float *expectedSamples = (float *) malloc(NUM_TEST_BLOCKS * blockLength * sizeof(float));
+  float *outputSamples = (float *) malloc(NUM_TEST_BLOCKS * blockLength * sizeof(float));
+  renderBlocks(reference, 0, NUM_TEST_BLOCKS, expectedSamples);
+  zg_delete_graph(reference);
+
+  int numFailures = 0;
+  renderBlocks(graph, 0, editBlockIndex, outputSamples);
+  ZGObject *adc = zg_get_object(graph, 0);
+  ZGObject *multiply = zg_get_object(graph, 1);
+  ZGObject *dac = zg_get_object(graph, 2);
+  ZGObject *sig = zg_get_object(graph, 3);
+  if (adc == NULL || dac == NULL || sig == NULL || zg_get_object(graph, 5) == NULL ||
+      zg_get_object(graph, 6) != NULL) {
+    printf("FAIL: zg_get_object() does not return the loaded objects\n");
+    numFailures++;
+  } else {
+    ZGObject *add = zg_add_object(graph, "+~ 0.5");
+    ZGObject *send = zg_add_object(graph, "send~ apiedit");
+    ZGObject *loadbang = zg_add_object(graph, "loadbang");
+    ZGObject *message = zg_add_object(graph, "msg 0.25");
+    zg_disconnect(graph, multiply, 0, dac, 0);
+    zg_connect(graph, multiply, 0, add, 0);
+    zg_connect(graph, add, 0, dac, 0);
+    zg_remove_object(graph, sig);
+    zg_connect(graph, adc, 0, send, 0);
+    zg_connect(graph, loadbang, 0, message, 0);
+    zg_connect(graph, message, 0, multiply, 1);
+    if (zg_get_object(graph, 3) == sig || zg_get_object(graph, 8) != message) {
+      printf("FAIL: zg_get_object() does not reflect the queued edits\n");
+      numFailures++;
+    }
+    renderBlocks(graph, editBlockIndex, removeBlockIndex - editBlockIndex, outputSamples);
+    for (int i = editBlockIndex * blockLength; i < removeBlockIndex * blockLength; i++) {
+      int frameIndex = (i / blockLength) * BLOCK_SIZE + (i % BLOCK_SIZE);
+      int channelIndex = (i % blockLength) / BLOCK_SIZE;
+      if (channelIndex == 1 && i < (editBlockIndex + 1) * blockLength) {
+        continue; // the [send~] has not yet been processed when [receive~] reads it
+      }
+      if (outputSamples[i] != expectedSamples[i]) {
+        printf("FAIL: the edited graph differs at frame %i of channel %i\n", frameIndex, channelIndex);
+        numFailures++;
+        break;
+      }
+    }
+
+    zg_remove_object(graph, add);
+    renderBlocks(graph, removeBlockIndex, NUM_TEST_BLOCKS - removeBlockIndex, outputSamples);
+    for (int i = removeBlockIndex * blockLength; i < NUM_TEST_BLOCKS * blockLength; i++) {
+      int frameIndex = (i / blockLength) * BLOCK_SIZE + (i % BLOCK_SIZE);
+      int channelIndex = (i % blockLength) / BLOCK_SIZE;
+      float expectedSample = (channelIndex == 0) ? 0.0f : expectedSamples[i];
+      if (outputSamples[i] != expectedSample) {
+        printf("FAIL: the graph without [+~] differs at frame %i of channel %i\n", frameIndex,
+            channelIndex);
+        numFailures++;
+        break;
+      }
+    }
+  }
+  zg_delete_graph(graph);
+  free(expectedSamples);
+  free(outputSamples);
+  return numFailures;
+}
+
+int main(int argc, char * const argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: zgapitest path/to/unittests/\n");
+    return 1;
+  }
+  // the graphs are loaded from the directory, which must end with a separator
+  size_t length = strlen(argv[1]);
+  char *directory = (char *) malloc(length + 2);
+  strcpy(directory, argv[1]);
+  if (length == 0 || directory[length-1] != '/') {
+    strcat(directory, "/");
+  }
+
+  int numFailures = 0;
+  numFailures += testNoiseSeed(directory);
+  // the latency is B - gcd(N, B) for host buffers of N frames and blocks of B frames
+  numFailures += testProcessFrames(directory, 441, 63);
+  numFailures += testProcessFrames(directory, 100, 60);
+  numFailures += testProcessFrames(directory, 128, 0);
+  numFailures += testProcessFrames(directory, 1, 63);
+  numFailures += testEdit(directory);
+  if (numErrors > 0) {
+    printf("FAIL: %i errors\n", numErrors);
+    numFailures++;
+  }
+  if (numFailures == 0) {
+    printf("ok\n");
+  }
+  free(directory);
+  return (numFailures > 0) ? 1 : 0;
+}
@@ -0,0 +1,338 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ *
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * zgbench loads a patch, renders it offline for a number of seconds, and reports the results as
+ * JSON on standard output. Messages printed by the patch go to standard error.
+ *
+ * usage: zgbench [-b blockSize] [-r sampleRate] [-i numInputChannels] [-o numOutputChannels]
+ *                [-s seconds] [-e] [-p] [-v] path/to/patch.pd
+ *        zgbench -k [-b blockSize] [-s seconds]
+ *
+ * The second form benchmarks the ArrayArithmetic kernels instead of a patch.
+ *
+ * With -p, blocks are paced in real time as an audio device would request them. This is slower,
+ * but shows the block time jitter caused by other threads, e.g. when streaming from disk.
+ *
+ * With -e, objects which cannot affect the output are removed from the patch after it is loaded
+ * (see zg_prune_graph()).
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "ArrayArithmetic.h"
+#include "Profiler.h"
+#include "ZenGarden.h"
+
+/*
+ * Allocations are counted by wrapping the allocator. This is only possible with glibc, which
+ * exports its implementation under alternative names. Elsewhere, allocations are reported as -1.
+ * Only allocations made by the main (i.e., audio) thread are counted, not those of helper threads
+ * such as the disk thread.
+ */
+#if __GLIBC__
+extern "C" {
+  extern void *__libc_malloc(size_t size);
+  extern void *__libc_calloc(size_t numElements, size_t size);
+  extern void *__libc_realloc(void *ptr, size_t size);
+
+  static long numAllocations = 0;
+  static __thread bool isCountingThread = false;
+
+  void *malloc(size_t size) {
+    if (isCountingThread) {
+      numAllocations++;
+    }
+    return __libc_malloc(size);
+  }
+
+  void *calloc(size_t numElements, size_t size) {
+    if (isCountingThread) {
+      numAllocations++;
+    }
+    return __libc_calloc(numElements, size);
+  }
+
+  void *realloc(void *ptr, size_t size) {
+    if (isCountingThread) {
+      numAllocations++;
+    }
+    return __libc_realloc(ptr, size);
+  }
+};
+#define GET_NUM_ALLOCATIONS() numAllocations
+#define START_COUNTING_ALLOCATIONS() isCountingThread = true
+#else
+#define GET_NUM_ALLOCATIONS() -1L
+#define START_COUNTING_ALLOCATIONS()
+#endif
+
+static bool isVerbose = false;
+
+extern "C" {
+  void callbackFunction(ZGCallbackFunction function, void *userData, void *ptr) {
+    switch (function) {
+      case ZG_PRINT_STD: {
+        if (isVerbose) {
+          fprintf(stderr, "%s\n", (char *) ptr);
+        }
+        break;
+      }
+      case ZG_PRINT_ERR: {
+        fprintf(stderr, "ERROR: %s\n", (char *) ptr);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+};
+
+static int compareDoubles(const void *a, const void *b) {
+  double x = *((double *) a);
+  double y = *((double *) b);
+  return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/** Returns the peak resident set size of this process in kilobytes. */
+static long getPeakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  #if __APPLE__
+  return usage.ru_maxrss / 1024; // bytes on OS X
+  #else
+  return usage.ru_maxrss; // kilobytes on Linux
+  #endif
+}
+
+/** Returns the current time in microseconds. */
+static long long getMicroseconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return ((long long) now.tv_sec * 1000000LL) + now.tv_usec;
+}
+
+static void printUsage() {
+  fprintf(stderr, "usage: zgbench [-b blockSize] [-r sampleRate] [-i numInputChannels] "
+      "[-o numOutputChannels] [-s seconds] [-e] [-p] [-v] path/to/patch.pd\n"
+      "       zgbench -k [-b blockSize] [-s seconds]\n");
+}
+
+/** Times one kernel over the given number of iterations and prints its JSON entry. */
+#define BENCHMARK_KERNEL(name, statement, isLast) { \
+  unsigned long long startTicks = Profiler::getTicks(); \
+  for (int i = 0; i < numIterations; i++) { \
+    statement; \
+  } \
+  double ns = (Profiler::getTicks() - startTicks) * nsPerTick; \
+  printf("    \"%s\": %.4f%s\n", name, ns / ((double) numIterations * blockSize), isLast ? "" : ","); \
+}
+
+/** Benchmarks the <code>ArrayArithmetic</code> kernels. Reports nanoseconds per sample. */
+static int benchmarkKernels(int blockSize, double seconds) {
+  // 16-byte aligned buffers, as required by the SIMD implementations
+  float *input0 = NULL;
+  float *input1 = NULL;
+  float *output = NULL;
+  if (posix_memalign((void **) &input0, 16, blockSize * sizeof(float)) != 0 ||
+      posix_memalign((void **) &input1, 16, blockSize * sizeof(float)) != 0 ||
+      posix_memalign((void **) &output, 16, blockSize * sizeof(float)) != 0) {
+    fprintf(stderr, "Could not allocate kernel buffers.\n");
+    return 1;
+  }
+  for (int i = 0; i < blockSize; i++) {
+    input0[i] = (float) i / (float) blockSize;
+    input1[i] = 1.0f + (float) (blockSize - i) / (float) blockSize;
+  }
+
+  // each kernel is run as many times as there are blocks in the given duration at 44.1kHz
+  int numIterations = (int) (seconds * 44100.0 / blockSize);
+  if (numIterations < 1) {
+    numIterations = 1;
+  }
+  double nsPerTick = Profiler::getNanosecondsPerTick();
+
+  printf("{\n");
+  printf("  \"block_size\": %i,\n", blockSize);
+  printf("  \"iterations\": %i,\n", numIterations);
+  printf("  \"ns_per_sample\": {\n");
+  BENCHMARK_KERNEL("add", ArrayArithmetic::add(input0, input1, output, 0, blockSize), false);
+  BENCHMARK_KERNEL("add_scalar", ArrayArithmetic::add(input0, 0.5f, output, 0, blockSize), false);
+  BENCHMARK_KERNEL("subtract", ArrayArithmetic::subtract(input0, input1, output, 0, blockSize), false);
+  BENCHMARK_KERNEL("subtract_scalar", ArrayArithmetic::subtract(input0, 0.5f, output, 0, blockSize), false);
+  BENCHMARK_KERNEL("multiply", ArrayArithmetic::multiply(input0, input1, output, 0, blockSize), false);
+  BENCHMARK_KERNEL("multiply_scalar", ArrayArithmetic::multiply(input0, 0.5f, output, 0, blockSize), false);
+  BENCHMARK_KERNEL("divide", ArrayArithmetic::divide(input0, input1, output, 0, blockSize), false);
+  BENCHMARK_KERNEL("divide_scalar", ArrayArithmetic::divide(input0, 0.5f, output, 0, blockSize), true);
+  printf("  }\n");
+  printf("}\n");
+
+  free(input0);
+  free(input1);
+  free(output);
+  return 0;
+}
+
+int main(int argc, char * const argv[]) {
+  int blockSize = 64;
+  float sampleRate = 44100.0f;
+  int numInputChannels = 2;
+  int numOutputChannels = 2;
+  double seconds = 10.0;
+  bool shouldBenchmarkKernels = false;
+  bool isPaced = false;
+  bool shouldPrune = false;
+  START_COUNTING_ALLOCATIONS();
+
+  int option;
+  while ((option = getopt(argc, argv, "b:r:i:o:s:kepv")) != -1) {
+    switch (option) {
+      case 'b': blockSize = atoi(optarg); break;
+      case 'r': sampleRate = (float) atof(optarg); break;
+      case 'i': numInputChannels = atoi(optarg); break;
+      case 'o': numOutputChannels = atoi(optarg); break;
+      case 's': seconds = atof(optarg); break;
+      case 'k': shouldBenchmarkKernels = true; break;
+      case 'e': shouldPrune = true; break;
+      case 'p': isPaced = true; break;
+      case 'v': isVerbose = true; break;
+      default: {
+        printUsage();
+        return 1;
+      }
+    }
+  }
+  if (blockSize <= 0 || sampleRate <= 0.0f || numInputChannels < 0 || numOutputChannels < 0 ||
+      seconds <= 0.0) {
+    printUsage();
+    return 1;
+  }
+
+  if (shouldBenchmarkKernels) {
+    return benchmarkKernels(blockSize, seconds);
+  }
+  if (optind != argc-1) {
+    printUsage();
+    return 1;
+  }
+
+  // split the path into directory (including the trailing '/') and filename
+  char *path = strdup(argv[optind]);
+  char *filename = strrchr(path, '/');
+  char *directory = NULL;
+  if (filename == NULL) {
+    directory = strdup("./");
+    filename = path;
+  } else {
+    filename++;
+    directory = strndup(path, filename - path);
+  }
+
+  double nsPerTick = Profiler::getNanosecondsPerTick();
+  long numAllocationsBeforeLoad = GET_NUM_ALLOCATIONS();
+  unsigned long long loadStartTicks = Profiler::getTicks();
+  ZGGraph *graph = zg_new_graph(directory, filename, blockSize, numInputChannels, numOutputChannels,
+      sampleRate);
+  int numPrunedObjects = (graph != NULL && shouldPrune) ? zg_prune_graph(graph) : 0;
+  double loadMs = (Profiler::getTicks() - loadStartTicks) * nsPerTick / 1000000.0;
+  if (graph == NULL) {
+    fprintf(stderr, "Could not load \"%s\". Is the given path correct?\n", argv[optind]);
+    free(path);
+    free(directory);
+    return 1;
+  }
+  zg_register_callback(graph, callbackFunction, NULL);
+  long numAllocationsDuringLoad = GET_NUM_ALLOCATIONS() - numAllocationsBeforeLoad;
+
+  int numBlocks = (int) (seconds * sampleRate / blockSize);
+  if (numBlocks < 1) {
+    numBlocks = 1;
+  }
+  float *inputBuffers = (float *) calloc(numInputChannels * blockSize, sizeof(float));
+  float *outputBuffers = (float *) calloc(numOutputChannels * blockSize, sizeof(float));
+  double *blockTimesNs = (double *) malloc(numBlocks * sizeof(double));
+
+  // render
+  double blockDurationUs = blockSize * 1000000.0 / sampleRate;
+  long long pacingStartUs = getMicroseconds();
+  double processNs = 0.0;
+  long numAllocationsBeforeProcess = GET_NUM_ALLOCATIONS();
+  for (int i = 0; i < numBlocks; i++) {
+    unsigned long long blockStartTicks = Profiler::getTicks();
+    zg_process(graph, inputBuffers, outputBuffers);
+    blockTimesNs[i] = (Profiler::getTicks() - blockStartTicks) * nsPerTick;
+    processNs += blockTimesNs[i];
+    if (isPaced) {
+      // wait until the next block would be due
+      long long waitUs = pacingStartUs + (long long) ((i+1) * blockDurationUs) - getMicroseconds();
+      if (waitUs > 0) {
+        usleep((useconds_t) waitUs);
+      }
+    }
+  }
+  long numAllocationsDuringProcess = GET_NUM_ALLOCATIONS() - numAllocationsBeforeProcess;
+
+  // compute statistics
+  double renderedNs = (double) numBlocks * blockSize * 1000000000.0 / sampleRate;
+  qsort(blockTimesNs, numBlocks, sizeof(double), compareDoubles);
+  int p99Index = (int) (0.99 * (numBlocks - 1));
+
+  printf("{\n");
+  printf("  \"patch\": \"%s\",\n", argv[optind]);
+  printf("  \"block_size\": %i,\n", blockSize);
+  printf("  \"sample_rate\": %g,\n", sampleRate);
+  printf("  \"input_channels\": %i,\n", numInputChannels);
+  printf("  \"output_channels\": %i,\n", numOutputChannels);
+  printf("  \"blocks\": %i,\n", numBlocks);
+  printf("  \"paced\": %s,\n", isPaced ? "true" : "false");
+  printf("  \"rendered_seconds\": %.3f,\n", renderedNs / 1000000000.0);
+  printf("  \"load_ms\": %.3f,\n", loadMs);
+  printf("  \"pruned_objects\": %i,\n", numPrunedObjects);
+  printf("  \"realtime_factor\": %.3f,\n", renderedNs / processNs);
+  printf("  \"block_time_us\": {\n");
+  printf("    \"mean\": %.3f,\n", processNs / numBlocks / 1000.0);
+  printf("    \"p99\": %.3f,\n", blockTimesNs[p99Index] / 1000.0);
+  printf("    \"max\": %.3f\n", blockTimesNs[numBlocks-1] / 1000.0);
+  printf("  },\n");
+  printf("  \"allocations\": {\n");
+  printf("    \"load\": %li,\n", numAllocationsDuringLoad);
+  printf("    \"process\": %li\n", numAllocationsDuringProcess);
+  printf("  },\n");
+  printf("  \"peak_rss_kb\": %li\n", getPeakRssKb());
+  printf("}\n");
+
+  zg_delete_graph(graph);
+  free(inputBuffers);
+  free(outputBuffers);
+  free(blockTimesNs);
+  free(path);
+  free(directory);
+
+  return 0;
+}
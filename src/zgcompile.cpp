@@ -0,0 +1,402 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * zgcompile translates the audio objects of a patch into C++ and builds them into a shared
+ * library, which zg_new_compiled_graph() loads in place of the interpreted objects.
+ *
+ * usage: zgcompile [-b blockSize] [-r sampleRate] [-i numInputChannels] [-o numOutputChannels]
+ *                  [-q 15|31] [-k] path/to/patch.pd output.so
+ *        zgcompile -t [-b blockSize] [-r sampleRate] [-i numInputChannels] [-o numOutputChannels]
+ *                  [-q 15|31] [-e maxError] [-s seconds] path/to/patch.pd ...
+ *
+ * A library can only be loaded with the same patch and parameters with which it was compiled.
+ * With -k, the generated code is kept next to the library, as output.so.cpp. The compiler is given
+ * by the CXX environment variable, or is c++. With -q, the code computes with Q15 or Q31
+ * fixed-point samples instead of floats, for targets without a floating-point unit.
+ *
+ * The second form is the conformance test. Each patch is compiled, and the compiled graph is run
+ * alongside the interpreted one for the given duration, with the same input. Both must print the
+ * same messages and produce the same audio, to within the given error (0 by default, i.e.
+ * identical audio). A patch which cannot be loaded or compiled fails as well, such that the test
+ * cannot pass without testing anything. The exit status is 1 if any patch fails.
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ZenGarden.h"
+
+/** Collects the messages printed by a graph, such that those of two graphs can be compared. */
+typedef struct {
+  char *text;
+  int length;
+  int capacity;
+} PrintLog;
+
+extern "C" {
+  void callbackFunction(ZGCallbackFunction function, void *userData, void *ptr) {
+    switch (function) {
+      case ZG_PRINT_STD: {
+        PrintLog *printLog = (PrintLog *) userData;
+        if (printLog != NULL) {
+          int length = strlen((char *) ptr);
+          if (printLog->length + length + 2 > printLog->capacity) {
+            printLog->capacity = 2 * (printLog->length + length + 2);
+            printLog->text = (char *) realloc(printLog->text, printLog->capacity);
+          }
+          memcpy(printLog->text + printLog->length, ptr, length);
+          printLog->length += length;
+          printLog->text[printLog->length++] = '\n';
+          printLog->text[printLog->length] = '\0';
+        }
+        break;
+      }
+      case ZG_PRINT_ERR: {
+        fprintf(stderr, "ERROR: %s\n", (char *) ptr);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+};
+
+static void printUsage() {
+  fprintf(stderr, "usage: zgcompile [-b blockSize] [-r sampleRate] [-i numInputChannels] "
+      "[-o numOutputChannels]\n"
+      "                 [-q 15|31] [-k] path/to/patch.pd output.so\n"
+      "       zgcompile -t [-b blockSize] [-r sampleRate] [-i numInputChannels] "
+      "[-o numOutputChannels]\n"
+      "                 [-q 15|31] [-e maxError] [-s seconds] path/to/patch.pd ...\n");
+}
+
+/** Splits the path into directory (including the trailing '/') and filename. Both must be freed. */
+static void splitPath(const char *path, char **directory, char **filename) {
+  const char *separator = strrchr(path, '/');
+  if (separator == NULL) {
+    *directory = strdup("./");
+    *filename = strdup(path);
+  } else {
+    *directory = strndup(path, separator + 1 - path);
+    *filename = strdup(separator + 1);
+  }
+}
+
+/** Generates the code of the graph and builds it into a library at the given path. */
+static bool buildLibrary(ZGGraph *graph, const char *libraryPath, ZGSampleType sampleType,
+    bool shouldKeepSource) {
+  int sourcePathLength = strlen(libraryPath) + 5;
+  char *sourcePath = (char *) malloc(sourcePathLength);
+  snprintf(sourcePath, sourcePathLength, "%s.cpp", libraryPath);
+  if (!zg_generate_code_with_sample_type(graph, sourcePath, sampleType)) {
+    free(sourcePath);
+    return false;
+  }
+  
+  // contraction into fused multiply-adds would round differently than the interpreted objects
+  const char *compiler = (getenv("CXX") != NULL) ? getenv("CXX") : "c++";
+  int commandLength = strlen(compiler) + strlen(libraryPath) + sourcePathLength + 64;
+  char *command = (char *) malloc(commandLength);
+  snprintf(command, commandLength, "%s -O3 -fPIC -shared -ffp-contract=off -o \"%s\" \"%s\"",
+      compiler, libraryPath, sourcePath);
+  bool isBuilt = (system(command) == 0);
+  if (!isBuilt) {
+    fprintf(stderr, "Could not build \"%s\" with: %s\n", libraryPath, command);
+  }
+  if (!shouldKeepSource) {
+    unlink(sourcePath);
+  }
+  free(command);
+  free(sourcePath);
+  return isBuilt;
+}
+
+/**
+ * Renders the given patch, or its compiled version if a library is given, and writes the output
+ * followed by all printed messages into the given file. Returns <code>false</code> if the graph
+ * cannot be loaded. This is run in a child process, such that both versions of a patch start from
+ * the same global state, e.g. in the numbering of graphs by $0.
+ */
+static bool renderToFile(const char *path, const char *libraryPath, const char *outputPath,
+    int blockSize, float sampleRate, int numInputChannels, int numOutputChannels, int numBlocks) {
+  char *directory = NULL;
+  char *filename = NULL;
+  splitPath(path, &directory, &filename);
+  ZGGraph *graph = (libraryPath == NULL)
+      ? zg_new_graph(directory, filename, blockSize, numInputChannels, numOutputChannels, sampleRate)
+      : zg_new_compiled_graph(libraryPath, directory, filename, blockSize, numInputChannels,
+            numOutputChannels, sampleRate);
+  free(directory);
+  free(filename);
+  if (graph == NULL) {
+    return false;
+  }
+  PrintLog printLog = {NULL, 0, 0};
+  zg_register_callback(graph, callbackFunction, &printLog);
+  
+  FILE *file = fopen(outputPath, "wb");
+  float *inputBuffers = (float *) malloc(numInputChannels * blockSize * sizeof(float));
+  float *outputBuffers = (float *) malloc(numOutputChannels * blockSize * sizeof(float));
+  for (int i = 0; i < numBlocks; i++) {
+    // a different sine in each input channel
+    for (int j = 0; j < numInputChannels; j++) {
+      for (int k = 0; k < blockSize; k++) {
+        inputBuffers[j*blockSize + k] = sinf(0.01f * (j+1) * (float) (i*blockSize + k));
+      }
+    }
+    zg_process(graph, inputBuffers, outputBuffers);
+    fwrite(outputBuffers, sizeof(float), numOutputChannels * blockSize, file);
+  }
+  zg_delete_graph(graph); // messages which are still queued are printed now
+  if (printLog.length > 0) {
+    fwrite(printLog.text, 1, printLog.length, file);
+  }
+  fclose(file);
+  free(printLog.text);
+  free(inputBuffers);
+  free(outputBuffers);
+  return true;
+}
+
+/** Runs <code>renderToFile()</code> in a child process. */
+static bool renderToFileInChild(const char *path, const char *libraryPath, const char *outputPath,
+    int blockSize, float sampleRate, int numInputChannels, int numOutputChannels, int numBlocks) {
+  fflush(stdout);
+  fflush(stderr);
+  pid_t pid = fork();
+  if (pid == 0) {
+    _exit(renderToFile(path, libraryPath, outputPath, blockSize, sampleRate, numInputChannels,
+        numOutputChannels, numBlocks) ? 0 : 1);
+  }
+  int status = 0;
+  return (pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+/** Reads the whole file into memory. The returned buffer must be freed. */
+static char *readFile(const char *path, long *length) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    *length = 0;
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  *length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  char *buffer = (char *) malloc(*length + 1);
+  *length = fread(buffer, 1, *length, file);
+  fclose(file);
+  return buffer;
+}
+
+/** The result of comparing a compiled graph with the interpreted one. */
+typedef enum {
+  CONFORMANCE_OK,
+  CONFORMANCE_FAILED
+} ConformanceResult;
+
+static ConformanceResult testConformance(const char *path, const char *temporaryPath, int blockSize,
+    float sampleRate, int numInputChannels, int numOutputChannels, double seconds,
+    ZGSampleType sampleType, float maxError) {
+  char libraryPath[256];
+  char interpretedPath[256];
+  char compiledPath[256];
+  snprintf(libraryPath, sizeof(libraryPath), "%s.so", temporaryPath);
+  snprintf(interpretedPath, sizeof(interpretedPath), "%s.interpreted", temporaryPath);
+  snprintf(compiledPath, sizeof(compiledPath), "%s.compiled", temporaryPath);
+  
+  char *directory = NULL;
+  char *filename = NULL;
+  splitPath(path, &directory, &filename);
+  ZGGraph *graph = zg_new_graph(directory, filename, blockSize, numInputChannels, numOutputChannels,
+      sampleRate);
+  free(directory);
+  free(filename);
+  if (graph == NULL) {
+    printf("FAIL %s: could not be loaded\n", path);
+    return CONFORMANCE_FAILED;
+  }
+  zg_register_callback(graph, callbackFunction, NULL);
+  bool isBuilt = buildLibrary(graph, libraryPath, sampleType, false);
+  zg_delete_graph(graph);
+  if (!isBuilt) {
+    printf("FAIL %s: could not be compiled\n", path);
+    return CONFORMANCE_FAILED;
+  }
+  
+  int numBlocks = (int) (seconds * sampleRate / blockSize);
+  bool isRendered =
+      renderToFileInChild(path, NULL, interpretedPath, blockSize, sampleRate, numInputChannels,
+          numOutputChannels, numBlocks) &&
+      renderToFileInChild(path, libraryPath, compiledPath, blockSize, sampleRate, numInputChannels,
+          numOutputChannels, numBlocks);
+  unlink(libraryPath);
+  if (!isRendered) {
+    printf("FAIL %s: the compiled graph could not be loaded\n", path);
+    unlink(interpretedPath);
+    unlink(compiledPath);
+    return CONFORMANCE_FAILED;
+  }
+  
+  long interpretedLength = 0;
+  long compiledLength = 0;
+  char *interpretedData = readFile(interpretedPath, &interpretedLength);
+  char *compiledData = readFile(compiledPath, &compiledLength);
+  unlink(interpretedPath);
+  unlink(compiledPath);
+  
+  // the audio is followed by the printed messages
+  long numSamples = (long) numBlocks * numOutputChannels * blockSize;
+  float *interpretedOutput = (float *) interpretedData;
+  float *compiledOutput = (float *) compiledData;
+  float maxDifference = 0.0f;
+  int numDifferentSamples = 0;
+  for (long i = 0; i < numSamples; i++) {
+    if (interpretedOutput[i] != compiledOutput[i]) {
+      float difference = fabsf(interpretedOutput[i] - compiledOutput[i]);
+      if (!(difference <= maxDifference)) {
+        maxDifference = difference; // also NaN
+      }
+      if (!(difference <= maxError)) {
+        numDifferentSamples++;
+      }
+    }
+  }
+  
+  ConformanceResult result = CONFORMANCE_OK;
+  if (numDifferentSamples > 0) {
+    printf("FAIL %s: %i samples differ, by up to %g\n", path, numDifferentSamples, maxDifference);
+    result = CONFORMANCE_FAILED;
+  } else if (interpretedLength != compiledLength ||
+      memcmp(interpretedOutput + numSamples, compiledOutput + numSamples,
+          interpretedLength - numSamples * sizeof(float)) != 0) {
+    printf("FAIL %s: the printed messages differ\n", path);
+    result = CONFORMANCE_FAILED;
+  } else if (maxDifference > 0.0f) {
+    printf("ok %s: samples differ by up to %g\n", path, maxDifference);
+  } else {
+    printf("ok %s\n", path);
+  }
+  free(interpretedData);
+  free(compiledData);
+  return result;
+}
+
+int main(int argc, char * const argv[]) {
+  int blockSize = 64;
+  float sampleRate = 44100.0f;
+  int numInputChannels = 2;
+  int numOutputChannels = 2;
+  double seconds = 2.0;
+  ZGSampleType sampleType = ZG_SAMPLE_FLOAT;
+  float maxError = 0.0f;
+  bool isTesting = false;
+  bool shouldKeepSource = false;
+  
+  int option;
+  while ((option = getopt(argc, argv, "b:r:i:o:s:q:e:kt")) != -1) {
+    switch (option) {
+      case 'b': blockSize = atoi(optarg); break;
+      case 'r': sampleRate = (float) atof(optarg); break;
+      case 'i': numInputChannels = atoi(optarg); break;
+      case 'o': numOutputChannels = atoi(optarg); break;
+      case 's': seconds = atof(optarg); break;
+      case 'q': {
+        switch (atoi(optarg)) {
+          case 15: sampleType = ZG_SAMPLE_Q15; break;
+          case 31: sampleType = ZG_SAMPLE_Q31; break;
+          default: {
+            printUsage();
+            return 1;
+          }
+        }
+        break;
+      }
+      case 'e': maxError = (float) atof(optarg); break;
+      case 'k': shouldKeepSource = true; break;
+      case 't': isTesting = true; break;
+      default: {
+        printUsage();
+        return 1;
+      }
+    }
+  }
+  if (blockSize <= 0 || sampleRate <= 0.0f || numInputChannels < 0 || numOutputChannels < 0 ||
+      seconds <= 0.0 || maxError < 0.0f) {
+    printUsage();
+    return 1;
+  }
+  
+  if (isTesting) {
+    if (optind == argc) {
+      printUsage();
+      return 1;
+    }
+    char temporaryDirectory[] = "/tmp/zgcompile.XXXXXX";
+    if (mkdtemp(temporaryDirectory) == NULL) {
+      fprintf(stderr, "Could not create a temporary directory.\n");
+      return 1;
+    }
+    int numPassed = 0;
+    int numFailed = 0;
+    for (int i = optind; i < argc; i++) {
+      char temporaryPath[64];
+      snprintf(temporaryPath, sizeof(temporaryPath), "%s/patch%i", temporaryDirectory, i);
+      switch (testConformance(argv[i], temporaryPath, blockSize, sampleRate, numInputChannels,
+          numOutputChannels, seconds, sampleType, maxError)) {
+        case CONFORMANCE_OK: numPassed++; break;
+        case CONFORMANCE_FAILED: numFailed++; break;
+      }
+    }
+    rmdir(temporaryDirectory);
+    printf("%i passed, %i failed\n", numPassed, numFailed);
+    return (numFailed > 0) ? 1 : 0;
+  }
+  
+  if (optind != argc-2) {
+    printUsage();
+    return 1;
+  }
+  char *directory = NULL;
+  char *filename = NULL;
+  splitPath(argv[optind], &directory, &filename);
+  ZGGraph *graph = zg_new_graph(directory, filename, blockSize, numInputChannels, numOutputChannels,
+      sampleRate);
+  if (graph == NULL) {
+    fprintf(stderr, "Could not load \"%s\". Is the given path correct?\n", argv[optind]);
+    free(directory);
+    free(filename);
+    return 1;
+  }
+  zg_register_callback(graph, callbackFunction, NULL);
+  bool isBuilt = buildLibrary(graph, argv[optind+1], sampleType, shouldKeepSource);
+  zg_delete_graph(graph);
+  free(directory);
+  free(filename);
+  return isBuilt ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ * 
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * zgrender renders a patch offline into a WAV file, as fast as possible.
+ *
+ * usage: zgrender [-b blockSize] [-r sampleRate] [-i numInputChannels] [-o numOutputChannels]
+ *                 [-d seconds] [-l silenceSeconds] [-t silenceThreshold] [-w bitsPerSample]
+ *                 [-f input.wav] [-s seed] [-e] [-v] path/to/patch.pd output.wav
+ *
+ * The render stops after the given duration (-d), or once the output has been silent for the
+ * given time (-l), whichever comes first. At least one of the two must be given. With -e, objects
+ * which cannot affect the output are removed from the patch before rendering. With -s, [noise~] and
+ * [random] are seeded such that repeated renders are identical.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "ZenGarden.h"
+
+static bool isVerbose = false;
+
+extern "C" {
+  void callbackFunction(ZGCallbackFunction function, void *userData, void *ptr) {
+    switch (function) {
+      case ZG_PRINT_STD: {
+        if (isVerbose) {
+          fprintf(stderr, "%s\n", (char *) ptr);
+        }
+        break;
+      }
+      case ZG_PRINT_ERR: {
+        fprintf(stderr, "ERROR: %s\n", (char *) ptr);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+};
+
+static void printUsage() {
+  fprintf(stderr, "usage: zgrender [-b blockSize] [-r sampleRate] [-i numInputChannels] "
+      "[-o numOutputChannels]\n"
+      "                [-d seconds] [-l silenceSeconds] [-t silenceThreshold] [-w bitsPerSample]\n"
+      "                [-f input.wav] [-s seed] [-e] [-v] path/to/patch.pd output.wav\n");
+}
+
+static double getSeconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (double) now.tv_sec + ((double) now.tv_usec / 1000000.0);
+}
+
+int main(int argc, char * const argv[]) {
+  int blockSize = 64;
+  float sampleRate = 44100.0f;
+  int numInputChannels = 2;
+  int numOutputChannels = 2;
+  
+  bool shouldPrune = false;
+  
+  ZGRenderOptions options;
+  options.durationSeconds = 0.0;
+  options.silenceSeconds = 0.0;
+  options.silenceThreshold = 0.0001f; // -80dBFS
+  options.bitsPerSample = 16;
+  options.inputPath = NULL;
+  
+  int option;
+  while ((option = getopt(argc, argv, "b:r:i:o:d:l:t:w:f:s:ev")) != -1) {
+    switch (option) {
+      case 'b': blockSize = atoi(optarg); break;
+      case 'r': sampleRate = (float) atof(optarg); break;
+      case 'i': numInputChannels = atoi(optarg); break;
+      case 'o': numOutputChannels = atoi(optarg); break;
+      case 'd': options.durationSeconds = atof(optarg); break;
+      case 'l': options.silenceSeconds = atof(optarg); break;
+      case 't': options.silenceThreshold = (float) atof(optarg); break;
+      case 'w': options.bitsPerSample = atoi(optarg); break;
+      case 'f': options.inputPath = optarg; break;
+      case 's': zg_set_random_seed((unsigned int) strtoul(optarg, NULL, 10)); break;
+      case 'e': shouldPrune = true; break;
+      case 'v': isVerbose = true; break;
+      default: {
+        printUsage();
+        return 1;
+      }
+    }
+  }
+  if (optind != argc-2 || blockSize <= 0 || sampleRate <= 0.0f || numInputChannels < 0 ||
+      numOutputChannels <= 0) {
+    printUsage();
+    return 1;
+  }
+  
+  // split the path into directory (including the trailing '/') and filename
+  char *path = strdup(argv[optind]);
+  char *filename = strrchr(path, '/');
+  char *directory = NULL;
+  if (filename == NULL) {
+    directory = strdup("./");
+    filename = path;
+  } else {
+    filename++;
+    directory = strndup(path, filename - path);
+  }
+  
+  ZGGraph *graph = zg_new_graph(directory, filename, blockSize, numInputChannels, numOutputChannels,
+      sampleRate);
+  free(path);
+  free(directory);
+  if (graph == NULL) {
+    fprintf(stderr, "Could not load \"%s\". Is the given path correct?\n", argv[optind]);
+    return 1;
+  }
+  zg_register_callback(graph, callbackFunction, NULL);
+  if (shouldPrune) {
+    int numPrunedObjects = zg_prune_graph(graph);
+    if (isVerbose) {
+      fprintf(stderr, "Removed %i objects which cannot affect the output.\n", numPrunedObjects);
+    }
+  }
+  
+  double startSeconds = getSeconds();
+  long long numFrames = zg_render_to_file(graph, argv[optind+1], &options);
+  double elapsedSeconds = getSeconds() - startSeconds;
+  zg_delete_graph(graph);
+  if (numFrames < 0) {
+    return 1;
+  }
+  
+  double renderedSeconds = (double) numFrames / sampleRate;
+  fprintf(stderr, "Rendered %.3f seconds in %.3f seconds (%.1fx realtime).\n",
+      renderedSeconds, elapsedSeconds, renderedSeconds / elapsedSeconds);
+  return 0;
+}
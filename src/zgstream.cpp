@@ -0,0 +1,329 @@
+/*
+ *  Copyright 2010 Reality Jockey, Ltd.
+ *                 info@rjdj.me
+ *                 http://rjdj.me/
+ *
+ *  This file is part of ZenGarden.
+ *
+ *  ZenGarden is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  ZenGarden is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with ZenGarden.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * zgstream tests the streaming of sound files. It records a known signal with a patch containing
+ * [writesf~ 4], plays the file back with a patch containing [readsf~ 4], and checks that the audio
+ * is read back exactly. Both patches are controlled through [r zgstream], and are run in real time
+ * as an audio device would run them, such that the disk thread must keep up.
+ *
+ * usage: zgstream [-b blockSize] [-r sampleRate] [-s seconds] [-d maxDropouts] [-j maxJitterUs]
+ *                 path/to/StreamWrite.pd path/to/StreamRead.pd
+ *
+ * The test fails if the audio read back differs from the recorded audio, if the streams drop more
+ * than the given number of blocks (0 by default), or if any block takes longer than the median
+ * block by more than the given jitter (half a block by default). The exit status is then 1.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "Profiler.h"
+#include "ZenGarden.h"
+
+/** The number of channels recorded and played back by the test patches. */
+#define NUM_STREAM_CHANNELS 4
+
+/** The time given to the disk thread to open a file before a stream is started, in seconds. */
+#define STREAM_PREROLL_SECONDS 0.5
+
+/** Collects the reports of the streams and counts the errors of a graph. */
+typedef struct {
+  int numDropouts;
+  int numErrors;
+} StreamLog;
+
+extern "C" {
+  void callbackFunction(ZGCallbackFunction function, void *userData, void *ptr) {
+    StreamLog *streamLog = (StreamLog *) userData;
+    switch (function) {
+      case ZG_PRINT_STD: {
+        // e.g. "readsf~: 4 channels, playing, 0 dropouts."
+        const char *report = strrchr((char *) ptr, ',');
+        int numDropouts = 0;
+        if (report != NULL && sscanf(report, ", %i dropouts", &numDropouts) == 1) {
+          streamLog->numDropouts += numDropouts;
+        }
+        break;
+      }
+      case ZG_PRINT_ERR: {
+        fprintf(stderr, "ERROR: %s\n", (char *) ptr);
+        streamLog->numErrors++;
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+};
+
+static void printUsage() {
+  fprintf(stderr, "usage: zgstream [-b blockSize] [-r sampleRate] [-s seconds] [-d maxDropouts] "
+      "[-j maxJitterUs]\n"
+      "                path/to/StreamWrite.pd path/to/StreamRead.pd\n");
+}
+
+/** Splits the path into directory (including the trailing '/') and filename. Both must be freed. */
+static void splitPath(const char *path, char **directory, char **filename) {
+  const char *separator = strrchr(path, '/');
+  if (separator == NULL) {
+    *directory = strdup("./");
+    *filename = strdup(path);
+  } else {
+    *directory = strndup(path, separator + 1 - path);
+    *filename = strdup(separator + 1);
+  }
+}
+
+/** Returns the current time in microseconds. */
+static long long getMicroseconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return ((long long) now.tv_sec * 1000000LL) + now.tv_usec;
+}
+
+static int compareDoubles(const void *a, const void *b) {
+  double x = *((double *) a);
+  double y = *((double *) b);
+  return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/**
+ * The recorded signal. Every sample is exactly representable, never zero, and identifies its frame
+ * and channel, such that any dropped, repeated or shifted audio is detected.
+ */
+static inline float getTestSample(long frameIndex, int channel) {
+  return (float) (((frameIndex + channel * 65536L) & 0xFFFFF) + 1) / 2097152.0f;
+}
+
+/** Runs graphs in real time, measuring the time taken by each block. */
+typedef struct {
+  double blockDurationUs;
+  long long startUs;
+  long numBlocks; // the number of blocks processed since the start
+  double *blockTimesNs;
+  int numTimedBlocks;
+  double nsPerTick;
+} Pacer;
+
+/** Processes one block of the graph, then waits until the next block would be due. */
+static void processPaced(Pacer *pacer, ZGGraph *graph, float *inputBuffers, float *outputBuffers) {
+  unsigned long long startTicks = Profiler::getTicks();
+  zg_process(graph, inputBuffers, outputBuffers);
+  pacer->blockTimesNs[pacer->numTimedBlocks++] = (Profiler::getTicks() - startTicks) * pacer->nsPerTick;
+  long long waitUs = pacer->startUs + (long long) (++pacer->numBlocks * pacer->blockDurationUs) -
+      getMicroseconds();
+  if (waitUs > 0) {
+    usleep((useconds_t) waitUs);
+  }
+}
+
+static ZGGraph *newGraph(const char *path, int blockSize, float sampleRate, StreamLog *streamLog) {
+  char *directory = NULL;
+  char *filename = NULL;
+  splitPath(path, &directory, &filename);
+  ZGGraph *graph = zg_new_graph(directory, filename, blockSize, NUM_STREAM_CHANNELS,
+      NUM_STREAM_CHANNELS, sampleRate);
+  free(directory);
+  free(filename);
+  if (graph == NULL) {
+    fprintf(stderr, "Could not load \"%s\". Is the given path correct?\n", path);
+  } else {
+    zg_register_callback(graph, callbackFunction, streamLog);
+  }
+  return graph;
+}
+
+int main(int argc, char * const argv[]) {
+  int blockSize = 64;
+  float sampleRate = 44100.0f;
+  double seconds = 10.0;
+  int maxDropouts = 0;
+  double maxJitterUs = -1.0; // half a block
+
+  int option;
+  while ((option = getopt(argc, argv, "b:r:s:d:j:")) != -1) {
+    switch (option) {
+      case 'b': blockSize = atoi(optarg); break;
+      case 'r': sampleRate = (float) atof(optarg); break;
+      case 's': seconds = atof(optarg); break;
+      case 'd': maxDropouts = atoi(optarg); break;
+      case 'j': maxJitterUs = atof(optarg); break;
+      default: {
+        printUsage();
+        return 1;
+      }
+    }
+  }
+  if (blockSize <= 0 || sampleRate <= 0.0f || seconds <= 0.0 || maxDropouts < 0 ||
+      optind != argc-2) {
+    printUsage();
+    return 1;
+  }
+
+  char temporaryDirectory[] = "/tmp/zgstream.XXXXXX";
+  if (mkdtemp(temporaryDirectory) == NULL) {
+    fprintf(stderr, "Could not create a temporary directory.\n");
+    return 1;
+  }
+  char soundfilePath[64];
+  snprintf(soundfilePath, sizeof(soundfilePath), "%s/stream.wav", temporaryDirectory);
+
+  int numBlocks = (int) (seconds * sampleRate / blockSize);
+  int numPrerollBlocks = (int) (STREAM_PREROLL_SECONDS * sampleRate / blockSize) + 1;
+  int numBufferSamples = NUM_STREAM_CHANNELS * blockSize;
+  float *inputBuffers = (float *) calloc(numBufferSamples, sizeof(float));
+  float *outputBuffers = (float *) calloc(numBufferSamples, sizeof(float));
+  // the playback is followed by a preroll's worth of blocks, during which the stream must be silent
+  long numPlayedFrames = (long) (numBlocks + numPrerollBlocks) * blockSize;
+  float *playedSamples = (float *) malloc(numPlayedFrames * NUM_STREAM_CHANNELS * sizeof(float));
+
+  Pacer pacer;
+  pacer.blockDurationUs = blockSize * 1000000.0 / sampleRate;
+  pacer.numBlocks = 0;
+  pacer.blockTimesNs = (double *) malloc(2 * (numBlocks + 2 * numPrerollBlocks + 2) * sizeof(double));
+  pacer.numTimedBlocks = 0;
+  pacer.nsPerTick = Profiler::getNanosecondsPerTick();
+  if (maxJitterUs < 0.0) {
+    maxJitterUs = pacer.blockDurationUs / 2.0;
+  }
+
+  // record
+  StreamLog writeLog = {0, 0};
+  ZGGraph *graph = newGraph(argv[optind], blockSize, sampleRate, &writeLog);
+  if (graph == NULL) {
+    rmdir(temporaryDirectory);
+    return 1;
+  }
+  pacer.startUs = getMicroseconds();
+  zg_send_message(graph, "zgstream", "ssfs", "open", "-bytes", 4.0f, soundfilePath);
+  for (int i = 0; i < numPrerollBlocks; i++) {
+    processPaced(&pacer, graph, inputBuffers, outputBuffers);
+  }
+  // the recording begins with the block at which it is started
+  long firstRecordedFrame = pacer.numBlocks * blockSize;
+  zg_send_message(graph, "zgstream", "s", "start");
+  for (int i = 0; i < numBlocks; i++) {
+    long frameIndex = pacer.numBlocks * blockSize;
+    for (int j = 0; j < NUM_STREAM_CHANNELS; j++) {
+      for (int k = 0; k < blockSize; k++) {
+        inputBuffers[j*blockSize + k] = getTestSample(frameIndex + k, j);
+      }
+    }
+    processPaced(&pacer, graph, inputBuffers, outputBuffers);
+  }
+  zg_send_message(graph, "zgstream", "s", "print");
+  zg_send_message(graph, "zgstream", "s", "stop");
+  processPaced(&pacer, graph, inputBuffers, outputBuffers);
+  zg_delete_graph(graph); // waits for the file to be closed
+  memset(inputBuffers, 0, numBufferSamples * sizeof(float));
+
+  // play back
+  StreamLog readLog = {0, 0};
+  graph = newGraph(argv[optind+1], blockSize, sampleRate, &readLog);
+  if (graph == NULL) {
+    unlink(soundfilePath);
+    rmdir(temporaryDirectory);
+    return 1;
+  }
+  pacer.startUs = getMicroseconds();
+  pacer.numBlocks = 0;
+  zg_send_message(graph, "zgstream", "ss", "open", soundfilePath);
+  for (int i = 0; i < numPrerollBlocks; i++) {
+    processPaced(&pacer, graph, inputBuffers, outputBuffers);
+  }
+  zg_send_message(graph, "zgstream", "s", "start");
+  for (long i = 0; i < numPlayedFrames; i += blockSize) {
+    processPaced(&pacer, graph, inputBuffers, outputBuffers);
+    for (int j = 0; j < NUM_STREAM_CHANNELS; j++) {
+      for (int k = 0; k < blockSize; k++) {
+        playedSamples[(i+k)*NUM_STREAM_CHANNELS + j] = outputBuffers[j*blockSize + k];
+      }
+    }
+  }
+  zg_send_message(graph, "zgstream", "s", "print");
+  processPaced(&pacer, graph, inputBuffers, outputBuffers);
+  zg_delete_graph(graph);
+  unlink(soundfilePath);
+  rmdir(temporaryDirectory);
+
+  // the file must be played back from its first frame to its last, followed by silence
+  long numRecordedFrames = (long) numBlocks * blockSize;
+  long numDifferentFrames = 0;
+  long firstDifferentFrame = -1;
+  for (long i = 0; i < numPlayedFrames; i++) {
+    for (int j = 0; j < NUM_STREAM_CHANNELS; j++) {
+      float expectedSample = (i < numRecordedFrames) ? getTestSample(firstRecordedFrame + i, j) : 0.0f;
+      if (playedSamples[i*NUM_STREAM_CHANNELS + j] != expectedSample) {
+        if (firstDifferentFrame < 0) {
+          firstDifferentFrame = i;
+        }
+        numDifferentFrames++;
+        break;
+      }
+    }
+  }
+
+  qsort(pacer.blockTimesNs, pacer.numTimedBlocks, sizeof(double), compareDoubles);
+  double medianBlockTimeUs = pacer.blockTimesNs[pacer.numTimedBlocks/2] / 1000.0;
+  double maxBlockTimeUs = pacer.blockTimesNs[pacer.numTimedBlocks-1] / 1000.0;
+  int numDropouts = writeLog.numDropouts + readLog.numDropouts;
+  int numErrors = writeLog.numErrors + readLog.numErrors;
+
+  printf("streamed %.1f MB in each direction\n",
+      numRecordedFrames * NUM_STREAM_CHANNELS * sizeof(float) / 1048576.0);
+  printf("block time: median %.1f us, max %.1f us\n", medianBlockTimeUs, maxBlockTimeUs);
+  bool hasFailed = false;
+  if (numErrors > 0) {
+    printf("FAIL: %i errors\n", numErrors);
+    hasFailed = true;
+  }
+  if (numDifferentFrames > 0) {
+    printf("FAIL: %li of %li frames differ, the first at frame %li\n", numDifferentFrames,
+        numPlayedFrames, firstDifferentFrame);
+    hasFailed = true;
+  }
+  if (numDropouts > maxDropouts) {
+    printf("FAIL: %i blocks dropped (writesf~: %i, readsf~: %i), at most %i allowed\n", numDropouts,
+        writeLog.numDropouts, readLog.numDropouts, maxDropouts);
+    hasFailed = true;
+  }
+  if (maxBlockTimeUs - medianBlockTimeUs > maxJitterUs) {
+    printf("FAIL: block time jitter of %.1f us, at most %.1f us allowed\n",
+        maxBlockTimeUs - medianBlockTimeUs, maxJitterUs);
+    hasFailed = true;
+  }
+  if (!hasFailed) {
+    printf("ok\n");
+  }
+
+  free(inputBuffers);
+  free(outputBuffers);
+  free(playedSamples);
+  free(pacer.blockTimesNs);
+  return hasFailed ? 1 : 0;
+}
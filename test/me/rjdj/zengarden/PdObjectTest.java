@@ -63,6 +63,61 @@ public class PdObjectTest implements ZenGardenListener {
     // nothing to do
   }
   
+  @Test
+  public void testDspBang() {
+    genericMessageTest("DspBang.pd", 4);
+  }
+
+  @Test
+  public void testDspClone() {
+    genericMessageTest("DspClone.pd", 15);
+  }
+
+  @Test
+  public void testDspEnvelope() {
+    genericMessageTest("DspEnvelope.pd", 14);
+  }
+
+  @Test
+  public void testDspSplitBlock() {
+    genericMessageTest("DspSplitBlock.pd", 6);
+  }
+
+  @Test
+  public void testDspTableOsc4() {
+    genericMessageTest("DspTableOsc4.pd", 14);
+  }
+
+  @Test
+  public void testDspTablePlay() {
+    genericMessageTest("DspTablePlay.pd", 22);
+  }
+
+  @Test
+  public void testDspTableRead4() {
+    genericMessageTest("DspTableRead4.pd", 2);
+  }
+
+  @Test
+  public void testDspTableWrite() {
+    genericMessageTest("DspTableWrite.pd", 15);
+  }
+
+  @Test
+  public void testDspThreshold() {
+    genericMessageTest("DspThreshold.pd", 4);
+  }
+
+  @Test
+  public void testDspVLine() {
+    genericMessageTest("DspVLine.pd", 13);
+  }
+
+  @Test
+  public void testDspVSnapshot() {
+    genericMessageTest("DspVSnapshot.pd");
+  }
+
   @Test
   public void testMessageAdd() {
     genericMessageTest("MessageAdd.pd");
@@ -78,6 +133,16 @@ public class PdObjectTest implements ZenGardenListener {
     genericMessageTest("MessageCosine.pd");
   }
 
+  @Test
+  public void testMessageCtlin() {
+    genericMidiTest("MessageCtlin.pd", new int[][] {
+        {0xB0, 7, 100, 0}, // controller 7 on the first channel
+        {0xB1, 7, 50, 8}, // controller 7 on the second channel
+        {0xB1, 1, 20, 16}, // another controller on the second channel
+        {0xBF, 7, 127, 32}, // controller 7 on the last channel
+        {0x91, 7, 100, 40}}); // a note, which is not received by [ctlin]
+  }
+
   @Test
   public void testMessageDivide() {
     genericMessageTest("MessageDivide.pd");
@@ -144,11 +209,37 @@ public class PdObjectTest implements ZenGardenListener {
     genericMessageTest("MessageNotEquals.pd");
   }
   
+  @Test
+  public void testMessageNotein() {
+    genericMidiTest("MessageNotein.pd", new int[][] {
+        {0x90, 60, 100, 0}, // note on, first channel
+        {0x91, 62, 90, 8}, // note on, second channel
+        {0x81, 62, 64, 16}, // note off with release velocity, second channel
+        {0x9F, 64, 80, 32}, // note on, last channel
+        {0x92, 65, 70, 44}}); // note on, third channel
+  }
+
   @Test
   public void testMessagePack() {
     genericMessageTest("MessagePack.pd");
   }
+
+  @Test
+  public void testMessagePoly() {
+    genericMessageTest("MessagePoly.pd");
+  }
   
+  @Test
+  public void testMessageQlist() {
+    genericMessageTest("MessageQlist.pd", 56);
+  }
+
+  @Test
+  public void testMessageRandom() {
+    // the same seed yields the same sequence
+    genericMessageTest("MessageRandom.pd");
+  }
+
   @Test
   public void testMessageSine() {
     genericMessageTest("MessageSine.pd");
@@ -159,12 +250,42 @@ public class PdObjectTest implements ZenGardenListener {
     genericMessageTest("MessageSubtract.pd");
   }
 
+  @Test
+  public void testMessageTextfile() {
+    // writes test/MessageTextfile.txt, and reads it back
+    genericMessageTest("MessageTextfile.pd");
+  }
+
   /**
    * Encompasses a generic test for message objects. It processes the graph once and compares the
    * standard output to the golden file, and ensures that the error output is empty.
    * @param testFilename
    */
   private void genericMessageTest(String testFilename) {
+    genericMessageTest(testFilename, 1);
+  }
+  
+  /**
+   * As <code>genericMessageTest(String)</code>, but processes the graph for the given number of
+   * blocks, such that messages which are scheduled later than the first block can be tested.
+   * @param testFilename
+   * @param numBlocks
+   */
+  private void genericMessageTest(String testFilename, int numBlocks) {
+    genericMessageTest(testFilename, numBlocks, new int[0][]);
+  }
+  
+  /**
+   * As <code>genericMessageTest(String)</code>, but sends the given MIDI events to the graph before
+   * it is processed. Each event is given as <code>{status, data1, data2, blockIndex}</code>.
+   * @param testFilename
+   * @param midiEvents
+   */
+  private void genericMidiTest(String testFilename, int[][] midiEvents) {
+    genericMessageTest(testFilename, 1, midiEvents);
+  }
+  
+  private void genericMessageTest(String testFilename, int numBlocks, int[][] midiEvents) {
     ZenGarden graph = null;
     try {
       graph = new ZenGarden(new File(TEST_PATHNAME, testFilename),
@@ -174,7 +295,12 @@ public class PdObjectTest implements ZenGardenListener {
     }
     graph.addListener(this);
     
-    graph.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    for (int[] event : midiEvents) {
+      graph.sendMidiEvent(event[0], event[1], event[2], event[3]);
+    }
+    for (int i = 0; i < numBlocks; i++) {
+      graph.process(INPUT_BUFFER, OUTPUT_BUFFER);
+    }
     
     String messageStdOutput = stringBuilderStd.toString();
     String messageErrOutput = stringBuilderErr.toString();